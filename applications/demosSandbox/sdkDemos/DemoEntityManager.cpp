@@ -94,6 +94,7 @@ void NonUniformScaledCollision (DemoEntityManager* const scene);
 void ScaledMeshCollision (DemoEntityManager* const scene);
 void ContinuousCollision (DemoEntityManager* const scene);
 void ContinuousCollision1 (DemoEntityManager* const scene);
+void SpeculativeContacts (DemoEntityManager* const scene);
 void PuckSlide (DemoEntityManager* const scene);
 void SceneCollision (DemoEntityManager* const scene);
 void CompoundCollision(DemoEntityManager* const scene);
@@ -146,6 +147,7 @@ DemoEntityManager::SDKDemos DemoEntityManager::m_demosSelection[] =
 	{"Scaled mesh collision", "demonstrate scaling mesh scaling collision", ScaledMeshCollision},
 	{"Continuous collision", "show continuous collision", ContinuousCollision },
 	{"Paper wall continuous collision", "show fast continuous collision", ContinuousCollision1 },
+	{"Speculative contacts", "show fast bodies stopped by speculative contacts", SpeculativeContacts },
 	{"Puck slide", "show continuous collision", PuckSlide },
 	{"Simple convex decomposition", "demonstrate convex decomposition and compound collision", SimpleConvexApproximation},
 	{"Multi geometry collision", "show static mesh with the ability of moving internal parts", SceneCollision},
@@ -712,6 +714,7 @@ void DemoEntityManager::ShowMainMenuBar()
 
 			ImGui::RadioButton("default broad phase", &m_broadPhaseType, 0);
 			ImGui::RadioButton("persistence broad phase", &m_broadPhaseType, 1);
+			ImGui::RadioButton("sweep and prune broad phase", &m_broadPhaseType, 2);
 			ImGui::Separator();
 
 			ImGui::RadioButton("Iterative solver one passes", &m_solverPasses, 1);
@@ -898,7 +901,7 @@ void DemoEntityManager::RenderStats()
 			sprintf (text, "physics time: %6.3f ms", m_mainThreadPhysicsTime * 1000.0f);
 			ImGui::Text(text);
 
-			sprintf (text, "memory used:   %d kbytes", NewtonGetMemoryUsed() / 1024);
+			sprintf (text, "memory used:   %d kbytes", int (NewtonGetMemoryUsed64() / 1024));
 			ImGui::Text(text);
 
 			if (m_currentPlugin) {
@@ -0,0 +1,65 @@
+/* Copyright (c) <2003-2016> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "toolbox_stdafx.h"
+#include "SkyBox.h"
+#include "DemoMesh.h"
+#include "DemoEntityManager.h"
+#include "DemoCamera.h"
+#include "PhysicsUtils.h"
+
+// a row of small spheres is shot at a thin wall, the spheres travel many times the wall
+// thickness in one step. the spheres on the left use speculative contacts and stop at the wall,
+// the spheres on the right do not use continuous collision and tunnel through it.
+static void FireSpheres (DemoEntityManager* const scene, const dVector& origin, dFloat speed, int count, bool speculative)
+{
+	NewtonWorld* const world = scene->GetNewton();
+	int defaultMaterialID = NewtonMaterialGetDefaultGroupID (world);
+
+	dVector size (0.25f, 0.25f, 0.25f, 0.0f);
+	NewtonCollision* const collision = CreateConvexCollision (world, dGetIdentityMatrix(), size, _SPHERE_PRIMITIVE, defaultMaterialID);
+	DemoMesh* const geometry = new DemoMesh("sphere", collision, speculative ? "smilli.tga" : "wood_0.tga", "wood_0.tga", "wood_0.tga");
+
+	dMatrix matrix (dGetIdentityMatrix());
+	dVector veloc (speed, 0.0f, 0.0f, 0.0f);
+	for (int i = 0; i < count; i ++) {
+		matrix.m_posit = origin;
+		matrix.m_posit.m_y += i * 0.6f;
+		matrix.m_posit.m_w = 1.0f;
+		NewtonBody* const body = CreateSimpleSolid (scene, geometry, 1.0f, matrix, collision, defaultMaterialID);
+		NewtonBodySetVelocity (body, &veloc[0]);
+		NewtonBodySetContinuousCollisionMode (body, speculative ? 1 : 0);
+		NewtonBodySetSpeculativeContactsMode (body, speculative ? 1 : 0);
+	}
+
+	geometry->Release();
+	NewtonDestroyCollision (collision);
+}
+
+void SpeculativeContacts (DemoEntityManager* const scene)
+{
+	// load the skybox
+	scene->CreateSkyBox();
+
+	AddFloorBox (scene, dVector (0.0f, -0.5f, 0.0f, 0.0f), dVector (100.0f, 1.0f, 100.0f, 0.0f));
+
+	// the wall is a tenth of a meter thick, at 60 steps per second the spheres move 2.5 meters per step
+	AddFloorBox (scene, dVector (10.0f, 3.0f, 0.0f, 0.0f), dVector (0.1f, 6.0f, 20.0f, 0.0f));
+
+	const dFloat speed = 150.0f;
+	FireSpheres (scene, dVector (-10.0f, 0.5f, -4.0f, 0.0f), speed, 8, true);
+	FireSpheres (scene, dVector (-10.0f, 0.5f, 4.0f, 0.0f), speed, 8, false);
+
+	dMatrix camMatrix (dYawMatrix (-30.0f * dDegreeToRad));
+	dQuaternion rot (camMatrix);
+	dVector origin (-25.0f, 4.0f, 0.0f, 0.0f);
+	scene->SetCameraMatrix (rot, origin);
+}
@@ -303,6 +303,7 @@ typedef void (*NewtonReportProgress) (dFloat progressNormalzedPercent);
 -(int) NewtonWorldGetVersion;
 -(int) NewtonWorldFloatSize;
 -(int) NewtonGetMemoryUsed;
+-(long long) NewtonGetMemoryUsed64;
 -(void) NewtonSetMemorySystem: (NewtonAllocMemory) malloc: (NewtonFreeMemory) free;
 -(struct iosNewtonWorld*) NewtonCreate;
 -(void) NewtonDestroy: (const NewtonWorld* const) newtonWorld;
@@ -47,6 +47,7 @@
 #include "dgFastQueue.h"
 #include "dgPolyhedra.h"
 #include "dgThreadHive.h"
+#include "dgParallelSort.h"
 #include "dgPathFinder.h"
 #include "dgRefCounter.h"
 #include "dgQuaternion.h"
@@ -56,6 +57,8 @@
 #include "dgIntersections.h"
 #include "dgGeneralVector.h"
 #include "dgGeneralMatrix.h"
+#include "dgSparseLDLt.h"
+#include "dgFrameAllocator.h"
 #include "dgAABBPolygonSoup.h"
 #include "dgSmallDeterminant.h"
 #include "dgPolygonSoupBuilder.h"
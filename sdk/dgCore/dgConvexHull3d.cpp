@@ -23,11 +23,16 @@
 #include "dgStack.h"
 #include "dgTree.h"
 #include "dgGoogol.h"
+#include "dgThreadHive.h"
 #include "dgConvexHull3d.h"
 #include "dgSmallDeterminant.h"
 
 
 #define DG_CONVEXHULL_3D_VERTEX_CLUSTER_SIZE		8
+#define DG_CONVEXHULL_3D_PARTITION_SIZE				(1024 * 2)
+#define DG_CONVEXHULL_3D_PARALLEL_MIN_COUNT			(DG_CONVEXHULL_3D_PARTITION_SIZE * 4)
+#define DG_CONVEXHULL_3D_SEED_DIRECTIONS			14
+#define DG_CONVEXHULL_3D_SEED_MAX_PLANES			(2 * DG_CONVEXHULL_3D_SEED_DIRECTIONS)
 
 #ifdef	DG_OLD_CONVEXHULL_3D
 class dgConvexHull3d::dgNormalMap
@@ -122,12 +127,85 @@ class dgConvexHull3dPointCluster: public dgConvexHull3dAABBTreeNode
 };
 
 
+// shared data for building the hull of a large point cloud in parallel. the cloud is split in 
+// partitions of fix size, so that the result does not depend on the number of threads.
+class dgConvexHull3dPartitionDescriptor
+{
+	public:
+	// remove the points that are inside the seed polytope, the distance to the planes is 
+	// calculated in single precision four points at a time, points closer than the margin
+	// to the boundary are kept and left to the exact predicates of the hull builder.
+	dgInt32 CullInteriorPoints (const dgBigVector* const points, dgInt32 count, dgBigVector* const output) const
+	{
+		if (!m_planesCount) {
+			for (dgInt32 i = 0; i < count; i ++) {
+				output[i] = points[i];
+			}
+			return count;
+		}
+
+		dgInt32 outCount = 0;
+		const dgVector negativeMargin (-m_margin);
+		for (dgInt32 i = 0; i < count; i += 4) {
+			dgVector p[4];
+			for (dgInt32 j = 0; j < 4; j ++) {
+				const dgInt32 index = dgMin (i + j, count - 1);
+				p[j] = dgVector (points[index] - m_origin);
+			}
+			dgVector x;
+			dgVector y;
+			dgVector z;
+			dgVector w;
+			dgVector::Transpose4x4 (x, y, z, w, p[0], p[1], p[2], p[3]);
+
+			dgVector maxDist (dgFloat32 (-1.0e20f));
+			for (dgInt32 j = 0; j < m_planesCount; j ++) {
+				const dgVector dist (m_planeX[j] * x + m_planeY[j] * y + m_planeZ[j] * z + m_planeW[j]);
+				maxDist = maxDist.GetMax(dist);
+				if (!(maxDist < negativeMargin).GetSignMask()) {
+					break;
+				}
+			}
+
+			const dgInt32 interiorMask = (maxDist < negativeMargin).GetSignMask();
+			const dgInt32 batchCount = dgMin (4, count - i);
+			for (dgInt32 j = 0; j < batchCount; j ++) {
+				if (!(interiorMask & (1 << j))) {
+					output[outCount] = points[i + j];
+					outCount ++;
+				}
+			}
+		}
+		return outCount;
+	}
+
+	dgVector m_planeX[DG_CONVEXHULL_3D_SEED_MAX_PLANES];
+	dgVector m_planeY[DG_CONVEXHULL_3D_SEED_MAX_PLANES];
+	dgVector m_planeZ[DG_CONVEXHULL_3D_SEED_MAX_PLANES];
+	dgVector m_planeW[DG_CONVEXHULL_3D_SEED_MAX_PLANES];
+	dgBigVector m_origin;
+	dgBigVector m_seedDirections[DG_CONVEXHULL_3D_SEED_DIRECTIONS];
+	dgFloat64 m_seedDist[DG_MAX_THREADS_HIVE_COUNT][DG_CONVEXHULL_3D_SEED_DIRECTIONS];
+	dgInt32 m_seedIndex[DG_MAX_THREADS_HIVE_COUNT][DG_CONVEXHULL_3D_SEED_DIRECTIONS];
+	dgMemoryAllocator* m_allocators[DG_MAX_THREADS_HIVE_COUNT];
+	const dgBigVector* m_points;
+	dgBigVector* m_hullPoints;
+	dgInt32* m_hullPointsCount;
+	dgFloat32 m_margin;
+	dgInt32 m_planesCount;
+	dgInt32 m_partitionsCount;
+	dgInt32 m_count;
+	dgInt32 m_index;
+};
+
+
 dgConvexHull3DFace::dgConvexHull3DFace()
 {
 	m_mark = 0;
 	m_twin[0] = NULL;
 	m_twin[1] = NULL;
 	m_twin[2] = NULL;
+	m_boundaryNode = NULL;
 }
 
 dgFloat64 dgConvexHull3DFace::Evalue (const dgBigVector* const pointArray, const dgBigVector& point) const
@@ -135,36 +213,7 @@ dgFloat64 dgConvexHull3DFace::Evalue (const dgBigVector* const pointArray, const
 	const dgBigVector& p0 = pointArray[m_index[0]];
 	const dgBigVector& p1 = pointArray[m_index[1]];
 	const dgBigVector& p2 = pointArray[m_index[2]];
-
-	dgFloat64 matrix[3][3];
-	for (dgInt32 i = 0; i < 3; i ++) {
-		matrix[0][i] = p2[i] - p0[i];
-		matrix[1][i] = p1[i] - p0[i];
-		matrix[2][i] = point[i] - p0[i];
-	}
-
-	dgFloat64 error;
-	dgFloat64 det = Determinant3x3 (matrix, &error);
-
-	// the code use double, however the threshold for accuracy test is the machine precision of a float.
-	// by changing this to a smaller number, the code should run faster since many small test will be considered valid
-	// the precision must be a power of two no smaller than the machine precision of a double, (1<<48)
-	// float64(1<<30) can be a good value
-
-	// dgFloat64 precision	= dgFloat64 (1.0f) / dgFloat64 (1<<30);
-	dgFloat64 precision	 = dgFloat64 (1.0f) / dgFloat64 (1<<24);
-	dgFloat64 errbound = error * precision;
-	if (fabs(det) > errbound) {
-		return det;
-	}
-
-	dgGoogol exactMatrix[3][3];
-	for (dgInt32 i = 0; i < 3; i ++) {
-		exactMatrix[0][i] = dgGoogol(p2[i]) - dgGoogol(p0[i]);
-		exactMatrix[1][i] = dgGoogol(p1[i]) - dgGoogol(p0[i]);
-		exactMatrix[2][i] = dgGoogol(point[i]) - dgGoogol(p0[i]);
-	}
-	return Determinant3x3(exactMatrix);
+	return dgOrientation3d (p0, p2, p1, point);
 }
 
 dgBigPlane dgConvexHull3DFace::GetPlaneEquation (const dgBigVector* const pointArray) const
@@ -220,7 +269,7 @@ dgConvexHull3d::dgConvexHull3d(const dgConvexHull3d& source)
 	}
 }
 
-dgConvexHull3d::dgConvexHull3d(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount)
+dgConvexHull3d::dgConvexHull3d(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount, dgThreadHive* const threadPool)
 	:dgList<dgConvexHull3DFace>(allocator)
 	,m_count (0)
 	,m_diag()
@@ -228,7 +277,7 @@ dgConvexHull3d::dgConvexHull3d(dgMemoryAllocator* const allocator, const dgFloat
 	,m_aabbP1 (dgBigVector (dgFloat64 (0.0), dgFloat64 (0.0), dgFloat64 (0.0), dgFloat64 (0.0)))
 	,m_points(allocator)
 {
-	BuildHull (vertexCloud, strideInBytes, count, distTol, maxVertexCount);
+	BuildHull (vertexCloud, strideInBytes, count, distTol, maxVertexCount, threadPool);
 }
 
 dgConvexHull3d::~dgConvexHull3d(void)
@@ -236,8 +285,23 @@ dgConvexHull3d::~dgConvexHull3d(void)
 }
 
 
-void dgConvexHull3d::BuildHull (const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount)
+void dgConvexHull3d::BuildHull (const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount, dgThreadHive* const threadPool)
 {
+	if (threadPool && (threadPool->GetThreadCount() > 1) && (count >= DG_CONVEXHULL_3D_PARALLEL_MIN_COUNT)) {
+		// the hull of the cloud is the same as the hull of the union of the hulls of its partitions, 
+		// the partitions are reduced in parallel and the final hull is build from the much smaller set.
+		dgStack<dgBigVector> points (count);
+		dgStack<dgBigVector> hullPoints (count);
+		dgInt32 stride = dgInt32(strideInBytes / sizeof(dgFloat64));
+		for (dgInt32 i = 0; i < count; i ++) {
+			dgInt32 index = i * stride;
+			points[i] = dgBigVector(vertexCloud[index], vertexCloud[index + 1], vertexCloud[index + 2], (stride >= 4) ? vertexCloud[index + 3] : dgFloat64(0.0f));
+		}
+		count = ReducePointCloud (threadPool, &points[0], count, &hullPoints[0]);
+		BuildHull (&hullPoints[0].m_x, sizeof (dgBigVector), count, distTol, maxVertexCount, NULL);
+		return;
+	}
+
 	dgSetPrecisionDouble precision;
 
 	dgInt32 treeCount = count / (DG_CONVEXHULL_3D_VERTEX_CLUSTER_SIZE>>1);
@@ -266,6 +330,179 @@ void dgConvexHull3d::BuildHull (const dgFloat64* const vertexCloud, dgInt32 stri
 #endif
 }
 
+void dgConvexHull3d::SeedPointsKernel (void* const context, void* const unused, dgInt32 threadID)
+{
+	dgConvexHull3dPartitionDescriptor* const descriptor = (dgConvexHull3dPartitionDescriptor*) context;
+	dgFloat64* const seedDist = descriptor->m_seedDist[threadID];
+	dgInt32* const seedIndex = descriptor->m_seedIndex[threadID];
+	for (dgInt32 i = 0; i < DG_CONVEXHULL_3D_SEED_DIRECTIONS; i ++) {
+		seedDist[i] = dgFloat64 (-1.0e20f);
+		seedIndex[i] = -1;
+	}
+
+	const dgBigVector* const points = descriptor->m_points;
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_partitionsCount; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+		const dgInt32 start = i * DG_CONVEXHULL_3D_PARTITION_SIZE;
+		const dgInt32 end = dgMin (start + DG_CONVEXHULL_3D_PARTITION_SIZE, descriptor->m_count);
+		for (dgInt32 j = start; j < end; j ++) {
+			for (dgInt32 k = 0; k < DG_CONVEXHULL_3D_SEED_DIRECTIONS; k ++) {
+				dgFloat64 dist = points[j].DotProduct3(descriptor->m_seedDirections[k]);
+				if ((dist > seedDist[k]) || ((dist == seedDist[k]) && (j < seedIndex[k]))) {
+					seedDist[k] = dist;
+					seedIndex[k] = j;
+				}
+			}
+		}
+	}
+}
+
+void dgConvexHull3d::PartitionHullKernel (void* const context, void* const unused, dgInt32 threadID)
+{
+	dgConvexHull3dPartitionDescriptor* const descriptor = (dgConvexHull3dPartitionDescriptor*) context;
+	dgMemoryAllocator* const allocator = descriptor->m_allocators[threadID];
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_partitionsCount; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+		const dgInt32 start = i * DG_CONVEXHULL_3D_PARTITION_SIZE;
+		const dgInt32 count = dgMin (DG_CONVEXHULL_3D_PARTITION_SIZE, descriptor->m_count - start);
+		dgBigVector* const hullPoints = &descriptor->m_hullPoints[start];
+
+		dgInt32 hullCount = descriptor->CullInteriorPoints (&descriptor->m_points[start], count, hullPoints);
+		if (hullCount > 4) {
+			// zero tolerance, all extreme points of the partition must reach the final hull
+			dgConvexHull3d partitionHull (allocator, &hullPoints[0].m_x, sizeof (dgBigVector), hullCount, dgFloat64 (0.0f));
+			if (partitionHull.GetCount()) {
+				dgInt8 mark[DG_CONVEXHULL_3D_PARTITION_SIZE];
+				const dgInt32 vertexCount = partitionHull.GetVertexCount();
+				memset (mark, 0, size_t (vertexCount));
+				for (dgListNode* node = partitionHull.GetFirst(); node; node = node->GetNext()) {
+					const dgConvexHull3DFace& face = node->GetInfo();
+					mark[face.m_index[0]] = 1;
+					mark[face.m_index[1]] = 1;
+					mark[face.m_index[2]] = 1;
+				}
+
+				hullCount = 0;
+				for (dgInt32 j = 0; j < vertexCount; j ++) {
+					if (mark[j]) {
+						hullPoints[hullCount] = partitionHull.GetVertex(j);
+						hullCount ++;
+					}
+				}
+			}
+		}
+		descriptor->m_hullPointsCount[i] = hullCount;
+	}
+}
+
+dgInt32 dgConvexHull3d::ReducePointCloud (dgThreadHive* const threadPool, const dgBigVector* const points, dgInt32 count, dgBigVector* const hullPoints) const
+{
+	dgConvexHull3dPartitionDescriptor descriptor;
+	descriptor.m_points = points;
+	descriptor.m_hullPoints = hullPoints;
+	descriptor.m_count = count;
+	descriptor.m_partitionsCount = (count + DG_CONVEXHULL_3D_PARTITION_SIZE - 1) / DG_CONVEXHULL_3D_PARTITION_SIZE;
+	descriptor.m_planesCount = 0;
+	descriptor.m_margin = dgFloat32 (0.0f);
+	descriptor.m_origin = dgBigVector (dgFloat64 (0.0f));
+
+	// the seed polytope is the hull of the extreme points along the box faces and corners
+	dgInt32 directionsCount = 0;
+	for (dgInt32 i = 0; i < 3; i ++) {
+		dgBigVector dir (dgFloat64 (0.0f));
+		dir[i] = dgFloat64 (1.0f);
+		descriptor.m_seedDirections[directionsCount] = dir;
+		descriptor.m_seedDirections[directionsCount + 1] = dir.Scale3 (dgFloat64 (-1.0f));
+		directionsCount += 2;
+	}
+	for (dgInt32 i = 0; i < 8; i ++) {
+		dgFloat64 x = (i & 1) ? dgFloat64 (1.0f) : dgFloat64 (-1.0f);
+		dgFloat64 y = (i & 2) ? dgFloat64 (1.0f) : dgFloat64 (-1.0f);
+		dgFloat64 z = (i & 4) ? dgFloat64 (1.0f) : dgFloat64 (-1.0f);
+		descriptor.m_seedDirections[directionsCount] = dgBigVector (x, y, z, dgFloat64 (0.0f));
+		directionsCount ++;
+	}
+	dgAssert (directionsCount == DG_CONVEXHULL_3D_SEED_DIRECTIONS);
+
+	const dgInt32 threadCount = threadPool->GetThreadCount();
+	descriptor.m_index = 0;
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		threadPool->QueueJob (SeedPointsKernel, &descriptor, NULL, "dgConvexHull3d::SeedPointsKernel");
+	}
+	threadPool->SynchronizationBarrier();
+
+	dgBigVector seedPoints[DG_CONVEXHULL_3D_SEED_DIRECTIONS];
+	for (dgInt32 i = 0; i < DG_CONVEXHULL_3D_SEED_DIRECTIONS; i ++) {
+		dgInt32 index = descriptor.m_seedIndex[0][i];
+		dgFloat64 dist = descriptor.m_seedDist[0][i];
+		for (dgInt32 j = 1; j < threadCount; j ++) {
+			const dgInt32 index1 = descriptor.m_seedIndex[j][i];
+			const dgFloat64 dist1 = descriptor.m_seedDist[j][i];
+			if ((index1 >= 0) && ((dist1 > dist) || ((dist1 == dist) && (index1 < index)))) {
+				index = index1;
+				dist = dist1;
+			}
+		}
+		dgAssert (index >= 0);
+		seedPoints[i] = points[index];
+	}
+
+	dgConvexHull3d seedHull (GetAllocator(), &seedPoints[0].m_x, sizeof (dgBigVector), DG_CONVEXHULL_3D_SEED_DIRECTIONS, dgFloat64 (0.0f));
+	if (seedHull.GetCount()) {
+		dgBigVector origin (dgFloat64 (0.0f));
+		for (dgInt32 i = 0; i < seedHull.GetVertexCount(); i ++) {
+			origin += seedHull.GetVertex(i);
+		}
+		origin = origin.Scale3 (dgFloat64 (1.0f) / seedHull.GetVertexCount());
+		origin.m_w = dgFloat64 (0.0f);
+
+		// the single precision distance error is proportional to the size of the cloud
+		dgBigVector p0;
+		dgBigVector p1;
+		seedHull.GetAABB (p0, p1);
+		dgBigVector size (p1 - p0);
+		descriptor.m_origin = origin;
+		descriptor.m_margin = dgFloat32 (sqrt (size.DotProduct3(size)) * dgFloat64 (1.0e-5f));
+
+		for (dgListNode* node = seedHull.GetFirst(); node; node = node->GetNext()) {
+			const dgBigPlane plane (node->GetInfo().GetPlaneEquation (seedHull.GetVertexPool()));
+			const dgFloat64 dist = plane.Evalue (origin);
+			dgAssert (dist < dgFloat64 (0.0f));
+			dgAssert (descriptor.m_planesCount < DG_CONVEXHULL_3D_SEED_MAX_PLANES);
+			descriptor.m_planeX[descriptor.m_planesCount] = dgVector (dgFloat32 (plane.m_x));
+			descriptor.m_planeY[descriptor.m_planesCount] = dgVector (dgFloat32 (plane.m_y));
+			descriptor.m_planeZ[descriptor.m_planesCount] = dgVector (dgFloat32 (plane.m_z));
+			descriptor.m_planeW[descriptor.m_planesCount] = dgVector (dgFloat32 (dist));
+			descriptor.m_planesCount ++;
+		}
+	}
+
+	// the memory pools are not thread safe, each worker builds its hulls with its own allocator
+	dgStack<dgInt32> hullPointsCount (descriptor.m_partitionsCount);
+	descriptor.m_hullPointsCount = &hullPointsCount[0];
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		descriptor.m_allocators[i] = new dgMemoryAllocator();
+	}
+
+	descriptor.m_index = 0;
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		threadPool->QueueJob (PartitionHullKernel, &descriptor, NULL, "dgConvexHull3d::PartitionHullKernel");
+	}
+	threadPool->SynchronizationBarrier();
+
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		delete descriptor.m_allocators[i];
+	}
+
+	dgInt32 hullCount = 0;
+	for (dgInt32 i = 0; i < descriptor.m_partitionsCount; i ++) {
+		const dgBigVector* const partitionPoints = &hullPoints[i * DG_CONVEXHULL_3D_PARTITION_SIZE];
+		for (dgInt32 j = 0; j < hullPointsCount[i]; j ++) {
+			hullPoints[hullCount] = partitionPoints[j];
+			hullCount ++;
+		}
+	}
+	return hullCount;
+}
+
 dgInt32 dgConvexHull3d::ConvexCompareVertex(const dgConvexHull3DVertex* const  A, const dgConvexHull3DVertex* const B, void* const context)
 {
 	for (dgInt32 i = 0; i < 3; i ++) {
@@ -822,10 +1059,11 @@ void dgConvexHull3d::CalculateConvexHull3d (dgConvexHull3dAABBTreeNode* vertexTr
 
 	dgList<dgListNode*> boundaryFaces(GetAllocator());
 
-	boundaryFaces.Append(f0Node);
-	boundaryFaces.Append(f1Node);
-	boundaryFaces.Append(f2Node);
-	boundaryFaces.Append(f3Node);
+	// each face keeps its node in the boundary list, so that it can be removed in constant time
+	f0->m_boundaryNode = boundaryFaces.Append(f0Node);
+	f1->m_boundaryNode = boundaryFaces.Append(f1Node);
+	f2->m_boundaryNode = boundaryFaces.Append(f2Node);
+	f3->m_boundaryNode = boundaryFaces.Append(f3Node);
 	count -= 4;
 	maxVertexCount -= 4;
 	dgInt32 currentIndex = 4;
@@ -921,9 +1159,9 @@ void dgConvexHull3d::CalculateConvexHull3d (dgConvexHull3dAABBTreeNode* vertexTr
 					if (!twinFace->m_mark) {
 						dgInt32 j1 = (j0 == 2) ? 0 : j0 + 1;
 						dgListNode* const newNode = AddFace (currentIndex, face1->m_index[j0], face1->m_index[j1]);
-						boundaryFaces.Addtop(newNode);
-
 						dgConvexHull3DFace* const newFace = &newNode->GetInfo();
+						newFace->m_boundaryNode = boundaryFaces.Addtop(newNode);
+
 						newFace->m_twin[1] = twinNode;
 						for (dgInt32 k = 0; k < 3; k ++) {
 							if (twinFace->m_twin[k] == node1) {
@@ -966,7 +1204,10 @@ void dgConvexHull3d::CalculateConvexHull3d (dgConvexHull3dAABBTreeNode* vertexTr
 
 			for (dgInt32 i = 0; i < deletedCount; i ++) {
 				dgListNode* const node = deleteList[i];
-				boundaryFaces.Remove (node);
+				dgConvexHull3DFace* const deletedFace = &node->GetInfo();
+				if (deletedFace->m_boundaryNode) {
+					boundaryFaces.Remove (deletedFace->m_boundaryNode);
+				}
 				DeleteFace (node);
 			}
 
@@ -974,7 +1215,8 @@ void dgConvexHull3d::CalculateConvexHull3d (dgConvexHull3dAABBTreeNode* vertexTr
 			currentIndex ++;
 			count --;
 		} else {
-			boundaryFaces.Remove (faceNode);
+			boundaryFaces.Remove (face->m_boundaryNode);
+			face->m_boundaryNode = NULL;
 		}
 	}
 	m_count = currentIndex;
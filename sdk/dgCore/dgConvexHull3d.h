@@ -32,9 +32,11 @@
 
 #define DG_OLD_CONVEXHULL_3D
 
+class dgThreadHive;
 class dgMemoryAllocator;
 class dgConvexHull3DVertex;
 class dgConvexHull3dAABBTreeNode;
+class dgConvexHull3dPartitionDescriptor;
 
 class dgConvexHull3DFace
 {
@@ -54,6 +56,7 @@ class dgConvexHull3DFace
 	private:
 	dgInt32 m_mark;
 	dgList<dgConvexHull3DFace>::dgListNode* m_twin[3];
+	dgList<dgList<dgConvexHull3DFace>::dgListNode*>::dgListNode* m_boundaryNode;
 	friend class dgConvexHull3d;
 };
 
@@ -65,7 +68,7 @@ class dgConvexHull3d: public dgList<dgConvexHull3DFace>
 
 	public:
 	dgConvexHull3d(const dgConvexHull3d& source);
-	dgConvexHull3d(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount = 0x7fffffff);
+	dgConvexHull3d(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount = 0x7fffffff, dgThreadHive* const threadPool = NULL);
 	virtual ~dgConvexHull3d();
 
 	dgInt32 GetVertexCount() const;
@@ -79,7 +82,8 @@ class dgConvexHull3d: public dgList<dgConvexHull3DFace>
 
 	protected:
 	dgConvexHull3d(dgMemoryAllocator* const allocator);
-	void BuildHull (const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount);
+	void BuildHull (const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, dgFloat64 distTol, dgInt32 maxVertexCount, dgThreadHive* const threadPool);
+	dgInt32 ReducePointCloud (dgThreadHive* const threadPool, const dgBigVector* const points, dgInt32 count, dgBigVector* const hullPoints) const;
 
 	virtual dgListNode* AddFace (dgInt32 i0, dgInt32 i1, dgInt32 i2);
 	virtual void DeleteFace (dgListNode* const node) ;
@@ -95,6 +99,8 @@ class dgConvexHull3d: public dgList<dgConvexHull3DFace>
 	dgInt32 GetUniquePoints(dgConvexHull3DVertex* const points, const dgFloat64* const vertexCloud, dgInt32 strideInBytes, dgInt32 count, void* const memoryPool, dgInt32 maxMemSize);
 	dgConvexHull3dAABBTreeNode* BuildTree (dgConvexHull3dAABBTreeNode* const parent, dgConvexHull3DVertex* const points, dgInt32 count, dgInt32 baseIndex, dgInt8** const memoryPool, dgInt32& maxMemSize) const;
 	static dgInt32 ConvexCompareVertex(const dgConvexHull3DVertex* const A, const dgConvexHull3DVertex* const B, void* const context);
+	static void SeedPointsKernel (void* const context, void* const unused, dgInt32 threadID);
+	static void PartitionHullKernel (void* const context, void* const unused, dgInt32 threadID);
 	bool Sanity() const;
 	void Save (const char* const filename) const;
 
@@ -217,31 +217,7 @@ dgFloat64 dgConvexHull4dTetraherum::Evalue (const dgConvexHull4dVector* const po
 	const dgBigVector &p1 = pointArray[m_faces[0].m_index[1]];
 	const dgBigVector &p2 = pointArray[m_faces[0].m_index[2]];
 	const dgBigVector &p3 = pointArray[m_faces[0].m_index[3]];
-
-	dgFloat64 matrix[4][4];
-	for (dgInt32 i = 0; i < 4; i ++) {
-		matrix[0][i] = p1[i] - p0[i];
-		matrix[1][i] = p2[i] - p0[i];
-		matrix[2][i] = p3[i] - p0[i];
-		matrix[3][i] = point[i] - p0[i];
-	}
-
-	dgFloat64 error;
-	dgFloat64 det = Determinant4x4 (matrix, &error);
-	dgFloat64 precision  = dgFloat64 (1.0f) / dgFloat64 (1<<24);
-	dgFloat64 errbound = error * precision; 
-	if (fabs(det) > errbound) {
-		return det;
-	}
-
-	dgGoogol exactMatrix[4][4];
-	for (dgInt32 i = 0; i < 4; i ++) {
-		exactMatrix[0][i] = dgGoogol(p1[i]) - dgGoogol(p0[i]);
-		exactMatrix[1][i] = dgGoogol(p2[i]) - dgGoogol(p0[i]);
-		exactMatrix[2][i] = dgGoogol(p3[i]) - dgGoogol(p0[i]);
-		exactMatrix[3][i] = dgGoogol(point[i]) - dgGoogol(p0[i]);
-	}
-	return Determinant4x4(exactMatrix);
+	return dgOrientation4d (p0, p1, p2, p3, point);
 }
 
 dgFloat64 dgConvexHull4dTetraherum::GetTetraVolume(const dgConvexHull4dVector* const points) const
@@ -250,31 +226,7 @@ dgFloat64 dgConvexHull4dTetraherum::GetTetraVolume(const dgConvexHull4dVector* c
 	const dgBigVector &p1 = points[m_faces[0].m_index[1]];
 	const dgBigVector &p2 = points[m_faces[0].m_index[2]];
 	const dgBigVector &p3 = points[m_faces[0].m_index[3]];
-
-	dgFloat64 matrix[3][3];
-	for (dgInt32 i = 0; i < 3; i++) {
-		matrix[0][i] = p2[i] - p0[i];
-		matrix[1][i] = p1[i] - p0[i];
-		matrix[2][i] = p3[i] - p0[i];
-	}
-
-	dgFloat64 error;
-	dgFloat64 det = Determinant3x3(matrix, &error);
-
-
-	dgFloat64 precision = dgFloat64(1.0f) / dgFloat64(1 << 24);
-	dgFloat64 errbound = error * precision;
-	if (fabs(det) > errbound) {
-		return det;
-	}
-
-	dgGoogol exactMatrix[3][3];
-	for (dgInt32 i = 0; i < 3; i++) {
-		exactMatrix[0][i] = dgGoogol(p2[i]) - dgGoogol(p0[i]);
-		exactMatrix[1][i] = dgGoogol(p1[i]) - dgGoogol(p0[i]);
-		exactMatrix[2][i] = dgGoogol(p3[i]) - dgGoogol(p0[i]);
-	}
-	return Determinant3x3(exactMatrix);
+	return dgOrientation3d (p0, p2, p1, p3);
 }
 
 
@@ -25,75 +25,39 @@
 #include "dgSmallDeterminant.h"
 #include "dgDelaunayTetrahedralization.h"
 
+#define DG_DELAUNAY_HILBERT_BITS		10
+#define DG_DELAUNAY_MIN_ROUND_SIZE		64
 
 
-dgDelaunayTetrahedralization::dgDelaunayTetrahedralization(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte, dgFloat64 distTol)
+dgDelaunayTetrahedralization::dgDelaunayTetrahedralization(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte)
 	:dgConvexHull4d(allocator)
+	,m_tetras(allocator)
+	,m_freeTetras(allocator)
+	,m_conflicts(allocator)
+	,m_cavityFaces(allocator)
+	,m_cavityEdges(allocator)
+	,m_tetraCount(0)
+	,m_freeCount(0)
+	,m_lastTetra(0)
+	,m_randomSeed(0)
+	,m_listDirty(false)
 {
 	dgSetPrecisionDouble precision;
-	dgStack<dgBigVector> pool(count + 2);
 
-	dgBigVector* const points = &pool[0];
+	m_points.Resize(count);
 	dgInt32 stride = dgInt32 (strideInByte / sizeof (dgFloat64));
 	for (dgInt32 i = 0; i < count; i ++) {
 		dgFloat64 x = dgRoundToFloat (vertexCloud[i * stride + 0]);
 		dgFloat64 y = dgRoundToFloat (vertexCloud[i * stride + 1]);
 		dgFloat64 z = dgRoundToFloat (vertexCloud[i * stride + 2]);
-		points[i] = dgBigVector (x, y, z, x * x + y * y + z * z);
-	}
-
-	dgInt32 oldCount = count;
-	BuildHull (allocator, &pool[0].m_x, sizeof (dgBigVector), count, distTol);
-	if (oldCount > m_count) {
-		// the mesh is convex, need to add two steiners point to make tractable
-		dgBigVector origin (dgFloat64 (0.0f));
-		dgFloat64 maxW = dgFloat64 (-1.0e20f);
-		for (dgInt32 i = 0; i < count; i++) {
-			dgFloat64 x = dgRoundToFloat(vertexCloud[i * stride + 0]);
-			dgFloat64 y = dgRoundToFloat(vertexCloud[i * stride + 1]);
-			dgFloat64 z = dgRoundToFloat(vertexCloud[i * stride + 2]);
-			points[i] = dgBigVector(x, y, z, x * x + y * y + z * z);
-			origin += points[i];
-			maxW = dgMax (points[i].m_w, maxW);
-		}
-		origin = origin.Scale4 (dgFloat64 (1.0f) / count);
-		points[count + 0] = origin;
-		points[count + 1] = origin;
-		points[count + 0].m_w += dgFloat64 (1.0f);
-		points[count + 1].m_w -= dgFloat64 (1.0f);
- 		BuildHull (allocator, &pool[0].m_x, sizeof (dgBigVector), count + 2, distTol);
-	}
-	if (oldCount > m_count) {
-		// this is probably a regular convex solid, which will have a zero volume hull
-		// add the rest of the points by incremental insertion with small perturbation
-		dgInt32 hullCount = m_count;
-		
-		for (dgInt32 i = 0; i < count; i ++) {
-			bool inHull = false;
-			const dgConvexHull4dVector* const hullPoints = &m_points[0];
-			for (dgInt32 j = 0; j < hullCount; j ++) {
-				if (hullPoints[j].m_index == i) {
-					inHull = true;
-					break;
-				}			
-			}
-			if (!inHull) {
-				dgBigVector q (points[i]);
-				dgInt32 index = AddVertex(q);
-				if (index == -1) {
-					q.m_x += dgFloat64 (1.0e-3f);
-					q.m_y += dgFloat64 (1.0e-3f);
-					q.m_z += dgFloat64 (1.0e-3f);
-					index = AddVertex(q);
-					dgAssert (index != -1);
-				}
-				dgAssert (index != -1);
-				m_points[index].m_index = i;
-			}
-		}
+		m_points[i] = dgBigVector (x, y, z, x * x + y * y + z * z);
+		m_points[i].m_index = i;
 	}
+	m_count = count;
 
-	SortVertexArray ();
+	if (BuildTetrahedralization ()) {
+		BuildTetrahedraList ();
+	}
 }
 
 dgDelaunayTetrahedralization::~dgDelaunayTetrahedralization()
@@ -101,54 +65,510 @@ dgDelaunayTetrahedralization::~dgDelaunayTetrahedralization()
 }
 
 
-
 dgInt32 dgDelaunayTetrahedralization::AddVertex (const dgBigVector& vertex)
 {
 	dgSetPrecisionDouble precision;
 
 	dgBigVector p (vertex);
 	p.m_w = p.DotProduct3(p);
-	dgInt32 index = dgConvexHull4d::AddVertex(p);
 
+	dgInt32 index = m_count;
+	m_points[index] = p;
+	m_points[index].m_index = index;
+	m_count ++;
+
+	bool inserted = m_tetraCount ? InsertVertex (index) : BuildTetrahedralization ();
+	if (!inserted) {
+		m_count --;
+		return -1;
+	}
+	m_listDirty = true;
 	return index;
 }
 
+void dgDelaunayTetrahedralization::UpdateTetrahedraList ()
+{
+	if (m_listDirty) {
+		m_listDirty = false;
+		BuildTetrahedraList ();
+	}
+}
 
 
-dgInt32 dgDelaunayTetrahedralization::CompareVertexByIndex(const dgConvexHull4dVector* const  A, const dgConvexHull4dVector* const B, void* const context)
+dgUnsigned32 dgDelaunayTetrahedralization::RandomIndex ()
+{
+	m_randomSeed = m_randomSeed * 1664525u + 1013904223u;
+	return m_randomSeed >> 8;
+}
+
+dgUnsigned32 dgDelaunayTetrahedralization::HilbertKey (dgUnsigned32 x, dgUnsigned32 y, dgUnsigned32 z)
 {
-	if (A->m_index < B ->m_index) {
+	// John Skilling, "Programming the Hilbert curve"
+	dgUnsigned32 axis[3];
+	axis[0] = x;
+	axis[1] = y;
+	axis[2] = z;
+	for (dgUnsigned32 q = 1 << (DG_DELAUNAY_HILBERT_BITS - 1); q > 1; q >>= 1) {
+		dgUnsigned32 p = q - 1;
+		for (dgInt32 i = 0; i < 3; i ++) {
+			if (axis[i] & q) {
+				axis[0] ^= p;
+			} else {
+				dgUnsigned32 t = (axis[0] ^ axis[i]) & p;
+				axis[0] ^= t;
+				axis[i] ^= t;
+			}
+		}
+	}
+
+	axis[1] ^= axis[0];
+	axis[2] ^= axis[1];
+	dgUnsigned32 t = 0;
+	for (dgUnsigned32 q = 1 << (DG_DELAUNAY_HILBERT_BITS - 1); q > 1; q >>= 1) {
+		if (axis[2] & q) {
+			t ^= q - 1;
+		}
+	}
+
+	dgUnsigned32 key = 0;
+	for (dgInt32 bit = DG_DELAUNAY_HILBERT_BITS - 1; bit >= 0; bit --) {
+		for (dgInt32 i = 0; i < 3; i ++) {
+			key = (key << 1) | (((axis[i] ^ t) >> bit) & 1);
+		}
+	}
+	return key;
+}
+
+dgInt32 dgDelaunayTetrahedralization::CompareSpatialKey (const dgSpatialKey* const keyA, const dgSpatialKey* const keyB, void* const context)
+{
+	if (keyA->m_key < keyB->m_key) {
 		return -1;
-	} else if (A->m_index > B->m_index) {
+	} else if (keyA->m_key > keyB->m_key) {
+		return 1;
+	}
+	if (keyA->m_index < keyB->m_index) {
+		return -1;
+	} else if (keyA->m_index > keyB->m_index) {
 		return 1;
 	}
 	return 0;
 }
 
+void dgDelaunayTetrahedralization::SpatialSort (dgInt32* const order)
+{
+	const dgConvexHull4dVector* const points = &m_points[0];
+	dgBigVector minP (points[0]);
+	dgBigVector maxP (points[0]);
+	for (dgInt32 i = 1; i < m_count; i ++) {
+		minP.m_x = dgMin (minP.m_x, points[i].m_x);
+		minP.m_y = dgMin (minP.m_y, points[i].m_y);
+		minP.m_z = dgMin (minP.m_z, points[i].m_z);
+		maxP.m_x = dgMax (maxP.m_x, points[i].m_x);
+		maxP.m_y = dgMax (maxP.m_y, points[i].m_y);
+		maxP.m_z = dgMax (maxP.m_z, points[i].m_z);
+	}
+
+	dgBigVector scale (dgFloat64 (0.0f));
+	const dgFloat64 gridSize = dgFloat64 ((1 << DG_DELAUNAY_HILBERT_BITS) - 1);
+	for (dgInt32 i = 0; i < 3; i ++) {
+		dgFloat64 size = maxP[i] - minP[i];
+		if (size > dgFloat64 (0.0f)) {
+			scale[i] = gridSize / size;
+		}
+	}
+
+	dgStack<dgSpatialKey> keys (m_count);
+	for (dgInt32 i = 0; i < m_count; i ++) {
+		dgUnsigned32 x = dgUnsigned32 ((points[i].m_x - minP.m_x) * scale.m_x);
+		dgUnsigned32 y = dgUnsigned32 ((points[i].m_y - minP.m_y) * scale.m_y);
+		dgUnsigned32 z = dgUnsigned32 ((points[i].m_z - minP.m_z) * scale.m_z);
+		keys[i].m_key = HilbertKey (x, y, z);
+		keys[i].m_index = i;
+	}
+
+	// biased randomized insertion order, each round is twice the size of the previous one
+	// and the points in a round are sorted along the Hilbert curve.
+	for (dgInt32 i = m_count - 1; i > 0; i --) {
+		dgInt32 j = dgInt32 (RandomIndex () % dgUnsigned32 (i + 1));
+		dgSwap (keys[i], keys[j]);
+	}
+
+	dgInt32 end = m_count;
+	while (end > 0) {
+		dgInt32 start = (end > DG_DELAUNAY_MIN_ROUND_SIZE) ? end >> 1 : 0;
+		dgSort (&keys[start], end - start, CompareSpatialKey);
+		end = start;
+	}
+
+	for (dgInt32 i = 0; i < m_count; i ++) {
+		order[i] = keys[i].m_index;
+	}
+}
+
 
-void dgDelaunayTetrahedralization::SortVertexArray ()
+dgFloat64 dgDelaunayTetrahedralization::Orientation (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3)
 {
-	dgConvexHull4dVector* const points = &m_points[0];
-	for (dgListNode* node = GetFirst(); node; node = node->GetNext()) {	
-		dgConvexHull4dTetraherum* const tetra = &node->GetInfo();
+	return dgOrientation3d (p0, p1, p2, p3);
+}
+
+dgFloat64 dgDelaunayTetrahedralization::InSphere (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3, const dgBigVector& point)
+{
+	return dgOrientation4d (p0, p1, p2, p3, point);
+}
+
+dgFloat64 dgDelaunayTetrahedralization::Orientation (const dgTetrahedron& tetra, dgInt32 face, const dgBigVector& point) const
+{
+	// orientation of the tetrahedron with the vertex opposite to face replaced by point, 
+	// positive when point is on the same side of the face as the vertex it replaces
+	const dgConvexHull4dVector* const points = &m_points[0];
+	const dgBigVector* p[4];
+	for (dgInt32 i = 0; i < 4; i ++) {
+		dgAssert ((i == face) || (tetra.m_vertex[i] != DG_DELAUNAY_INFINITE_VERTEX));
+		p[i] = (i == face) ? &point : &points[tetra.m_vertex[i]];
+	}
+	return Orientation (*p[0], *p[1], *p[2], *p[3]);
+}
+
+dgFloat64 dgDelaunayTetrahedralization::InSphere (const dgTetrahedron& tetra, const dgBigVector& point) const
+{
+	// positive when the point is strictly inside the circum sphere
+	const dgConvexHull4dVector* const points = &m_points[0];
+	return InSphere (points[tetra.m_vertex[0]], points[tetra.m_vertex[1]], points[tetra.m_vertex[2]], points[tetra.m_vertex[3]], point);
+}
+
+bool dgDelaunayTetrahedralization::IsInConflict (dgInt32 tetraIndex, const dgBigVector& point) const
+{
+	const dgTetrahedron& tetra = m_tetras[tetraIndex];
+	dgInt32 face = tetra.GetInfiniteVertexFace();
+	if (face == -1) {
+		return InSphere (tetra, point) > dgFloat64 (0.0f);
+	}
+
+	// a ghost tetrahedron is in conflict when the point is in front of its hull face,
+	// or on the face plane and inside the circum sphere of the interior tetrahedron behind it
+	dgFloat64 side = Orientation (tetra, face, point);
+	if (side > dgFloat64 (0.0f)) {
+		return true;
+	} else if (side < dgFloat64 (0.0f)) {
+		return false;
+	}
+	return InSphere (m_tetras[tetra.m_neighbor[face]], point) > dgFloat64 (0.0f);
+}
+
+
+dgInt32 dgDelaunayTetrahedralization::AllocTetrahedron ()
+{
+	dgInt32 index = m_freeCount ? m_freeTetras[-- m_freeCount] : m_tetraCount ++;
+	m_tetras[index].m_mark = 0;
+	return index;
+}
+
+bool dgDelaunayTetrahedralization::InitialTetrahedron (const dgInt32* const order, dgInt32* const tetra)
+{
+	const dgConvexHull4dVector* const points = &m_points[0];
+
+	dgInt32 i1 = 1;
+	const dgBigVector& p0 = points[order[0]];
+	for (; i1 < m_count; i1 ++) {
+		const dgBigVector& p = points[order[i1]];
+		if ((p.m_x != p0.m_x) || (p.m_y != p0.m_y) || (p.m_z != p0.m_z)) {
+			break;
+		}
+	}
+	if (i1 >= m_count) {
+		return false;
+	}
+
+	dgInt32 i2 = i1 + 1;
+	const dgBigVector& p1 = points[order[i1]];
+	const dgBigVector p10 (p1 - p0);
+	for (; i2 < m_count; i2 ++) {
+		const dgBigVector& p = points[order[i2]];
+		dgBigVector normal (p10.CrossProduct3(p - p0));
+		if (normal.DotProduct3(normal) > dgFloat64 (0.0f)) {
+			break;
+		}
+	}
+	if (i2 >= m_count) {
+		return false;
+	}
+
+	dgInt32 i3 = i2 + 1;
+	const dgBigVector& p2 = points[order[i2]];
+	dgFloat64 volume = dgFloat64 (0.0f);
+	for (; i3 < m_count; i3 ++) {
+		volume = Orientation (p0, p1, p2, points[order[i3]]);
+		if (volume != dgFloat64 (0.0f)) {
+			break;
+		}
+	}
+	if (i3 >= m_count) {
+		return false;
+	}
+
+	tetra[0] = order[0];
+	tetra[1] = order[i1];
+	tetra[2] = order[i2];
+	tetra[3] = order[i3];
+	if (volume < dgFloat64 (0.0f)) {
+		dgSwap (tetra[0], tetra[1]);
+	}
+
+	// one interior tetrahedron and a ghost tetrahedron for each one of its faces
+	dgInt32 nodes[5];
+	for (dgInt32 i = 0; i < 5; i ++) {
+		nodes[i] = AllocTetrahedron();
+	}
+	dgTetrahedron* const tetras = &m_tetras[0];
+	for (dgInt32 i = 0; i < 4; i ++) {
+		tetras[nodes[0]].m_vertex[i] = tetra[i];
+	}
+	for (dgInt32 i = 0; i < 4; i ++) {
+		dgTetrahedron& ghost = tetras[nodes[i + 1]];
+		for (dgInt32 j = 0; j < 4; j ++) {
+			ghost.m_vertex[j] = tetra[j];
+		}
+		ghost.m_vertex[i] = DG_DELAUNAY_INFINITE_VERTEX;
+		dgSwap (ghost.m_vertex[(i + 1) & 3], ghost.m_vertex[(i + 2) & 3]);
+	}
+
+	// any two of the five tetrahedra share a face
+	for (dgInt32 i = 0; i < 5; i ++) {
+		dgTetrahedron& tetraA = tetras[nodes[i]];
+		for (dgInt32 j = i + 1; j < 5; j ++) {
+			dgTetrahedron& tetraB = tetras[nodes[j]];
+			dgInt32 faceA = -1;
+			dgInt32 faceB = -1;
+			for (dgInt32 k = 0; k < 4; k ++) {
+				bool sharedA = false;
+				bool sharedB = false;
+				for (dgInt32 l = 0; l < 4; l ++) {
+					sharedA |= (tetraA.m_vertex[k] == tetraB.m_vertex[l]);
+					sharedB |= (tetraB.m_vertex[k] == tetraA.m_vertex[l]);
+				}
+				faceA = sharedA ? faceA : k;
+				faceB = sharedB ? faceB : k;
+			}
+			dgAssert ((faceA != -1) && (faceB != -1));
+			tetraA.m_neighbor[faceA] = nodes[j];
+			tetraB.m_neighbor[faceB] = nodes[i];
+		}
+	}
+
+	m_lastTetra = nodes[0];
+	return true;
+}
+
+bool dgDelaunayTetrahedralization::BuildTetrahedralization ()
+{
+	m_tetraCount = 0;
+	m_freeCount = 0;
+	m_lastTetra = 0;
+	m_randomSeed = 0;
+	if (m_count < 4) {
+		return false;
+	}
+
+	dgStack<dgInt32> order (m_count);
+	SpatialSort (&order[0]);
+
+	dgInt32 tetra[4];
+	if (!InitialTetrahedron (&order[0], tetra)) {
+		m_tetraCount = 0;
+		return false;
+	}
+
+	for (dgInt32 i = 0; i < m_count; i ++) {
+		dgInt32 index = order[i];
+		if ((index != tetra[0]) && (index != tetra[1]) && (index != tetra[2]) && (index != tetra[3])) {
+			InsertVertex (index);
+		}
+	}
+	return true;
+}
+
+dgInt32 dgDelaunayTetrahedralization::LocateVertex (const dgBigVector& point)
+{
+	// stochastic visibility walk starting from the last tetrahedron created
+	dgInt32 index = m_lastTetra;
+	dgInt32 infiniteFace = m_tetras[index].GetInfiniteVertexFace();
+	if (infiniteFace != -1) {
+		index = m_tetras[index].m_neighbor[infiniteFace];
+	}
+
+	for (;;) {
+		const dgTetrahedron& tetra = m_tetras[index];
+		if (tetra.GetInfiniteVertexFace() != -1) {
+			// the walk crossed a hull face, the point is outside the convex hull
+			return index;
+		}
+
+		dgInt32 next = -1;
+		dgInt32 start = dgInt32 (RandomIndex () & 3);
 		for (dgInt32 i = 0; i < 4; i ++) {
-			dgConvexHull4dTetraherum::dgTetrahedrumFace& face = tetra->m_faces[i];
-			for (dgInt32 j = 0; j < 4; j ++) {
-				dgInt32 index = face.m_index[j];
-				face.m_index[j] = points[index].m_index;
+			dgInt32 face = (start + i) & 3;
+			if (Orientation (tetra, face, point) < dgFloat64 (0.0f)) {
+				next = tetra.m_neighbor[face];
+				break;
 			}
 		}
+
+		if (next == -1) {
+			for (dgInt32 i = 0; i < 4; i ++) {
+				const dgBigVector& p = m_points[tetra.m_vertex[i]];
+				if ((p.m_x == point.m_x) && (p.m_y == point.m_y) && (p.m_z == point.m_z)) {
+					return -1;
+				}
+			}
+			return index;
+		}
+		index = next;
+	}
+	return -1;
+}
+
+bool dgDelaunayTetrahedralization::InsertVertex (dgInt32 vertexIndex)
+{
+	const dgBigVector point (m_points[vertexIndex]);
+	dgInt32 start = LocateVertex (point);
+	if ((start == -1) || !IsInConflict (start, point)) {
+		// duplicated vertex
+		return false;
+	}
+
+	// collect the cavity of all tetrahedra whose circum sphere contain the point
+	dgInt32 mark = IncMark();
+	dgInt32 faceCount = 0;
+	dgInt32 conflictCount = 1;
+	m_conflicts[0] = start;
+	m_tetras[start].m_mark = mark;
+	for (dgInt32 i = 0; i < conflictCount; i ++) {
+		dgInt32 index = m_conflicts[i];
+		for (dgInt32 j = 0; j < 4; j ++) {
+			dgInt32 neighbor = m_tetras[index].m_neighbor[j];
+			if (m_tetras[neighbor].m_mark != mark) {
+				if (IsInConflict (neighbor, point)) {
+					m_tetras[neighbor].m_mark = mark;
+					m_conflicts[conflictCount] = neighbor;
+					conflictCount ++;
+				} else {
+					dgCavityFace& cavityFace = m_cavityFaces[faceCount];
+					const dgTetrahedron& tetra = m_tetras[index];
+					for (dgInt32 k = 0; k < 4; k ++) {
+						cavityFace.m_vertex[k] = tetra.m_vertex[k];
+					}
+					cavityFace.m_vertex[j] = vertexIndex;
+					cavityFace.m_face = j;
+					cavityFace.m_neighbor = neighbor;
+					cavityFace.m_neighborFace = -1;
+					const dgTetrahedron& neighborTetra = m_tetras[neighbor];
+					for (dgInt32 k = 0; k < 4; k ++) {
+						if (neighborTetra.m_neighbor[k] == index) {
+							cavityFace.m_neighborFace = k;
+							break;
+						}
+					}
+					dgAssert (cavityFace.m_neighborFace != -1);
+					faceCount ++;
+				}
+			}
+		}
+	}
+
+	for (dgInt32 i = 0; i < conflictCount; i ++) {
+		dgInt32 index = m_conflicts[i];
+		m_tetras[index].m_mark = -1;
+		m_freeTetras[m_freeCount] = index;
+		m_freeCount ++;
 	}
 
-	dgSort(points, m_count, CompareVertexByIndex);
+	// connect the point to each face of the cavity boundary, the new tetrahedra
+	// are connected to each other by the boundary edges they share
+	dgInt32 edgeCount = 0;
+	for (dgInt32 i = 0; i < faceCount; i ++) {
+		const dgCavityFace& cavityFace = m_cavityFaces[i];
+		dgInt32 index = AllocTetrahedron();
+		dgTetrahedron& tetra = m_tetras[index];
+		for (dgInt32 j = 0; j < 4; j ++) {
+			tetra.m_vertex[j] = cavityFace.m_vertex[j];
+		}
+		tetra.m_neighbor[cavityFace.m_face] = cavityFace.m_neighbor;
+		m_tetras[cavityFace.m_neighbor].m_neighbor[cavityFace.m_neighborFace] = index;
+
+		for (dgInt32 j = 0; j < 4; j ++) {
+			if (j != cavityFace.m_face) {
+				dgInt32 edge[2];
+				dgInt32 count = 0;
+				for (dgInt32 k = 0; k < 4; k ++) {
+					if ((k != j) && (k != cavityFace.m_face)) {
+						edge[count] = tetra.m_vertex[k];
+						count ++;
+					}
+				}
+				dgInt32 v0 = dgMin (edge[0], edge[1]);
+				dgInt32 v1 = dgMax (edge[0], edge[1]);
+
+				bool found = false;
+				for (dgInt32 k = 0; k < edgeCount; k ++) {
+					dgCavityEdge& cavityEdge = m_cavityEdges[k];
+					if ((cavityEdge.m_v0 == v0) && (cavityEdge.m_v1 == v1)) {
+						tetra.m_neighbor[j] = cavityEdge.m_tetra;
+						m_tetras[cavityEdge.m_tetra].m_neighbor[cavityEdge.m_face] = index;
+						edgeCount --;
+						cavityEdge = m_cavityEdges[edgeCount];
+						found = true;
+						break;
+					}
+				}
+				if (!found) {
+					dgCavityEdge& cavityEdge = m_cavityEdges[edgeCount];
+					cavityEdge.m_v0 = v0;
+					cavityEdge.m_v1 = v1;
+					cavityEdge.m_tetra = index;
+					cavityEdge.m_face = j;
+					edgeCount ++;
+				}
+			}
+		}
+		m_lastTetra = index;
+	}
+	dgAssert (edgeCount == 0);
+	return true;
 }
 
+void dgDelaunayTetrahedralization::BuildTetrahedraList ()
+{
+	RemoveAll();
+
+	dgStack<dgListNode*> nodes (m_tetraCount + 1);
+	for (dgInt32 i = 0; i < m_tetraCount; i ++) {
+		nodes[i] = NULL;
+		const dgTetrahedron& tetra = m_tetras[i];
+		if ((tetra.m_mark >= 0) && (tetra.GetInfiniteVertexFace() == -1)) {
+			nodes[i] = AddFace (tetra.m_vertex[0], tetra.m_vertex[1], tetra.m_vertex[2], tetra.m_vertex[3]);
+		}
+	}
+
+	// face i of a list tetrahedron is opposite to vertex faceToVertex[i]
+	static const dgInt32 faceToVertex[] = {3, 1, 0, 2};
+	for (dgInt32 i = 0; i < m_tetraCount; i ++) {
+		if (nodes[i]) {
+			const dgTetrahedron& tetra = m_tetras[i];
+			dgConvexHull4dTetraherum& listTetra = nodes[i]->GetInfo();
+			for (dgInt32 j = 0; j < 4; j ++) {
+				listTetra.m_faces[j].m_twin = nodes[tetra.m_neighbor[faceToVertex[j]]];
+			}
+		}
+	}
+}
 
 
 void dgDelaunayTetrahedralization::RemoveUpperHull ()
 {
 	dgSetPrecisionDouble precision;
 
+	UpdateTetrahedraList ();
+
 	dgListNode* nextNode = NULL;
 	for (dgListNode* node = GetFirst(); node; node = nextNode) {
 		nextNode = node->GetNext();
@@ -180,7 +600,3 @@ void dgDelaunayTetrahedralization::DeleteFace (dgListNode* const node)
 	}
 	dgConvexHull4d::DeleteFace (node);
 }
-
-
-
-
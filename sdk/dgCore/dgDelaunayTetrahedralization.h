@@ -25,21 +25,98 @@
 #include "dgStdafx.h"
 #include "dgConvexHull4d.h"
 
+#define DG_DELAUNAY_INFINITE_VERTEX	-1
+
+// the tetrahedralization is built by incremental insertion (Bowyer Watson) on a flat array of 
+// tetrahedra, the hull is closed with ghost tetrahedra that connect each hull face to a vertex at infinity.
+// points are inserted in biased randomized order sorted along a Hilbert curve, so that each point
+// can be located by a short walk from the last tetrahedron created.
+// the result is copied to the tetrahedra list of the base class.
 class dgDelaunayTetrahedralization: public dgConvexHull4d
 {
 	public:
-	dgDelaunayTetrahedralization(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte, dgFloat64 distTol);
+	dgDelaunayTetrahedralization(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte);
 	virtual ~dgDelaunayTetrahedralization();
 	void RemoveUpperHull ();
 
+	// AddVertex only updates the flat tetrahedra array, after adding a batch of 
+	// points call UpdateTetrahedraList before walking the tetrahedra list.
 	dgInt32 AddVertex (const dgBigVector& vertex);
+	void UpdateTetrahedraList ();
 
 	protected:
+	class dgTetrahedron
+	{
+		public:
+		dgInt32 GetInfiniteVertexFace() const
+		{
+			for (dgInt32 i = 0; i < 4; i ++) {
+				if (m_vertex[i] == DG_DELAUNAY_INFINITE_VERTEX) {
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		dgInt32 m_vertex[4];
+		dgInt32 m_neighbor[4];
+		dgInt32 m_mark;
+	};
+
+	class dgCavityFace
+	{
+		public:
+		dgInt32 m_vertex[4];
+		dgInt32 m_face;
+		dgInt32 m_neighbor;
+		dgInt32 m_neighborFace;
+	};
+
+	class dgCavityEdge
+	{
+		public:
+		dgInt32 m_v0;
+		dgInt32 m_v1;
+		dgInt32 m_tetra;
+		dgInt32 m_face;
+	};
+
+	class dgSpatialKey
+	{
+		public:
+		dgUnsigned32 m_key;
+		dgInt32 m_index;
+	};
+
 	virtual void DeleteFace (dgListNode* const node) ;
 
-	void SortVertexArray ();
-	static dgInt32 CompareVertexByIndex(const dgConvexHull4dVector* const  A, const dgConvexHull4dVector* const B, void* const context);
+	bool BuildTetrahedralization ();
+	void SpatialSort (dgInt32* const order);
+	bool InitialTetrahedron (const dgInt32* const order, dgInt32* const tetra);
+	bool InsertVertex (dgInt32 vertexIndex);
+	dgInt32 LocateVertex (const dgBigVector& point);
+	bool IsInConflict (dgInt32 tetraIndex, const dgBigVector& point) const;
+	dgFloat64 Orientation (const dgTetrahedron& tetra, dgInt32 face, const dgBigVector& point) const;
+	dgFloat64 InSphere (const dgTetrahedron& tetra, const dgBigVector& point) const;
+	dgInt32 AllocTetrahedron ();
+	void BuildTetrahedraList ();
+	dgUnsigned32 RandomIndex ();
+
+	static dgFloat64 Orientation (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3);
+	static dgFloat64 InSphere (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3, const dgBigVector& point);
+	static dgUnsigned32 HilbertKey (dgUnsigned32 x, dgUnsigned32 y, dgUnsigned32 z);
+	static dgInt32 CompareSpatialKey (const dgSpatialKey* const keyA, const dgSpatialKey* const keyB, void* const context);
 
+	dgArray<dgTetrahedron> m_tetras;
+	dgArray<dgInt32> m_freeTetras;
+	dgArray<dgInt32> m_conflicts;
+	dgArray<dgCavityFace> m_cavityFaces;
+	dgArray<dgCavityEdge> m_cavityEdges;
+	dgInt32 m_tetraCount;
+	dgInt32 m_freeCount;
+	dgInt32 m_lastTetra;
+	dgUnsigned32 m_randomSeed;
+	bool m_listDirty;
 };
 
 #endif
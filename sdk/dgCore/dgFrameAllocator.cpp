@@ -0,0 +1,147 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgStdafx.h"
+#include "dgDebug.h"
+#include "dgFrameAllocator.h"
+
+#define DG_FRAME_ALLOCATOR_GRANULARITY	(1024 * 16)
+
+dgFrameAllocator::dgFrameAllocator (dgMemoryAllocator* const allocator)
+	:m_allocator(allocator)
+{
+	memset (m_slices, 0, sizeof (m_slices));
+}
+
+dgFrameAllocator::~dgFrameAllocator ()
+{
+	for (dgInt32 i = 0; i < DG_FRAME_ALLOCATOR_SLICES; i ++) {
+		dgSlice& slice = m_slices[i];
+		Reset (slice);
+		if (slice.m_memory) {
+			m_allocator->FreeLow (slice.m_memory);
+		}
+	}
+}
+
+void* dgFrameAllocator::Alloc (dgSlice& slice, dgInt32 sizeInBytes)
+{
+	const dgInt32 size = (sizeInBytes + DG_FRAME_ALLOCATOR_ALIGNMENT - 1) & -DG_FRAME_ALLOCATOR_ALIGNMENT;
+	slice.m_used += size;
+	slice.m_highWaterMark = dgMax (slice.m_highWaterMark, slice.m_used);
+
+	if ((slice.m_offset + size) <= slice.m_capacity) {
+		void* const ptr = &slice.m_memory[slice.m_offset];
+		slice.m_offset += size;
+		return ptr;
+	}
+
+	// the slice is full, serve this one from the heap until the next reset
+	slice.m_allocatorCalls ++;
+	dgMemoryCategoryScope memoryScope (m_memorySolver);
+	dgOverflowBlock* const block = (dgOverflowBlock*) m_allocator->MallocLow (size + DG_FRAME_ALLOCATOR_ALIGNMENT, DG_FRAME_ALLOCATOR_ALIGNMENT);
+	block->m_next = slice.m_overflow;
+	slice.m_overflow = block;
+	return ((dgInt8*)block) + DG_FRAME_ALLOCATOR_ALIGNMENT;
+}
+
+void dgFrameAllocator::Resize (dgSlice& slice, dgInt32 sizeInBytes)
+{
+	dgAssert (!slice.m_offset);
+	const dgInt32 size = (sizeInBytes + DG_FRAME_ALLOCATOR_GRANULARITY - 1) & -DG_FRAME_ALLOCATOR_GRANULARITY;
+	if (size > slice.m_capacity) {
+		if (slice.m_memory) {
+			m_allocator->FreeLow (slice.m_memory);
+		}
+		slice.m_allocatorCalls ++;
+		dgMemoryCategoryScope memoryScope (m_memorySolver);
+		slice.m_memory = (dgInt8*) m_allocator->MallocLow (size, DG_FRAME_ALLOCATOR_ALIGNMENT);
+		slice.m_capacity = size;
+	}
+}
+
+void dgFrameAllocator::Reset (dgSlice& slice)
+{
+	while (slice.m_overflow) {
+		dgOverflowBlock* const block = slice.m_overflow;
+		slice.m_overflow = block->m_next;
+		m_allocator->FreeLow (block);
+	}
+	slice.m_offset = 0;
+	slice.m_used = 0;
+}
+
+void dgFrameAllocator::Reset ()
+{
+	for (dgInt32 i = 0; i < DG_FRAME_ALLOCATOR_SLICES; i ++) {
+		dgSlice& slice = m_slices[i];
+		const bool overflow = slice.m_overflow ? true : false;
+		Reset (slice);
+		if (overflow) {
+			Resize (slice, dgInt32 (slice.m_highWaterMark));
+		}
+	}
+}
+
+void dgFrameAllocator::Reserve (dgInt32 sharedSizeInBytes, dgInt32 threadSizeInBytes)
+{
+	for (dgInt32 i = 0; i < DG_MAX_THREADS_HIVE_COUNT; i ++) {
+		Reset (m_slices[i]);
+		Resize (m_slices[i], threadSizeInBytes);
+	}
+	Reset (m_slices[DG_FRAME_ALLOCATOR_SHARED_SLICE]);
+	Resize (m_slices[DG_FRAME_ALLOCATOR_SHARED_SLICE], sharedSizeInBytes);
+}
+
+dgInt64 dgFrameAllocator::GetCapacity () const
+{
+	dgInt64 capacity = 0;
+	for (dgInt32 i = 0; i < DG_FRAME_ALLOCATOR_SLICES; i ++) {
+		capacity += m_slices[i].m_capacity;
+	}
+	return capacity;
+}
+
+dgInt64 dgFrameAllocator::GetHighWaterMark () const
+{
+	dgInt64 highWaterMark = 0;
+	for (dgInt32 i = 0; i < DG_FRAME_ALLOCATOR_SLICES; i ++) {
+		highWaterMark += m_slices[i].m_highWaterMark;
+	}
+	return highWaterMark;
+}
+
+dgInt64 dgFrameAllocator::GetAllocatorCalls () const
+{
+	dgInt64 calls = 0;
+	for (dgInt32 i = 0; i < DG_FRAME_ALLOCATOR_SLICES; i ++) {
+		calls += m_slices[i].m_allocatorCalls;
+	}
+	return calls;
+}
+
+void dgFrameAllocator::ClearStatistics ()
+{
+	for (dgInt32 i = 0; i < DG_FRAME_ALLOCATOR_SLICES; i ++) {
+		m_slices[i].m_highWaterMark = m_slices[i].m_used;
+		m_slices[i].m_allocatorCalls = 0;
+	}
+}
@@ -0,0 +1,93 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __DG_FRAME_ALLOCATOR_H__
+#define __DG_FRAME_ALLOCATOR_H__
+
+#include "dgStdafx.h"
+#include "dgMemory.h"
+
+#define DG_FRAME_ALLOCATOR_ALIGNMENT	64
+#define DG_FRAME_ALLOCATOR_SLICES		(DG_MAX_THREADS_HIVE_COUNT + 1)
+#define DG_FRAME_ALLOCATOR_SHARED_SLICE	DG_MAX_THREADS_HIVE_COUNT
+
+// linear allocator for memory that only lives for the duration of one simulation step.
+// each worker thread has its own slice so allocations do not need locks, and the calling 
+// thread uses the shared slice. allocations that do not fit the slice are served from the 
+// heap, and on reset the slice grows to the high water mark, so after a few steps a
+// scene runs without calling the memory allocator at all. 
+class dgFrameAllocator
+{
+	public:
+	dgFrameAllocator (dgMemoryAllocator* const allocator);
+	~dgFrameAllocator ();
+
+	void* Alloc (dgInt32 sizeInBytes);
+	void* Alloc (dgInt32 sizeInBytes, dgInt32 threadID);
+	void Reserve (dgInt32 sharedSizeInBytes, dgInt32 threadSizeInBytes);
+	void Reset ();
+
+	dgInt64 GetCapacity () const;
+	dgInt64 GetHighWaterMark () const;
+	dgInt64 GetAllocatorCalls () const;
+	void ClearStatistics ();
+
+	private:
+	class dgOverflowBlock
+	{
+		public:
+		dgOverflowBlock* m_next;
+	};
+
+	class dgSlice
+	{
+		public:
+		dgInt8* m_memory;
+		dgOverflowBlock* m_overflow;
+		dgInt32 m_capacity;
+		dgInt32 m_offset;
+		dgInt64 m_used;
+		dgInt64 m_highWaterMark;
+		dgInt64 m_allocatorCalls;
+	};
+
+	void* Alloc (dgSlice& slice, dgInt32 sizeInBytes);
+	void Resize (dgSlice& slice, dgInt32 sizeInBytes);
+	void Reset (dgSlice& slice);
+
+	dgMemoryAllocator* m_allocator;
+	dgSlice m_slices[DG_FRAME_ALLOCATOR_SLICES];
+};
+
+DG_INLINE void* dgFrameAllocator::Alloc (dgInt32 sizeInBytes)
+{
+	return Alloc (m_slices[DG_FRAME_ALLOCATOR_SHARED_SLICE], sizeInBytes);
+}
+
+DG_INLINE void* dgFrameAllocator::Alloc (dgInt32 sizeInBytes, dgInt32 threadID)
+{
+	dgAssert (threadID >= 0);
+	dgAssert (threadID < DG_MAX_THREADS_HIVE_COUNT);
+	return Alloc (m_slices[threadID], sizeInBytes);
+}
+
+#endif
+
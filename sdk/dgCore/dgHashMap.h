@@ -0,0 +1,575 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __dgHashMap__
+#define __dgHashMap__
+
+#include "dgStdafx.h"
+#include "dgDebug.h"
+#include "dgMemory.h"
+
+#define DG_HASH_MAP_PAGE_SIZE		256
+#define DG_HASH_MAP_MIN_TABLE_BITS	6
+
+// unordered map with the same interface than dgTree, for integer keys.
+// the keys are located in an open addressing table with linear probing, the nodes are 
+// allocated from contiguous pages and never move, and the iteration follows the insertion order,
+// so that nodes can be added or removed while iterating the same way than in a dgTree.
+template<class OBJECT, class KEY>
+class dgHashMap 
+{
+	public:
+	class dgHashMapNode
+	{
+		dgHashMapNode (const OBJECT &info, KEY key)
+			:m_info (info)
+			,m_key (key)
+			,m_next (NULL)
+			,m_prev (NULL)
+		{
+		}
+
+		~dgHashMapNode () 
+		{
+		}
+
+		public:
+		OBJECT& GetInfo()
+		{
+			return m_info;
+		}
+
+		const OBJECT& GetInfo() const
+		{
+			return m_info;
+		}
+
+		const KEY& GetKey() const
+		{
+			return m_key;
+		}
+
+		dgHashMapNode* GetNext() const
+		{
+			return m_next;
+		}
+
+		dgHashMapNode* GetPrev() const
+		{
+			return m_prev;
+		}
+
+		private:
+		OBJECT m_info;
+		KEY m_key; 
+		dgHashMapNode* m_next;
+		dgHashMapNode* m_prev;
+		friend class dgHashMap<OBJECT, KEY>;
+	};
+
+	// same node name than dgTree, so that a class can switch between the two containers
+	typedef dgHashMapNode dgTreeNode;
+
+	class Iterator
+	{
+		public:
+		Iterator(const dgHashMap<OBJECT, KEY> &me)
+		{
+			m_ptr = NULL;
+			m_map = &me;
+		}
+
+		~Iterator()
+		{
+		}
+
+		void Begin() 
+		{
+			m_ptr = m_map->m_first;
+		}
+
+		void End()  
+		{
+			m_ptr = m_map->m_last;
+		}
+
+		void Set (dgHashMapNode* const node)
+		{
+			m_ptr = node;
+		}
+
+		operator dgInt32() const 
+		{
+			return m_ptr != NULL;
+		}
+
+		void operator++ ()
+		{
+			dgAssert (m_ptr);
+			m_ptr = m_ptr->m_next;
+		}
+
+		void operator++ (dgInt32)
+		{
+			dgAssert (m_ptr);
+			m_ptr = m_ptr->m_next;
+		}
+
+		void operator-- () 
+		{
+			dgAssert (m_ptr);
+			m_ptr = m_ptr->m_prev;
+		}
+
+		void operator-- (dgInt32) 
+		{
+			dgAssert (m_ptr);
+			m_ptr = m_ptr->m_prev;
+		}
+
+		OBJECT &operator* () const 
+		{
+			return m_ptr->GetInfo();
+		}
+
+		dgHashMapNode* GetNode() const
+		{
+			return m_ptr;
+		}
+
+		KEY GetKey () const
+		{
+			return m_ptr ? m_ptr->GetKey() : KEY(0);
+		}
+
+		private:
+		dgHashMapNode* m_ptr;
+		const dgHashMap* m_map;
+	};
+
+	// ***********************************************************
+	// member functions
+	// ***********************************************************
+	public:
+	DG_CLASS_ALLOCATOR(allocator)
+
+	dgHashMap (dgMemoryAllocator* const allocator);
+	virtual ~dgHashMap (); 
+
+	dgMemoryAllocator* GetAllocator () const;
+
+	operator dgInt32() const;
+	dgInt32 GetCount() const;
+
+	dgHashMapNode* GetRoot () const;
+	dgHashMapNode* GetFirst () const;
+	dgHashMapNode* GetLast () const;
+
+	dgHashMapNode* Find (KEY key) const;
+	dgHashMapNode* GetNodeFromInfo (OBJECT &info) const;
+
+	dgHashMapNode* Insert (const OBJECT &element, KEY key, bool& elementWasInMap);
+	dgHashMapNode* Insert (const OBJECT &element, KEY key);
+	dgHashMapNode* Insert (dgHashMapNode* const node, KEY key);
+
+	dgHashMapNode* ReplaceKey (KEY oldKey, KEY newKey);
+	dgHashMapNode* ReplaceKey (dgHashMapNode* const node, KEY key);
+
+	void Remove (KEY key);
+	void Remove (dgHashMapNode* const node);
+	void RemoveAll (); 
+
+	void Unlink (dgHashMapNode* const node);
+	void SwapInfo (dgHashMap& map);
+	void Reserve (dgInt32 count);
+
+	// ***********************************************************
+	// member variables
+	// ***********************************************************
+	private:
+	dgInt32 GetSlot (KEY key) const;
+	void AddToTable (dgHashMapNode* const node);
+	void RemoveFromTable (dgHashMapNode* const node);
+	void ResizeTable (dgInt32 tableBits);
+	void LinkNode (dgHashMapNode* const node);
+	void UnlinkNode (dgHashMapNode* const node);
+	dgHashMapNode* AllocNode ();
+	void FreeNode (dgHashMapNode* const node);
+
+	dgHashMapNode* m_first;
+	dgHashMapNode* m_last;
+	dgHashMapNode* m_freeList;
+	dgHashMapNode** m_table;
+	void* m_pages;
+	dgMemoryAllocator* m_allocator;
+	dgInt32 m_count;
+	dgInt32 m_tableBits;
+};
+
+
+template<class OBJECT, class KEY>
+dgHashMap<OBJECT, KEY>::dgHashMap (dgMemoryAllocator* const allocator)
+	:m_first(NULL)
+	,m_last(NULL)
+	,m_freeList(NULL)
+	,m_table(NULL)
+	,m_pages(NULL)
+	,m_allocator(allocator)
+	,m_count(0)
+	,m_tableBits(0)
+{
+}
+
+template<class OBJECT, class KEY>
+dgHashMap<OBJECT, KEY>::~dgHashMap () 
+{
+	RemoveAll();
+}
+
+template<class OBJECT, class KEY>
+dgMemoryAllocator* dgHashMap<OBJECT, KEY>::GetAllocator () const
+{
+	return m_allocator;
+}
+
+template<class OBJECT, class KEY>
+dgHashMap<OBJECT, KEY>::operator dgInt32() const
+{
+	return m_first != NULL;
+}
+
+template<class OBJECT, class KEY>
+dgInt32 dgHashMap<OBJECT, KEY>::GetCount() const
+{
+	return m_count;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::GetRoot () const
+{
+	return m_first;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::GetFirst () const
+{
+	return m_first;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::GetLast () const
+{
+	return m_last;
+}
+
+template<class OBJECT, class KEY>
+dgInt32 dgHashMap<OBJECT, KEY>::GetSlot (KEY key) const
+{
+	// fibonacci hashing, the high bits of the product mix all the bits of the key
+	const dgUnsigned64 hash = dgUnsigned64 (key) * dgUnsigned64 (0x9e3779b97f4a7c15ULL);
+	return dgInt32 (hash >> (64 - m_tableBits));
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::Find (KEY key) const
+{
+	if (!m_count) {
+		return NULL;
+	}
+
+	const dgInt32 mask = (1 << m_tableBits) - 1;
+	for (dgInt32 slot = GetSlot (key); m_table[slot]; slot = (slot + 1) & mask) {
+		if (m_table[slot]->m_key == key) {
+			return m_table[slot];
+		}
+	}
+	return NULL;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::GetNodeFromInfo (OBJECT &info) const
+{
+	dgHashMapNode* const node = (dgHashMapNode*) &info;
+	dgInt64 offset = ((char*) &node->m_info) - ((char *) node);
+	dgHashMapNode* const retnode = (dgHashMapNode*) (((char *) node) - offset);
+	dgAssert (&retnode->GetInfo () == &info);
+	return retnode;
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::ResizeTable (dgInt32 tableBits)
+{
+	if (m_table) {
+		m_allocator->Free (m_table);
+	}
+
+	const dgInt32 size = 1 << tableBits;
+	m_tableBits = tableBits;
+	m_table = (dgHashMapNode**) m_allocator->Malloc (dgInt32 (size * sizeof (dgHashMapNode*)));
+	memset (m_table, 0, size * sizeof (dgHashMapNode*));
+
+	for (dgHashMapNode* node = m_first; node; node = node->m_next) {
+		AddToTable (node);
+	}
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::Reserve (dgInt32 count)
+{
+	// keep the load factor of the table under one half
+	dgInt32 tableBits = dgMax (m_tableBits, DG_HASH_MAP_MIN_TABLE_BITS);
+	while ((1 << tableBits) < (count * 2)) {
+		tableBits ++;
+	}
+	if (tableBits != m_tableBits) {
+		ResizeTable (tableBits);
+	}
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::AddToTable (dgHashMapNode* const node)
+{
+	const dgInt32 mask = (1 << m_tableBits) - 1;
+	dgInt32 slot = GetSlot (node->m_key);
+	while (m_table[slot]) {
+		dgAssert (m_table[slot]->m_key != node->m_key);
+		slot = (slot + 1) & mask;
+	}
+	m_table[slot] = node;
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::RemoveFromTable (dgHashMapNode* const node)
+{
+	const dgInt32 mask = (1 << m_tableBits) - 1;
+	dgInt32 slot = GetSlot (node->m_key);
+	while (m_table[slot] != node) {
+		dgAssert (m_table[slot]);
+		slot = (slot + 1) & mask;
+	}
+
+	// backward shift deletion, move up all the entries of the cluster 
+	// that can not be reached from their home slot once this slot is empty 
+	for (dgInt32 next = (slot + 1) & mask; m_table[next]; next = (next + 1) & mask) {
+		const dgInt32 home = GetSlot (m_table[next]->m_key);
+		if (((next - home) & mask) >= ((next - slot) & mask)) {
+			m_table[slot] = m_table[next];
+			slot = next;
+		}
+	}
+	m_table[slot] = NULL;
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::LinkNode (dgHashMapNode* const node)
+{
+	node->m_next = NULL;
+	node->m_prev = m_last;
+	if (m_last) {
+		m_last->m_next = node;
+	} else {
+		m_first = node;
+	}
+	m_last = node;
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::UnlinkNode (dgHashMapNode* const node)
+{
+	if (node->m_prev) {
+		node->m_prev->m_next = node->m_next;
+	} else {
+		m_first = node->m_next;
+	}
+	if (node->m_next) {
+		node->m_next->m_prev = node->m_prev;
+	} else {
+		m_last = node->m_prev;
+	}
+	node->m_next = NULL;
+	node->m_prev = NULL;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::AllocNode ()
+{
+	if (!m_freeList) {
+		// the link to the previous page is saved after the last node of the page
+		dgAssert (m_allocator);
+		const dgInt32 pageSize = dgInt32 (DG_HASH_MAP_PAGE_SIZE * sizeof (dgHashMapNode));
+		char* const page = (char*) m_allocator->Malloc (dgInt32 (pageSize + sizeof (void*)));
+		*((void**) &page[pageSize]) = m_pages;
+		m_pages = page;
+
+		dgHashMapNode* const nodes = (dgHashMapNode*) page;
+		for (dgInt32 i = DG_HASH_MAP_PAGE_SIZE - 1; i >= 0; i --) {
+			nodes[i].m_next = m_freeList;
+			m_freeList = &nodes[i];
+		}
+	}
+	dgHashMapNode* const node = m_freeList;
+	m_freeList = node->m_next;
+	return node;
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::FreeNode (dgHashMapNode* const node)
+{
+	node->~dgHashMapNode();
+	node->m_next = m_freeList;
+	m_freeList = node;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::Insert (const OBJECT &element, KEY key, bool& elementWasInMap)
+{
+	dgHashMapNode* const node = Find (key);
+	elementWasInMap = node ? true : false;
+	if (node) {
+		return node;
+	}
+
+	Reserve (m_count + 1);
+	dgHashMapNode* const ptr = new (AllocNode ()) dgHashMapNode (element, key);
+	AddToTable (ptr);
+	LinkNode (ptr);
+	m_count ++;
+	return ptr;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::Insert (const OBJECT &element, KEY key)
+{
+	bool foundState;
+	dgHashMapNode* const node = Insert (element, key, foundState);
+	if (foundState) {
+		return NULL;
+	}
+	return node;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::Insert (dgHashMapNode* const node, KEY key)
+{
+	// insert a node previously unlinked from this map
+	if (Find (key)) {
+		return NULL;
+	}
+
+	Reserve (m_count + 1);
+	node->m_key = key;
+	AddToTable (node);
+	LinkNode (node);
+	m_count ++;
+	return node;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::ReplaceKey (dgHashMapNode* const node, KEY key)
+{
+	// the node keeps its place in the iteration order
+	if (node->m_key == key) {
+		return node;
+	}
+	dgAssert (!Find (key));
+	RemoveFromTable (node);
+	node->m_key = key;
+	AddToTable (node);
+	return node;
+}
+
+template<class OBJECT, class KEY>
+typename dgHashMap<OBJECT, KEY>::dgHashMapNode* dgHashMap<OBJECT, KEY>::ReplaceKey (KEY oldKey, KEY newKey)
+{
+	dgHashMapNode* const node = Find (oldKey);
+	return node ? ReplaceKey (node, newKey) : NULL;
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::Unlink (dgHashMapNode* const node)
+{
+	m_count --;
+	RemoveFromTable (node);
+	UnlinkNode (node);
+	dgAssert (!Find (node->GetKey()));
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::Remove (dgHashMapNode* const node)
+{
+	m_count --;
+	RemoveFromTable (node);
+	UnlinkNode (node);
+	FreeNode (node);
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::Remove (KEY key) 
+{
+	dgHashMapNode* const node = Find (key);
+	if (node) {
+		Remove (node);
+	}
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::RemoveAll () 
+{
+	for (dgHashMapNode* node = m_first; node; ) {
+		dgHashMapNode* const next = node->m_next;
+		node->~dgHashMapNode();
+		node = next;
+	}
+
+	const dgInt32 pageSize = dgInt32 (DG_HASH_MAP_PAGE_SIZE * sizeof (dgHashMapNode));
+	while (m_pages) {
+		char* const page = (char*) m_pages;
+		m_pages = *((void**) &page[pageSize]);
+		m_allocator->Free (page);
+	}
+
+	if (m_table) {
+		m_allocator->Free (m_table);
+	}
+
+	m_first = NULL;
+	m_last = NULL;
+	m_freeList = NULL;
+	m_table = NULL;
+	m_count = 0;
+	m_tableBits = 0;
+}
+
+template<class OBJECT, class KEY>
+void dgHashMap<OBJECT, KEY>::SwapInfo (dgHashMap<OBJECT, KEY>& map)
+{
+	dgAssert (m_allocator == map.m_allocator);
+	dgSwap (m_first, map.m_first);
+	dgSwap (m_last, map.m_last);
+	dgSwap (m_freeList, map.m_freeList);
+	dgSwap (m_table, map.m_table);
+	dgSwap (m_pages, map.m_pages);
+	dgSwap (m_count, map.m_count);
+	dgSwap (m_tableBits, map.m_tableBits);
+}
+
+#endif
+
@@ -25,8 +25,10 @@
 #include "dgMemory.h"
 
 
+// the memory pools of an allocator are not thread safe, in debug we check that no two threads
+// access the same allocator at the same time. different allocators can be used concurrently, 
+// and MallocLow and FreeLow are safe to call from any thread.
 #ifdef _DEBUG
-static dgInt32 m_threadSanityCheck = 0;
 #define DG_MEMORY_THREAD_SANITY_CHECK_LOCK()		\
 	dgAssert (!m_threadSanityCheck);				\
 	dgAtomicExchangeAndAdd(&m_threadSanityCheck, 1);
@@ -36,6 +38,10 @@ static dgInt32 m_threadSanityCheck = 0;
 	#define DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK()
 #endif
 
+#define DG_MEMORY_UNTRACKED_CATEGORY	-1
+
+static DG_THREAD_LOCAL dgInt32 currentMemoryCategory = m_memoryGeneral;
+
 
 class dgMemoryAllocator::dgMemoryBin
 {
@@ -67,6 +73,7 @@ class dgMemoryAllocator::dgMemoryInfo
 	dgMemoryAllocator* m_allocator;
 	dgInt32 m_size;
 	dgInt32 m_enum;
+	dgInt32 m_category;
 
 	#ifdef _DEBUG
 	dgInt32 m_workingSize;
@@ -77,6 +84,7 @@ class dgMemoryAllocator::dgMemoryInfo
 		m_ptr = ptr;
 		m_size = size;
 		m_enum = enumerator;
+		m_category = DG_MEMORY_UNTRACKED_CATEGORY;
 		enumerator++;
 		m_allocator = allocator;
 #ifdef _DEBUG
@@ -118,9 +126,9 @@ class dgGlobalAllocator: public dgMemoryAllocator, public dgList<dgMemoryAllocat
 	}
 
 
-	dgInt32 GetMemoryUsed () const
+	dgInt64 GetMemoryUsed () const
 	{
-		dgInt32 mem = m_memoryUsed;
+		dgInt64 mem = m_memoryUsed;
 		for (dgList<dgMemoryAllocator*>::dgListNode* node = GetFirst(); node; node = node->GetNext()) {
 			mem += node->GetInfo()->GetMemoryUsed();
 		}
@@ -146,6 +154,10 @@ dgMemoryAllocator::dgMemoryAllocator ()
 {
 	SetAllocatorsCallback (dgGlobalAllocator::GetGlobalAllocator().m_malloc, dgGlobalAllocator::GetGlobalAllocator().m_free);
 	memset (m_memoryDirectory, 0, sizeof (m_memoryDirectory));
+	memset (m_statistics, 0, sizeof (m_statistics));
+#ifdef _DEBUG
+	m_threadSanityCheck = 0;
+#endif
 	dgGlobalAllocator::GetGlobalAllocator().Append(this);
 }
 
@@ -158,6 +170,10 @@ dgMemoryAllocator::dgMemoryAllocator (dgMemAlloc memAlloc, dgMemFree memFree)
 {
 	SetAllocatorsCallback (memAlloc, memFree);
 	memset (m_memoryDirectory, 0, sizeof (m_memoryDirectory));
+	memset (m_statistics, 0, sizeof (m_statistics));
+#ifdef _DEBUG
+	m_threadSanityCheck = 0;
+#endif
 }
 
 
@@ -181,11 +197,44 @@ void dgMemoryAllocator::operator delete (void* const ptr)
 }
 
 
-dgInt32 dgMemoryAllocator::GetMemoryUsed() const
+dgInt64 dgMemoryAllocator::GetMemoryUsed() const
 {
 	return m_memoryUsed;
 }
 
+void dgMemoryAllocator::GetMemoryStatistics (dgMemoryCategory category, dgMemoryStatistics& statistics) const
+{
+	dgAssert ((category >= m_memoryGeneral) && (category < m_memoryCategoriesCount));
+	statistics = m_statistics[category];
+}
+
+// peaks and allocation counts are measured from the last reset, the world resets them at the beginning of each step
+void dgMemoryAllocator::ResetMemoryPeaks ()
+{
+	for (dgInt32 i = 0; i < m_memoryCategoriesCount; i ++) {
+		m_statistics[i].m_peakMemoryUsed = m_statistics[i].m_memoryUsed;
+		m_statistics[i].m_allocationsCount = 0;
+	}
+}
+
+void dgMemoryAllocator::AddCategoryMemory (dgInt32 category, dgInt32 size)
+{
+	dgMemoryStatistics& statistics = m_statistics[category];
+	dgAtomicExchangeAndAdd (&statistics.m_allocationsCount, dgInt64 (1));
+	const dgInt64 memoryUsed = dgAtomicExchangeAndAdd (&statistics.m_memoryUsed, dgInt64 (size)) + size;
+	// the peak is only statistics, a lost update between two threads is acceptable 
+	if (memoryUsed > statistics.m_peakMemoryUsed) {
+		statistics.m_peakMemoryUsed = memoryUsed;
+	}
+}
+
+void dgMemoryAllocator::RemoveCategoryMemory (dgInt32 category, dgInt32 size)
+{
+	if (category != DG_MEMORY_UNTRACKED_CATEGORY) {
+		dgAtomicExchangeAndAdd (&m_statistics[category].m_memoryUsed, -dgInt64 (size));
+	}
+}
+
 void dgMemoryAllocator::SetAllocatorsCallback (dgMemAlloc memAlloc, dgMemFree memFree)
 {
 	m_free = memFree;
@@ -195,6 +244,11 @@ void dgMemoryAllocator::SetAllocatorsCallback (dgMemAlloc memAlloc, dgMemFree me
 
 
 void *dgMemoryAllocator::MallocLow (dgInt32 workingSize, dgInt32 alignment)
+{
+	return MallocLow (workingSize, alignment, currentMemoryCategory);
+}
+
+void* dgMemoryAllocator::MallocLow (dgInt32 workingSize, dgInt32 alignment, dgInt32 category)
 {
 	dgAssert (alignment >= DG_MEMORY_GRANULARITY);
 	dgAssert (((-alignment) & (alignment - 1)) == 0);
@@ -212,7 +266,11 @@ void *dgMemoryAllocator::MallocLow (dgInt32 workingSize, dgInt32 alignment)
 	dgMemoryInfo* const info = ((dgMemoryInfo*) (retPtr)) - 1;
 	info->SaveInfo(this, ptr, size, m_emumerator, workingSize);
 
-	dgAtomicExchangeAndAdd (&m_memoryUsed, size);
+	dgAtomicExchangeAndAdd (&m_memoryUsed, dgInt64 (size));
+	if (category != DG_MEMORY_UNTRACKED_CATEGORY) {
+		info->m_category = category;
+		AddCategoryMemory (category, size);
+	}
 	return retPtr;
 }
 
@@ -221,7 +279,8 @@ void dgMemoryAllocator::FreeLow (void* const retPtr)
 	dgMemoryInfo* const info = ((dgMemoryInfo*) (retPtr)) - 1;
 	dgAssert (info->m_allocator == this);
 
-	dgAtomicExchangeAndAdd (&m_memoryUsed, -info->m_size);
+	dgAtomicExchangeAndAdd (&m_memoryUsed, -dgInt64 (info->m_size));
+	RemoveCategoryMemory (info->m_category, info->m_size);
 
 #ifdef _DEBUG
 	memset (retPtr, 0, size_t(info->m_workingSize));
@@ -246,8 +305,10 @@ void *dgMemoryAllocator::Malloc (dgInt32 memsize)
 	if (entry >= DG_MEMORY_BIN_ENTRIES) {
 		ptr = MallocLow (size);
 	} else {
+		DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 		if (!m_memoryDirectory[entry].m_cache) {
-			dgMemoryBin* const bin = (dgMemoryBin*) MallocLow (sizeof (dgMemoryBin));
+			// bins are shared by all categories, only the blocks taken from them are accounted
+			dgMemoryBin* const bin = (dgMemoryBin*) MallocLow (sizeof (dgMemoryBin), DG_MEMORY_GRANULARITY, DG_MEMORY_UNTRACKED_CATEGORY);
 
 			dgInt32 count = dgInt32 (sizeof (bin->m_pool) / paddedSize);
 			bin->m_info.m_count = 0;
@@ -295,10 +356,13 @@ void *dgMemoryAllocator::Malloc (dgInt32 memsize)
 		dgMemoryBin* const bin = (dgMemoryBin*) info->m_ptr;
 		bin->m_info.m_count ++;
 
+		info->m_category = currentMemoryCategory;
+		AddCategoryMemory (info->m_category, paddedSize);
+
 		#ifdef __TRACK_MEMORY_LEAKS__
 		m_leaklTracker.InsertBlock (dgInt32 (memsize), ptr);
 		#endif
-
+		DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	}
 	return ptr;
 }
@@ -315,6 +379,7 @@ void dgMemoryAllocator::Free (void* const retPtr)
 	if (entry >= DG_MEMORY_BIN_ENTRIES) {
 		FreeLow (retPtr);
 	} else {
+		DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 		#ifdef __TRACK_MEMORY_LEAKS__
 		m_leaklTracker.RemoveBlock (retPtr);
 		#endif
@@ -339,6 +404,9 @@ void dgMemoryAllocator::Free (void* const retPtr)
 		memset (retPtr, 0, size_t(bin->m_info.m_stepInBites - DG_MEMORY_GRANULARITY));
 #endif
 
+		RemoveCategoryMemory (info->m_category, bin->m_info.m_stepInBites);
+		info->m_category = DG_MEMORY_UNTRACKED_CATEGORY;
+
 		bin->m_info.m_count --;
 		if (bin->m_info.m_count == 0) {
 
@@ -375,6 +443,7 @@ void dgMemoryAllocator::Free (void* const retPtr)
 
 			FreeLow (bin);
 		}
+		DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	}
 }
 
@@ -459,28 +528,40 @@ void dgMemoryAllocator::SetGlobalAllocators (dgMemAlloc malloc, dgMemFree free)
 	dgGlobalAllocator::GetGlobalAllocator().SetAllocatorsCallback (malloc, free);
 }
 
-dgInt32 dgMemoryAllocator::GetGlobalMemoryUsed ()
+dgInt64 dgMemoryAllocator::GetGlobalMemoryUsed ()
 {
 	return dgGlobalAllocator::GetGlobalAllocator().GetMemoryUsed();
 }
 
+dgMemoryCategoryScope::dgMemoryCategoryScope (dgMemoryCategory category)
+	:m_parentCategory(dgMemoryCategory (currentMemoryCategory))
+{
+	currentMemoryCategory = category;
+}
+
+dgMemoryCategoryScope::~dgMemoryCategoryScope ()
+{
+	currentMemoryCategory = m_parentCategory;
+}
+
+dgMemoryCategory dgMemoryCategoryScope::GetCurrentCategory()
+{
+	return dgMemoryCategory (currentMemoryCategory);
+}
+
 // this can be used by function that allocates large memory pools memory locally on the stack
 // this by pases the pool allocation because this should only be used for very large memory blocks.
 // this was using virtual memory on windows but 
 // but because of many complaint I changed it to use malloc and free
 void* dgApi dgMallocStack (size_t size)
 {
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	void * const ptr = dgGlobalAllocator::GetGlobalAllocator().MallocLow (dgInt32 (size));
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	return ptr;
 }
 
 void* dgApi dgMallocAligned (size_t size, dgInt32 align)
 {
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	void * const ptr = dgGlobalAllocator::GetGlobalAllocator().MallocLow (dgInt32 (size), align);
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	return ptr;
 	
 }
@@ -491,9 +572,7 @@ void* dgApi dgMallocAligned (size_t size, dgInt32 align)
 // but because of many complaint I changed it to use malloc and free
 void  dgApi dgFreeStack (void* const ptr)
 {
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	dgGlobalAllocator::GetGlobalAllocator().FreeLow (ptr);
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 }
 
 
@@ -503,12 +582,9 @@ void* dgApi dgMalloc (size_t size, dgMemoryAllocator* const allocator)
 	void* ptr = NULL;
 	dgAssert (allocator);
 
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	if (size) {
 		ptr = allocator->Malloc (dgInt32 (size));
 	}
-
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	return ptr;
 }
 
@@ -517,12 +593,10 @@ void* dgApi dgMalloc (size_t size, dgMemoryAllocator* const allocator)
 void dgApi dgFree (void* const ptr)
 {
 	if (ptr) {
-		DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 		dgMemoryAllocator::dgMemoryInfo* info;
 		info = ((dgMemoryAllocator::dgMemoryInfo*) ptr) - 1; 
 		dgAssert (info->m_allocator);
 		info->m_allocator->Free (ptr);
-		DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	}
 }
 
@@ -62,6 +62,39 @@ typedef void (dgApi *dgMemFree) (void* const ptr, dgUnsigned32 size);
 	DG_CLASS_ALLOCATOR_DELETE_ARRAY_DUMMY
 
 
+// subsystems the allocations are accounted to, the category is selected per thread with a dgMemoryCategoryScope
+enum dgMemoryCategory
+{
+	m_memoryGeneral = 0,
+	m_memoryBroadPhase,
+	m_memoryContacts,
+	m_memoryCollisionShapes,
+	m_memoryMeshes,
+	m_memorySolver,
+	m_memorySkeletons,
+	m_memoryCategoriesCount,
+};
+
+class dgMemoryStatistics
+{
+	public:
+	dgInt64 m_memoryUsed;
+	dgInt64 m_peakMemoryUsed;
+	dgInt64 m_allocationsCount;
+};
+
+// all allocations made by the calling thread while the scope is alive are accounted to the category
+class dgMemoryCategoryScope
+{
+	public:
+	dgMemoryCategoryScope (dgMemoryCategory category);
+	~dgMemoryCategoryScope ();
+
+	static dgMemoryCategory GetCurrentCategory();
+
+	private:
+	dgMemoryCategory m_parentCategory;
+};
 
 
 class dgMemoryAllocator
@@ -120,7 +153,9 @@ class dgMemoryAllocator
 
 	void *operator new (size_t size);
 	void operator delete (void* const ptr);
-	dgInt32 GetMemoryUsed() const;
+	dgInt64 GetMemoryUsed() const;
+	void GetMemoryStatistics (dgMemoryCategory category, dgMemoryStatistics& statistics) const;
+	void ResetMemoryPeaks ();
 
 	void SetAllocatorsCallback (dgMemAlloc memAlloc, dgMemFree memFree);
 	virtual void *MallocLow (dgInt32 size, dgInt32 alignment = DG_MEMORY_GRANULARITY);
@@ -128,7 +163,7 @@ class dgMemoryAllocator
 	virtual void *Malloc (dgInt32 memsize);
 	virtual void Free (void* const retPtr);
 
-	static dgInt32 GetGlobalMemoryUsed ();
+	static dgInt64 GetGlobalMemoryUsed ();
 	static void SetGlobalAllocators (dgMemAlloc alloc, dgMemFree free);
 
 	protected:
@@ -141,18 +176,29 @@ class dgMemoryAllocator
 	{	
 		//m_memoryUsed = 0;
 		//m_isInList = false;
+		memset (m_statistics, 0, sizeof (m_statistics));
+#ifdef _DEBUG
+		m_threadSanityCheck = 0;
+#endif
 	}
 
 	dgMemoryAllocator (dgMemAlloc memAlloc, dgMemFree memFree);
+	void* MallocLow (dgInt32 workingSize, dgInt32 alignment, dgInt32 category);
+	void AddCategoryMemory (dgInt32 category, dgInt32 size);
+	void RemoveCategoryMemory (dgInt32 category, dgInt32 size);
 
 	dgInt32 m_emumerator;
-	dgInt32 m_memoryUsed;
+	dgInt64 m_memoryUsed;
+	dgMemoryStatistics m_statistics[m_memoryCategoriesCount];
 	dgMemFree m_free;
 	dgMemAlloc m_malloc;
 	dgMemDirectory m_memoryDirectory[DG_MEMORY_BIN_ENTRIES + 1]; 
 
 #ifdef __TRACK_MEMORY_LEAKS__
 	dgMemoryLeaksTracker m_leaklTracker;
+#endif
+#ifdef _DEBUG
+	dgInt32 m_threadSanityCheck;
 #endif
 	bool m_isInList;
 };
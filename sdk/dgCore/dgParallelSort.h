@@ -0,0 +1,303 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __dgParallelSort__
+#define __dgParallelSort__
+
+#include "dgStdafx.h"
+#include "dgTypes.h"
+#include "dgThreadHive.h"
+
+#define DG_PARALLEL_SORT_MIN_ELEMENTS	256
+
+// multi threaded versions of dgSort and dgRadixSort.
+// the sort can be issued on a thread pool, or it can be called cooperatively from inside 
+// a kernel already running on all threads, in which case all threads must make the call 
+// with the same arguments and the call return after a synchronization point.
+// the merge sort is not stable across thread counts, the radix sort is always stable.
+template <class T>
+class dgParallelSort
+{
+	public:
+	typedef dgInt32 (*dgCompare) (const T* const A, const T* const B, void* const context);
+	typedef dgInt32 (*dgGetRadixKey) (const T* const A, void* const context);
+
+	dgParallelSort();
+
+	void Sort (dgThreadHive* const threadPool, T* const array, T* const tmpArray, dgInt32 elements, dgCompare compare, void* const context = NULL);
+	void RadixSort (dgThreadHive* const threadPool, T* const array, T* const tmpArray, dgInt32 elements, dgInt32 radixPass, dgGetRadixKey getRadixKey, void* const context = NULL);
+
+	void Sort (dThreadHiveSync& sync, dgInt32 threadID, dgInt32 threadCount, T* const array, T* const tmpArray, dgInt32 elements, dgCompare compare, void* const context = NULL);
+	void RadixSort (dThreadHiveSync& sync, dgInt32 threadID, dgInt32 threadCount, T* const array, T* const tmpArray, dgInt32 elements, dgInt32 radixPass, dgGetRadixKey getRadixKey, void* const context = NULL);
+
+	private:
+	static dgInt32 GetBlockStart (dgInt32 elements, dgInt32 threadCount, dgInt32 block);
+	static dgInt32 CoRank (dgInt32 k, const T* const A, dgInt32 countA, const T* const B, dgInt32 countB, dgCompare compare, void* const context);
+	static void MergeSlice (const T* const src, T* const dst, dgInt32 start, dgInt32 split, dgInt32 end, dgInt32 k0, dgInt32 k1, dgCompare compare, void* const context);
+	static void SortKernel (void* const context, void* const worldContext, dgInt32 threadID);
+	static void RadixSortKernel (void* const context, void* const worldContext, dgInt32 threadID);
+
+	dThreadHiveSync m_sync;
+	T* m_array;
+	T* m_tmpArray;
+	void* m_context;
+	dgCompare m_compare;
+	dgGetRadixKey m_getRadixKey;
+	dgInt32 m_elements;
+	dgInt32 m_radixPass;
+	dgInt32 m_threadCount;
+	dgInt32 m_histogram[DG_MAX_THREADS_HIVE_COUNT][256];
+};
+
+template <class T>
+dgParallelSort<T>::dgParallelSort()
+	:m_sync()
+	,m_array(NULL)
+	,m_tmpArray(NULL)
+	,m_context(NULL)
+	,m_compare(NULL)
+	,m_getRadixKey(NULL)
+	,m_elements(0)
+	,m_radixPass(0)
+	,m_threadCount(1)
+{
+}
+
+template <class T>
+DG_INLINE dgInt32 dgParallelSort<T>::GetBlockStart (dgInt32 elements, dgInt32 threadCount, dgInt32 block)
+{
+	return dgInt32 ((dgInt64 (elements) * block) / threadCount);
+}
+
+template <class T>
+void dgParallelSort<T>::Sort (dgThreadHive* const threadPool, T* const array, T* const tmpArray, dgInt32 elements, dgCompare compare, void* const context)
+{
+	const dgInt32 threadCount = threadPool->GetThreadCount();
+	if ((threadCount <= 1) || (elements < DG_PARALLEL_SORT_MIN_ELEMENTS)) {
+		dgSort (array, elements, compare, context);
+	} else {
+		m_array = array;
+		m_tmpArray = tmpArray;
+		m_context = context;
+		m_compare = compare;
+		m_elements = elements;
+		m_threadCount = threadCount;
+		m_sync.Reset(threadCount);
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			threadPool->QueueJob (SortKernel, this, NULL, "dgParallelSort::Sort");
+		}
+		threadPool->SynchronizationBarrier();
+	}
+}
+
+template <class T>
+void dgParallelSort<T>::RadixSort (dgThreadHive* const threadPool, T* const array, T* const tmpArray, dgInt32 elements, dgInt32 radixPass, dgGetRadixKey getRadixKey, void* const context)
+{
+	const dgInt32 threadCount = threadPool->GetThreadCount();
+	if ((threadCount <= 1) || (elements < DG_PARALLEL_SORT_MIN_ELEMENTS)) {
+		dgRadixSort (array, tmpArray, elements, radixPass, getRadixKey, context);
+	} else {
+		m_array = array;
+		m_tmpArray = tmpArray;
+		m_context = context;
+		m_getRadixKey = getRadixKey;
+		m_elements = elements;
+		m_radixPass = radixPass;
+		m_threadCount = threadCount;
+		m_sync.Reset(threadCount);
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			threadPool->QueueJob (RadixSortKernel, this, NULL, "dgParallelSort::RadixSort");
+		}
+		threadPool->SynchronizationBarrier();
+	}
+}
+
+template <class T>
+void dgParallelSort<T>::SortKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgParallelSort* const me = (dgParallelSort*) context;
+	me->Sort (me->m_sync, threadID, me->m_threadCount, me->m_array, me->m_tmpArray, me->m_elements, me->m_compare, me->m_context);
+}
+
+template <class T>
+void dgParallelSort<T>::RadixSortKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgParallelSort* const me = (dgParallelSort*) context;
+	me->RadixSort (me->m_sync, threadID, me->m_threadCount, me->m_array, me->m_tmpArray, me->m_elements, me->m_radixPass, me->m_getRadixKey, me->m_context);
+}
+
+// find how many elements of A are in the first k elements of the merge of A and B,
+// elements of A go first when the keys are equal
+template <class T>
+dgInt32 dgParallelSort<T>::CoRank (dgInt32 k, const T* const A, dgInt32 countA, const T* const B, dgInt32 countB, dgCompare compare, void* const context)
+{
+	dgInt32 i0 = dgMax (k - countB, 0);
+	dgInt32 i1 = dgMin (k, countA);
+	while (i0 < i1) {
+		const dgInt32 i = (i0 + i1 + 1) >> 1;
+		const dgInt32 j = k - i;
+		if ((j >= countB) || (compare (&B[j], &A[i - 1], context) >= 0)) {
+			i0 = i;
+		} else {
+			i1 = i - 1;
+		}
+	}
+	return i0;
+}
+
+// merge the output elements [k0, k1) of the two sorted runs [start, split) and [split, end)
+template <class T>
+void dgParallelSort<T>::MergeSlice (const T* const src, T* const dst, dgInt32 start, dgInt32 split, dgInt32 end, dgInt32 k0, dgInt32 k1, dgCompare compare, void* const context)
+{
+	const T* const A = &src[start];
+	const T* const B = &src[split];
+	const dgInt32 countA = split - start;
+	const dgInt32 countB = end - split;
+
+	dgInt32 i = CoRank (k0, A, countA, B, countB, compare, context);
+	dgInt32 j = k0 - i;
+	const dgInt32 i1 = CoRank (k1, A, countA, B, countB, compare, context);
+	const dgInt32 j1 = k1 - i1;
+
+	T* out = &dst[start + k0];
+	while ((i < i1) && (j < j1)) {
+		if (compare (&B[j], &A[i], context) < 0) {
+			*out = B[j];
+			j ++;
+		} else {
+			*out = A[i];
+			i ++;
+		}
+		out ++;
+	}
+	for (; i < i1; i ++) {
+		*out = A[i];
+		out ++;
+	}
+	for (; j < j1; j ++) {
+		*out = B[j];
+		out ++;
+	}
+}
+
+template <class T>
+void dgParallelSort<T>::Sort (dThreadHiveSync& sync, dgInt32 threadID, dgInt32 threadCount, T* const array, T* const tmpArray, dgInt32 elements, dgCompare compare, void* const context)
+{
+	if ((threadCount <= 1) || (elements < DG_PARALLEL_SORT_MIN_ELEMENTS)) {
+		if (!threadID) {
+			dgSort (array, elements, compare, context);
+		}
+		sync.Sync();
+		return;
+	}
+
+	// each thread sort its own block
+	const dgInt32 start = GetBlockStart (elements, threadCount, threadID);
+	const dgInt32 end = GetBlockStart (elements, threadCount, threadID + 1);
+	dgSort (&array[start], end - start, compare, context);
+	sync.Sync();
+
+	// merge pairs of sorted runs, on each pass every thread produce the same slice of the output 
+	// no matter which runs it comes from, so the work stays balanced.
+	T* src = array;
+	T* dst = tmpArray;
+	for (dgInt32 width = 1; width < threadCount; width *= 2) {
+		for (dgInt32 block = 0; block < threadCount; block += width * 2) {
+			const dgInt32 runStart = GetBlockStart (elements, threadCount, block);
+			const dgInt32 runSplit = GetBlockStart (elements, threadCount, dgMin (block + width, threadCount));
+			const dgInt32 runEnd = GetBlockStart (elements, threadCount, dgMin (block + width * 2, threadCount));
+			const dgInt32 k0 = dgMax (start, runStart);
+			const dgInt32 k1 = dgMin (end, runEnd);
+			if (k0 < k1) {
+				MergeSlice (src, dst, runStart, runSplit, runEnd, k0 - runStart, k1 - runStart, compare, context);
+			}
+		}
+		sync.Sync();
+		dgSwap (src, dst);
+	}
+
+	if (src != array) {
+		for (dgInt32 i = start; i < end; i ++) {
+			array[i] = src[i];
+		}
+		sync.Sync();
+	}
+}
+
+template <class T>
+void dgParallelSort<T>::RadixSort (dThreadHiveSync& sync, dgInt32 threadID, dgInt32 threadCount, T* const array, T* const tmpArray, dgInt32 elements, dgInt32 radixPass, dgGetRadixKey getRadixKey, void* const context)
+{
+	dgAssert (radixPass >= 1);
+	dgAssert (radixPass <= 4);
+	if ((threadCount <= 1) || (elements < DG_PARALLEL_SORT_MIN_ELEMENTS)) {
+		if (!threadID) {
+			dgRadixSort (array, tmpArray, elements, radixPass, getRadixKey, context);
+		}
+		sync.Sync();
+		return;
+	}
+
+	const dgInt32 start = GetBlockStart (elements, threadCount, threadID);
+	const dgInt32 end = GetBlockStart (elements, threadCount, threadID + 1);
+
+	T* src = array;
+	T* dst = tmpArray;
+	dgInt32* const histogram = m_histogram[threadID];
+	for (dgInt32 pass = 0; pass < radixPass; pass ++) {
+		const dgInt32 shift = pass * 8;
+		memset (histogram, 0, 256 * sizeof (dgInt32));
+		for (dgInt32 i = start; i < end; i ++) {
+			const dgInt32 key = (getRadixKey (&src[i], context) >> shift) & 0xff;
+			histogram[key] ++;
+		}
+		sync.Sync();
+
+		// a digit is scattered after all lower digits, and after the same digit from lower threads
+		dgInt32 scan[256];
+		dgInt32 sum = 0;
+		for (dgInt32 i = 0; i < 256; i ++) {
+			for (dgInt32 j = 0; j < threadCount; j ++) {
+				if (j == threadID) {
+					scan[i] = sum;
+				}
+				sum += m_histogram[j][i];
+			}
+		}
+		dgAssert (sum == elements);
+
+		for (dgInt32 i = start; i < end; i ++) {
+			const dgInt32 key = (getRadixKey (&src[i], context) >> shift) & 0xff;
+			dst[scan[key]] = src[i];
+			scan[key] ++;
+		}
+		sync.Sync();
+		dgSwap (src, dst);
+	}
+
+	if (src != array) {
+		for (dgInt32 i = start; i < end; i ++) {
+			array[i] = src[i];
+		}
+		sync.Sync();
+	}
+}
+
+#endif
@@ -146,7 +146,7 @@ class dgVertexCollapseVertexMetric
 
 
 dgPolyhedra::dgPolyhedra (dgMemoryAllocator* const allocator)
-	:dgTree <dgEdge, dgInt64>(allocator)
+	:dgHashMap <dgEdge, dgInt64>(allocator)
 	,m_baseMark(0)
 	,m_edgeMark(0)
 	,m_faceSecuence(0)
@@ -154,16 +154,35 @@ dgPolyhedra::dgPolyhedra (dgMemoryAllocator* const allocator)
 }
 
 dgPolyhedra::dgPolyhedra (const dgPolyhedra &polyhedra)
-	:dgTree <dgEdge, dgInt64>(polyhedra.GetAllocator())
+	:dgHashMap <dgEdge, dgInt64>(polyhedra.GetAllocator())
 	,m_baseMark(0)
 	,m_edgeMark(0)
 	,m_faceSecuence(0)
+{
+	CopyFaces (polyhedra);
+}
+
+dgPolyhedra::dgPolyhedra (dgMemoryAllocator* const allocator, const dgPolyhedra &polyhedra)
+	:dgHashMap <dgEdge, dgInt64>(allocator)
+	,m_baseMark(0)
+	,m_edgeMark(0)
+	,m_faceSecuence(0)
+{
+	CopyFaces (polyhedra);
+}
+
+dgPolyhedra::~dgPolyhedra ()
+{
+}
+
+void dgPolyhedra::CopyFaces (const dgPolyhedra &polyhedra)
 {
 	dgStack<dgInt32> indexPool (DG_LOCAL_BUFFER_SIZE * 16);
 	dgStack<dgUnsigned64> userPool (DG_LOCAL_BUFFER_SIZE * 16);
 	dgInt32* const index = &indexPool[0];
 	dgUnsigned64* const user = &userPool[0];
 
+	Reserve (polyhedra.GetCount());
 	BeginFace ();
 	Iterator iter(polyhedra);
 	for (iter.Begin(); iter; iter ++) {
@@ -199,10 +218,6 @@ dgPolyhedra::dgPolyhedra (const dgPolyhedra &polyhedra)
 #endif
 }
 
-dgPolyhedra::~dgPolyhedra ()
-{
-}
-
 
 dgInt32 dgPolyhedra::GetFaceCount() const
 {
@@ -2154,7 +2169,7 @@ dgFloat64 dgPolyhedra::EdgePenalty (const dgBigVector* const pool, dgEdge* const
 }
 
 
-bool dgPolyhedra::Optimize (const dgFloat64* const array, dgInt32 strideInBytes, dgReportProgress normalizedProgress, void* const reportProgressUserData, dgFloat64 tol, dgInt32 maxFaceCount)
+bool dgPolyhedra::Optimize (const dgFloat64* const array, dgInt32 strideInBytes, dgReportProgress normalizedProgress, void* const reportProgressUserData, dgFloat64 tol, dgInt32 maxFaceCount, const dgInt8* const lockedVertex)
 {
 	dgInt32 stride = dgInt32 (strideInBytes / sizeof (dgFloat64));
 
@@ -2214,15 +2229,32 @@ bool dgPolyhedra::Optimize (const dgFloat64* const array, dgInt32 strideInBytes,
 		bigHeapArray.Pop();
 		edgeHandleList.Remove (handleNodePtr);
 
+		if (edge && lockedVertex) {
+			// collapsing the edge removes its incident vertex. locked vertices can be shared with faces 
+			// that are not in this mesh, so they can not be connected by an edge that is not there already
+			const dgInt32 v1 = edge->m_twin->m_incidentVertex;
+			bool isLocked = lockedVertex[edge->m_incidentVertex] ? true : false;
+			if (!isLocked && lockedVertex[v1]) {
+				dgEdge* ptr = edge->m_twin->m_next;
+				do {
+					const dgInt32 v = ptr->m_twin->m_incidentVertex;
+					isLocked |= (lockedVertex[v] && !FindEdge (v1, v));
+					ptr = ptr->m_twin->m_next;
+				} while (!isLocked && (ptr != edge));
+			}
+			if (isLocked) {
+				edge = NULL;
+			}
+		}
+
 		if (edge) {
 			if (IsOkToCollapse (&vertexPool[0], edge)) {
 
+				dgInt32 collapsedFaces = ((edge->m_incidentFace >= 0) ? 1 : 0) + ((edge->m_twin->m_incidentFace >= 0) ? 1 : 0);
 				if (normalizedProgress) {
-				interPasses ++;
-				faceCount -= 2;
-				if (interPasses >= 400) {
-					interPasses = 0;
-					faceCount = GetFaceCount();
+					interPasses ++;
+					if (interPasses >= 400) {
+						interPasses = 0;
 						progress = normalizedProgress(dgFloat32 (1.0f) - GetEdgeCount() * progressDen, reportProgressUserData);
 					}
 				}
@@ -2247,6 +2279,7 @@ bool dgPolyhedra::Optimize (const dgFloat64* const array, dgInt32 strideInBytes,
 				dgAssert (SanityCheck ());
 #endif
 				if (edge) {
+					faceCount -= collapsedFaces;
 					// Update vertex metrics
 					CalculateVertexMetrics (&vertexMetrics[0], &vertexPool[0], edge);
 
@@ -2379,10 +2412,12 @@ bool dgPolyhedra::PolygonizeFace(dgEdge* const face, const dgFloat64* const pool
 {
 	dgPolyhedra flatFace(GetAllocator());
 	dgEdge* array[DG_LOCAL_BUFFER_SIZE];
+	dgEdge* faceEdges[DG_LOCAL_BUFFER_SIZE];
 
 	dgInt32 count = 0;		
 	dgEdge* edge = face;
 	do {
+		faceEdges[count] = edge;
 		dgEdge* const perimeter = flatFace.AddHalfEdge (edge->m_incidentVertex, edge->m_twin->m_incidentVertex);
 		dgAssert (perimeter);
 		perimeter->m_userData = edge->m_userData;
@@ -2554,14 +2589,19 @@ bool dgPolyhedra::PolygonizeFace(dgEdge* const face, const dgFloat64* const pool
 				edge1->m_mark = mark;
 				edge1->m_twin->m_mark = mark;
 				if (!FindEdge(edge1->m_incidentVertex, edge1->m_twin->m_incidentVertex)) {
-					dgPairKey key0 (edge1->m_incidentVertex, 0);
-					dgPairKey key1 (edge1->m_twin->m_incidentVertex, 0);
-					dgTreeNode* const node0 = FindGreater (key0.GetVal());
-					dgTreeNode* const node1 = FindGreater (key1.GetVal());
-					dgAssert (node0);
-					dgAssert (node1);
-					dgEdge* e0 = &node0->GetInfo();
-					dgEdge* e1 = &node1->GetInfo();
+					// the edges of the original face are still edges leaving these vertices
+					dgEdge* e0 = NULL;
+					dgEdge* e1 = NULL;
+					for (dgInt32 j = 0; j < count; j ++) {
+						if (faceEdges[j]->m_incidentVertex == edge1->m_incidentVertex) {
+							e0 = faceEdges[j];
+						}
+						if (faceEdges[j]->m_incidentVertex == edge1->m_twin->m_incidentVertex) {
+							e1 = faceEdges[j];
+						}
+					}
+					dgAssert (e0);
+					dgAssert (e1);
 
 					dgBigVector p0 (&pool[e0->m_incidentVertex * stride]);
 					dgBigVector p1 (&pool[e1->m_incidentVertex * stride]);
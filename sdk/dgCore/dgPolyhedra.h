@@ -25,6 +25,7 @@
 #include "dgStdafx.h"
 #include "dgList.h"
 #include "dgTree.h"
+#include "dgHashMap.h"
 #include "dgHeap.h"
 #include "dgDebug.h"
 
@@ -59,7 +60,7 @@ class dgEdge
 } DG_GCC_VECTOR_ALIGMENT;
 
 
-class dgPolyhedra: public dgTree <dgEdge, dgEdgeKey>
+class dgPolyhedra: public dgHashMap <dgEdge, dgEdgeKey>
 {
 	public:
 	class dgPairKey
@@ -118,6 +119,7 @@ class dgPolyhedra: public dgTree <dgEdge, dgEdgeKey>
 
 	dgPolyhedra (dgMemoryAllocator* const allocator);
 	dgPolyhedra (const dgPolyhedra &polyhedra);
+	dgPolyhedra (dgMemoryAllocator* const allocator, const dgPolyhedra &polyhedra);
 	virtual ~dgPolyhedra();
 
 	virtual void BeginFace();
@@ -156,7 +158,8 @@ class dgPolyhedra: public dgTree <dgEdge, dgEdgeKey>
 	void ChangeEdgeIncidentVertex (dgEdge* const edge, dgInt32 newIndex);	
 	void DeleteDegenerateFaces (const dgFloat64* const pool, dgInt32 dstStrideInBytes, dgFloat64 minArea);
 
-	bool Optimize (const dgFloat64* const pool, dgInt32 strideInBytes, dgReportProgress normalizedProgress, void* const reportProgressUserData, dgFloat64 tol, dgInt32 maxFaceCount = 1<<28);
+	// collapse edges by quadric error, lockedVertex is an optional mask of vertices that must not be removed
+	bool Optimize (const dgFloat64* const pool, dgInt32 strideInBytes, dgReportProgress normalizedProgress, void* const reportProgressUserData, dgFloat64 tol, dgInt32 maxFaceCount = 1<<28, const dgInt8* const lockedVertex = NULL);
 	void Triangulate (const dgFloat64* const vertex, dgInt32 strideInBytes, dgPolyhedra* const leftOversOut);
 	void ConvexPartition (const dgFloat64* const vertex, dgInt32 strideInBytes, dgPolyhedra* const leftOversOut);
 	dgEdge* CollapseEdge(dgEdge* const edge);
@@ -164,6 +167,7 @@ class dgPolyhedra: public dgTree <dgEdge, dgEdgeKey>
 	bool TriangulateFace (dgEdge* const face, const dgFloat64* const pool, dgInt32 stride);
 
 	private:
+	void CopyFaces (const dgPolyhedra &polyhedra);
 	void RefineTriangulation (const dgFloat64* const vertex, dgInt32 stride);
 	void RefineTriangulation (const dgFloat64* const vertex, dgInt32 stride, const dgBigVector& normal, dgInt32 perimeterCount, dgEdge** const perimeter);
 	void OptimizeTriangulation (const dgFloat64* const vertex, dgInt32 strideInBytes);
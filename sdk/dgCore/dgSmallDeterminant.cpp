@@ -151,3 +151,310 @@ dgGoogol Determinant4x4 (const dgGoogol matrix[4][4])
 }
 
 
+
+
+// error bounds for the double evaluation of the 3x3 and 4x4 determinants of coordinates differences, 
+// in units of the permanent (the determinant evaluated with the absolute values of all products)
+#define DG_PREDICATE_EPSILON		(dgFloat64 (1.1102230246251565e-16))
+#define DG_PREDICATE_SPLITTER		(dgFloat64 (134217729.0))
+#define DG_ORIENTATION_3D_ERROR		((dgFloat64 (7.0f) + dgFloat64 (56.0f) * DG_PREDICATE_EPSILON) * DG_PREDICATE_EPSILON)
+#define DG_ORIENTATION_4D_ERROR		((dgFloat64 (16.0f) + dgFloat64 (256.0f) * DG_PREDICATE_EPSILON) * DG_PREDICATE_EPSILON)
+
+// floating point expansions, a number is represented as an unevaluated sum of non overlapping doubles 
+// sorted by increasing magnitude, the last component has the sign of the whole expansion.
+// Jonathan Richard Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates"
+DG_INLINE static void dgTwoSum (dgFloat64 a, dgFloat64 b, dgFloat64& x, dgFloat64& y)
+{
+	x = a + b;
+	dgFloat64 bvirt = x - a;
+	dgFloat64 avirt = x - bvirt;
+	dgFloat64 bround = b - bvirt;
+	dgFloat64 around = a - avirt;
+	y = around + bround;
+}
+
+DG_INLINE static void dgFastTwoSum (dgFloat64 a, dgFloat64 b, dgFloat64& x, dgFloat64& y)
+{
+	x = a + b;
+	dgFloat64 bvirt = x - a;
+	y = b - bvirt;
+}
+
+DG_INLINE static void dgSplit (dgFloat64 a, dgFloat64& high, dgFloat64& low)
+{
+	dgFloat64 c = DG_PREDICATE_SPLITTER * a;
+	dgFloat64 big = c - a;
+	high = c - big;
+	low = a - high;
+}
+
+DG_INLINE static void dgTwoProduct (dgFloat64 a, dgFloat64 b, dgFloat64 bHigh, dgFloat64 bLow, dgFloat64& x, dgFloat64& y)
+{
+	dgFloat64 aHigh;
+	dgFloat64 aLow;
+	x = a * b;
+	dgSplit (a, aHigh, aLow);
+	dgFloat64 err1 = x - (aHigh * bHigh);
+	dgFloat64 err2 = err1 - (aLow * bHigh);
+	dgFloat64 err3 = err2 - (aHigh * bLow);
+	y = (aLow * bLow) - err3;
+}
+
+static dgInt32 dgExpansionSum (dgInt32 elen, const dgFloat64* const e, dgInt32 flen, const dgFloat64* const f, dgFloat64* const h)
+{
+	dgFloat64 q;
+	dgFloat64 qNew;
+	dgFloat64 hh;
+	dgInt32 eindex = 0;
+	dgInt32 findex = 0;
+	dgInt32 hindex = 0;
+	dgFloat64 enow = e[0];
+	dgFloat64 fnow = f[0];
+	if ((fnow > enow) == (fnow > -enow)) {
+		q = enow;
+		eindex ++;
+		enow = (eindex < elen) ? e[eindex] : dgFloat64 (0.0f);
+	} else {
+		q = fnow;
+		findex ++;
+		fnow = (findex < flen) ? f[findex] : dgFloat64 (0.0f);
+	}
+
+	if ((eindex < elen) && (findex < flen)) {
+		if ((fnow > enow) == (fnow > -enow)) {
+			dgFastTwoSum (enow, q, qNew, hh);
+			eindex ++;
+			enow = (eindex < elen) ? e[eindex] : dgFloat64 (0.0f);
+		} else {
+			dgFastTwoSum (fnow, q, qNew, hh);
+			findex ++;
+			fnow = (findex < flen) ? f[findex] : dgFloat64 (0.0f);
+		}
+		q = qNew;
+		if (hh != dgFloat64 (0.0f)) {
+			h[hindex ++] = hh;
+		}
+		while ((eindex < elen) && (findex < flen)) {
+			if ((fnow > enow) == (fnow > -enow)) {
+				dgTwoSum (q, enow, qNew, hh);
+				eindex ++;
+				enow = (eindex < elen) ? e[eindex] : dgFloat64 (0.0f);
+			} else {
+				dgTwoSum (q, fnow, qNew, hh);
+				findex ++;
+				fnow = (findex < flen) ? f[findex] : dgFloat64 (0.0f);
+			}
+			q = qNew;
+			if (hh != dgFloat64 (0.0f)) {
+				h[hindex ++] = hh;
+			}
+		}
+	}
+
+	for (; eindex < elen; eindex ++) {
+		dgTwoSum (q, e[eindex], qNew, hh);
+		q = qNew;
+		if (hh != dgFloat64 (0.0f)) {
+			h[hindex ++] = hh;
+		}
+	}
+	for (; findex < flen; findex ++) {
+		dgTwoSum (q, f[findex], qNew, hh);
+		q = qNew;
+		if (hh != dgFloat64 (0.0f)) {
+			h[hindex ++] = hh;
+		}
+	}
+	if ((q != dgFloat64 (0.0f)) || (hindex == 0)) {
+		h[hindex ++] = q;
+	}
+	return hindex;
+}
+
+static dgInt32 dgExpansionScale (dgInt32 elen, const dgFloat64* const e, dgFloat64 b, dgFloat64* const h)
+{
+	dgFloat64 q;
+	dgFloat64 hh;
+	dgFloat64 bHigh;
+	dgFloat64 bLow;
+	dgSplit (b, bHigh, bLow);
+	dgTwoProduct (e[0], b, bHigh, bLow, q, hh);
+
+	dgInt32 hindex = 0;
+	if (hh != dgFloat64 (0.0f)) {
+		h[hindex ++] = hh;
+	}
+	for (dgInt32 i = 1; i < elen; i ++) {
+		dgFloat64 sum;
+		dgFloat64 product0;
+		dgFloat64 product1;
+		dgTwoProduct (e[i], b, bHigh, bLow, product1, product0);
+		dgTwoSum (q, product0, sum, hh);
+		if (hh != dgFloat64 (0.0f)) {
+			h[hindex ++] = hh;
+		}
+		dgFastTwoSum (product1, sum, q, hh);
+		if (hh != dgFloat64 (0.0f)) {
+			h[hindex ++] = hh;
+		}
+	}
+	if ((q != dgFloat64 (0.0f)) || (hindex == 0)) {
+		h[hindex ++] = q;
+	}
+	return hindex;
+}
+
+// exact value of the 2x2 minor a0 * b1 - a1 * b0, at most 4 components
+static dgInt32 dgExpansionMinor (dgFloat64 a0, dgFloat64 a1, dgFloat64 b0, dgFloat64 b1, dgFloat64* const h)
+{
+	dgFloat64 high;
+	dgFloat64 low;
+	dgFloat64 product0[2];
+	dgFloat64 product1[2];
+	dgSplit (b1, high, low);
+	dgTwoProduct (a0, b1, high, low, product0[1], product0[0]);
+	dgSplit (b0, high, low);
+	dgTwoProduct (-a1, b0, high, low, product1[1], product1[0]);
+	return dgExpansionSum (2, product0, 2, product1, h);
+}
+
+// exact value of the triple product a.(b x c), at most 24 components
+static dgInt32 dgExpansionTripleProduct (const dgBigVector& a, const dgBigVector& b, const dgBigVector& c, dgFloat64* const h)
+{
+	dgFloat64 minor[4];
+	dgFloat64 x[8];
+	dgFloat64 y[8];
+	dgFloat64 z[8];
+	dgFloat64 xy[16];
+
+	dgInt32 count = dgExpansionMinor (b.m_y, b.m_z, c.m_y, c.m_z, minor);
+	dgInt32 xCount = dgExpansionScale (count, minor, a.m_x, x);
+	count = dgExpansionMinor (b.m_z, b.m_x, c.m_z, c.m_x, minor);
+	dgInt32 yCount = dgExpansionScale (count, minor, a.m_y, y);
+	count = dgExpansionMinor (b.m_x, b.m_y, c.m_x, c.m_y, minor);
+	dgInt32 zCount = dgExpansionScale (count, minor, a.m_z, z);
+
+	dgInt32 xyCount = dgExpansionSum (xCount, x, yCount, y, xy);
+	return dgExpansionSum (xyCount, xy, zCount, z, h);
+}
+
+// returns the difference a - b, and the round off error in tail 
+DG_INLINE static dgBigVector dgTwoDiff (const dgBigVector& a, const dgBigVector& b, dgBigVector& tail)
+{
+	dgBigVector x (a - b);
+	dgBigVector bvirt (a - x);
+	dgBigVector avirt (x + bvirt);
+	dgBigVector bround (bvirt - b);
+	dgBigVector around (a - avirt);
+	tail = around + bround;
+	return x;
+}
+
+DG_INLINE static dgBigVector dgCrossPermanent (const dgBigVector& b, const dgBigVector& c)
+{
+	const dgBigVector absB (b.Abs());
+	const dgBigVector absC (c.Abs());
+	return absB.ShiftTripleLeft() * absC.ShiftTripleRight() + absB.ShiftTripleRight() * absC.ShiftTripleLeft();
+}
+
+DG_INLINE static dgBigVector dgCrossProduct (const dgBigVector& b, const dgBigVector& c)
+{
+	return b.ShiftTripleLeft() * c.ShiftTripleRight() - b.ShiftTripleRight() * c.ShiftTripleLeft();
+}
+
+dgFloat64 dgOrientation3d (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3)
+{
+	dgBigVector tail0;
+	dgBigVector tail1;
+	dgBigVector tail2;
+	const dgBigVector a (dgTwoDiff (p1, p0, tail0));
+	const dgBigVector b (dgTwoDiff (p2, p0, tail1));
+	const dgBigVector c (dgTwoDiff (p3, p0, tail2));
+
+	// Determinant3x3 returns -a.(b x c)
+	const dgFloat64 det = -a.DotProduct3(dgCrossProduct (b, c));
+	const dgFloat64 permanent = a.Abs().DotProduct3(dgCrossPermanent (b, c));
+	if (fabs (det) > DG_ORIENTATION_3D_ERROR * permanent) {
+		return det;
+	}
+
+	const dgBigVector tail (tail0.Abs() + tail1.Abs() + tail2.Abs());
+	if ((tail.m_x == dgFloat64 (0.0f)) && (tail.m_y == dgFloat64 (0.0f)) && (tail.m_z == dgFloat64 (0.0f))) {
+		dgFloat64 expansion[24];
+		dgInt32 count = dgExpansionTripleProduct (a, b, c, expansion);
+		return -expansion[count - 1];
+	}
+
+	dgGoogol exactMatrix[3][3];
+	for (dgInt32 i = 0; i < 3; i ++) {
+		exactMatrix[0][i] = dgGoogol(p1[i]) - dgGoogol(p0[i]);
+		exactMatrix[1][i] = dgGoogol(p2[i]) - dgGoogol(p0[i]);
+		exactMatrix[2][i] = dgGoogol(p3[i]) - dgGoogol(p0[i]);
+	}
+	return Determinant3x3(exactMatrix);
+}
+
+dgFloat64 dgOrientation4d (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3, const dgBigVector& p4)
+{
+	dgBigVector tail0;
+	dgBigVector tail1;
+	dgBigVector tail2;
+	dgBigVector tail3;
+	const dgBigVector a (dgTwoDiff (p1, p0, tail0));
+	const dgBigVector b (dgTwoDiff (p2, p0, tail1));
+	const dgBigVector c (dgTwoDiff (p3, p0, tail2));
+	const dgBigVector d (dgTwoDiff (p4, p0, tail3));
+
+	// cofactor expansion along the w column
+	const dgBigVector cd (dgCrossProduct (c, d));
+	const dgBigVector bd (dgCrossProduct (b, d));
+	const dgBigVector bc (dgCrossProduct (b, c));
+	const dgFloat64 det0 = b.DotProduct3(cd);
+	const dgFloat64 det1 = a.DotProduct3(cd);
+	const dgFloat64 det2 = a.DotProduct3(bd);
+	const dgFloat64 det3 = a.DotProduct3(bc);
+	const dgFloat64 det = d.m_w * det3 - c.m_w * det2 + b.m_w * det1 - a.m_w * det0;
+
+	const dgBigVector absA (a.Abs());
+	const dgBigVector absB (b.Abs());
+	const dgBigVector cdPermanent (dgCrossPermanent (c, d));
+	const dgFloat64 permanent0 = absB.DotProduct3(cdPermanent);
+	const dgFloat64 permanent1 = absA.DotProduct3(cdPermanent);
+	const dgFloat64 permanent2 = absA.DotProduct3(dgCrossPermanent (b, d));
+	const dgFloat64 permanent3 = absA.DotProduct3(dgCrossPermanent (b, c));
+	const dgFloat64 permanent = fabs (d.m_w) * permanent3 + fabs (c.m_w) * permanent2 + fabs (b.m_w) * permanent1 + fabs (a.m_w) * permanent0;
+	if (fabs (det) > DG_ORIENTATION_4D_ERROR * permanent) {
+		return det;
+	}
+
+	const dgBigVector tail (tail0.Abs() + tail1.Abs() + tail2.Abs() + tail3.Abs());
+	if ((tail.m_x == dgFloat64 (0.0f)) && (tail.m_y == dgFloat64 (0.0f)) && (tail.m_z == dgFloat64 (0.0f)) && (tail.m_w == dgFloat64 (0.0f))) {
+		dgFloat64 tripleProduct[24];
+		dgFloat64 term[4][48];
+		dgFloat64 sum0[96];
+		dgFloat64 sum1[96];
+		dgFloat64 expansion[192];
+		dgInt32 count = dgExpansionTripleProduct (b, c, d, tripleProduct);
+		dgInt32 count0 = dgExpansionScale (count, tripleProduct, -a.m_w, term[0]);
+		count = dgExpansionTripleProduct (a, c, d, tripleProduct);
+		dgInt32 count1 = dgExpansionScale (count, tripleProduct, b.m_w, term[1]);
+		count = dgExpansionTripleProduct (a, b, d, tripleProduct);
+		dgInt32 count2 = dgExpansionScale (count, tripleProduct, -c.m_w, term[2]);
+		count = dgExpansionTripleProduct (a, b, c, tripleProduct);
+		dgInt32 count3 = dgExpansionScale (count, tripleProduct, d.m_w, term[3]);
+
+		count0 = dgExpansionSum (count0, term[0], count1, term[1], sum0);
+		count2 = dgExpansionSum (count2, term[2], count3, term[3], sum1);
+		count = dgExpansionSum (count0, sum0, count2, sum1, expansion);
+		return expansion[count - 1];
+	}
+
+	dgGoogol exactMatrix[4][4];
+	for (dgInt32 i = 0; i < 4; i ++) {
+		exactMatrix[0][i] = dgGoogol(p1[i]) - dgGoogol(p0[i]);
+		exactMatrix[1][i] = dgGoogol(p2[i]) - dgGoogol(p0[i]);
+		exactMatrix[2][i] = dgGoogol(p3[i]) - dgGoogol(p0[i]);
+		exactMatrix[3][i] = dgGoogol(p4[i]) - dgGoogol(p0[i]);
+	}
+	return Determinant4x4(exactMatrix);
+}
@@ -25,6 +25,7 @@
 #include "dgStdafx.h"
 
 class dgGoogol;
+class dgBigVector;
 dgFloat64 Determinant2x2 (const dgFloat64 matrix[2][2], dgFloat64* const error);
 dgFloat64 Determinant3x3 (const dgFloat64 matrix[3][3], dgFloat64* const error);
 dgFloat64 Determinant4x4 (const dgFloat64 matrix[4][4], dgFloat64* const error);
@@ -34,4 +35,12 @@ dgGoogol Determinant2x2 (const dgGoogol matrix[2][2]);
 dgGoogol Determinant3x3 (const dgGoogol matrix[3][3]);
 dgGoogol Determinant4x4 (const dgGoogol matrix[4][4]);
 
+// adaptive precision orientation tests, the value returned always has the exact sign of the determinant of the 
+// differences (p1 - p0, p2 - p0, ...), with the same sign convention as Determinant3x3 and Determinant4x4.
+// the determinant is evaluated in double with a forward error bound, if the sign can not be certified 
+// it is recalculated exactly with floating point expansions, and only when the differences themselves 
+// can not be represented in double the test falls back to dgGoogol arithmetic.
+dgFloat64 dgOrientation3d (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3);
+dgFloat64 dgOrientation4d (const dgBigVector& p0, const dgBigVector& p1, const dgBigVector& p2, const dgBigVector& p3, const dgBigVector& p4);
+
 #endif
@@ -0,0 +1,533 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgStdafx.h"
+#include "dgDebug.h"
+#include "dgSparseLDLt.h"
+
+#define DG_SPARSE_LDLT_PIVOT_TOL	dgFloat64 (1.0e-7f)
+#define DG_SPARSE_LDLT_REGULARIZER_TOL	dgFloat64 (1.0e-5f)
+#define DG_SPARSE_LDLT_REGULARIZER_PASSES	16
+
+
+dgSparseLDLt::dgSparseLDLt(dgMemoryAllocator* const allocator)
+	:m_entries(allocator)
+	,m_columnStart(allocator)
+	,m_rowIndex(allocator)
+	,m_values(allocator)
+	,m_diagonalIndex(allocator)
+	,m_patternColumnStart(allocator)
+	,m_patternRowIndex(allocator)
+	,m_permutation(allocator)
+	,m_inversePermutation(allocator)
+	,m_parent(allocator)
+	,m_factorColumnStart(allocator)
+	,m_factorColumnCount(allocator)
+	,m_factorRowIndex(allocator)
+	,m_factorValues(allocator)
+	,m_diagonal(allocator)
+	,m_graphPool(allocator)
+	,m_workBuffer(allocator)
+	,m_workValues(allocator)
+	,m_size(0)
+	,m_entriesCount(0)
+	,m_nonZeroCount(0)
+	,m_patternSize(0)
+	,m_patternNonZeroCount(0)
+	,m_factorNonZeroCount(0)
+{
+}
+
+dgSparseLDLt::~dgSparseLDLt()
+{
+}
+
+dgInt32 dgSparseLDLt::CompareEntries (const dgEntry* const entryA, const dgEntry* const entryB, void* const context)
+{
+	if (entryA->m_column < entryB->m_column) {
+		return -1;
+	} else if (entryA->m_column > entryB->m_column) {
+		return 1;
+	} else if (entryA->m_row < entryB->m_row) {
+		return -1;
+	} else if (entryA->m_row > entryB->m_row) {
+		return 1;
+	}
+	return 0;
+}
+
+void dgSparseLDLt::BeginMatrix (dgInt32 size)
+{
+	m_size = size;
+	m_entriesCount = 0;
+	m_nonZeroCount = 0;
+}
+
+void dgSparseLDLt::AddEntry (dgInt32 row, dgInt32 column, dgFloat32 value)
+{
+	dgAssert (row >= column);
+	dgAssert (row < m_size);
+	dgAssert (column >= 0);
+	dgEntry& entry = m_entries[m_entriesCount];
+	entry.m_row = row;
+	entry.m_column = column;
+	entry.m_value = value;
+	m_entriesCount ++;
+}
+
+void dgSparseLDLt::EndMatrix ()
+{
+	const dgInt32 size = m_size;
+	dgEntry* const entries = m_entriesCount ? &m_entries[0] : NULL;
+	if (m_entriesCount) {
+		dgSort (entries, m_entriesCount, CompareEntries);
+	}
+
+	// merge duplicated entries
+	dgInt32 uniqueCount = 0;
+	for (dgInt32 i = 0; i < m_entriesCount; i ++) {
+		if (uniqueCount && (entries[uniqueCount - 1].m_row == entries[i].m_row) && (entries[uniqueCount - 1].m_column == entries[i].m_column)) {
+			entries[uniqueCount - 1].m_value += entries[i].m_value;
+		} else {
+			entries[uniqueCount] = entries[i];
+			uniqueCount ++;
+		}
+	}
+	m_entriesCount = uniqueCount;
+
+	// count the entries of each column, every column always has a diagonal
+	m_columnStart.ResizeIfNecessary (size + 1);
+	m_diagonalIndex.ResizeIfNecessary (size);
+	m_workBuffer.ResizeIfNecessary (size);
+	dgInt32* const columnStart = &m_columnStart[0];
+	dgInt32* const diagonalIndex = &m_diagonalIndex[0];
+	dgInt32* const position = &m_workBuffer[0];
+	for (dgInt32 i = 0; i < size; i ++) {
+		position[i] = 1;
+	}
+	for (dgInt32 i = 0; i < m_entriesCount; i ++) {
+		const dgEntry& entry = entries[i];
+		if (entry.m_row != entry.m_column) {
+			position[entry.m_row] ++;
+			position[entry.m_column] ++;
+		}
+	}
+
+	dgInt32 acc = 0;
+	for (dgInt32 i = 0; i < size; i ++) {
+		columnStart[i] = acc;
+		acc += position[i];
+	}
+	columnStart[size] = acc;
+	m_nonZeroCount = acc;
+
+	m_rowIndex.ResizeIfNecessary (m_nonZeroCount);
+	m_values.ResizeIfNecessary (m_nonZeroCount);
+	dgInt32* const rowIndex = &m_rowIndex[0];
+	dgFloat64* const values = &m_values[0];
+	for (dgInt32 i = 0; i < size; i ++) {
+		const dgInt32 index = columnStart[i];
+		rowIndex[index] = i;
+		values[index] = dgFloat64 (0.0f);
+		diagonalIndex[i] = index;
+		position[i] = index + 1;
+	}
+
+	for (dgInt32 i = 0; i < m_entriesCount; i ++) {
+		const dgEntry& entry = entries[i];
+		const dgInt32 row = entry.m_row;
+		const dgInt32 column = entry.m_column;
+		if (row == column) {
+			values[diagonalIndex[row]] += entry.m_value;
+		} else {
+			const dgInt32 index0 = position[column];
+			rowIndex[index0] = row;
+			values[index0] = entry.m_value;
+			position[column] ++;
+
+			const dgInt32 index1 = position[row];
+			rowIndex[index1] = column;
+			values[index1] = entry.m_value;
+			position[row] ++;
+		}
+	}
+
+	// the ordering and the symbolic factorization only depend of the non zero pattern,
+	// most frames the pattern is identical to the previous frame, so they can be reused.
+	bool samePattern = (m_patternSize == size) && (m_patternNonZeroCount == m_nonZeroCount);
+	if (samePattern) {
+		samePattern = !memcmp (&m_patternColumnStart[0], columnStart, (size + 1) * sizeof (dgInt32)) && !memcmp (&m_patternRowIndex[0], rowIndex, m_nonZeroCount * sizeof (dgInt32));
+	}
+
+	if (!samePattern) {
+		m_patternSize = size;
+		m_patternNonZeroCount = m_nonZeroCount;
+		m_patternColumnStart.ResizeIfNecessary (size + 1);
+		m_patternRowIndex.ResizeIfNecessary (m_nonZeroCount);
+		memcpy (&m_patternColumnStart[0], columnStart, (size + 1) * sizeof (dgInt32));
+		memcpy (&m_patternRowIndex[0], rowIndex, m_nonZeroCount * sizeof (dgInt32));
+
+		MinimumDegreeOrdering();
+		SymbolicFactorization();
+	}
+}
+
+void dgSparseLDLt::MinimumDegreeOrdering()
+{
+	// minimum degree ordering using an explicit elimination graph,
+	// the neighbors of the eliminated row become a clique.
+	const dgInt32 size = m_size;
+	const dgInt32* const columnStart = &m_columnStart[0];
+	const dgInt32* const rowIndex = &m_rowIndex[0];
+
+	m_permutation.ResizeIfNecessary (size);
+	m_inversePermutation.ResizeIfNecessary (size);
+	m_workBuffer.ResizeIfNecessary (size * 7);
+	dgInt32* const permutation = &m_permutation[0];
+	dgInt32* const inversePermutation = &m_inversePermutation[0];
+	dgInt32* const listStart = &m_workBuffer[0];
+	dgInt32* const listCount = &listStart[size];
+	dgInt32* const listCapacity = &listCount[size];
+	dgInt32* const degreeHead = &listCapacity[size];
+	dgInt32* const degreeNext = &degreeHead[size];
+	dgInt32* const degreePrev = &degreeNext[size];
+	dgInt32* const mark = &degreePrev[size];
+
+	dgInt32 poolSize = 0;
+	for (dgInt32 i = 0; i < size; i ++) {
+		const dgInt32 count = columnStart[i + 1] - columnStart[i] - 1;
+		listStart[i] = poolSize;
+		listCount[i] = count;
+		listCapacity[i] = count * 2 + 4;
+		poolSize += listCapacity[i];
+		degreeHead[i] = -1;
+		mark[i] = 0;
+	}
+
+	m_graphPool.ResizeIfNecessary (poolSize);
+	dgInt32* pool = &m_graphPool[0];
+	for (dgInt32 i = 0; i < size; i ++) {
+		dgInt32 index = listStart[i];
+		for (dgInt32 j = columnStart[i]; j < columnStart[i + 1]; j ++) {
+			if (rowIndex[j] != i) {
+				pool[index] = rowIndex[j];
+				index ++;
+			}
+		}
+	}
+
+	// insert in reverse order so that rows of equal degree are eliminated in their natural order
+	for (dgInt32 i = size - 1; i >= 0; i --) {
+		const dgInt32 degree = listCount[i];
+		degreePrev[i] = -1;
+		degreeNext[i] = degreeHead[degree];
+		if (degreeHead[degree] >= 0) {
+			degreePrev[degreeHead[degree]] = i;
+		}
+		degreeHead[degree] = i;
+	}
+
+	dgInt32 stamp = 0;
+	dgInt32 minDegree = 0;
+	for (dgInt32 step = 0; step < size; step ++) {
+		while (degreeHead[minDegree] < 0) {
+			minDegree ++;
+			dgAssert (minDegree < size);
+		}
+
+		const dgInt32 pivot = degreeHead[minDegree];
+		degreeHead[minDegree] = degreeNext[pivot];
+		if (degreeNext[pivot] >= 0) {
+			degreePrev[degreeNext[pivot]] = -1;
+		}
+		permutation[step] = pivot;
+		inversePermutation[pivot] = step;
+
+		const dgInt32 pivotStart = listStart[pivot];
+		const dgInt32 pivotCount = listCount[pivot];
+		for (dgInt32 i = 0; i < pivotCount; i ++) {
+			const dgInt32 node = pool[pivotStart + i];
+
+			// remove the node from its degree list
+			const dgInt32 degree = listCount[node];
+			if (degreePrev[node] >= 0) {
+				degreeNext[degreePrev[node]] = degreeNext[node];
+			} else {
+				degreeHead[degree] = degreeNext[node];
+			}
+			if (degreeNext[node] >= 0) {
+				degreePrev[degreeNext[node]] = degreePrev[node];
+			}
+
+			// remove the pivot from the adjacency of this node and mark the remaining neighbors
+			stamp ++;
+			mark[node] = stamp;
+			dgInt32 nodeStart = listStart[node];
+			dgInt32 nodeCount = listCount[node];
+			for (dgInt32 j = nodeCount - 1; j >= 0; j --) {
+				const dgInt32 neighbor = pool[nodeStart + j];
+				if (neighbor == pivot) {
+					nodeCount --;
+					pool[nodeStart + j] = pool[nodeStart + nodeCount];
+				} else {
+					mark[neighbor] = stamp;
+				}
+			}
+
+			// connect the node to all the other neighbors of the pivot
+			for (dgInt32 j = 0; j < pivotCount; j ++) {
+				const dgInt32 neighbor = pool[pivotStart + j];
+				if (mark[neighbor] != stamp) {
+					mark[neighbor] = stamp;
+					if (nodeCount == listCapacity[node]) {
+						const dgInt32 capacity = listCapacity[node] * 2 + 4;
+						m_graphPool.ResizeIfNecessary (poolSize + capacity);
+						pool = &m_graphPool[0];
+						memcpy (&pool[poolSize], &pool[nodeStart], nodeCount * sizeof (dgInt32));
+						nodeStart = poolSize;
+						listStart[node] = poolSize;
+						listCapacity[node] = capacity;
+						poolSize += capacity;
+					}
+					pool[nodeStart + nodeCount] = neighbor;
+					nodeCount ++;
+				}
+			}
+			listCount[node] = nodeCount;
+
+			// reinsert the node in the list of its new degree
+			degreePrev[node] = -1;
+			degreeNext[node] = degreeHead[nodeCount];
+			if (degreeHead[nodeCount] >= 0) {
+				degreePrev[degreeHead[nodeCount]] = node;
+			}
+			degreeHead[nodeCount] = node;
+			minDegree = dgMin (minDegree, nodeCount);
+		}
+		listCount[pivot] = 0;
+	}
+}
+
+void dgSparseLDLt::SymbolicFactorization()
+{
+	// calculate the elimination tree and the number of entries of each column of L
+	const dgInt32 size = m_size;
+	const dgInt32* const columnStart = &m_columnStart[0];
+	const dgInt32* const rowIndex = &m_rowIndex[0];
+	const dgInt32* const permutation = &m_permutation[0];
+	const dgInt32* const inversePermutation = &m_inversePermutation[0];
+
+	m_parent.ResizeIfNecessary (size);
+	m_factorColumnStart.ResizeIfNecessary (size + 1);
+	m_factorColumnCount.ResizeIfNecessary (size);
+	m_workBuffer.ResizeIfNecessary (size);
+	dgInt32* const parent = &m_parent[0];
+	dgInt32* const factorColumnStart = &m_factorColumnStart[0];
+	dgInt32* const factorColumnCount = &m_factorColumnCount[0];
+	dgInt32* const flag = &m_workBuffer[0];
+
+	for (dgInt32 k = 0; k < size; k ++) {
+		parent[k] = -1;
+		flag[k] = k;
+		factorColumnCount[k] = 0;
+		const dgInt32 column = permutation[k];
+		for (dgInt32 j = columnStart[column]; j < columnStart[column + 1]; j ++) {
+			dgInt32 i = inversePermutation[rowIndex[j]];
+			if (i < k) {
+				for (; flag[i] != k; i = parent[i]) {
+					if (parent[i] == -1) {
+						parent[i] = k;
+					}
+					factorColumnCount[i] ++;
+					flag[i] = k;
+				}
+			}
+		}
+	}
+
+	dgInt32 acc = 0;
+	for (dgInt32 k = 0; k < size; k ++) {
+		factorColumnStart[k] = acc;
+		acc += factorColumnCount[k];
+	}
+	factorColumnStart[size] = acc;
+	m_factorNonZeroCount = acc;
+
+	m_factorRowIndex.ResizeIfNecessary (m_factorNonZeroCount);
+	m_factorValues.ResizeIfNecessary (m_factorNonZeroCount);
+	m_diagonal.ResizeIfNecessary (size);
+}
+
+void dgSparseLDLt::AddDiagonal (const dgFloat32* const diagonal)
+{
+	for (dgInt32 i = 0; i < m_size; i ++) {
+		m_values[m_diagonalIndex[i]] += diagonal[i];
+	}
+}
+
+bool dgSparseLDLt::Factorize ()
+{
+	// up looking numerical factorization, each row of L is the solution of a
+	// sparse triangular system with the pattern given by the elimination tree.
+	const dgInt32 size = m_size;
+	if (!size) {
+		return true;
+	}
+
+	const dgInt32* const columnStart = &m_columnStart[0];
+	const dgInt32* const rowIndex = &m_rowIndex[0];
+	const dgFloat64* const values = &m_values[0];
+	const dgInt32* const diagonalIndex = &m_diagonalIndex[0];
+	const dgInt32* const permutation = &m_permutation[0];
+	const dgInt32* const inversePermutation = &m_inversePermutation[0];
+	const dgInt32* const parent = &m_parent[0];
+	const dgInt32* const factorColumnStart = &m_factorColumnStart[0];
+
+	m_workBuffer.ResizeIfNecessary (size * 2);
+	m_workValues.ResizeIfNecessary (size);
+	dgInt32* const factorColumnCount = &m_factorColumnCount[0];
+	dgInt32* const factorRowIndex = m_factorNonZeroCount ? &m_factorRowIndex[0] : NULL;
+	dgFloat64* const factorValues = m_factorNonZeroCount ? &m_factorValues[0] : NULL;
+	dgFloat64* const diagonal = &m_diagonal[0];
+	dgInt32* const flag = &m_workBuffer[0];
+	dgInt32* const pattern = &flag[size];
+	dgFloat64* const y = &m_workValues[0];
+
+	for (dgInt32 k = 0; k < size; k ++) {
+		y[k] = dgFloat64 (0.0f);
+	}
+
+	for (dgInt32 k = 0; k < size; k ++) {
+		dgInt32 top = size;
+		flag[k] = k;
+		factorColumnCount[k] = 0;
+		const dgInt32 column = permutation[k];
+		for (dgInt32 j = columnStart[column]; j < columnStart[column + 1]; j ++) {
+			dgInt32 i = inversePermutation[rowIndex[j]];
+			if (i <= k) {
+				y[i] += values[j];
+				dgInt32 length = 0;
+				for (; flag[i] != k; i = parent[i]) {
+					pattern[length] = i;
+					length ++;
+					flag[i] = k;
+				}
+				while (length > 0) {
+					top --;
+					length --;
+					pattern[top] = pattern[length];
+				}
+			}
+		}
+
+		dgFloat64 d = y[k];
+		y[k] = dgFloat64 (0.0f);
+		for (; top < size; top ++) {
+			const dgInt32 i = pattern[top];
+			const dgFloat64 yi = y[i];
+			y[i] = dgFloat64 (0.0f);
+			const dgInt32 start = factorColumnStart[i];
+			const dgInt32 end = start + factorColumnCount[i];
+			for (dgInt32 j = start; j < end; j ++) {
+				y[factorRowIndex[j]] -= factorValues[j] * yi;
+			}
+			const dgFloat64 l_ki = yi / diagonal[i];
+			d -= l_ki * yi;
+			factorRowIndex[end] = k;
+			factorValues[end] = l_ki;
+			factorColumnCount[i] ++;
+		}
+
+		if (d <= (values[diagonalIndex[column]] * DG_SPARSE_LDLT_PIVOT_TOL)) {
+			// the matrix is not positive definite, clean up the work buffer and report failure
+			for (dgInt32 i = k + 1; i < size; i ++) {
+				y[i] = dgFloat64 (0.0f);
+			}
+			return false;
+		}
+		diagonal[k] = d;
+	}
+	return true;
+}
+
+bool dgSparseLDLt::FactorizeWithRegularizer (dgFloat32* const regularizer)
+{
+	dgFloat64 maxDiagonal = dgFloat64 (0.0f);
+	for (dgInt32 i = 0; i < m_size; i ++) {
+		maxDiagonal = dgMax (maxDiagonal, dgAbs (m_values[m_diagonalIndex[i]]));
+	}
+
+	// a zero or negative regularizer never grows, so each one is at least a fraction of its diagonal
+	for (dgInt32 pass = 0; pass < DG_SPARSE_LDLT_REGULARIZER_PASSES; pass ++) {
+		if (Factorize()) {
+			return true;
+		}
+		for (dgInt32 i = 0; i < m_size; i ++) {
+			const dgFloat64 diagonal = dgMax (dgAbs (m_values[m_diagonalIndex[i]]), maxDiagonal * DG_SPARSE_LDLT_REGULARIZER_TOL);
+			regularizer[i] = dgMax (regularizer[i], dgFloat32 (diagonal * DG_SPARSE_LDLT_REGULARIZER_TOL)) * dgFloat32 (4.0f);
+			m_values[m_diagonalIndex[i]] += regularizer[i];
+		}
+	}
+	return Factorize();
+}
+
+void dgSparseLDLt::Solve (dgFloat32* const x) const
+{
+	const dgInt32 size = m_size;
+	if (!size) {
+		return;
+	}
+
+	m_workValues.ResizeIfNecessary (size);
+	dgFloat64* const y = &m_workValues[0];
+	const dgInt32* const permutation = &m_permutation[0];
+	const dgInt32* const factorColumnStart = &m_factorColumnStart[0];
+	const dgInt32* const factorRowIndex = m_factorNonZeroCount ? &m_factorRowIndex[0] : NULL;
+	const dgFloat64* const factorValues = m_factorNonZeroCount ? &m_factorValues[0] : NULL;
+	const dgFloat64* const diagonal = &m_diagonal[0];
+
+	for (dgInt32 k = 0; k < size; k ++) {
+		y[k] = x[permutation[k]];
+	}
+
+	for (dgInt32 k = 0; k < size; k ++) {
+		const dgFloat64 yk = y[k];
+		for (dgInt32 j = factorColumnStart[k]; j < factorColumnStart[k + 1]; j ++) {
+			y[factorRowIndex[j]] -= factorValues[j] * yk;
+		}
+	}
+
+	for (dgInt32 k = 0; k < size; k ++) {
+		y[k] /= diagonal[k];
+	}
+
+	for (dgInt32 k = size - 1; k >= 0; k --) {
+		dgFloat64 yk = y[k];
+		for (dgInt32 j = factorColumnStart[k]; j < factorColumnStart[k + 1]; j ++) {
+			yk -= factorValues[j] * y[factorRowIndex[j]];
+		}
+		y[k] = yk;
+	}
+
+	for (dgInt32 k = 0; k < size; k ++) {
+		x[permutation[k]] = dgFloat32 (y[k]);
+	}
+}
@@ -0,0 +1,127 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __dgSparseLDLt__
+#define __dgSparseLDLt__
+
+#include "dgStdafx.h"
+#include "dgMemory.h"
+#include "dgArray.h"
+
+
+// sparse L * D * L' factorization of a symmetric positive definite matrix.
+// the matrix is built from a list of entries, the rows are reorder using a minimum degree
+// ordering to reduce the fill in, and the symbolic factorization (elimination tree and
+// column counts) is only recalculated when the non zero pattern of the matrix changes.
+class dgSparseLDLt
+{
+	public:
+	dgSparseLDLt(dgMemoryAllocator* const allocator);
+	~dgSparseLDLt();
+
+	// start a new matrix, only entries in the lower triangle (row >= column) should be added,
+	// entries with the same row and column are accumulated
+	void BeginMatrix (dgInt32 size);
+	void AddEntry (dgInt32 row, dgInt32 column, dgFloat32 value);
+	void EndMatrix ();
+
+	void AddDiagonal (const dgFloat32* const diagonal);
+	bool Factorize ();
+	// adds a growing regularizer to the diagonal until the matrix factorizes, returns false if it never does
+	bool FactorizeWithRegularizer (dgFloat32* const regularizer);
+	void Solve (dgFloat32* const x) const;
+
+	dgInt32 GetSize() const;
+	dgInt32 GetEntriesCount() const;
+	dgInt32 GetFactorEntriesCount() const;
+	dgFloat32 GetDiagonal(dgInt32 row) const;
+
+	private:
+	class dgEntry
+	{
+		public:
+		dgInt32 m_row;
+		dgInt32 m_column;
+		dgFloat32 m_value;
+	};
+
+	void MinimumDegreeOrdering();
+	void SymbolicFactorization();
+	static dgInt32 CompareEntries (const dgEntry* const entryA, const dgEntry* const entryB, void* const context);
+
+	dgArray<dgEntry> m_entries;
+
+	// symmetric matrix in compressed column format, both triangles are stored
+	dgArray<dgInt32> m_columnStart;
+	dgArray<dgInt32> m_rowIndex;
+	dgArray<dgFloat64> m_values;
+	dgArray<dgInt32> m_diagonalIndex;
+
+	// copy of the pattern used to calculate the current ordering
+	dgArray<dgInt32> m_patternColumnStart;
+	dgArray<dgInt32> m_patternRowIndex;
+
+	// ordering and symbolic factorization
+	dgArray<dgInt32> m_permutation;
+	dgArray<dgInt32> m_inversePermutation;
+	dgArray<dgInt32> m_parent;
+	dgArray<dgInt32> m_factorColumnStart;
+	dgArray<dgInt32> m_factorColumnCount;
+
+	// numeric factorization
+	dgArray<dgInt32> m_factorRowIndex;
+	dgArray<dgFloat64> m_factorValues;
+	dgArray<dgFloat64> m_diagonal;
+
+	// scratch buffers
+	dgArray<dgInt32> m_graphPool;
+	dgArray<dgInt32> m_workBuffer;
+	mutable dgArray<dgFloat64> m_workValues;
+
+	dgInt32 m_size;
+	dgInt32 m_entriesCount;
+	dgInt32 m_nonZeroCount;
+	dgInt32 m_patternSize;
+	dgInt32 m_patternNonZeroCount;
+	dgInt32 m_factorNonZeroCount;
+};
+
+inline dgInt32 dgSparseLDLt::GetSize() const
+{
+	return m_size;
+}
+
+inline dgInt32 dgSparseLDLt::GetEntriesCount() const
+{
+	return m_nonZeroCount;
+}
+
+inline dgInt32 dgSparseLDLt::GetFactorEntriesCount() const
+{
+	return m_factorNonZeroCount;
+}
+
+inline dgFloat32 dgSparseLDLt::GetDiagonal(dgInt32 row) const
+{
+	return dgFloat32 (m_values[m_diagonalIndex[row]]);
+}
+
+#endif
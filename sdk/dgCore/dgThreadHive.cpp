@@ -25,6 +25,8 @@
 #include "dgProfiler.h"
 #include "dgThreadHive.h"
 
+// the hive that owns the job running in this thread
+static DG_THREAD_LOCAL dgThreadHive* runningJobHive = NULL;
 
 dgThreadHive::dgWorkerThread::dgWorkerThread()
 	:dgThread()
@@ -63,6 +65,7 @@ bool dgThreadHive::dgWorkerThread::IsBusy() const
 
 void dgThreadHive::dgWorkerThread::Execute (dgInt32 threadId)
 {
+	runningJobHive = m_hive;
 	m_hive->OnBeginWorkerThread (threadId);
 
 	while (!m_terminate) {
@@ -105,6 +108,7 @@ dgThreadHive::dgThreadHive(dgMemoryAllocator* const allocator)
 	,m_jobsCount(0)
 	,m_workerThreadsCount(0)
 	,m_globalCriticalSection(0)
+	,m_ownerLock(0)
 {
 }
 
@@ -151,12 +155,18 @@ void dgThreadHive::QueueJob (dgWorkerThreadTaskCallback callback, void* const co
 {
 	if (!m_workerThreadsCount) {
 		DG_TRACKTIME(functionName);
+		dgThreadHive* const parentHive = runningJobHive;
+		runningJobHive = this;
 		callback (context0, context1, 0);
+		runningJobHive = parentHive;
 	} else {
 		dgInt32 workerTreadEntry = m_jobsCount % m_workerThreadsCount;
 		#ifdef DG_USE_THREAD_EMULATION
 			DG_TRACKTIME(functionName);
+			dgThreadHive* const parentHive = runningJobHive;
+			runningJobHive = this;
 			callback (context0, context1, workerTreadEntry);
+			runningJobHive = parentHive;
 		#else 
 			dgInt32 index = m_workerThreads[workerTreadEntry].PushJob(dgThreadJob(context0, context1, callback, functionName));
 			if (index >= DG_THREAD_POOL_JOB_SIZE) {
@@ -189,3 +199,136 @@ void dgThreadHive::SynchronizationBarrier ()
 	m_jobsCount = 0;
 }
 
+bool dgThreadHive::TryAcquire()
+{
+	// a job can not use its own hive, the workers would wait for themselves
+	if (runningJobHive == this) {
+		return false;
+	}
+	return dgInterlockedExchange(&m_ownerLock, 1) ? false : true;
+}
+
+void dgThreadHive::Acquire()
+{
+	dgAssert (runningJobHive != this);
+	while (dgInterlockedExchange(&m_ownerLock, 1)) {
+		dgThreadYield();
+	}
+}
+
+void dgThreadHive::Release()
+{
+	dgInterlockedExchange(&m_ownerLock, 0);
+}
+
+
+dgTaskGraph::dgTaskGraph(dgThreadHive* const threadPool)
+	:m_threadPool(threadPool)
+	,m_taskCount(0)
+	,m_readyHead(0)
+	,m_readyTail(0)
+{
+}
+
+dgInt32 dgTaskGraph::AddTask (dgWorkerThreadTaskCallback callback, void* const context0, void* const context1, const char* const taskName)
+{
+	dgAssert (m_taskCount < DG_TASK_GRAPH_MAX_TASKS);
+	dgTask& task = m_tasks[m_taskCount];
+	task.m_job = dgThreadHive::dgThreadJob(context0, context1, callback, taskName);
+	task.m_dependencyCount = 0;
+	task.m_pendingCount = 0;
+	task.m_successorCount = 0;
+	m_taskCount ++;
+	return m_taskCount - 1;
+}
+
+dgInt32 dgTaskGraph::AddJoin (const dgInt32* const tasks, dgInt32 count, const char* const joinName)
+{
+	// an empty task that depends on all the tasks in the list, used for saving edges 
+	// when all the tasks of one phase depend on all the tasks of a previous phase.
+	const dgInt32 join = AddTask (JoinKernel, NULL, NULL, joinName);
+	for (dgInt32 i = 0; i < count; i ++) {
+		AddDependency (join, tasks[i]);
+	}
+	return join;
+}
+
+void dgTaskGraph::AddDependency (dgInt32 task, dgInt32 dependsOnTask)
+{
+	dgAssert (task > dependsOnTask);
+	dgAssert (task < m_taskCount);
+	dgTask& parent = m_tasks[dependsOnTask];
+	dgAssert (parent.m_successorCount < DG_TASK_GRAPH_MAX_SUCCESSORS);
+	parent.m_successors[parent.m_successorCount] = task;
+	parent.m_successorCount ++;
+	m_tasks[task].m_dependencyCount ++;
+}
+
+void dgTaskGraph::MakeReady (dgInt32 task)
+{
+	dgInt32 slot = dgAtomicExchangeAndAdd(&m_readyTail, 1);
+	dgInterlockedExchange(&m_readyQueue[slot], task);
+}
+
+void dgTaskGraph::ExecuteTasks (dgInt32 threadID)
+{
+	// every task is pushed exactly once in the ready queue, so a worker that claims a slot 
+	// only have to wait until one of its dependencies finishes and fill that slot.
+	const volatile dgInt32* const readyQueue = m_readyQueue;
+	for (dgInt32 slot = dgAtomicExchangeAndAdd(&m_readyHead, 1); slot < m_taskCount; slot = dgAtomicExchangeAndAdd(&m_readyHead, 1)) {
+		dgInt32 count = 0;
+		while (readyQueue[slot] < 0) {
+			count ++;
+			dgThreadPause();
+			if (count >= 1024 * 64) {
+				count = 0;
+				dgThreadYield();
+			}
+		}
+
+		dgTask& task = m_tasks[readyQueue[slot]];
+		{
+			DG_TRACKTIME_NAMED(task.m_job.m_jobName);
+			task.m_job.m_callback(task.m_job.m_context0, task.m_job.m_context1, threadID);
+		}
+
+		for (dgInt32 i = 0; i < task.m_successorCount; i ++) {
+			const dgInt32 successor = task.m_successors[i];
+			if (dgAtomicExchangeAndAdd(&m_tasks[successor].m_pendingCount, -1) == 1) {
+				MakeReady (successor);
+			}
+		}
+	}
+}
+
+void dgTaskGraph::JoinKernel (void* const context0, void* const context1, dgInt32 threadID)
+{
+}
+
+void dgTaskGraph::ExecuteTasksKernel (void* const context, void* const unused, dgInt32 threadID)
+{
+	dgTaskGraph* const graph = (dgTaskGraph*) context;
+	graph->ExecuteTasks(threadID);
+}
+
+void dgTaskGraph::Execute ()
+{
+	m_readyHead = 0;
+	m_readyTail = 0;
+	for (dgInt32 i = 0; i < m_taskCount; i ++) {
+		m_readyQueue[i] = -1;
+		m_tasks[i].m_pendingCount = m_tasks[i].m_dependencyCount;
+	}
+
+	for (dgInt32 i = 0; i < m_taskCount; i ++) {
+		if (!m_tasks[i].m_dependencyCount) {
+			MakeReady (i);
+		}
+	}
+
+	const dgInt32 threadCount = dgMin (m_threadPool->GetThreadCount(), m_taskCount);
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		m_threadPool->QueueJob(ExecuteTasksKernel, this, NULL, "dgTaskGraph::Execute");
+	}
+	m_threadPool->SynchronizationBarrier();
+}
@@ -29,6 +29,8 @@
 
 
 #define DG_THREAD_POOL_JOB_SIZE (256)
+#define DG_TASK_GRAPH_MAX_TASKS (128)
+#define DG_TASK_GRAPH_MAX_SUCCESSORS (DG_MAX_THREADS_HIVE_COUNT * 2 + 2)
 typedef void (*dgWorkerThreadTaskCallback) (void* const context0, void* const context1, dgInt32 threadID);
 
 class dThreadHiveSync
@@ -144,6 +146,12 @@ class dgThreadHive
 	virtual void QueueJob (dgWorkerThreadTaskCallback callback, void* const context0, void* const context1, const char* const functionName);
 	virtual void SynchronizationBarrier ();
 
+	// the hive is owned by one caller at a time, TryAcquire fails when the hive is owned 
+	// by another caller, or when it is called from a job running in this hive.
+	bool TryAcquire();
+	void Acquire();
+	void Release();
+
 	private:
 	void DestroyThreads();
 
@@ -153,9 +161,72 @@ class dgThreadHive
 	dgInt32 m_jobsCount;
 	dgInt32 m_workerThreadsCount;
 	mutable dgInt32 m_globalCriticalSection;
+	dgInt32 m_ownerLock;
 	dgThread::dgSemaphore m_semaphore[DG_MAX_THREADS_HIVE_COUNT];
 };
 
+// borrows an idle hive for the duration of a scope, GetPool returns NULL if the hive is not available
+class dgScopeIdleThreadPool
+{
+	public:
+	dgScopeIdleThreadPool (dgThreadHive* const threadPool)
+		:m_threadPool ((threadPool && threadPool->TryAcquire()) ? threadPool : NULL)
+	{
+	}
+
+	~dgScopeIdleThreadPool ()
+	{
+		if (m_threadPool) {
+			m_threadPool->Release();
+		}
+	}
+
+	dgThreadHive* GetPool() const
+	{
+		return m_threadPool;
+	}
+
+	private:
+	dgThreadHive* const m_threadPool;
+};
+
+// a set of jobs with dependencies between them, each job is executed by the first 
+// available worker as soon as all the jobs it depends on are completed. 
+// the whole graph executes inside a single synchronization barrier.
+class dgTaskGraph
+{
+	public:
+	dgTaskGraph(dgThreadHive* const threadPool);
+
+	dgInt32 AddTask (dgWorkerThreadTaskCallback callback, void* const context0, void* const context1, const char* const taskName);
+	dgInt32 AddJoin (const dgInt32* const tasks, dgInt32 count, const char* const joinName);
+	void AddDependency (dgInt32 task, dgInt32 dependsOnTask);
+	void Execute ();
+
+	private:
+	class dgTask
+	{
+		public:
+		dgThreadHive::dgThreadJob m_job;
+		dgInt32 m_dependencyCount;
+		dgInt32 m_pendingCount;
+		dgInt32 m_successorCount;
+		dgInt32 m_successors[DG_TASK_GRAPH_MAX_SUCCESSORS];
+	};
+
+	void MakeReady (dgInt32 task);
+	void ExecuteTasks (dgInt32 threadID);
+	static void ExecuteTasksKernel (void* const context, void* const unused, dgInt32 threadID);
+	static void JoinKernel (void* const context0, void* const context1, dgInt32 threadID);
+
+	dgThreadHive* m_threadPool;
+	dgInt32 m_taskCount;
+	dgInt32 m_readyHead;
+	dgInt32 m_readyTail;
+	dgInt32 m_readyQueue[DG_TASK_GRAPH_MAX_TASKS];
+	dgTask m_tasks[DG_TASK_GRAPH_MAX_TASKS];
+};
+
 DG_INLINE dgInt32 dgThreadHive::GetThreadCount() const
 {
 	return m_workerThreadsCount ? m_workerThreadsCount : 1;
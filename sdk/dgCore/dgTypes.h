@@ -233,6 +233,12 @@
 #endif
 
 
+#if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
+	#define DG_THREAD_LOCAL __declspec(thread)
+#else 
+	#define DG_THREAD_LOCAL __thread
+#endif
+
 #define DG_VECTOR_SIMD_SIZE		16
 #define DG_VECTOR_AVX2_SIZE		32
 
@@ -554,7 +560,7 @@ void dgRadixSort (T* const array, T* const tmpArray, dgInt32 elements, dgInt32 r
 			
 			dgInt32 radixShift = (radix + 1) << 3;
 			for (dgInt32 i = 0; i < elements; i ++) {
-				dgInt32 key = (getRadixKey (&array[i], context) >> radixShift) & 0xff;
+				dgInt32 key = (getRadixKey (&tmpArray[i], context) >> radixShift) & 0xff;
 				dgInt32 index = scanCount[key];
 				array[index] = tmpArray[i];
 				scanCount[key] = index + 1;
@@ -823,6 +829,21 @@ DG_INLINE dgInt32 dgAtomicExchangeAndAdd (dgInt32* const addend, dgInt32 amount)
 	#endif
 }
 
+DG_INLINE dgInt64 dgAtomicExchangeAndAdd (dgInt64* const addend, dgInt64 amount)
+{
+	#if defined (_WIN_64_VER)
+		return _InterlockedExchangeAdd64((__int64*) addend, amount);
+	#endif
+
+	#if (defined (_WIN_32_VER) || defined (_MINGW_32_VER) || defined (_MINGW_64_VER))
+		return InterlockedExchangeAdd64((LONGLONG*) addend, LONGLONG (amount));
+	#endif
+
+	#if (defined (_POSIX_VER) || defined (_POSIX_VER_64) ||defined (_MACOSX_VER))
+		return __sync_fetch_and_add ((int64_t*)addend, amount);
+	#endif
+}
+
 DG_INLINE dgInt32 dgInterlockedExchange(dgInt32* const ptr, dgInt32 value)
 {
 	#if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
@@ -25,7 +25,9 @@
 #include <dgRefCounter.h>
 
 class dgWorld;
+class dgThreadHive;
 class dgMeshEffect;
+class dgCollisionBVH;
 class dgCollisionInstance;
 
 #define DG_MESH_EFFECT_PRECISION_BITS		48
@@ -180,6 +182,7 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 		{
 			public:
 			const dgChannel<dgBigVector, m_point>* m_points;
+			const dgChannel<dgInt32, m_layer>* m_layers;
 			dgInt32 m_vertexSortIndex;
 		};
 
@@ -208,6 +211,7 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 		~dgPointFormat();
 
 		void Clear();
+		void CopyFrom (const dgPointFormat& source);
 		void CompressData(dgInt32* const indexList);
 
 		dgChannel<dgInt32, m_layer> m_layers;
@@ -319,6 +323,7 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 	dgMeshEffect(dgMemoryAllocator* const allocator);
 	dgMeshEffect(dgCollisionInstance* const collision);
 	dgMeshEffect(const dgMeshEffect& source);
+	dgMeshEffect(dgMemoryAllocator* const allocator, const dgMeshEffect& source);
 	dgMeshEffect(dgPolyhedra& mesh, const dgMeshEffect& source);
 	dgMeshEffect (dgMemoryAllocator* const allocator, dgDeserialize deserialization, void* const userData);
 
@@ -326,7 +331,7 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 	dgMeshEffect(dgMemoryAllocator* const allocator, const char* const fileName);
 
 	// Create a convex hull Mesh form point cloud
-	dgMeshEffect (dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte, dgFloat64 distTol);
+	dgMeshEffect (dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte, dgFloat64 distTol, dgThreadHive* const threadPool = NULL);
 
 	// create a planar Mesh
 	dgMeshEffect(dgMemoryAllocator* const allocator, const dgMatrix& planeMatrix, dgFloat32 witdth, dgFloat32 breadth, dgInt32 material, const dgMatrix& textureMatrix0, const dgMatrix& textureMatrix1);
@@ -356,6 +361,8 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 	//bool PlaneClip (const dgBigPlane& plane);
 	
 	dgMeshEffect* ConvexMeshIntersection (const dgMeshEffect* const convexMesh) const;
+	dgMeshEffect* ConvexMeshIntersection (const dgMeshEffect* const convexMesh, dgMemoryAllocator* const allocator) const;
+	void ConvexMeshIntersection (dgInt32 count, const dgMeshEffect* const* const convexMeshArray, dgMeshEffect** const intersections, dgThreadHive* const threadPool) const;
 
 	dgMeshEffect* GetFirstLayer ();
 	dgMeshEffect* GetNextLayer (dgMeshEffect* const layer);
@@ -429,13 +436,14 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 	dgCollisionInstance* CreateCollisionTree(dgWorld* const world, dgInt32 shapeID) const;
 	dgCollisionInstance* CreateConvexCollision(dgWorld* const world, dgFloat64 tolerance, dgInt32 shapeID, const dgMatrix& matrix = dgGetIdentityMatrix()) const;
 
-	dgMeshEffect* CreateSimplification (dgInt32 maxVertexCount, dgReportProgress reportProgressCallback, void* const userData) const;
-	dgMeshEffect* CreateConvexApproximation (dgFloat32 maxConcavity, dgFloat32 backFaceDistanceFactor, dgInt32 maxHullOuputCount, dgInt32 maxVertexPerHull, dgReportProgress reportProgressCallback, void* const userData) const;
+	// the simplified mesh keeps the vertex positions and the face materials, all other vertex attributes are dropped
+	dgMeshEffect* CreateSimplification (dgInt32 maxVertexCount, dgReportProgress reportProgressCallback, void* const userData, dgThreadHive* const threadPool = NULL) const;
+	dgMeshEffect* CreateConvexApproximation (dgFloat32 maxConcavity, dgFloat32 backFaceDistanceFactor, dgInt32 maxHullOuputCount, dgInt32 maxVertexPerHull, dgReportProgress reportProgressCallback, void* const userData, dgThreadHive* const threadPool = NULL) const;
 
-	dgMeshEffect* CreateTetrahedraIsoSurface() const;
-	void CreateTetrahedraLinearBlendSkinWeightsChannel (const dgMeshEffect* const tetrahedraMesh);
+	dgMeshEffect* CreateTetrahedraIsoSurface(dgThreadHive* const threadPool = NULL) const;
+	void CreateTetrahedraLinearBlendSkinWeightsChannel (const dgMeshEffect* const tetrahedraMesh, dgThreadHive* const threadPool = NULL);
 
-	static dgMeshEffect* CreateVoronoiConvexDecomposition (dgMemoryAllocator* const allocator, dgInt32 pointCount, dgInt32 pointStrideInBytes, const dgFloat32* const pointCloud, dgInt32 materialId, const dgMatrix& textureProjectionMatrix);
+	static dgMeshEffect* CreateVoronoiConvexDecomposition (dgMemoryAllocator* const allocator, dgInt32 pointCount, dgInt32 pointStrideInBytes, const dgFloat32* const pointCloud, dgInt32 materialId, const dgMatrix& textureProjectionMatrix, dgThreadHive* const threadPool = NULL);
 	static dgMeshEffect* CreateFromSerialization (dgMemoryAllocator* const allocator, dgDeserialize deserialization, void* const userData);
 
 	void LoadOffMesh (const char* const filename);
@@ -502,6 +510,8 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 	void PackPoints (dgFloat64 tol);
 	void UnpackPoints();
 
+	static void ConvexMeshIntersectionKernel (void* const context, void* const unused, dgInt32 threadID);
+
 	dgPointFormat m_points;
 	dgAttibutFormat m_attrib;
 	dgInt32 m_constructionIndex;
@@ -513,8 +523,206 @@ class dgMeshEffect: public dgPolyhedra, public dgRefCounter
 	friend class dgTriangleAnglesToUV;
 	friend class dgTetraIsoSufaceStuffing;
 	friend class dgCollisionCompoundFractured;
+	friend class dgMeshEffectFracturePattern;
+	friend class dgMeshEffectSimplifier;
+};
+
+// intersects a mesh with a set of convex meshes in a background thread, so that the caller 
+// can keep running. all the meshes are copied, and the pieces are calculated with a private 
+// allocator, they are moved to the allocator of the source mesh when the caller collects them.
+class dgMeshEffectConvexIntersectionTask: public dgThread
+{
+	public:
+	DG_CLASS_ALLOCATOR(allocator)
+
+	dgMeshEffectConvexIntersectionTask (const dgMeshEffect* const mesh, dgInt32 count, const dgMeshEffect* const* const convexMeshArray);
+	virtual ~dgMeshEffectConvexIntersectionTask ();
+
+	bool IsDone () const;
+	void GetIntersections (dgMeshEffect** const intersections);
+
+	private:
+	virtual void Execute (dgInt32 threadID);
+	void Wait ();
+
+	dgMemoryAllocator* m_resultAllocator;
+	dgMemoryAllocator* m_allocator;
+	dgMeshEffect* m_mesh;
+	dgMeshEffect** m_convexMeshes;
+	dgMeshEffect** m_intersections;
+	dgInt32 m_count;
+	bool m_joined;
+};
+
+// the voronoi cells of a point cloud and their adjacency, the pattern is calculated once 
+// and later it can be placed over any solid mesh to break it in convex pieces, this only
+// clips the solid mesh with the cells, so it is cheap enough to be done at fracture time.
+class dgMeshEffectFracturePattern
+{
+	public:
+	DG_CLASS_ALLOCATOR(allocator)
+
+	dgMeshEffectFracturePattern (dgMemoryAllocator* const allocator, dgInt32 pointCount, dgInt32 pointStrideInBytes, const dgFloat32* const pointCloud, dgInt32 materialId, const dgMatrix& textureProjectionMatrix, dgThreadHive* const threadPool = NULL);
+	~dgMeshEffectFracturePattern ();
+
+	dgInt32 GetCellCount () const;
+	const dgMeshEffect* GetCell (dgInt32 cell) const;
+	dgInt32 GetNeighborCount (dgInt32 cell) const;
+	const dgInt32* GetNeighbors (dgInt32 cell) const;
+
+	// pieces[i] is the part of the solid mesh inside cell i, after the cell is moved by matrix, or NULL 
+	// if they do not intersect. adjacent pieces are always in adjacent cells, but for concave solids 
+	// the pieces of two adjacent cells may not touch.
+	void Apply (const dgMeshEffect* const solidMesh, const dgMatrix& matrix, dgMeshEffect** const pieces, dgThreadHive* const threadPool = NULL) const;
+
+	private:
+	class dgCellEdge
+	{
+		public:
+		dgInt32 m_cell0;
+		dgInt32 m_cell1;
+	};
+
+	static dgInt32 CompareCellEdges (const dgCellEdge* const edgeA, const dgCellEdge* const edgeB, void* const context);
+	static void CreateCellsKernel (void* const context, void* const unused, dgInt32 threadID);
+	static dgMeshEffect* CreateCell (dgMemoryAllocator* const allocator, const dgBigVector* const voronoiPoints, const dgList<dgInt32>& tetras, dgInt32 materialId, const dgMatrix& textureProjectionMatrix);
+
+	dgMemoryAllocator* m_allocator;
+	dgArray<dgMeshEffect*> m_cells;
+	dgArray<dgInt32> m_neighborsStart;
+	dgArray<dgInt32> m_neighbors;
+	dgInt32 m_cellCount;
 };
 
+// reduces a triangle mesh to a face budget by collapsing edges. the mesh is cut in regions 
+// by a grid, each region is simplified by a different thread with the vertices shared with 
+// other regions locked, and the grid is shifted on the next pass so that the region borders 
+// are simplified too. faces can be streamed in, they are welded and simplified in batches, 
+// so the full resolution mesh is never in memory. the result does not depend on the threads.
+// streamed faces must arrive in spatial order, row by row or tile by tile, a vertex is locked until 
+// all the faces around it are in. faces in scattered order are held until their neighbors arrive, 
+// which in the worst case is the whole mesh.
+// the thread pool is not owned, it is borrowed with a dgScopeIdleThreadPool each time faces are simplified.
+class dgMeshEffectSimplifier
+{
+	public:
+	DG_CLASS_ALLOCATOR(allocator)
+
+	dgMeshEffectSimplifier (dgMemoryAllocator* const allocator, dgInt32 maxFaceCount, dgInt32 expectedFaceCount, dgThreadHive* const threadPool = NULL);
+	~dgMeshEffectSimplifier ();
+
+	void AddFace (dgInt32 vertexCount, const dgFloat32* const vertex, dgInt32 strideInBytes, dgInt32 faceAttribute);
+	void AddMesh (const dgMeshEffect* const mesh);
+	void Simplify (dgReportProgress reportProgressCallback = NULL, void* const userData = NULL);
+
+	dgInt32 GetVertexCount () const;
+	dgInt32 GetFaceCount () const;
+	const dgBigVector* GetVertexPool () const;
+	const dgInt32* GetFaceIndices (dgInt32 face) const;
+	dgInt32 GetFaceAttribute (dgInt32 face) const;
+
+	void BuildCollisionTree (dgCollisionBVH* const collision, dgInt32 optimize) const;
+	dgMeshEffect* CreateMesh () const;
+
+	private:
+	class dgTriangle
+	{
+		public:
+		dgInt32 m_index[3];
+		dgInt32 m_attribute;
+	};
+
+	class dgRegion
+	{
+		public:
+		dgInt32 m_start;
+		dgInt32 m_count;
+		dgInt32 m_target;
+	};
+
+	class dgSortKey
+	{
+		public:
+		dgInt64 m_key;
+		dgInt32 m_index;
+	};
+
+	class dgRegionDescriptor;
+
+	void FlushBatch ();
+	void WeldVertices ();
+	void LockOpenEdges (dgInt32 firstFace, dgInt8* const lockedVertex) const;
+	void RemoveUnusedVertices (dgInt32 firstVertex, dgInt32 firstFace);
+	void SimplifyFaces (dgInt32 firstFace, dgInt32 maxFaceCount, const dgInt8* const lockedVertex, dgReportProgress reportProgressCallback, void* const userData);
+	static dgInt32 CompareSortKeys (const dgSortKey* const keyA, const dgSortKey* const keyB, void* const context);
+	static void SimplifyRegionsKernel (void* const context, void* const unused, dgInt32 threadID);
+	static dgInt32 SimplifyRegion (const dgRegionDescriptor* const descriptor, const dgRegion& region, dgInt32 threadID);
+
+	dgMemoryAllocator* m_allocator;
+	dgThreadHive* m_threadPool;
+	dgArray<dgBigVector> m_points;
+	dgArray<dgTriangle> m_faces;
+	dgArray<dgBigVector> m_batchPoints;
+	dgArray<dgInt32> m_batchAttributes;
+	dgInt32 m_pointCount;
+	dgInt32 m_faceCount;
+	dgInt32 m_batchFaceCount;
+	dgInt32 m_maxFaceCount;
+	dgInt32 m_expectedFaceCount;
+	dgInt32 m_capFaceCount;
+	bool m_needsWeld;
+};
+
+DG_INLINE dgInt32 dgMeshEffectSimplifier::GetVertexCount () const
+{
+	return m_pointCount;
+}
+
+DG_INLINE dgInt32 dgMeshEffectSimplifier::GetFaceCount () const
+{
+	return m_faceCount;
+}
+
+DG_INLINE const dgBigVector* dgMeshEffectSimplifier::GetVertexPool () const
+{
+	return &m_points[0];
+}
+
+DG_INLINE const dgInt32* dgMeshEffectSimplifier::GetFaceIndices (dgInt32 face) const
+{
+	dgAssert ((face >= 0) && (face < m_faceCount));
+	return m_faces[face].m_index;
+}
+
+DG_INLINE dgInt32 dgMeshEffectSimplifier::GetFaceAttribute (dgInt32 face) const
+{
+	dgAssert ((face >= 0) && (face < m_faceCount));
+	return m_faces[face].m_attribute;
+}
+
+DG_INLINE dgInt32 dgMeshEffectFracturePattern::GetCellCount () const
+{
+	return m_cellCount;
+}
+
+DG_INLINE const dgMeshEffect* dgMeshEffectFracturePattern::GetCell (dgInt32 cell) const
+{
+	dgAssert ((cell >= 0) && (cell < m_cellCount));
+	return m_cells[cell];
+}
+
+DG_INLINE dgInt32 dgMeshEffectFracturePattern::GetNeighborCount (dgInt32 cell) const
+{
+	dgAssert ((cell >= 0) && (cell < m_cellCount));
+	return m_neighborsStart[cell + 1] - m_neighborsStart[cell];
+}
+
+DG_INLINE const dgInt32* dgMeshEffectFracturePattern::GetNeighbors (dgInt32 cell) const
+{
+	dgAssert ((cell >= 0) && (cell < m_cellCount));
+	return &m_neighbors[m_neighborsStart[cell]];
+}
+
 DG_INLINE dgInt32 dgMeshEffect::GetVertexCount() const
 {
 	return m_points.m_vertex.m_count;
@@ -53,6 +53,13 @@ void dgMeshEffect::dgPointFormat::Clear()
 	m_weights.Clear();
 }
 
+void dgMeshEffect::dgPointFormat::CopyFrom (const dgPointFormat& source)
+{
+	m_layers.CopyFrom(source.m_layers);
+	m_vertex.CopyFrom(source.m_vertex);
+	m_weights.CopyFrom(source.m_weights);
+}
+
 dgInt32 dgMeshEffect::dgFormat::GetSortIndex (const dgChannel<dgBigVector, m_point>& points, dgFloat64& dist) const
 {
 	dgBigVector xc(dgFloat64(0.0f));
@@ -90,6 +97,20 @@ dgInt32 dgMeshEffect::dgFormat::CompareVertex(const dgSortKey* const ptr0, const
 	const VertexSortData* const sortContext = (VertexSortData*)context;
 	const dgInt32 compIndex = sortContext->m_vertexSortIndex;
 	const dgChannel<dgBigVector, m_point>& points = *sortContext->m_points;
+
+	// vertices in different layers never collapse, sorting by layer first keeps the sweep 
+	// windows from spanning coplanar vertices of other layers
+	const dgChannel<dgInt32, m_layer>& layers = *sortContext->m_layers;
+	if (layers.m_count) {
+		const dgInt32 layer0 = layers[ptr0->m_vertexIndex];
+		const dgInt32 layer1 = layers[ptr1->m_vertexIndex];
+		if (layer0 < layer1) {
+			return -1;
+		} else if (layer0 > layer1) {
+			return 1;
+		}
+	}
+
 	const dgFloat64 x0 = points[ptr0->m_vertexIndex][compIndex];
 	const dgFloat64 x1 = points[ptr1->m_vertexIndex][compIndex];
 
@@ -119,6 +140,7 @@ void dgMeshEffect::dgPointFormat::CompressData(dgInt32* const indexList)
 	VertexSortData sortContext;
 	sortContext.m_points = &tmpFormat.m_vertex;
 	//sortContext.m_points = &tmpFormat;
+	sortContext.m_layers = &tmpFormat.m_layers;
 	sortContext.m_vertexSortIndex = firstSortAxis;
 	dgSort(indirectList, m_vertex.m_count, dgFormat::CompareVertex, &sortContext);
 
@@ -142,6 +164,9 @@ void dgMeshEffect::dgPointFormat::CompressData(dgInt32* const indexList)
 					if (val >= swept) {
 						break;
 					}
+					if (tmpFormat.m_layers.m_count && (tmpFormat.m_layers[i0] != tmpFormat.m_layers[j0])) {
+						break;
+					}
 
 					bool test = true;
 					if (iii != jjj) {
@@ -271,6 +296,7 @@ void dgMeshEffect::dgAttibutFormat::CompressData (const dgPointFormat& points, d
 
 	VertexSortData sortContext;
 	sortContext.m_points = &points.m_vertex;
+	sortContext.m_layers = &points.m_layers;
 	sortContext.m_vertexSortIndex = firstSortAxis;
 	dgSort (indirectList, m_pointChannel.m_count, dgFormat::CompareVertex, &sortContext);
 	dgAttibutFormat tmpFormat (*this);
@@ -295,6 +321,9 @@ void dgMeshEffect::dgAttibutFormat::CompressData (const dgPointFormat& points, d
 					if (val >= swept) {
 						break;
 					}
+					if (points.m_layers.m_count && (points.m_layers[iii] != points.m_layers[jjj])) {
+						break;
+					}
 
 					bool test = true;
 					if (iii != jjj) {
@@ -1277,6 +1306,16 @@ dgMeshEffect::dgMeshEffect(const dgMeshEffect& source)
 {
 }
 
+dgMeshEffect::dgMeshEffect(dgMemoryAllocator* const allocator, const dgMeshEffect& source)
+	:dgPolyhedra (allocator, source) 
+	,m_points(allocator)
+	,m_attrib(allocator)
+	,m_constructionIndex(0)
+{
+	m_points.CopyFrom(source.m_points);
+	m_attrib.CopyFrom(source.m_attrib);
+}
+
 dgMeshEffect::dgMeshEffect(dgCollisionInstance* const collision)
 	:dgPolyhedra (collision->GetAllocator()) 
 	,m_points(collision->GetAllocator())
@@ -1361,13 +1400,13 @@ dgMeshEffect::dgMeshEffect(dgCollisionInstance* const collision)
 }
 
 // create a convex hull
-dgMeshEffect::dgMeshEffect(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte, dgFloat64 distTol)
+dgMeshEffect::dgMeshEffect(dgMemoryAllocator* const allocator, const dgFloat64* const vertexCloud, dgInt32 count, dgInt32 strideInByte, dgFloat64 distTol, dgThreadHive* const threadPool)
 	:dgPolyhedra(allocator)
 	,m_points(allocator)
 	,m_attrib(allocator)
 {
 	if (count >= 4) {
-		dgConvexHull3d convexHull(allocator, vertexCloud, strideInByte, count, distTol);
+		dgConvexHull3d convexHull(allocator, vertexCloud, strideInByte, count, distTol, 0x7fffffff, threadPool);
 		if (convexHull.GetCount()) {
 			dgStack<dgInt32> faceCountPool(convexHull.GetCount());
 			dgStack<dgInt32> vertexIndexListPool(convexHull.GetCount() * 3);
@@ -2148,6 +2187,7 @@ void dgMeshEffect::EndBuild (dgFloat64 tol, bool fixTjoint)
 
 	dgInt32 triangCount = m_points.m_vertex.m_count / 3;
 	const dgInt32* const indexList = &m_attrib.m_pointChannel[0];
+	Reserve (triangCount * 3);
 	for (dgInt32 i = 0; i < triangCount; i ++) {
 		dgInt32 index[3];
 		dgInt64 userdata[3];
@@ -2247,6 +2287,7 @@ void dgMeshEffect::BuildFromIndexList(const dgMeshVertexFormat* const format)
 		}
 		maxAttribCount += count;
 	}
+	Reserve (maxAttribCount);
 
 	dgInt32 layerIndex = 0;
 	dgInt32 vertexStride = dgInt32(format->m_vertex.m_strideInBytes / sizeof (dgFloat64));
@@ -2558,10 +2599,14 @@ dgInt32 dgMeshEffect::GetVertexIndexFromPoint (const void* const point) const
 dgEdge* dgMeshEffect::SpliteFace (dgInt32 v0, dgInt32 v1)
 {
 	if (!FindEdge(v0, v1)) {
-		dgPolyhedra::dgPairKey key (v0, 0);
-		dgTreeNode* const node = FindGreaterEqual(key.GetVal());
-		if (node) {
-			dgEdge* const edge = &node->GetInfo();
+		dgEdge* edge = NULL;
+		Iterator iter (*this);
+		for (iter.Begin(); iter && !edge; iter ++) {
+			if ((*iter).m_incidentVertex == v0) {
+				edge = &(*iter);
+			}
+		}
+		if (edge) {
 			dgEdge* edge0 = edge;
 			do {
 				if (edge0->m_incidentFace > 0) {
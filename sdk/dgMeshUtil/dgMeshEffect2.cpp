@@ -25,47 +25,298 @@
 #include "dgMeshEffect.h"
 #include "dgCollisionConvexHull.h"
 
+#define DG_TETRA_ISO_SURFACE_BATCH_SIZE		1024
+#define DG_TETRA_GRID_CELLS_PER_TETRA		4
 
 
-class dgRayTrataAABBAccelerator: public dgMeshEffect::dgMeshBVH
+// uniform grid over the bounding boxes of the tetrahedra of a tetrahedra mesh, each cell lists the 
+// tetrahedra overlapping it, so locating the tetrahedron that contains a point only visits one cell.
+// the grid is read only after it is built, so it can be queried by many threads at once.
+class dgTetraGridAccelerator
 {
 	public:
-	dgRayTrataAABBAccelerator(const dgMeshEffect* const tetraMesh)
-		:dgMeshEffect::dgMeshBVH(tetraMesh)
+	class dgTetrahedra
 	{
-		Build();
-	}
+		public:
+		dgInt32 m_index[4];
+	};
 
-	dgMeshBVHNode* CreateLeafNode(dgEdge* const face, void* const userData)
+	class dgWeightsDescriptor
 	{
-		dgMemoryAllocator* const allocator = m_mesh->GetAllocator();
-		dgMeshBVHNode* const node = new (allocator)dgMeshBVHNode(m_mesh, face, userData);
+		public:
+		const dgTetraGridAccelerator* m_grid;
+		const dgBigVector* m_points;
+		dgMeshEffect::dgPointFormat::dgWeightSet* m_weights;
+		dgInt32 m_count;
+		dgInt32 m_index;
+	};
+
+	dgTetraGridAccelerator(const dgMeshEffect* const tetraMesh)
+		:m_tetras(tetraMesh->GetAllocator())
+		,m_cellStart(tetraMesh->GetAllocator())
+		,m_cellTetras(tetraMesh->GetAllocator())
+		,m_mesh(tetraMesh)
+		,m_origin(dgFloat64 (0.0f))
+		,m_invCellSize(dgFloat64 (1.0f))
+		,m_padding(dgFloat64 (0.0f))
+		,m_tetraCount(0)
+	{
+		m_size[0] = 1;
+		m_size[1] = 1;
+		m_size[2] = 1;
+
+		// each tetrahedron is a closed shell, the three faces adjacent to a face complete it
+		dgInt32 mark = tetraMesh->IncLRU();
+		dgMeshEffect::Iterator iter(*tetraMesh);
+		for (iter.Begin(); iter; iter++) {
+			dgEdge* const face = &iter.GetNode()->GetInfo();
+			if ((face->m_mark != mark) && (face->m_incidentFace > 0)) {
+				dgTetrahedra& tetra = m_tetras[m_tetraCount];
+				tetra.m_index[0] = face->m_incidentVertex;
+				tetra.m_index[1] = face->m_next->m_incidentVertex;
+				tetra.m_index[2] = face->m_prev->m_incidentVertex;
+				tetra.m_index[3] = face->m_twin->m_prev->m_incidentVertex;
+				m_tetraCount ++;
+
+				dgEdge* faceEdge = face;
+				do {
+					faceEdge->m_mark = mark;
+					dgEdge* twinFace = faceEdge->m_twin;
+					do {
+						twinFace->m_mark = mark;
+						twinFace = twinFace->m_next;
+					} while (twinFace != faceEdge->m_twin);
+					faceEdge = faceEdge->m_next;
+				} while (faceEdge != face);
+			}
+		}
+
+		if (!m_tetraCount) {
+			return;
+		}
 
-		dgInt32 mark = m_mesh->GetLRU();
+		// the cell size is the average size of a tetrahedron
+		dgFloat64 extent = dgFloat64 (0.0f);
+		dgBigVector minBox (dgFloat64 (1.0e20f));
+		dgBigVector maxBox (dgFloat64 (-1.0e20f));
+		for (dgInt32 i = 0; i < m_tetraCount; i ++) {
+			dgBigVector p0;
+			dgBigVector p1;
+			CalculateTetraBox (i, p0, p1);
+			minBox = minBox.GetMin(p0);
+			maxBox = maxBox.GetMax(p1);
+			dgBigVector size (p1 - p0);
+			extent += dgMax (size.m_x, size.m_y, size.m_z);
+		}
 
-		dgVector p0(m_mesh->GetVertex(face->m_twin->m_prev->m_incidentVertex));
-		dgVector p1(p0);
-		dgEdge* faceEdge = face;
+		dgFloat64 cellSize = dgMax (extent / m_tetraCount, dgFloat64 (1.0e-6f));
+		m_padding = cellSize * dgFloat64 (1.0e-2f);
+		minBox -= dgBigVector (m_padding);
+		maxBox += dgBigVector (m_padding);
+
+		dgInt64 cellCount = 0;
+		const dgInt64 maxCellCount = dgInt64 (m_tetraCount) * DG_TETRA_GRID_CELLS_PER_TETRA;
 		do {
-			dgEdge* twinFace = faceEdge->m_twin;
-			do {
-				twinFace->m_mark = mark;
-				twinFace = twinFace->m_next;
-			} while (twinFace != faceEdge->m_twin);
-
-			dgVector point(m_mesh->GetVertex(faceEdge->m_incidentVertex));
-			p0 = point.GetMin(p0);
-			p1 = point.GetMax(p1);
-
-			faceEdge = faceEdge->m_next;
-		} while (faceEdge != face);
-
-		dgVector padding(dgFloat32(0.01f));
-		p0 -= padding;
-		p1 += padding;
-		node->SetBox(p0, p1);
-		return node;
+			for (dgInt32 i = 0; i < 3; i ++) {
+				m_size[i] = dgInt32 (dgMin (floor ((maxBox[i] - minBox[i]) / cellSize) + dgFloat64 (1.0f), dgFloat64 (1 << 20)));
+			}
+			cellCount = dgInt64 (m_size[0]) * m_size[1] * m_size[2];
+			if (cellCount > maxCellCount) {
+				cellSize *= dgFloat64 (1.25f);
+			}
+		} while (cellCount > maxCellCount);
+
+		m_origin = minBox;
+		m_origin.m_w = dgFloat64 (0.0f);
+		m_invCellSize = dgFloat64 (1.0f) / cellSize;
+		const dgInt32 gridCellCount = dgInt32 (cellCount);
+
+		// bucket the tetrahedra by cell in two passes, first count them and then scatter them
+		m_cellStart.Resize(gridCellCount + 1);
+		dgInt32* const cellStart = &m_cellStart[0];
+		memset (cellStart, 0, (gridCellCount + 1) * sizeof (dgInt32));
+		for (dgInt32 i = 0; i < m_tetraCount; i ++) {
+			dgInt32 box0[3];
+			dgInt32 box1[3];
+			CalculateTetraCells (i, box0, box1);
+			for (dgInt32 z = box0[2]; z <= box1[2]; z ++) {
+				for (dgInt32 y = box0[1]; y <= box1[1]; y ++) {
+					for (dgInt32 x = box0[0]; x <= box1[0]; x ++) {
+						cellStart[(z * m_size[1] + y) * m_size[0] + x + 1] ++;
+					}
+				}
+			}
+		}
+
+		for (dgInt32 i = 0; i < gridCellCount; i ++) {
+			cellStart[i + 1] += cellStart[i];
+		}
+
+		dgStack<dgInt32> cursorBuffer (gridCellCount);
+		dgInt32* const cursor = &cursorBuffer[0];
+		memcpy (cursor, cellStart, gridCellCount * sizeof (dgInt32));
+		m_cellTetras.Resize(cellStart[gridCellCount] + 1);
+		dgInt32* const cellTetras = &m_cellTetras[0];
+		for (dgInt32 i = 0; i < m_tetraCount; i ++) {
+			dgInt32 box0[3];
+			dgInt32 box1[3];
+			CalculateTetraCells (i, box0, box1);
+			for (dgInt32 z = box0[2]; z <= box1[2]; z ++) {
+				for (dgInt32 y = box0[1]; y <= box1[1]; y ++) {
+					for (dgInt32 x = box0[0]; x <= box1[0]; x ++) {
+						dgInt32 cell = (z * m_size[1] + y) * m_size[0] + x;
+						cellTetras[cursor[cell]] = i;
+						cursor[cell] ++;
+					}
+				}
+			}
+		}
+	}
+
+	void CalculateTetraBox (dgInt32 tetraIndex, dgBigVector& p0, dgBigVector& p1) const
+	{
+		const dgTetrahedra& tetra = m_tetras[tetraIndex];
+		p0 = m_mesh->GetVertex(tetra.m_index[0]);
+		p1 = p0;
+		for (dgInt32 i = 1; i < 4; i ++) {
+			dgBigVector point (m_mesh->GetVertex(tetra.m_index[i]));
+			p0 = p0.GetMin(point);
+			p1 = p1.GetMax(point);
+		}
+	}
+
+	dgInt32 CalculateCell (dgFloat64 value, dgInt32 axis) const
+	{
+		dgInt32 cell = dgInt32 (floor ((value - m_origin[axis]) * m_invCellSize));
+		return dgClamp (cell, 0, m_size[axis] - 1);
+	}
+
+	void CalculateTetraCells (dgInt32 tetraIndex, dgInt32* const box0, dgInt32* const box1) const
+	{
+		dgBigVector p0;
+		dgBigVector p1;
+		CalculateTetraBox (tetraIndex, p0, p1);
+		for (dgInt32 i = 0; i < 3; i ++) {
+			box0[i] = CalculateCell (p0[i] - m_padding, i);
+			box1[i] = CalculateCell (p1[i] + m_padding, i);
+		}
+	}
+
+	// barycentric coordinates of a point, using the Cholesky factorization of the tetrahedron edges 
+	dgFloat64 CalculateBarycentric (const dgBigVector& p, dgInt32 tetraIndex, dgFloat64* const weights) const
+	{
+		const dgTetrahedra& tetra = m_tetras[tetraIndex];
+		dgBigVector q0 (m_mesh->GetVertex(tetra.m_index[0]));
+		dgBigVector q1 (m_mesh->GetVertex(tetra.m_index[1]));
+		dgBigVector q2 (m_mesh->GetVertex(tetra.m_index[2]));
+		dgBigVector q3 (m_mesh->GetVertex(tetra.m_index[3]));
+
+		const dgBigVector e10(q1 - q0);
+		const dgBigVector e20(q2 - q0);
+		const dgBigVector e30(q3 - q0);
+
+		dgAssert (e10.DotProduct4(e10).GetScalar() > dgFloat32 (0.0f));
+		const dgFloat64 d0 = sqrt(e10.DotProduct4(e10).GetScalar());
+		const dgFloat64 invd0 = dgFloat64(1.0f) / d0;
+		const dgFloat64 l10 = e20.DotProduct4(e10).GetScalar() * invd0;
+		const dgFloat64 l20 = e30.DotProduct4(e10).GetScalar() * invd0;
+
+		dgAssert ((e20.DotProduct4(e20).GetScalar() - l10 * l10) > dgFloat32 (0.0f));
+		const dgFloat64 desc11 = e20.DotProduct4(e20).GetScalar() - l10 * l10;
+
+		const dgFloat64 d1 = sqrt(desc11);
+		const dgFloat64 invd1 = dgFloat64(1.0f) / d1;
+		const dgFloat64 l21 = (e30.DotProduct4(e20).GetScalar() - l20 * l10) * invd1;
+		dgAssert (e30.DotProduct4(e30).GetScalar() - l20 * l20 - l21 * l21 > dgFloat32 (0.0f));
+		const dgFloat64 desc22 = e30.DotProduct4(e30).GetScalar() - l20 * l20 - l21 * l21;
+
+		dgBigVector p0Point(p - q0);
+		const dgFloat64 d2 = sqrt(desc22);
+		const dgFloat64 invd2 = dgFloat64(1.0f) / d2;
+
+		const dgFloat64 b0 = e10.DotProduct4(p0Point).GetScalar();
+		const dgFloat64 b1 = e20.DotProduct4(p0Point).GetScalar();
+		const dgFloat64 b2 = e30.DotProduct4(p0Point).GetScalar();
+
+		dgFloat64 u1 = b0 * invd0;
+		dgFloat64 u2 = (b1 - l10 * u1) * invd1;
+		dgFloat64 u3 = (b2 - l20 * u1 - l21 * u2) * invd2;
+
+		u3 = u3 * invd2;
+		u2 = (u2 - l21 * u3) * invd1;
+		u1 = (u1 - l10 * u2 - l20 * u3) * invd0;
+
+		weights[0] = dgFloat64 (1.0f) - u1 - u2 - u3;
+		weights[1] = u1;
+		weights[2] = u2;
+		weights[3] = u3;
+		return dgMin (dgMin (weights[0], weights[1]), dgMin (weights[2], weights[3]));
+	}
+
+	// the weights are the barycentric coordinates of the point in the first tetrahedron of its cell that 
+	// contains it, a point that is not inside any tetrahedron takes the tetrahedron closest to contain it.
+	void CalculateWeights (const dgBigVector& point, dgMeshEffect::dgPointFormat::dgWeightSet& weightSet) const
+	{
+		dgInt32 bestTetra = -1;
+		dgFloat64 bestWeight = dgFloat64 (-1.0e20f);
+		dgFloat64 bestWeights[4];
+
+		if (m_tetraCount) {
+			const dgInt32 cell = (CalculateCell (point.m_z, 2) * m_size[1] + CalculateCell (point.m_y, 1)) * m_size[0] + CalculateCell (point.m_x, 0);
+			const dgInt32 start = m_cellStart[cell];
+			const dgInt32 count = m_cellStart[cell + 1] - start;
+			for (dgInt32 i = 0; (i < count) && (bestWeight < dgFloat64 (0.0f)); i ++) {
+				dgFloat64 weights[4];
+				const dgInt32 tetraIndex = m_cellTetras[start + i];
+				dgFloat64 weight = CalculateBarycentric (point, tetraIndex, weights);
+				if (weight > bestWeight) {
+					bestTetra = tetraIndex;
+					bestWeight = weight;
+					memcpy (bestWeights, weights, sizeof (bestWeights));
+				}
+			}
+
+			if (!count) {
+				for (dgInt32 i = 0; (i < m_tetraCount) && (bestWeight < dgFloat64 (0.0f)); i ++) {
+					dgFloat64 weights[4];
+					dgFloat64 weight = CalculateBarycentric (point, i, weights);
+					if (weight > bestWeight) {
+						bestTetra = i;
+						bestWeight = weight;
+						memcpy (bestWeights, weights, sizeof (bestWeights));
+					}
+				}
+			}
+		}
+
+		if (bestTetra >= 0) {
+			const dgTetrahedra& tetra = m_tetras[bestTetra];
+			for (dgInt32 i = 0; i < 4; i ++) {
+				weightSet.m_weightPair[i].m_controlIndex = tetra.m_index[i];
+				weightSet.m_weightPair[i].m_weight = dgFloat32 (bestWeights[i]);
+			}
+		} else {
+			memset (&weightSet, 0, sizeof (weightSet));
+		}
+	}
+
+	static void CalculateWeightsKernel (void* const context, void* const unused, dgInt32 threadID)
+	{
+		dgWeightsDescriptor* const descriptor = (dgWeightsDescriptor*) context;
+		for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_count; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+			descriptor->m_grid->CalculateWeights (descriptor->m_points[i], descriptor->m_weights[i]);
+		}
 	}
+
+	dgArray<dgTetrahedra> m_tetras;
+	dgArray<dgInt32> m_cellStart;
+	dgArray<dgInt32> m_cellTetras;
+	const dgMeshEffect* m_mesh;
+	dgBigVector m_origin;
+	dgFloat64 m_invCellSize;
+	dgFloat64 m_padding;
+	dgInt32 m_tetraCount;
+	dgInt32 m_size[3];
 };
 
 
@@ -234,7 +485,7 @@ class dgTetraIsoSufaceStuffing
 			return node;
 		}
 
-		bool DoesTetrahedrumHasInsidePoints (const dgArray<dgBigVector>& points, const dgTetrahedra& tetra) const 
+		bool DoesTetrahedrumHasInsidePoints (const dgArray<dgBigVector>& points, const dgTetrahedra& tetra, dgMemoryAllocator* const allocator) const 
 		{
 			dgBigVector box0(dgFloat64( 1.0e10f));
 			dgBigVector box1(dgFloat64(-1.0e10f));
@@ -247,7 +498,7 @@ class dgTetraIsoSufaceStuffing
 			box0 -= padding;
 			box1 += padding;
 
-			dgList<dgMeshBVH::dgMeshBVHNode*> overlapNodes(m_mesh->GetAllocator());
+			dgList<dgMeshBVH::dgMeshBVHNode*> overlapNodes(allocator);
 			GetOverlapNodes(overlapNodes, box0, box1);
 			if (overlapNodes.GetCount()) {
 				dgBigVector p0(points[tetra[0]]);
@@ -480,7 +731,41 @@ class dgTetraIsoSufaceStuffing
 		dgFloat64 m_diameter;
 	};
 
-	dgTetraIsoSufaceStuffing(const dgMeshEffect* const mesh, dgFloat64 cellSize)
+	class dgVertexSideDescriptor
+	{
+		public:
+		const dgBigVector* m_points;
+		const dgRayTraceAccelerator* m_rayAccelerator;
+		dgVertexSign* m_vertexSide;
+		dgInt32 m_count;
+		dgInt32 m_index;
+	};
+
+	class dgInsideTetrasDescriptor
+	{
+		public:
+		const dgTetraIsoSufaceStuffing* m_stuffing;
+		const dgTetrahedra* m_tetras;
+		const dgVertexSign* m_vertexSigns;
+		const dgClosePointsAccelerator* m_closePoint;
+		dgInt8* m_isInside;
+		dgMemoryAllocator* m_allocators[DG_MAX_THREADS_HIVE_COUNT];
+		dgInt32 m_count;
+		dgInt32 m_index;
+	};
+
+	class dgTetraMeshesDescriptor
+	{
+		public:
+		const dgTetraIsoSufaceStuffing* m_stuffing;
+		dgMeshEffect** m_meshes;
+		dgMemoryAllocator* m_allocators[DG_MAX_THREADS_HIVE_COUNT];
+		dgInt32 m_base;
+		dgInt32 m_count;
+		dgInt32 m_index;
+	};
+
+	dgTetraIsoSufaceStuffing(const dgMeshEffect* const mesh, dgFloat64 cellSize, dgThreadHive* const threadPool)
 		:m_points(mesh->GetAllocator())
 		,m_tetraList(mesh->GetAllocator())
 		,m_pointCount(0)
@@ -495,8 +780,8 @@ class dgTetraIsoSufaceStuffing
 		dgRayTraceAccelerator rayAccelerator (mesh, gridDim.m_diameter);
 		
 		PopulateGridPoints (gridDim);
-		CalculateVertexSide (vertexSide, rayAccelerator);
-		BuildTetraGraph (gridDim, vertexSide, closePointaAccelerator, tetraGraph);
+		CalculateVertexSide (vertexSide, rayAccelerator, threadPool);
+		BuildTetraGraph (gridDim, vertexSide, closePointaAccelerator, tetraGraph, threadPool);
 		//CalculateEdgeCuts (tetraEdgeCuts, tetraGraph, vertexSide, rayAccelerator);
 		//SnapClosePoints (tetraEdgeCuts, tetraGraph, vertexSide, rayAccelerator);
 	}
@@ -567,11 +852,34 @@ class dgTetraIsoSufaceStuffing
 		}
 	}
 
-	void CalculateVertexSide (dgArray<dgVertexSign>& vertexSide, const dgRayTraceAccelerator& rayAccelerator)
+	void CalculateVertexSide (dgArray<dgVertexSign>& vertexSide, const dgRayTraceAccelerator& rayAccelerator, dgThreadHive* const threadPool)
 	{
 		vertexSide.Resize(m_pointCount);
-		for (dgInt32 i = 0; i < m_pointCount; i ++) {
-			vertexSide[i] = rayAccelerator.CalculateVertexSide (m_points[i]);
+		const dgInt32 threadCount = threadPool ? threadPool->GetThreadCount() : 1;
+		if (threadCount <= 1) {
+			for (dgInt32 i = 0; i < m_pointCount; i ++) {
+				vertexSide[i] = rayAccelerator.CalculateVertexSide (m_points[i]);
+			}
+		} else {
+			// each grid point casts its own rays, the accelerator is only read 
+			dgVertexSideDescriptor descriptor;
+			descriptor.m_points = &m_points[0];
+			descriptor.m_rayAccelerator = &rayAccelerator;
+			descriptor.m_vertexSide = &vertexSide[0];
+			descriptor.m_count = m_pointCount;
+			descriptor.m_index = 0;
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				threadPool->QueueJob (CalculateVertexSideKernel, &descriptor, NULL, "dgTetraIsoSufaceStuffing::CalculateVertexSide");
+			}
+			threadPool->SynchronizationBarrier();
+		}
+	}
+
+	static void CalculateVertexSideKernel (void* const context, void* const unused, dgInt32 threadID)
+	{
+		dgVertexSideDescriptor* const descriptor = (dgVertexSideDescriptor*) context;
+		for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_count; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+			descriptor->m_vertexSide[i] = descriptor->m_rayAccelerator->CalculateVertexSide (descriptor->m_points[i]);
 		}
 	}
 
@@ -628,7 +936,7 @@ class dgTetraIsoSufaceStuffing
 		}
 	}
 
-	void AddTetra(dgArray<dgTetraToVertexNode>& graph, const dgTetrahedra& tetra, const dgArray<dgVertexSign>& vertexSigns, const dgClosePointsAccelerator& closePoint)
+	bool HasInsidePoints(const dgTetrahedra& tetra, const dgVertexSign* const vertexSigns, const dgClosePointsAccelerator& closePoint, dgMemoryAllocator* const allocator) const
 	{
 		dgAssert(CalculateVolume(tetra) > dgFloat64(0.0f));
 		bool hasInsizePoints = false;
@@ -636,30 +944,43 @@ class dgTetraIsoSufaceStuffing
 		hasInsizePoints = hasInsizePoints || (vertexSigns[tetra[1]] == m_inside);
 		hasInsizePoints = hasInsizePoints || (vertexSigns[tetra[2]] == m_inside);
 		hasInsizePoints = hasInsizePoints || (vertexSigns[tetra[3]] == m_inside);
-		hasInsizePoints = hasInsizePoints || closePoint.DoesTetrahedrumHasInsidePoints(m_points, tetra);
+		hasInsizePoints = hasInsizePoints || closePoint.DoesTetrahedrumHasInsidePoints(m_points, tetra, allocator);
+		return hasInsizePoints;
+	}
 
-		if (hasInsizePoints) {
-			m_tetraList[m_tetraCount] = tetra;
-			dgTetrahedra& tetraEntry = m_tetraList[m_tetraCount];
-			for (dgInt32 i = 0; i < 4; i ++) {
-				dgInt32 vertexIndex = tetra[i];
-				tetraEntry.PushBack(vertexIndex);
-				graph[vertexIndex].PushBack(m_tetraCount);
-			}
-			m_tetraCount ++;
+	static void CalculateInsideTetrasKernel (void* const context, void* const unused, dgInt32 threadID)
+	{
+		dgInsideTetrasDescriptor* const descriptor = (dgInsideTetrasDescriptor*) context;
+		dgMemoryAllocator* const allocator = descriptor->m_allocators[threadID];
+		for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_count; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+			descriptor->m_isInside[i] = descriptor->m_stuffing->HasInsidePoints (descriptor->m_tetras[i], descriptor->m_vertexSigns, *descriptor->m_closePoint, allocator) ? 1 : 0;
 		}
 	}
 
-	void BuildTetraGraph(const dgGridDimension& gridDimension, const dgArray<dgVertexSign>& vertexSigns, const dgClosePointsAccelerator& closePoint, dgArray<dgTetraToVertexNode>& graph)
+	void AddTetra(dgArray<dgTetraToVertexNode>& graph, const dgTetrahedra& tetra)
+	{
+		m_tetraList[m_tetraCount] = tetra;
+		dgTetrahedra& tetraEntry = m_tetraList[m_tetraCount];
+		for (dgInt32 i = 0; i < 4; i ++) {
+			dgInt32 vertexIndex = tetra[i];
+			tetraEntry.PushBack(vertexIndex);
+			graph[vertexIndex].PushBack(m_tetraCount);
+		}
+		m_tetraCount ++;
+	}
+
+	void BuildTetraGraph(const dgGridDimension& gridDimension, const dgArray<dgVertexSign>& vertexSigns, const dgClosePointsAccelerator& closePoint, dgArray<dgTetraToVertexNode>& graph, dgThreadHive* const threadPool)
 	{
 		graph.Resize(m_pointCount);
 		for (dgInt32 i = 0; i < m_pointCount; i ++) {
 			graph[i] = dgTetraToVertexNode();
 		}
 
-		dgDelaunayTetrahedralization delaunayTetrahedras(m_points.GetAllocator(), &m_points[0].m_x, m_pointCount, sizeof (dgBigVector), dgFloat32(0.0f));
+		dgDelaunayTetrahedralization delaunayTetrahedras(m_points.GetAllocator(), &m_points[0].m_x, m_pointCount, sizeof (dgBigVector));
 		delaunayTetrahedras.RemoveUpperHull();
 
+		dgInt32 tetraCount = 0;
+		dgStack<dgTetrahedra> tetras (delaunayTetrahedras.GetCount() + 1);
 		for (dgDelaunayTetrahedralization::dgListNode* node = delaunayTetrahedras.GetFirst(); node; node = node->GetNext()) {
 			dgTetrahedra stuffingTetra;
 			dgConvexHull4dTetraherum& delaunayTetra = node->GetInfo();
@@ -671,7 +992,43 @@ class dgTetraIsoSufaceStuffing
 			if (volume < dgFloat64 (0.0f)) {
 				dgSwap(stuffingTetra[0], stuffingTetra[1]);
 			}
-			AddTetra(graph, stuffingTetra, vertexSigns, closePoint);
+			tetras[tetraCount] = stuffingTetra;
+			tetraCount ++;
+		}
+
+		dgStack<dgInt8> isInside (tetraCount + 1);
+		const dgInt32 threadCount = threadPool ? threadPool->GetThreadCount() : 1;
+		if (threadCount <= 1) {
+			for (dgInt32 i = 0; i < tetraCount; i ++) {
+				isInside[i] = HasInsidePoints(tetras[i], &vertexSigns[0], closePoint, m_points.GetAllocator()) ? 1 : 0;
+			}
+		} else {
+			// the memory pools are not thread safe, each worker queries the close points with its own allocator
+			dgInsideTetrasDescriptor descriptor;
+			descriptor.m_stuffing = this;
+			descriptor.m_tetras = &tetras[0];
+			descriptor.m_vertexSigns = &vertexSigns[0];
+			descriptor.m_closePoint = &closePoint;
+			descriptor.m_isInside = &isInside[0];
+			descriptor.m_count = tetraCount;
+			descriptor.m_index = 0;
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				descriptor.m_allocators[i] = new dgMemoryAllocator();
+			}
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				threadPool->QueueJob (CalculateInsideTetrasKernel, &descriptor, NULL, "dgTetraIsoSufaceStuffing::BuildTetraGraph");
+			}
+			threadPool->SynchronizationBarrier();
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				delete descriptor.m_allocators[i];
+			}
+		}
+
+		// the tetrahedra are added in the delaunay order, so the graph does not depend on the thread count
+		for (dgInt32 i = 0; i < tetraCount; i ++) {
+			if (isInside[i]) {
+				AddTetra(graph, tetras[i]);
+			}
 		}
 
 		
@@ -755,6 +1112,31 @@ class dgTetraIsoSufaceStuffing
 */
 	}
 
+	dgMeshEffect* CreateTetraMesh(dgMemoryAllocator* const allocator, dgInt32 tetraIndex) const
+	{
+		dgBigVector pointArray[4];
+		const dgTetrahedra& tetra = m_tetraList[tetraIndex];
+		for (dgInt32 i = 0; i < 4; i ++) {
+			pointArray[i] = m_points[tetra[i]];
+		}
+		dgMeshEffect* const convexMesh = new (allocator) dgMeshEffect(allocator, &pointArray[0].m_x, 4, sizeof (dgBigVector), dgFloat64(0.0f));
+		//dgAssert (convexMesh->GetCount());
+		//convexMesh->CalculateNormals(dgFloat32 (30.0f * dgDEG2RAD));
+		for (dgInt32 i = 0; i < convexMesh->m_points.m_vertex.m_count; i++) {
+			convexMesh->m_points.m_layers[i] = tetraIndex;
+		}
+		return convexMesh;
+	}
+
+	static void CreateTetraMeshesKernel (void* const context, void* const unused, dgInt32 threadID)
+	{
+		dgTetraMeshesDescriptor* const descriptor = (dgTetraMeshesDescriptor*) context;
+		dgMemoryAllocator* const allocator = descriptor->m_allocators[threadID];
+		for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_count; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+			descriptor->m_meshes[i] = descriptor->m_stuffing->CreateTetraMesh (allocator, descriptor->m_base + i);
+		}
+	}
+
 	dgFloat64 CalculateVolume(const dgTetrahedra& tetra) const
 	{
 		const dgBigVector& p0 = m_points[tetra[0]];
@@ -935,7 +1317,25 @@ void dgMeshEffect::LoadTetraMesh (const char* const filename)
 	}
 }
 
-dgMeshEffect* dgMeshEffect::CreateVoronoiConvexDecomposition (dgMemoryAllocator* const allocator, dgInt32 pointCount, dgInt32 pointStrideInBytes, const dgFloat32* const pointCloud, dgInt32 materialId, const dgMatrix& textureProjectionMatrix)
+class dgFracturePatternCellsDescriptor
+{
+	public:
+	const dgBigVector* m_voronoiPoints;
+	const dgList<dgInt32>** m_cellTetras;
+	const dgMatrix* m_textureProjectionMatrix;
+	dgMeshEffect** m_cells;
+	dgMemoryAllocator* m_allocators[DG_MAX_THREADS_HIVE_COUNT];
+	dgInt32 m_materialId;
+	dgInt32 m_count;
+	dgInt32 m_index;
+};
+
+dgMeshEffectFracturePattern::dgMeshEffectFracturePattern (dgMemoryAllocator* const allocator, dgInt32 pointCount, dgInt32 pointStrideInBytes, const dgFloat32* const pointCloud, dgInt32 materialId, const dgMatrix& textureProjectionMatrix, dgThreadHive* const threadPool)
+	:m_allocator(allocator)
+	,m_cells(allocator)
+	,m_neighborsStart(allocator)
+	,m_neighbors(allocator)
+	,m_cellCount(0)
 {
 	dgStack<dgBigVector> buffer(pointCount + 16);
 	dgBigVector* const pool = &buffer[0];
@@ -990,21 +1390,22 @@ dgMeshEffect* dgMeshEffect::CreateVoronoiConvexDecomposition (dgMemoryAllocator*
 	pool[count + 7] = dgBigVector ( pMax.m_x, pMax.m_y, pMax.m_z, dgFloat64 (0.0f));
 	count += 8; 
 
-	dgDelaunayTetrahedralization delaunayTetrahedras (allocator, &pool[0].m_x, count, sizeof (dgBigVector), dgFloat32 (0.0f));
+	dgDelaunayTetrahedralization delaunayTetrahedras (allocator, &pool[0].m_x, count, sizeof (dgBigVector));
 	delaunayTetrahedras.RemoveUpperHull ();
 
-//	delaunayTetrahedras.Save("xxx0.txt");
 	dgInt32 tetraCount = delaunayTetrahedras.GetCount();
 	dgStack<dgBigVector> voronoiPoints(tetraCount + 32);
-	dgStack<dgDelaunayTetrahedralization::dgListNode*> tetradrumNode(tetraCount);
 	dgTree<dgList<dgInt32>, dgInt32> delaunayNodes (allocator);	
 
+	// each delaunay edge between two interior points is a face shared by two voronoi cells
+	dgInt32 edgeCount = 0;
+	dgStack<dgCellEdge> delaunayEdges (tetraCount * 6 + 1);
+
 	dgInt32 index = 0;
 	const dgConvexHull4dVector* const convexHulPoints = delaunayTetrahedras.GetHullVertexArray();
 	for (dgDelaunayTetrahedralization::dgListNode* node = delaunayTetrahedras.GetFirst(); node; node = node->GetNext()) {
 		dgConvexHull4dTetraherum& tetra = node->GetInfo();
 		voronoiPoints[index] = tetra.CircumSphereCenter (convexHulPoints);
-		tetradrumNode[index] = node;
 
 		for (dgInt32 i = 0; i < 4; i ++) {
 			dgTree<dgList<dgInt32>, dgInt32>::dgTreeNode* header = delaunayNodes.Find(tetra.m_faces[0].m_index[i]);
@@ -1013,54 +1414,225 @@ dgMeshEffect* dgMeshEffect::CreateVoronoiConvexDecomposition (dgMemoryAllocator*
 				header = delaunayNodes.Insert(list, tetra.m_faces[0].m_index[i]);
 			}
 			header->GetInfo().Append (index);
+
+			for (dgInt32 j = i + 1; j < 4; j ++) {
+				dgInt32 key0 = tetra.m_faces[0].m_index[i];
+				dgInt32 key1 = tetra.m_faces[0].m_index[j];
+				if ((key0 < guardVertexKey) && (key1 < guardVertexKey)) {
+					delaunayEdges[edgeCount].m_cell0 = dgMin (key0, key1);
+					delaunayEdges[edgeCount].m_cell1 = dgMax (key0, key1);
+					edgeCount ++;
+				}
+			}
 		}
 		index ++;
 	}
 
-	const dgFloat32 normalAngleInRadians = dgFloat32 (30.0f * dgDEG2RAD);
-	dgMeshEffect* const voronoiPartition = new (allocator) dgMeshEffect (allocator);
-	voronoiPartition->BeginBuild();
-	dgInt32 layer = 0;
+	// collect the cells in key order, so that the layers do not depend on the number of threads
+	dgInt32 cellCount = 0;
+	dgStack<dgInt32> cellKeys (delaunayNodes.GetCount() + 1);
+	dgStack<const dgList<dgInt32>*> cellTetras (delaunayNodes.GetCount() + 1);
+	dgStack<dgMeshEffect*> cells (delaunayNodes.GetCount() + 1);
 	dgTree<dgList<dgInt32>, dgInt32>::Iterator iter (delaunayNodes);
 	for (iter.Begin(); iter; iter ++) {
 		dgTree<dgList<dgInt32>, dgInt32>::dgTreeNode* const nodeNode = iter.GetNode();
-		const dgList<dgInt32>& list = nodeNode->GetInfo();
 		dgInt32 key = nodeNode->GetKey();
-
 		if (key < guardVertexKey) {
-			dgBigVector pointArray[512];
-			dgInt32 indexArray[512];
-			
-			dgInt32 count1 = 0;
-			for (dgList<dgInt32>::dgListNode* ptr = list.GetFirst(); ptr; ptr = ptr->GetNext()) {
-				dgInt32 i = ptr->GetInfo();
-				pointArray[count1] = voronoiPoints[i];
-				count1 ++;
-				dgAssert (count1 < dgInt32 (sizeof (pointArray) / sizeof (pointArray[0])));
+			cellKeys[cellCount] = key;
+			cellTetras[cellCount] = &nodeNode->GetInfo();
+			cells[cellCount] = NULL;
+			cellCount ++;
+		}
+	}
+
+	const dgInt32 threadCount = threadPool ? threadPool->GetThreadCount() : 1;
+	if ((threadCount <= 1) || (cellCount <= 1)) {
+		for (dgInt32 i = 0; i < cellCount; i ++) {
+			cells[i] = CreateCell (allocator, &voronoiPoints[0], *cellTetras[i], materialId, textureProjectionMatrix);
+		}
+	} else {
+		// the memory pools are not thread safe, each worker builds its cells with its own allocator
+		dgFracturePatternCellsDescriptor descriptor;
+		descriptor.m_voronoiPoints = &voronoiPoints[0];
+		descriptor.m_cellTetras = &cellTetras[0];
+		descriptor.m_textureProjectionMatrix = &textureProjectionMatrix;
+		descriptor.m_cells = &cells[0];
+		descriptor.m_materialId = materialId;
+		descriptor.m_count = cellCount;
+		descriptor.m_index = 0;
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			descriptor.m_allocators[i] = new dgMemoryAllocator();
+		}
+
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			threadPool->QueueJob (CreateCellsKernel, &descriptor, NULL, "dgMeshEffectFracturePattern::CreateCells");
+		}
+		threadPool->SynchronizationBarrier();
+
+		// move the cells to the allocator of the pattern
+		for (dgInt32 i = 0; i < cellCount; i ++) {
+			dgMeshEffect* const cell = cells[i];
+			if (cell) {
+				cells[i] = new (allocator) dgMeshEffect (allocator, *cell);
+				delete cell;
 			}
+		}
 
-			count1 = dgVertexListToIndexList(&pointArray[0].m_x, sizeof (dgBigVector), 3, count1, &indexArray[0], dgFloat64 (1.0e-3f));	
-			if (count1 >= 4) {
-				dgMeshEffect convexMesh (allocator, &pointArray[0].m_x, count1, sizeof (dgBigVector), dgFloat64 (0.0f));
-				if (convexMesh.GetCount()) {
-					convexMesh.CalculateNormals(normalAngleInRadians);
-					convexMesh.UniformBoxMapping (materialId, textureProjectionMatrix);
-					for (dgInt32 i = 0; i < convexMesh.m_points.m_vertex.m_count; i ++) {
-						convexMesh.m_points.m_layers[i] = layer;
-					}
-					voronoiPartition->MergeFaces(&convexMesh);
-					layer ++;
-				}
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			delete descriptor.m_allocators[i];
+		}
+	}
+
+	// remove the empty cells and map the point keys to the cell index
+	dgStack<dgInt32> keyToCell (guardVertexKey + 1);
+	for (dgInt32 i = 0; i < guardVertexKey; i ++) {
+		keyToCell[i] = -1;
+	}
+	for (dgInt32 i = 0; i < cellCount; i ++) {
+		dgMeshEffect* const cell = cells[i];
+		if (cell) {
+			for (dgInt32 j = 0; j < cell->m_points.m_vertex.m_count; j ++) {
+				cell->m_points.m_layers[j] = m_cellCount;
 			}
+			keyToCell[cellKeys[i]] = m_cellCount;
+			m_cells[m_cellCount] = cell;
+			m_cellCount ++;
 		}
 	}
+
+	dgInt32 validEdgeCount = 0;
+	for (dgInt32 i = 0; i < edgeCount; i ++) {
+		dgInt32 cell0 = keyToCell[delaunayEdges[i].m_cell0];
+		dgInt32 cell1 = keyToCell[delaunayEdges[i].m_cell1];
+		if ((cell0 >= 0) && (cell1 >= 0)) {
+			delaunayEdges[validEdgeCount].m_cell0 = cell0;
+			delaunayEdges[validEdgeCount].m_cell1 = cell1;
+			validEdgeCount ++;
+		}
+	}
+	dgSort (&delaunayEdges[0], validEdgeCount, CompareCellEdges);
+
+	// build the adjacency lists, since the edges are sorted each list comes out sorted too
+	for (dgInt32 i = 0; i <= m_cellCount; i ++) {
+		m_neighborsStart[i] = 0;
+	}
+	dgInt32 uniqueCount = 0;
+	for (dgInt32 i = 0; i < validEdgeCount; i ++) {
+		if (!uniqueCount || CompareCellEdges (&delaunayEdges[uniqueCount - 1], &delaunayEdges[i], NULL)) {
+			delaunayEdges[uniqueCount] = delaunayEdges[i];
+			m_neighborsStart[delaunayEdges[i].m_cell0 + 1] += 1;
+			m_neighborsStart[delaunayEdges[i].m_cell1 + 1] += 1;
+			uniqueCount ++;
+		}
+	}
+	for (dgInt32 i = 0; i < m_cellCount; i ++) {
+		m_neighborsStart[i + 1] += m_neighborsStart[i];
+	}
+
+	dgStack<dgInt32> neighborsCount (m_cellCount + 1);
+	for (dgInt32 i = 0; i < m_cellCount; i ++) {
+		neighborsCount[i] = m_neighborsStart[i];
+	}
+	m_neighbors.Resize (uniqueCount * 2 + 1);
+	for (dgInt32 i = 0; i < uniqueCount; i ++) {
+		dgInt32 cell0 = delaunayEdges[i].m_cell0;
+		dgInt32 cell1 = delaunayEdges[i].m_cell1;
+		m_neighbors[neighborsCount[cell0]] = cell1;
+		m_neighbors[neighborsCount[cell1]] = cell0;
+		neighborsCount[cell0] ++;
+		neighborsCount[cell1] ++;
+	}
+}
+
+dgMeshEffectFracturePattern::~dgMeshEffectFracturePattern ()
+{
+	for (dgInt32 i = 0; i < m_cellCount; i ++) {
+		delete m_cells[i];
+	}
+}
+
+dgInt32 dgMeshEffectFracturePattern::CompareCellEdges (const dgCellEdge* const edgeA, const dgCellEdge* const edgeB, void* const context)
+{
+	if (edgeA->m_cell0 < edgeB->m_cell0) {
+		return -1;
+	} else if (edgeA->m_cell0 > edgeB->m_cell0) {
+		return 1;
+	} else if (edgeA->m_cell1 < edgeB->m_cell1) {
+		return -1;
+	} else if (edgeA->m_cell1 > edgeB->m_cell1) {
+		return 1;
+	}
+	return 0;
+}
+
+dgMeshEffect* dgMeshEffectFracturePattern::CreateCell (dgMemoryAllocator* const allocator, const dgBigVector* const voronoiPoints, const dgList<dgInt32>& tetras, dgInt32 materialId, const dgMatrix& textureProjectionMatrix)
+{
+	dgBigVector pointArray[512];
+	dgInt32 indexArray[512];
+
+	dgInt32 count = 0;
+	for (dgList<dgInt32>::dgListNode* ptr = tetras.GetFirst(); ptr; ptr = ptr->GetNext()) {
+		dgInt32 i = ptr->GetInfo();
+		pointArray[count] = voronoiPoints[i];
+		count ++;
+		dgAssert (count < dgInt32 (sizeof (pointArray) / sizeof (pointArray[0])));
+	}
+
+	count = dgVertexListToIndexList(&pointArray[0].m_x, sizeof (dgBigVector), 3, count, &indexArray[0], dgFloat64 (1.0e-3f));	
+	if (count >= 4) {
+		const dgFloat32 normalAngleInRadians = dgFloat32 (30.0f * dgDEG2RAD);
+		dgMeshEffect* const convexMesh = new (allocator) dgMeshEffect (allocator, &pointArray[0].m_x, count, sizeof (dgBigVector), dgFloat64 (0.0f));
+		if (convexMesh->GetCount()) {
+			convexMesh->CalculateNormals(normalAngleInRadians);
+			convexMesh->UniformBoxMapping (materialId, textureProjectionMatrix);
+			return convexMesh;
+		}
+		delete convexMesh;
+	}
+	return NULL;
+}
+
+void dgMeshEffectFracturePattern::CreateCellsKernel (void* const context, void* const unused, dgInt32 threadID)
+{
+	dgFracturePatternCellsDescriptor* const descriptor = (dgFracturePatternCellsDescriptor*) context;
+	dgMemoryAllocator* const allocator = descriptor->m_allocators[threadID];
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_count; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+		descriptor->m_cells[i] = CreateCell (allocator, descriptor->m_voronoiPoints, *descriptor->m_cellTetras[i], descriptor->m_materialId, *descriptor->m_textureProjectionMatrix);
+	}
+}
+
+void dgMeshEffectFracturePattern::Apply (const dgMeshEffect* const solidMesh, const dgMatrix& matrix, dgMeshEffect** const pieces, dgThreadHive* const threadPool) const
+{
+	dgMemoryAllocator* const allocator = solidMesh->GetAllocator();
+	dgStack<dgMeshEffect*> cells (m_cellCount + 1);
+	for (dgInt32 i = 0; i < m_cellCount; i ++) {
+		cells[i] = new (allocator) dgMeshEffect (allocator, *m_cells[i]);
+		cells[i]->ApplyTransform (matrix);
+	}
+
+	solidMesh->ConvexMeshIntersection (m_cellCount, &cells[0], pieces, threadPool);
+
+	for (dgInt32 i = 0; i < m_cellCount; i ++) {
+		delete cells[i];
+	}
+}
+
+dgMeshEffect* dgMeshEffect::CreateVoronoiConvexDecomposition (dgMemoryAllocator* const allocator, dgInt32 pointCount, dgInt32 pointStrideInBytes, const dgFloat32* const pointCloud, dgInt32 materialId, const dgMatrix& textureProjectionMatrix, dgThreadHive* const threadPool)
+{
+	dgMeshEffectFracturePattern pattern (allocator, pointCount, pointStrideInBytes, pointCloud, materialId, textureProjectionMatrix, threadPool);
+
+	dgMeshEffect* const voronoiPartition = new (allocator) dgMeshEffect (allocator);
+	voronoiPartition->BeginBuild();
+	for (dgInt32 i = 0; i < pattern.GetCellCount(); i ++) {
+		voronoiPartition->MergeFaces(pattern.GetCell(i));
+	}
 	voronoiPartition->EndBuild(dgFloat64 (1.0e-8f), false);
 	//voronoiPartition->SaveOFF("xxx0.off");
 	return voronoiPartition;
 }
 
 
-dgMeshEffect* dgMeshEffect::CreateTetrahedraIsoSurface() const
+dgMeshEffect* dgMeshEffect::CreateTetrahedraIsoSurface(dgThreadHive* const threadPool) const
 {
 /*
 dgMeshEffect xxxx  (GetAllocator());
@@ -1092,29 +1664,49 @@ xxxx.EndBuild(dgFloat64(1.0e-8f), false);
 */
 
 
-	dgTetraIsoSufaceStuffing tetraIsoStuffing (this, dgFloat64(0.125f));
+	dgTetraIsoSufaceStuffing tetraIsoStuffing (this, dgFloat64(0.125f), threadPool);
 
 	dgMeshEffect* delaunayPartition = NULL;
 	if (tetraIsoStuffing.m_tetraCount) {
 		dgMemoryAllocator* const allocator = GetAllocator();
 		delaunayPartition = new (allocator) dgMeshEffect (allocator);
 		delaunayPartition->BeginBuild();
-		dgInt32 layer = 0;
-		dgBigVector pointArray[4];
-		for (dgInt32 j = 0; j < tetraIsoStuffing.m_tetraCount; j ++) {
-			dgTetraIsoSufaceStuffing::dgTetrahedra& tetra = tetraIsoStuffing.m_tetraList[j];
-			for (dgInt32 i = 0; i < 4; i ++) {
-				dgInt32 index = tetra[i];
-				pointArray[i] = tetraIsoStuffing.m_points[index];
+		const dgInt32 threadCount = threadPool ? threadPool->GetThreadCount() : 1;
+		if (threadCount <= 1) {
+			for (dgInt32 j = 0; j < tetraIsoStuffing.m_tetraCount; j ++) {
+				dgMeshEffect* const convexMesh = tetraIsoStuffing.CreateTetraMesh (allocator, j);
+				delaunayPartition->MergeFaces(convexMesh);
+				delete convexMesh;
 			}
-			dgMeshEffect convexMesh(allocator, &pointArray[0].m_x, 4, sizeof (dgBigVector), dgFloat64(0.0f));
-			//dgAssert (convexMesh.GetCount());
-			//convexMesh.CalculateNormals(dgFloat32 (30.0f * dgDEG2RAD));
-			for (dgInt32 i = 0; i < convexMesh.m_points.m_vertex.m_count; i++) {
-				convexMesh.m_points.m_layers[i] = layer;
+		} else {
+			// the memory pools are not thread safe, the workers build the meshes of a batch of tetrahedra 
+			// with their own allocators, and the batch is merged in order, the same as the serial loop
+			dgStack<dgMeshEffect*> meshes (DG_TETRA_ISO_SURFACE_BATCH_SIZE);
+			dgTetraIsoSufaceStuffing::dgTetraMeshesDescriptor descriptor;
+			descriptor.m_stuffing = &tetraIsoStuffing;
+			descriptor.m_meshes = &meshes[0];
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				descriptor.m_allocators[i] = new dgMemoryAllocator();
+			}
+
+			for (dgInt32 base = 0; base < tetraIsoStuffing.m_tetraCount; base += DG_TETRA_ISO_SURFACE_BATCH_SIZE) {
+				descriptor.m_base = base;
+				descriptor.m_count = dgMin (tetraIsoStuffing.m_tetraCount - base, DG_TETRA_ISO_SURFACE_BATCH_SIZE);
+				descriptor.m_index = 0;
+				for (dgInt32 i = 0; i < threadCount; i ++) {
+					threadPool->QueueJob (dgTetraIsoSufaceStuffing::CreateTetraMeshesKernel, &descriptor, NULL, "dgMeshEffect::CreateTetrahedraIsoSurface");
+				}
+				threadPool->SynchronizationBarrier();
+
+				for (dgInt32 i = 0; i < descriptor.m_count; i ++) {
+					delaunayPartition->MergeFaces(meshes[i]);
+					delete meshes[i];
+				}
+			}
+
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				delete descriptor.m_allocators[i];
 			}
-			delaunayPartition->MergeFaces(&convexMesh);
-			layer++;
 		}
 		delaunayPartition->EndBuild(dgFloat64(1.0e-8f), false);
 	}
@@ -1123,97 +1715,28 @@ xxxx.EndBuild(dgFloat64(1.0e-8f), false);
 }
 
 
-void dgMeshEffect::CreateTetrahedraLinearBlendSkinWeightsChannel (const dgMeshEffect* const tetrahedraMesh)
+void dgMeshEffect::CreateTetrahedraLinearBlendSkinWeightsChannel (const dgMeshEffect* const tetrahedraMesh, dgThreadHive* const threadPool)
 {
-	dgRayTrataAABBAccelerator accelerator (tetrahedraMesh);
+	dgTetraGridAccelerator accelerator (tetrahedraMesh);
 	m_points.m_weights.Clear();
 	m_points.m_weights.Reserve(m_points.m_vertex.m_count);
 
-	dgBigVector padding (dgFloat64(1.0f / 32.0f));
-	for (dgInt32 i = 0; i < m_points.m_weights.m_count; i ++) {
-		dgBigVector p (m_points.m_vertex[i]);
-		dgBigVector p0 (p - padding);
-		dgBigVector p1 (p + padding);
-		dgList<dgMeshBVH::dgMeshBVHNode*> overlapNodes (GetAllocator());
-		accelerator.GetOverlapNodes (overlapNodes, p0, p1);
-		dgAssert (overlapNodes.GetCount());
-
-		bool weightFound = false;
-		for (dgList<dgMeshBVH::dgMeshBVHNode*>::dgListNode* node = overlapNodes.GetFirst(); node; node = node->GetNext()) {
-			dgEdge* const edge = node->GetInfo()->m_face;
-
-			dgInt32 i0 = edge->m_incidentVertex;
-			dgInt32 i1 = edge->m_next->m_incidentVertex;
-			dgInt32 i2 = edge->m_prev->m_incidentVertex;
-			dgInt32 i3 = edge->m_twin->m_prev->m_incidentVertex;
-			dgBigVector q0 (tetrahedraMesh->m_points.m_vertex[i0]);
-			dgBigVector q1 (tetrahedraMesh->m_points.m_vertex[i1]);
-			dgBigVector q2 (tetrahedraMesh->m_points.m_vertex[i2]);
-			dgBigVector q3 (tetrahedraMesh->m_points.m_vertex[i3]);
-
-			const dgBigVector e10(q1 - q0);
-			const dgBigVector e20(q2 - q0);
-			const dgBigVector e30(q3 - q0);
-
-			dgAssert (e10.DotProduct4(e10).GetScalar() > dgFloat32 (0.0f));
-			const dgFloat64 d0 = sqrt(e10.DotProduct4(e10).GetScalar());
-			const dgFloat64 invd0 = dgFloat64(1.0f) / d0;
-			const dgFloat64 l10 = e20.DotProduct4(e10).GetScalar() * invd0;
-			const dgFloat64 l20 = e30.DotProduct4(e10).GetScalar() * invd0;
-
-			dgAssert ((e20.DotProduct4(e20).GetScalar() - l10 * l10) > dgFloat32 (0.0f));
-			const dgFloat64 desc11 = e20.DotProduct4(e20).GetScalar() - l10 * l10;
-
-			const dgFloat64 d1 = sqrt(desc11);
-			const dgFloat64 invd1 = dgFloat64(1.0f) / d1;
-			const dgFloat64 l21 = (e30.DotProduct4(e20).GetScalar() - l20 * l10) * invd1;
-			dgAssert (e30.DotProduct4(e30).GetScalar() - l20 * l20 - l21 * l21 > dgFloat32 (0.0f));
-			const dgFloat64 desc22 = e30.DotProduct4(e30).GetScalar() - l20 * l20 - l21 * l21;
-
-			dgBigVector p0Point(p - q0);
-			const dgFloat64 d2 = sqrt(desc22);
-			const dgFloat64 invd2 = dgFloat64(1.0f) / d2;
-
-			const dgFloat64 b0 = e10.DotProduct4(p0Point).GetScalar();
-			const dgFloat64 b1 = e20.DotProduct4(p0Point).GetScalar();
-			const dgFloat64 b2 = e30.DotProduct4(p0Point).GetScalar();
-
-			dgFloat64 u1 = b0 * invd0;
-			dgFloat64 u2 = (b1 - l10 * u1) * invd1;
-			dgFloat64 u3 = (b2 - l20 * u1 - l21 * u2) * invd2;
-
-			u3 = u3 * invd2;
-			u2 = (u2 - l21 * u3) * invd1;
-			u1 = (u1 - l10 * u2 - l20 * u3) * invd0;
-			if ((u1 >= dgFloat64(0.0f)) && (u2 >= dgFloat64(0.0f)) && (u3 >= dgFloat64(0.0f)) && ((u1 + u2 + u3) <= dgFloat64(1.0f))) {
-				dgBigVector r0 (q0 + e10.Scale4(u1) + e20.Scale4(u2) + e30.Scale4(u3));
-
-				dgFloat64 u0 = dgFloat64 (1.0f) - u1 - u2 - u3;
-				dgBigVector r1 (q0.Scale4 (u0) + q1.Scale4 (u1) + q2.Scale4 (u2) + q3.Scale4 (u3));
-				dgPointFormat::dgWeightSet& weighSet = m_points.m_weights[i];
-
-				weighSet.m_weightPair[0].m_controlIndex = i0;
-				weighSet.m_weightPair[0].m_weight = dgFloat32 (u0);
-
-				weighSet.m_weightPair[1].m_controlIndex = i1;
-				weighSet.m_weightPair[1].m_weight = dgFloat32(u1);
-
-				weighSet.m_weightPair[2].m_controlIndex = i2;
-				weighSet.m_weightPair[2].m_weight = dgFloat32(u2);
-
-				weighSet.m_weightPair[3].m_controlIndex = i3;
-				weighSet.m_weightPair[3].m_weight = dgFloat32(u3);
-
-				weightFound = true;
-				break;
-			}
+	const dgInt32 threadCount = threadPool ? threadPool->GetThreadCount() : 1;
+	if ((threadCount <= 1) || (m_points.m_weights.m_count <= 1)) {
+		for (dgInt32 i = 0; i < m_points.m_weights.m_count; i ++) {
+			accelerator.CalculateWeights (m_points.m_vertex[i], m_points.m_weights[i]);
 		}
-		dgAssert (weightFound);
-		if (!weightFound) {
-			dgTrace (("%d %f %f %f\n", i, p.m_x, p.m_y, p.m_z));
+	} else {
+		// each vertex writes only its own weights, the accelerator is only read
+		dgTetraGridAccelerator::dgWeightsDescriptor descriptor;
+		descriptor.m_grid = &accelerator;
+		descriptor.m_points = &m_points.m_vertex[0];
+		descriptor.m_weights = &m_points.m_weights[0];
+		descriptor.m_count = m_points.m_weights.m_count;
+		descriptor.m_index = 0;
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			threadPool->QueueJob (dgTetraGridAccelerator::CalculateWeightsKernel, &descriptor, NULL, "dgMeshEffect::CreateTetrahedraLinearBlendSkinWeightsChannel");
 		}
-
-
-		overlapNodes.RemoveAll();
+		threadPool->SynchronizationBarrier();
 	}
 }
@@ -81,6 +81,8 @@ class dgHACDCluster: public dgList<dgHACDClusterFace>
 		,m_hierachicalClusterIndex(0)
 		,m_area(dgFloat64 (0.0f))
 		,m_concavity(dgFloat64 (0.0f))
+		,m_hullPoints()
+		,m_hullPointsCount(0)
 	{
 	}
 
@@ -107,6 +109,11 @@ class dgHACDCluster: public dgList<dgHACDClusterFace>
 	dgInt32 m_hierachicalClusterIndex;
 	dgFloat64 m_area;
 	dgFloat64 m_concavity;
+
+	// the extreme points of the cluster, the hull of two clusters is the hull of their 
+	// extreme points, so candidate merges do not have to visit all the cluster vertices
+	dgArray<dgBigVector> m_hullPoints;
+	dgInt32 m_hullPointsCount;
 };
 
 
@@ -537,6 +544,22 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 		dgFloat64 m_distanceConcavity;
 	};
 
+	// a candidate merge of two adjacent clusters, the cost only depends on the two clusters 
+	// so candidates are evaluated concurrently and submitted to the heap in a fix order
+	class dgEdgeCost
+	{
+		public:
+		dgListNode* m_clusterNodeA;
+		dgListNode* m_clusterNodeB;
+		dgHACDEdge* m_edgeAB;
+		dgHACDEdge* m_edgeBA;
+		dgFloat64 m_perimeterHandicap;
+		dgFloat64 m_area;
+		dgFloat64 m_perimeter;
+		dgFloat64 m_concavity;
+		bool m_isValid;
+	};
+
 
 	class dgBackFaceFinder: public dgMeshEffect::dgMeshBVH
 	{
@@ -644,34 +667,38 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 		dgHACDClusterGraph* m_graph;
 	};
 
-    dgHACDClusterGraph(dgMeshEffect& mesh, dgFloat32 backFaceDistanceFactor, dgReportProgress reportProgressCallback, void* const reportProgressUserData)
+    dgHACDClusterGraph(dgMeshEffect& mesh, dgFloat32 backFaceDistanceFactor, dgReportProgress reportProgressCallback, void* const reportProgressUserData, dgThreadHive* const threadPool)
 		:dgGraph<dgHACDCluster, dgHACDEdge> (mesh.GetAllocator())
 		,m_mark(0)
 		,m_faceCount(0)
-		,m_vertexMark(0)
 		,m_progress(0)
 		,m_concavityTreeIndex(0)
+		,m_edgeCostsCount(0)
+		,m_edgeCostsIndex(0)
+		,m_threadCount(1)
 		,m_invFaceCount(dgFloat32 (1.0f))
 		,m_diagonal(dgFloat64(1.0f))
-		,m_vertexMarks(NULL)
-		,m_vertexPool(NULL)
+		,m_edgeCosts(mesh.GetAllocator())
 		,m_proxyList(mesh.GetAllocator())
 		,m_concavityTreeArray(NULL)
 		,m_convexProximation(mesh.GetAllocator())
 		,m_priorityHeap (mesh.GetCount() * 2 + 2048, mesh.GetAllocator())
         ,m_reportProgressCallback(reportProgressCallback)
         ,m_reportProgressUserData(reportProgressUserData)
+		,m_threadPool(threadPool)
 	{
 		m_faceCount = mesh.GetTotalFaceCount();
 
 		dgMemoryAllocator* const allocator = mesh.GetAllocator();
 		m_invFaceCount = dgFloat32 (1.0f) / (m_faceCount);
 
-		// init some auxiliary structures
-		dgInt32 vertexCount = mesh.GetVertexCount();
-		m_vertexMarks = (dgInt32*) dgMallocStack(vertexCount * sizeof(dgInt32));
-		m_vertexPool = (dgBigVector*) dgMallocStack(vertexCount * sizeof(dgBigVector));
-		memset(m_vertexMarks, 0, vertexCount * sizeof(dgInt32));
+		// the memory pools are not thread safe, each worker builds its hulls with its own allocator
+		if (m_threadPool) {
+			m_threadCount = m_threadPool->GetThreadCount();
+		}
+		for (dgInt32 i = 0; i < m_threadCount; i ++) {
+			m_allocators[i] = (m_threadCount > 1) ? new dgMemoryAllocator() : allocator;
+		}
 
 		m_concavityTreeIndex = m_faceCount + 1;
 		m_concavityTreeArray = (dgHACDConvacityLookAheadTree**) dgMallocStack(2 * m_concavityTreeIndex * sizeof(dgHACDConvacityLookAheadTree*));
@@ -690,12 +717,15 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 				dgListNode* const clusterNode = AddNode ();
 				dgHACDCluster& cluster = clusterNode->GetInfo().m_nodeData;
 				cluster.SetAllocator(mesh.GetAllocator());
+				cluster.m_hullPoints.SetAllocator(mesh.GetAllocator());
 
 				dgFloat64 perimeter = dgFloat64(0.0f);
 				dgEdge* ptr = edge;
 				do {
 					dgBigVector p1p0(points[ptr->m_incidentVertex] - points[ptr->m_prev->m_incidentVertex]);
 					perimeter += sqrt(p1p0.DotProduct3(p1p0));
+					cluster.m_hullPoints[cluster.m_hullPointsCount] = points[ptr->m_incidentVertex];
+					cluster.m_hullPointsCount ++;
 					ptr->m_incidentFace = color;
 					ptr->m_userData = dgUnsigned64 (clusterNode);
 					ptr->m_mark = meshMask;
@@ -801,8 +831,12 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 		}
 
 		dgFreeStack(m_concavityTreeArray);
-		dgFreeStack(m_vertexPool);
-		dgFreeStack(m_vertexMarks);
+
+		if (m_threadCount > 1) {
+			for (dgInt32 i = 0; i < m_threadCount; i ++) {
+				delete m_allocators[i];
+			}
+		}
 	}
 
 
@@ -899,6 +933,7 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 	void SubmitInitialEdgeCosts (dgMeshEffect& mesh) 
 	{
 		m_mark ++;
+		m_edgeCostsCount = 0;
 		for (dgListNode* clusterNodeA = GetFirst(); clusterNodeA; clusterNodeA = clusterNodeA->GetNext()) {
 			// call the progress callback
 			for (dgGraphNode<dgHACDCluster, dgHACDEdge>::dgListNode* edgeNodeAB = clusterNodeA->GetInfo().GetFirst(); edgeNodeAB; edgeNodeAB = edgeNodeAB->GetNext()) {
@@ -916,62 +951,104 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 							dgAssert (!edgeBA.m_proxyListNode);
 
 							dgAssert (edgeBA.m_backFaceHandicap == weight);
-							dgList<dgPairProxy>::dgListNode* const proxyNode = SubmitEdgeCost (mesh, clusterNodeA, clusterNodeB, weight * edgeBA.m_backFaceHandicap);
-							edgeAB.m_proxyListNode = proxyNode;
-							edgeBA.m_proxyListNode = proxyNode;
+							AddEdgeCost (clusterNodeA, clusterNodeB, &edgeAB, &edgeBA, weight * edgeBA.m_backFaceHandicap);
 							break;
 						}
 					}
 				}
 			}
 		}
+		SubmitEdgeCosts (mesh);
 	}
 
-	dgInt32 CopyVertexToPool(const dgMeshEffect& mesh, const dgHACDCluster& cluster, dgInt32 start)
+	void AddEdgeCost (dgListNode* const clusterNodeA, dgListNode* const clusterNodeB, dgHACDEdge* const edgeAB, dgHACDEdge* const edgeBA, dgFloat64 perimeterHandicap)
 	{
-		dgInt32 count = start;
+		dgEdgeCost& cost = m_edgeCosts[m_edgeCostsCount];
+		cost.m_clusterNodeA = clusterNodeA;
+		cost.m_clusterNodeB = clusterNodeB;
+		cost.m_edgeAB = edgeAB;
+		cost.m_edgeBA = edgeBA;
+		cost.m_perimeterHandicap = perimeterHandicap;
+		cost.m_isValid = false;
+		m_edgeCostsCount ++;
+	}
 
-		const dgBigVector* const points = (dgBigVector*) mesh.GetVertexPool();
-		for (dgList<dgHACDClusterFace>::dgListNode* node = cluster.GetFirst(); node; node = node->GetNext()) {
-			const dgHACDClusterFace& clusterFace = node->GetInfo();
-			dgEdge* edge = clusterFace.m_edge;
-			do {
-				dgInt32 index = edge->m_incidentVertex;
-				if (m_vertexMarks[index] != m_vertexMark) {
-					m_vertexMarks[index] = m_vertexMark;
-					m_vertexPool[count] = points[index];
-					count++;
-				}
-				edge = edge->m_next;
-			} while (edge != clusterFace.m_edge);
+	// evaluate all pending candidates and add them to the heap in the order they were added, 
+	// this way the collapse sequence is the same regardless of the number of threads.
+	void SubmitEdgeCosts (dgMeshEffect& mesh)
+	{
+		if ((m_threadCount > 1) && (m_edgeCostsCount > 1)) {
+			m_edgeCostsIndex = 0;
+			for (dgInt32 i = 0; i < m_threadCount; i ++) {
+				m_threadPool->QueueJob (CalculateEdgeCostsKernel, this, &mesh, "dgHACDClusterGraph::CalculateEdgeCosts");
+			}
+			m_threadPool->SynchronizationBarrier();
+		} else {
+			for (dgInt32 i = 0; i < m_edgeCostsCount; i ++) {
+				CalculateEdgeCost (mesh, m_edgeCosts[i], m_allocators[0]);
+			}
 		}
-		return count;
+
+		for (dgInt32 i = 0; i < m_edgeCostsCount; i ++) {
+			const dgEdgeCost& cost = m_edgeCosts[i];
+			if (cost.m_isValid) {
+				dgList<dgPairProxy>::dgListNode* const proxyNode = SubmitEdgeCost (cost);
+				cost.m_edgeAB->m_proxyListNode = proxyNode;
+				cost.m_edgeBA->m_proxyListNode = proxyNode;
+			}
+		}
+		m_edgeCostsCount = 0;
 	}
 
+	static void CalculateEdgeCostsKernel (void* const context, void* const meshPtr, dgInt32 threadID)
+	{
+		dgHACDClusterGraph* const graph = (dgHACDClusterGraph*) context;
+		const dgMeshEffect* const mesh = (dgMeshEffect*) meshPtr;
+		dgMemoryAllocator* const allocator = graph->m_allocators[threadID];
+		for (dgInt32 i = dgAtomicExchangeAndAdd(&graph->m_edgeCostsIndex, 1); i < graph->m_edgeCostsCount; i = dgAtomicExchangeAndAdd(&graph->m_edgeCostsIndex, 1)) {
+			graph->CalculateEdgeCost (*mesh, graph->m_edgeCosts[i], allocator);
+		}
+	}
 
-	void MarkInteriorClusterEdges (dgMeshEffect& mesh, dgInt32 mark, const dgHACDCluster& cluster, dgInt32 colorA, dgInt32 colorB) const
+	// replace the extreme points of cluster A with the extreme points of the union of the two clusters
+	void MergeHullPoints (const dgMeshEffect& mesh, dgHACDCluster& clusterA, const dgHACDCluster& clusterB) const
 	{
-		dgAssert (colorA != colorB);
-		for (dgList<dgHACDClusterFace>::dgListNode* node = cluster.GetFirst(); node; node = node->GetNext()) {
-			dgHACDClusterFace& clusterFace = node->GetInfo();
-			dgEdge* edge = clusterFace.m_edge;
-			do {
-				if ((edge->m_twin->m_incidentFace == colorA) || (edge->m_twin->m_incidentFace == colorB)) {
-					edge->m_mark = mark;
-					edge->m_twin->m_mark = mark;
+		dgInt32 count = clusterA.m_hullPointsCount;
+		for (dgInt32 i = 0; i < clusterB.m_hullPointsCount; i ++) {
+			clusterA.m_hullPoints[count] = clusterB.m_hullPoints[i];
+			count ++;
+		}
+
+		dgHACDConveHull convexHull (mesh.GetAllocator(), &clusterA.m_hullPoints[0], count);
+		if (convexHull.GetCount()) {
+			const dgInt32 vertexCount = convexHull.GetVertexCount();
+			dgStack<dgInt8> mark (vertexCount);
+			memset (&mark[0], 0, size_t (vertexCount));
+			for (dgHACDConveHull::dgListNode* node = convexHull.GetFirst(); node; node = node->GetNext()) {
+				const dgConvexHull3DFace& face = node->GetInfo();
+				mark[face.m_index[0]] = 1;
+				mark[face.m_index[1]] = 1;
+				mark[face.m_index[2]] = 1;
+			}
+
+			count = 0;
+			for (dgInt32 i = 0; i < vertexCount; i ++) {
+				if (mark[i]) {
+					clusterA.m_hullPoints[count] = convexHull.GetVertex(i);
+					count ++;
 				}
-				edge = edge->m_next;
-			} while (edge != clusterFace.m_edge);
+			}
 		}
+		clusterA.m_hullPointsCount = count;
 	}
 
-	dgFloat64 CalculateClusterPerimeter (dgMeshEffect& mesh, dgInt32 mark, const dgHACDCluster& cluster, dgInt32 colorA, dgInt32 colorB) const
+	dgFloat64 CalculateClusterPerimeter (const dgMeshEffect& mesh, const dgHACDCluster& cluster, dgInt32 colorA, dgInt32 colorB) const
 	{
 		dgAssert (colorA != colorB);
 		dgFloat64 perimeter = dgFloat64 (0.0f);
 		const dgBigVector* const points = (dgBigVector*) mesh.GetVertexPool();
 		for (dgList<dgHACDClusterFace>::dgListNode* node = cluster.GetFirst(); node; node = node->GetNext()) {
-			dgHACDClusterFace& clusterFace = node->GetInfo();
+			const dgHACDClusterFace& clusterFace = node->GetInfo();
 			dgEdge* edge = clusterFace.m_edge;
 			do {
 				if (!((edge->m_twin->m_incidentFace == colorA) || (edge->m_twin->m_incidentFace == colorB))) {
@@ -999,13 +1076,13 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 	}
 
 
-	dgFloat64 CalculateConcavity(dgHACDConveHull& hull, const dgMeshEffect& mesh, const dgHACDCluster& cluster)
+	dgFloat64 CalculateConcavity(dgHACDConveHull& hull, const dgMeshEffect& mesh, const dgHACDCluster& cluster) const
 	{
 		dgFloat64 concavity = dgFloat32(0.0f);
 
 		const dgBigVector* const points = (dgBigVector*) mesh.GetVertexPool();
 		for (dgList<dgHACDClusterFace>::dgListNode* node = cluster.GetFirst(); node; node = node->GetNext()) {
-			dgHACDClusterFace& clusterFace = node->GetInfo();
+			const dgHACDClusterFace& clusterFace = node->GetInfo();
 			dgEdge* edge = clusterFace.m_edge;
 			dgInt32 i0 = edge->m_incidentVertex;
 			dgInt32 i1 = edge->m_next->m_incidentVertex;
@@ -1022,21 +1099,24 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 		return concavity;
 	}
 
-	dgFloat64 CalculateConcavity (dgHACDConveHull& hull, dgMeshEffect& mesh, dgHACDCluster& clusterA, dgHACDCluster& clusterB)
+	dgFloat64 CalculateConcavity (dgHACDConveHull& hull, const dgMeshEffect& mesh, const dgHACDCluster& clusterA, const dgHACDCluster& clusterB) const
 	{
 		return dgMax(CalculateConcavity(hull, mesh, clusterA), CalculateConcavity(hull, mesh, clusterB));
 	}
 
-
-	dgList<dgPairProxy>::dgListNode* SubmitEdgeCost (dgMeshEffect& mesh, dgListNode* const clusterNodeA, dgListNode* const clusterNodeB, dgFloat64 perimeterHandicap)
+	// only reads the mesh and the two clusters, it is safe to call it from different threads 
+	// as long as each thread uses a different allocator
+	void CalculateEdgeCost (const dgMeshEffect& mesh, dgEdgeCost& cost, dgMemoryAllocator* const allocator) const
 	{
-		dgHACDCluster& clusterA = clusterNodeA->GetInfo().m_nodeData;
-		dgHACDCluster& clusterB = clusterNodeB->GetInfo().m_nodeData;
+		const dgHACDCluster& clusterA = cost.m_clusterNodeA->GetInfo().m_nodeData;
+		const dgHACDCluster& clusterB = cost.m_clusterNodeB->GetInfo().m_nodeData;
 		const dgBigVector* const points = (dgBigVector*) mesh.GetVertexPool();
 
+		cost.m_isValid = false;
+
 		bool flatStrip = true;
 		dgFloat64 tol = dgFloat64 (1.0e-5f) * m_diagonal;
-		dgHACDClusterFace& clusterFaceA = clusterA.GetFirst()->GetInfo();
+		const dgHACDClusterFace& clusterFaceA = clusterA.GetFirst()->GetInfo();
 		dgBigPlane plane(clusterFaceA.m_normal, - points[clusterFaceA.m_edge->m_incidentVertex].DotProduct3(clusterFaceA.m_normal));
 
 		if (clusterA.GetCount() > 1) {
@@ -1047,51 +1127,55 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 			flatStrip = clusterB.IsCoplanar(plane, mesh, tol);
 		}
 
-		dgList<dgPairProxy>::dgListNode* pairNode = NULL;
 		if (!flatStrip) {
-			m_vertexMark ++;
-			dgInt32 vertexCount = CopyVertexToPool(mesh, clusterA, 0);
-			vertexCount = CopyVertexToPool(mesh, clusterB, vertexCount);
-
-			dgHACDConveHull convexHull(mesh.GetAllocator(), m_vertexPool, vertexCount);
+			dgInt32 vertexCount = 0;
+			dgStack<dgBigVector> vertexPool (clusterA.m_hullPointsCount + clusterB.m_hullPointsCount);
+			for (dgInt32 i = 0; i < clusterA.m_hullPointsCount; i ++) {
+				vertexPool[vertexCount] = clusterA.m_hullPoints[i];
+				vertexCount ++;
+			}
+			for (dgInt32 i = 0; i < clusterB.m_hullPointsCount; i ++) {
+				vertexPool[vertexCount] = clusterB.m_hullPoints[i];
+				vertexCount ++;
+			}
 
+			dgHACDConveHull convexHull(allocator, &vertexPool[0], vertexCount);
 			if (convexHull.GetVertexCount()) {
-				dgInt32 mark = mesh.IncLRU();
-				MarkInteriorClusterEdges (mesh, mark, clusterA, clusterA.m_color, clusterB.m_color);
-				MarkInteriorClusterEdges (mesh, mark, clusterB, clusterA.m_color, clusterB.m_color);
-
-				dgFloat64 area = clusterA.m_area + clusterB.m_area;
-				dgFloat64 perimeter = CalculateClusterPerimeter (mesh, mark, clusterA, clusterA.m_color, clusterB.m_color) +
-									  CalculateClusterPerimeter (mesh, mark, clusterB, clusterA.m_color, clusterB.m_color);
-				dgFloat64 concavity = CalculateConcavity (convexHull, mesh, clusterA, clusterB);
-
-				if (concavity < dgFloat64(1.0e-3f)) {
-					concavity = dgFloat64(0.0f);
+				cost.m_area = clusterA.m_area + clusterB.m_area;
+				cost.m_perimeter = CalculateClusterPerimeter (mesh, clusterA, clusterA.m_color, clusterB.m_color) +
+								   CalculateClusterPerimeter (mesh, clusterB, clusterA.m_color, clusterB.m_color);
+				cost.m_concavity = CalculateConcavity (convexHull, mesh, clusterA, clusterB);
+				if (cost.m_concavity < dgFloat64(1.0e-3f)) {
+					cost.m_concavity = dgFloat64(0.0f);
 				}
+				cost.m_isValid = true;
+			}
+		}
+	}
 
-				// see if the heap will overflow
-				HeapCollectGarbage ();
-
-				// add a new pair to the heap
-				dgList<dgPairProxy>::dgListNode* pairNode1 = m_proxyList.Append();
-				dgPairProxy& pair = pairNode1->GetInfo();
-				pair.m_nodeA = clusterNodeA;
-				pair.m_nodeB = clusterNodeB;
-				pair.m_distanceConcavity = concavity;
-				pair.m_hierachicalClusterIndexA = clusterA.m_hierachicalClusterIndex;
-				pair.m_hierachicalClusterIndexB = clusterB.m_hierachicalClusterIndex;
+	dgList<dgPairProxy>::dgListNode* SubmitEdgeCost (const dgEdgeCost& cost)
+	{
+		const dgHACDCluster& clusterA = cost.m_clusterNodeA->GetInfo().m_nodeData;
+		const dgHACDCluster& clusterB = cost.m_clusterNodeB->GetInfo().m_nodeData;
 
-				pair.m_area = area;
-				dgFloat64 cost = CalculateConcavityMetric (concavity, area * perimeterHandicap, perimeter * perimeterHandicap, clusterA.GetCount(), clusterB.GetCount());
-				m_priorityHeap.Push(pairNode1, cost);
+		// see if the heap will overflow
+		HeapCollectGarbage ();
 
-				return pairNode1;
-			}
-		}
+		// add a new pair to the heap
+		dgList<dgPairProxy>::dgListNode* pairNode = m_proxyList.Append();
+		dgPairProxy& pair = pairNode->GetInfo();
+		pair.m_nodeA = cost.m_clusterNodeA;
+		pair.m_nodeB = cost.m_clusterNodeB;
+		pair.m_distanceConcavity = cost.m_concavity;
+		pair.m_hierachicalClusterIndexA = clusterA.m_hierachicalClusterIndex;
+		pair.m_hierachicalClusterIndexB = clusterB.m_hierachicalClusterIndex;
+
+		pair.m_area = cost.m_area;
+		dgFloat64 metric = CalculateConcavityMetric (cost.m_concavity, cost.m_area * cost.m_perimeterHandicap, cost.m_perimeter * cost.m_perimeterHandicap, clusterA.GetCount(), clusterB.GetCount());
+		m_priorityHeap.Push(pairNode, metric);
 		return pairNode;
 	}
 
-
 	bool CollapseEdge (dgList<dgPairProxy>::dgListNode* const pairNode, dgMeshEffect& mesh, dgFloat64 concavity)
 	{
 		dgListNode* adjacentNodes[1024];
@@ -1147,6 +1231,7 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 			}
 			clusterA.m_area = pair.m_area;
 			clusterA.m_concavity = concavity;
+			MergeHullPoints (mesh, clusterA, clusterB);
 
 			// invalidate all proxies that are still in the heap
 			dgInt32 adjacentCount = 1;
@@ -1201,15 +1286,12 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 					dgListNode* const clusterNode = edgeNodeBA->GetInfo().m_node;
 					if (clusterNode == clusterNodeA) {
 						dgHACDEdge& edgeBA = edgeNodeBA->GetInfo().m_edgeData;
-						dgList<dgPairProxy>::dgListNode* const proxyNode = SubmitEdgeCost (mesh, clusterNodeA, clusterNodeB1, weigh * edgeBA.m_backFaceHandicap);
-						if (proxyNode) {
-							edgeBA.m_proxyListNode = proxyNode;
-							edgeAB.m_proxyListNode = proxyNode;
-						}
+						AddEdgeCost (clusterNodeA, clusterNodeB1, &edgeAB, &edgeBA, weigh * edgeBA.m_backFaceHandicap);
 						break;
 					}
 				}
 			}
+			SubmitEdgeCosts (mesh);
 		}
 		m_proxyList.Remove(pairNode);
 
@@ -1284,22 +1366,25 @@ class dgHACDClusterGraph: public dgGraph<dgHACDCluster, dgHACDEdge>
 
 	dgInt32 m_mark;
 	dgInt32 m_faceCount;
-	dgInt32 m_vertexMark;
 	dgInt32 m_progress;
 	dgInt32 m_concavityTreeIndex;
+	dgInt32 m_edgeCostsCount;
+	dgInt32 m_edgeCostsIndex;
+	dgInt32 m_threadCount;
 	dgFloat32 m_invFaceCount;
 	dgFloat64 m_diagonal;
-	dgInt32* m_vertexMarks;
-	dgBigVector* m_vertexPool;
+	dgArray<dgEdgeCost> m_edgeCosts;
 	dgList<dgPairProxy> m_proxyList;
 	dgHACDConvacityLookAheadTree** m_concavityTreeArray;	
 	dgList<dgHACDConvacityLookAheadTree*> m_convexProximation;
 	dgUpHeap<dgList<dgPairProxy>::dgListNode*, dgFloat64> m_priorityHeap;
 	dgReportProgress m_reportProgressCallback;
     void* m_reportProgressUserData;
+	dgThreadHive* m_threadPool;
+	dgMemoryAllocator* m_allocators[DG_MAX_THREADS_HIVE_COUNT];
 };
 
-dgMeshEffect* dgMeshEffect::CreateConvexApproximation(dgFloat32 maxConcavity, dgFloat32 backFaceDistanceFactor, dgInt32 maxHullsCount, dgInt32 maxVertexPerHull, dgReportProgress reportProgressCallback, void* const progressReportUserData) const
+dgMeshEffect* dgMeshEffect::CreateConvexApproximation(dgFloat32 maxConcavity, dgFloat32 backFaceDistanceFactor, dgInt32 maxHullsCount, dgInt32 maxVertexPerHull, dgReportProgress reportProgressCallback, void* const progressReportUserData, dgThreadHive* const threadPool) const
 {
 	//	dgMeshEffect triangleMesh(*this);
 	if (maxHullsCount <= 1) {
@@ -1346,7 +1431,7 @@ dgMeshEffect* dgMeshEffect::CreateConvexApproximation(dgFloat32 maxConcavity, dg
 		//mesh.SaveOFF ("xxxxxx.off");
 
 		// create a general connectivity graph    
-		dgHACDClusterGraph graph (mesh, backFaceDistanceFactor, reportProgressCallback, progressReportUserData);
+		dgHACDClusterGraph graph (mesh, backFaceDistanceFactor, reportProgressCallback, progressReportUserData, threadPool);
 
 		// calculate initial edge costs
 		graph.SubmitInitialEdgeCosts (mesh);
@@ -23,8 +23,13 @@
 #include "dgBody.h"
 #include "dgWorld.h"
 #include "dgMeshEffect.h"
+#include "dgCollisionBVH.h"
 #include "dgCollisionConvexHull.h"
 
+#define DG_SIMPLIFIER_BATCH_SIZE		(1024 * 64)
+#define DG_SIMPLIFIER_REGION_SIZE		(1024 * 4)
+#define DG_SIMPLIFIER_MAX_PASSES		8
+#define DG_SIMPLIFIER_FACE_AREA			dgFloat64 (1.0e-2f)
 
 
 #if 0
@@ -1524,102 +1529,625 @@ class dgHACDClusterGraph
 
 #endif
 
-dgMeshEffect* dgMeshEffect::CreateSimplification(dgInt32 maxVertexCount, dgReportProgress reportProgressCallback, void* const reportPrgressUserData) const
+class dgMeshEffectSimplifier::dgRegionDescriptor
 {
-	if (GetVertexCount() <= maxVertexCount) {
-		return new (GetAllocator()) dgMeshEffect(*this); 
+	public:
+	const dgBigVector* m_points;
+	const dgInt8* m_lockedVertex;
+	dgTriangle* m_faces;
+	dgRegion* m_regions;
+	dgInt32* m_vertexMap[DG_MAX_THREADS_HIVE_COUNT];
+	dgMemoryAllocator* m_allocators[DG_MAX_THREADS_HIVE_COUNT];
+	dgBigVector m_origin;
+	dgFloat64 m_scale;
+	dgInt32 m_regionCount;
+	dgInt32 m_index;
+};
+
+dgMeshEffectSimplifier::dgMeshEffectSimplifier (dgMemoryAllocator* const allocator, dgInt32 maxFaceCount, dgInt32 expectedFaceCount, dgThreadHive* const threadPool)
+	:m_allocator(allocator)
+	,m_threadPool(threadPool)
+	,m_points(allocator)
+	,m_faces(allocator)
+	,m_batchPoints(allocator)
+	,m_batchAttributes(allocator)
+	,m_pointCount(0)
+	,m_faceCount(0)
+	,m_batchFaceCount(0)
+	,m_maxFaceCount(dgMax (maxFaceCount, 4))
+	,m_expectedFaceCount(dgMax (expectedFaceCount, maxFaceCount))
+	,m_capFaceCount(2 * m_maxFaceCount)
+	,m_needsWeld(false)
+{
+}
+
+dgMeshEffectSimplifier::~dgMeshEffectSimplifier ()
+{
+}
+
+dgInt32 dgMeshEffectSimplifier::CompareSortKeys (const dgSortKey* const keyA, const dgSortKey* const keyB, void* const context)
+{
+	if (keyA->m_key < keyB->m_key) {
+		return -1;
+	} else if (keyA->m_key > keyB->m_key) {
+		return 1;
 	}
-dgAssert (0);
-return new (GetAllocator()) dgMeshEffect(*this); 
-/*
-	//	dgMeshEffect triangleMesh(*this);
-	if (maxHullsCount <= 1) {
-		maxHullsCount = 1;
+	if (keyA->m_index < keyB->m_index) {
+		return -1;
+	} else if (keyA->m_index > keyB->m_index) {
+		return 1;
 	}
-	if (maxConcavity <= dgFloat32 (1.0e-5f)) {
-		maxConcavity = dgFloat32 (1.0e-5f);
+	return 0;
+}
+
+void dgMeshEffectSimplifier::AddFace (dgInt32 vertexCount, const dgFloat32* const vertex, dgInt32 strideInBytes, dgInt32 faceAttribute)
+{
+	const dgInt32 stride = dgInt32 (strideInBytes / sizeof (dgFloat32));
+	const dgBigVector p0 (vertex[0], vertex[1], vertex[2], dgFloat64 (0.0f));
+	for (dgInt32 i = 2; i < vertexCount; i ++) {
+		const dgInt32 i1 = (i - 1) * stride;
+		const dgInt32 i2 = i * stride;
+		const dgInt32 index = m_batchFaceCount * 3;
+		m_batchPoints[index + 0] = p0;
+		m_batchPoints[index + 1] = dgBigVector (vertex[i1 + 0], vertex[i1 + 1], vertex[i1 + 2], dgFloat64 (0.0f));
+		m_batchPoints[index + 2] = dgBigVector (vertex[i2 + 0], vertex[i2 + 1], vertex[i2 + 2], dgFloat64 (0.0f));
+		m_batchAttributes[m_batchFaceCount] = faceAttribute;
+		m_batchFaceCount ++;
 	}
 
-	if (maxVertexPerHull < 4) {
-		maxVertexPerHull = 4;
+	if (m_batchFaceCount >= DG_SIMPLIFIER_BATCH_SIZE) {
+		FlushBatch ();
 	}
-	ClampValue(backFaceDistanceFactor, dgFloat32 (0.01f), dgFloat32 (1.0f));
+}
 
-	if (reportProgressCallback) {
-		reportProgressCallback (0.0f);
+void dgMeshEffectSimplifier::AddMesh (const dgMeshEffect* const mesh)
+{
+	FlushBatch ();
+
+	// the mesh is already welded, the faces are added directly
+	const dgInt32 firstPoint = m_pointCount;
+	const dgInt32 pointCount = mesh->GetVertexCount();
+	m_points.ResizeIfNecessary (m_pointCount + pointCount);
+	for (dgInt32 i = 0; i < pointCount; i ++) {
+		m_points[m_pointCount + i] = mesh->m_points.m_vertex[i];
+		m_points[m_pointCount + i].m_w = dgFloat64 (0.0f);
 	}
+	m_pointCount += pointCount;
+
+	const dgInt32 mark = mesh->IncLRU();
+	dgPolyhedra::Iterator iter (*mesh);
+	for (iter.Begin(); iter; iter ++) {
+		dgEdge* const edge = &(*iter);
+		if ((edge->m_incidentFace > 0) && (edge->m_mark != mark)) {
+			const dgInt32 material = mesh->m_attrib.m_materialChannel.m_count ? mesh->m_attrib.m_materialChannel[dgInt32 (edge->m_userData)] : 0;
+			dgEdge* ptr = edge;
+			do {
+				ptr->m_mark = mark;
+				ptr = ptr->m_next;
+			} while (ptr != edge);
 
+			for (ptr = edge->m_next->m_next; ptr != edge; ptr = ptr->m_next) {
+				dgTriangle& face = m_faces[m_faceCount];
+				face.m_index[0] = firstPoint + edge->m_incidentVertex;
+				face.m_index[1] = firstPoint + ptr->m_prev->m_incidentVertex;
+				face.m_index[2] = firstPoint + ptr->m_incidentVertex;
+				face.m_attribute = material;
+				m_faceCount ++;
+			}
+		}
+	}
+	m_needsWeld |= (firstPoint > 0);
+}
 
-	// make a copy of the mesh
-	dgMeshEffect mesh(*this);
-	mesh.ClearAttributeArray();
+void dgMeshEffectSimplifier::FlushBatch ()
+{
+	if (!m_batchFaceCount) {
+		return;
+	}
 
+	// the batch is welded exactly, so that the vertices shared with other batches are welded again later
+	const dgInt32 firstPoint = m_pointCount;
+	const dgInt32 firstFace = m_faceCount;
+	const dgInt32 batchPointCount = m_batchFaceCount * 3;
+	dgStack<dgInt32> indexMap (batchPointCount);
+	const dgInt32 pointCount = dgVertexListToIndexList (&m_batchPoints[0].m_x, sizeof (dgBigVector), 3, batchPointCount, &indexMap[0], dgFloat64 (0.0f));
+	m_points.ResizeIfNecessary (m_pointCount + pointCount);
+	for (dgInt32 i = 0; i < pointCount; i ++) {
+		m_points[m_pointCount + i] = m_batchPoints[i];
+	}
+	m_pointCount += pointCount;
+
+	m_faces.ResizeIfNecessary (m_faceCount + m_batchFaceCount);
+	for (dgInt32 i = 0; i < m_batchFaceCount; i ++) {
+		const dgInt32 i0 = indexMap[i * 3 + 0];
+		const dgInt32 i1 = indexMap[i * 3 + 1];
+		const dgInt32 i2 = indexMap[i * 3 + 2];
+		if ((i0 != i1) && (i1 != i2) && (i2 != i0)) {
+			dgTriangle& face = m_faces[m_faceCount];
+			face.m_index[0] = firstPoint + i0;
+			face.m_index[1] = firstPoint + i1;
+			face.m_index[2] = firstPoint + i2;
+			face.m_attribute = m_batchAttributes[i];
+			m_faceCount ++;
+		}
+	}
+	m_batchFaceCount = 0;
+
+	// the vertices on the open edges of the batch may be shared with faces that are not added yet
+	const dgInt32 batchFaceCount = m_faceCount - firstFace;
+	const dgInt32 batchMaxFaceCount = dgInt32 (dgInt64 (batchFaceCount) * m_maxFaceCount / m_expectedFaceCount);
+	if (batchMaxFaceCount < batchFaceCount) {
+		dgStack<dgInt8> lockedVertex (m_pointCount);
+		memset (&lockedVertex[0], 0, lockedVertex.GetSizeInBytes());
+		LockOpenEdges (firstFace, &lockedVertex[0]);
+		SimplifyFaces (firstFace, batchMaxFaceCount, &lockedVertex[0], NULL, NULL);
+		RemoveUnusedVertices (firstPoint, firstFace);
+	}
+	m_needsWeld |= (firstPoint > 0);
+
+	// do not let the faces added so far grow without bound when there are more faces than expected.
+	// when the faces do not arrive in spatial order most vertices are still on open edges and the pass 
+	// removes little, so the next pass waits until the faces held double instead of welding and sorting
+	// all of them again on each batch.
+	if (m_faceCount > m_capFaceCount) {
+		WeldVertices ();
+		dgStack<dgInt8> lockedVertex (m_pointCount);
+		memset (&lockedVertex[0], 0, lockedVertex.GetSizeInBytes());
+		LockOpenEdges (0, &lockedVertex[0]);
+		SimplifyFaces (0, m_maxFaceCount, &lockedVertex[0], NULL, NULL);
+		RemoveUnusedVertices (0, 0);
+		m_capFaceCount = 2 * dgMax (m_maxFaceCount, m_faceCount);
+	}
+}
 
-	dgInt32 faceCount = mesh.GetTotalFaceCount();
-	if (faceCount  > meshSimplicationMaxFaceCount) {
-		mesh.Triangulate();
+void dgMeshEffectSimplifier::WeldVertices ()
+{
+	if (m_pointCount) {
+		dgStack<dgInt32> indexMap (m_pointCount);
+		m_pointCount = dgVertexListToIndexList (&m_points[0].m_x, sizeof (dgBigVector), 3, m_pointCount, &indexMap[0], dgFloat64 (0.0f));
+
+		dgInt32 faceCount = 0;
+		for (dgInt32 i = 0; i < m_faceCount; i ++) {
+			dgTriangle face (m_faces[i]);
+			face.m_index[0] = indexMap[face.m_index[0]];
+			face.m_index[1] = indexMap[face.m_index[1]];
+			face.m_index[2] = indexMap[face.m_index[2]];
+			if ((face.m_index[0] != face.m_index[1]) && (face.m_index[1] != face.m_index[2]) && (face.m_index[2] != face.m_index[0])) {
+				m_faces[faceCount] = face;
+				faceCount ++;
+			}
+		}
+		m_faceCount = faceCount;
+	}
+	m_needsWeld = false;
+}
 
-		dgPolyhedra polygon(GetAllocator());
-		dgInt32 mark = mesh.IncLRU();
-		polygon.BeginFace();
-		dgPolyhedra::Iterator iter (mesh);
-		for (iter.Begin(); iter; iter ++){
-			dgEdge* const face = &(*iter);
+void dgMeshEffectSimplifier::LockOpenEdges (dgInt32 firstFace, dgInt8* const lockedVertex) const
+{
+	// an edge used by only one face is an open edge
+	const dgInt32 edgeCount = (m_faceCount - firstFace) * 3;
+	if (!edgeCount) {
+		return;
+	}
+	dgStack<dgSortKey> edges (edgeCount);
+	for (dgInt32 i = firstFace; i < m_faceCount; i ++) {
+		const dgTriangle& face = m_faces[i];
+		dgInt32 i0 = face.m_index[2];
+		for (dgInt32 j = 0; j < 3; j ++) {
+			const dgInt32 i1 = face.m_index[j];
+			dgSortKey& edge = edges[(i - firstFace) * 3 + j];
+			edge.m_key = (dgInt64 (dgMin (i0, i1)) << 32) + dgMax (i0, i1);
+			edge.m_index = 0;
+			i0 = i1;
+		}
+	}
+	dgSort (&edges[0], edgeCount, CompareSortKeys);
+
+	for (dgInt32 i = 0; i < edgeCount; ) {
+		dgInt32 j = i + 1;
+		for (; (j < edgeCount) && (edges[j].m_key == edges[i].m_key); j ++);
+		if (j == (i + 1)) {
+			lockedVertex[dgInt32 (edges[i].m_key >> 32)] = 1;
+			lockedVertex[dgInt32 (edges[i].m_key & 0xffffffff)] = 1;
+		}
+		i = j;
+	}
+}
 
-			if ((face->m_mark != mark) && (face->m_incidentFace > 0)) {
-				dgInt32	index[DG_MESH_EFFECT_POINT_SPLITED];
+void dgMeshEffectSimplifier::RemoveUnusedVertices (dgInt32 firstVertex, dgInt32 firstFace)
+{
+	// only the faces after firstFace use the vertices after firstVertex
+	const dgInt32 count = m_pointCount - firstVertex;
+	if (!count) {
+		return;
+	}
+	dgStack<dgInt32> vertexMap (count);
+	memset (&vertexMap[0], -1, vertexMap.GetSizeInBytes());
+	for (dgInt32 i = firstFace; i < m_faceCount; i ++) {
+		const dgTriangle& face = m_faces[i];
+		for (dgInt32 j = 0; j < 3; j ++) {
+			const dgInt32 index = face.m_index[j] - firstVertex;
+			if (index >= 0) {
+				vertexMap[index] = 0;
+			}
+		}
+	}
 
-				dgEdge* ptr = face;
-				dgInt32 indexCount = 0;
-				do {
-					index[indexCount] = ptr->m_incidentVertex;
-					ptr->m_mark = mark;
-					indexCount ++;
-					ptr = ptr->m_next;
-				} while (ptr != face);
-				polygon.AddFace(indexCount, index);
+	dgInt32 pointCount = firstVertex;
+	for (dgInt32 i = 0; i < count; i ++) {
+		if (vertexMap[i] == 0) {
+			vertexMap[i] = pointCount;
+			m_points[pointCount] = m_points[firstVertex + i];
+			pointCount ++;
+		}
+	}
+	m_pointCount = pointCount;
+
+	for (dgInt32 i = firstFace; i < m_faceCount; i ++) {
+		dgTriangle& face = m_faces[i];
+		for (dgInt32 j = 0; j < 3; j ++) {
+			const dgInt32 index = face.m_index[j] - firstVertex;
+			if (index >= 0) {
+				face.m_index[j] = vertexMap[index];
 			}
 		}
-		polygon.EndFace();
+	}
+}
 
-		polygon.Optimize(&mesh.m_points[0].m_x, sizeof (dgFloat64), 1000.0f, meshSimplicationMaxFaceCount);
+dgInt32 dgMeshEffectSimplifier::SimplifyRegion (const dgRegionDescriptor* const descriptor, const dgRegion& region, dgInt32 threadID)
+{
+	if (region.m_count <= region.m_target) {
+		return region.m_count;
+	}
 
-		mesh.RemoveAll();
-		
-		mark = polygon.IncLRU();
-		mesh.BeginFace();
-		dgPolyhedra::Iterator iter1 (polygon);
-		for (iter1.Begin(); iter1; iter1 ++){
-			dgEdge* const face = &(*iter1);
-			if ((face->m_mark != mark) && (face->m_incidentFace > 0)) {
-				dgInt32	index[DG_MESH_EFFECT_POINT_SPLITED];
-				dgEdge* ptr = face;
-				dgInt32 indexCount = 0;
-				do {
-					ptr->m_mark = mark;
-					index[indexCount] = dgInt32 (ptr->m_incidentVertex);
-					indexCount ++;
-					ptr = ptr->m_next;
-				} while (ptr != face);
-				mesh.AddFace(indexCount, index);
+	dgMemoryAllocator* const allocator = descriptor->m_allocators[threadID];
+	dgInt32* const vertexMap = descriptor->m_vertexMap[threadID];
+	const dgBigVector* const points = descriptor->m_points;
+	const dgInt8* const lockedVertex = descriptor->m_lockedVertex;
+	dgTriangle* const faces = &descriptor->m_faces[region.m_start];
+
+	// the faces are copied because the region is overwritten with the simplified faces
+	dgArray<dgTriangle> regionFaces (allocator);
+	dgArray<dgBigVector> localPoints (allocator);
+	dgArray<dgInt32> globalIndex (allocator);
+	dgArray<dgInt8> localLocked (allocator);
+	dgArray<dgInt32> keptFaces (allocator);
+	regionFaces.ResizeIfNecessary (region.m_count);
+	memcpy (&regionFaces[0], faces, region.m_count * sizeof (dgTriangle));
+
+	dgInt32 pointCount = 0;
+	dgInt32 keptCount = 0;
+	dgPolyhedra polyhedra (allocator);
+	polyhedra.BeginFace();
+	for (dgInt32 i = 0; i < region.m_count; i ++) {
+		dgInt32 index[3];
+		const dgTriangle& face = regionFaces[i];
+		for (dgInt32 j = 0; j < 3; j ++) {
+			const dgInt32 k = face.m_index[j];
+			if (vertexMap[k] < 0) {
+				vertexMap[k] = pointCount;
+				localPoints[pointCount] = (points[k] - descriptor->m_origin).Scale3 (descriptor->m_scale);
+				localPoints[pointCount].m_w = dgFloat64 (0.0f);
+				localLocked[pointCount] = lockedVertex[k];
+				globalIndex[pointCount] = k;
+				pointCount ++;
 			}
+			index[j] = vertexMap[k];
 		}
-		mesh.EndFace();
 
-		faceCount = mesh.GetTotalFaceCount();
-		mesh.ClearAttributeArray();
+		dgEdge* const edge = polyhedra.AddFace (3, index);
+		if (edge) {
+			dgEdge* ptr = edge;
+			do {
+				ptr->m_incidentFace = i + 1;
+				ptr = ptr->m_next;
+			} while (ptr != edge);
+		} else {
+			keptFaces[keptCount] = i;
+			keptCount ++;
+		}
+	}
+	polyhedra.EndFace();
+
+	// the faces that could not be added are kept as they are, their vertices and
+	// the vertices where two open borders meet can not be removed
+	for (dgInt32 i = 0; i < keptCount; i ++) {
+		const dgTriangle& face = regionFaces[keptFaces[i]];
+		for (dgInt32 j = 0; j < 3; j ++) {
+			localLocked[vertexMap[face.m_index[j]]] = 1;
+		}
+	}
+	dgStack<dgInt8> borderCount (pointCount);
+	memset (&borderCount[0], 0, borderCount.GetSizeInBytes());
+	dgPolyhedra::Iterator iter (polyhedra);
+	for (iter.Begin(); iter; iter ++) {
+		dgEdge* const edge = &(*iter);
+		if (edge->m_incidentFace < 0) {
+			borderCount[edge->m_incidentVertex] ++;
+			if (borderCount[edge->m_incidentVertex] > 1) {
+				localLocked[edge->m_incidentVertex] = 1;
+			}
+		}
 	}
 
-	// create a general connectivity graph    
-	dgHACDClusterGraph graph (mesh, backFaceDistanceFactor, reportProgressCallback);
+	const dgInt32 maxFaceCount = dgMax (region.m_target - keptCount, 0);
+	if (maxFaceCount < (region.m_count - keptCount)) {
+		polyhedra.Optimize (&localPoints[0].m_x, sizeof (dgBigVector), NULL, NULL, dgFloat64 (0.0f), maxFaceCount, &localLocked[0]);
+	}
 
-	// calculate initial edge costs
-	graph.SubmitInitialEdgeCosts (mesh);
+	dgInt32 count = 0;
+	for (dgInt32 i = 0; i < keptCount; i ++) {
+		faces[count] = regionFaces[keptFaces[i]];
+		count ++;
+	}
 
-	// collapse the graph
-	graph.CollapseClusters (mesh, maxConcavity, maxHullsCount);
+	// collapsing edges only removes faces, so the faces are still triangles
+	const dgInt32 mark = polyhedra.IncLRU();
+	for (iter.Begin(); iter; iter ++) {
+		dgEdge* const edge = &(*iter);
+		if ((edge->m_incidentFace > 0) && (edge->m_mark != mark)) {
+			const dgInt32 attribute = regionFaces[edge->m_incidentFace - 1].m_attribute;
+			dgEdge* ptr = edge;
+			do {
+				ptr->m_mark = mark;
+				ptr = ptr->m_next;
+			} while (ptr != edge);
 
-	// Create Partition Mesh
-	return graph.CreatePatitionMesh (mesh, maxVertexPerHull);
-*/
+			for (ptr = edge->m_next->m_next; ptr != edge; ptr = ptr->m_next) {
+				dgAssert (count < region.m_count);
+				dgTriangle& face = faces[count];
+				face.m_index[0] = globalIndex[edge->m_incidentVertex];
+				face.m_index[1] = globalIndex[ptr->m_prev->m_incidentVertex];
+				face.m_index[2] = globalIndex[ptr->m_incidentVertex];
+				face.m_attribute = attribute;
+				count ++;
+			}
+		}
+	}
+
+	for (dgInt32 i = 0; i < pointCount; i ++) {
+		vertexMap[globalIndex[i]] = -1;
+	}
+	return count;
+}
+
+void dgMeshEffectSimplifier::SimplifyRegionsKernel (void* const context, void* const unused, dgInt32 threadID)
+{
+	dgRegionDescriptor* const descriptor = (dgRegionDescriptor*) context;
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_regionCount; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+		dgRegion& region = descriptor->m_regions[i];
+		region.m_count = SimplifyRegion (descriptor, region, threadID);
+	}
+}
+
+void dgMeshEffectSimplifier::SimplifyFaces (dgInt32 firstFace, dgInt32 maxFaceCount, const dgInt8* const lockedVertex, dgReportProgress reportProgressCallback, void* const userData)
+{
+	dgInt32 faceCount = m_faceCount - firstFace;
+	if (faceCount <= maxFaceCount) {
+		return;
+	}
+
+	dgTriangle* const faces = &m_faces[firstFace];
+	dgBigVector minBox (dgFloat64 (1.0e20f), dgFloat64 (1.0e20f), dgFloat64 (1.0e20f), dgFloat64 (0.0f));
+	dgBigVector maxBox (dgFloat64 (-1.0e20f), dgFloat64 (-1.0e20f), dgFloat64 (-1.0e20f), dgFloat64 (0.0f));
+	dgFloat64 area = dgFloat64 (0.0f);
+	for (dgInt32 i = 0; i < faceCount; i ++) {
+		const dgBigVector& p0 = m_points[faces[i].m_index[0]];
+		const dgBigVector& p1 = m_points[faces[i].m_index[1]];
+		const dgBigVector& p2 = m_points[faces[i].m_index[2]];
+		minBox = minBox.GetMin (p0.GetMin (p1.GetMin (p2)));
+		maxBox = maxBox.GetMax (p0.GetMax (p1.GetMax (p2)));
+		const dgBigVector normal ((p1 - p0).CrossProduct3 (p2 - p0));
+		area += sqrt (normal.DotProduct3 (normal));
+	}
+	area = dgMax (area * dgFloat64 (0.5f), dgFloat64 (1.0e-12f));
+
+	dgRegionDescriptor descriptor;
+	// the collapse thresholds of the polyhedra are absolute values, the mesh is scaled so that 
+	// a face of the simplified mesh has the same area no matter the size of the mesh
+	descriptor.m_origin = minBox;
+	descriptor.m_scale = sqrt (DG_SIMPLIFIER_FACE_AREA * maxFaceCount / area);
+	descriptor.m_points = &m_points[0];
+
+	// the worker threads are borrowed on each call, since the owner of the hive may be using them by now
+	dgScopeIdleThreadPool scopeThreadPool (m_threadPool);
+	dgThreadHive* const threadPool = scopeThreadPool.GetPool();
+	const dgInt32 threadCount = threadPool ? threadPool->GetThreadCount() : 1;
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		descriptor.m_allocators[i] = (threadCount > 1) ? new dgMemoryAllocator() : m_allocator;
+		descriptor.m_vertexMap[i] = (dgInt32*) descriptor.m_allocators[i]->Malloc (dgInt32 (m_pointCount * sizeof (dgInt32)));
+		memset (descriptor.m_vertexMap[i], -1, m_pointCount * sizeof (dgInt32));
+	}
+
+	dgStack<dgSortKey> regionKeys (faceCount);
+	dgStack<dgTriangle> sortedFaces (faceCount);
+	dgStack<dgRegion> regions (faceCount);
+	dgStack<dgInt8> regionLocked (m_pointCount);
+	dgStack<dgInt32> vertexRegion (m_pointCount);
+
+	const dgInt32 initialFaceCount = faceCount;
+	for (dgInt32 pass = 0; (pass < DG_SIMPLIFIER_MAX_PASSES) && (faceCount > maxFaceCount); pass ++) {
+		// the regions are the cells of a grid with about the same number of faces in each cell, 
+		// the grid is shifted on each pass so that the borders of the regions are simplified too
+		const dgFloat64 cellSize = sqrt (area * DG_SIMPLIFIER_REGION_SIZE / faceCount);
+		const dgFloat64 invCellSize = (faceCount > 2 * DG_SIMPLIFIER_REGION_SIZE) ? dgFloat64 (1.0f) / cellSize : dgFloat64 (0.0f);
+		const dgFloat64 offset = (pass & 1) ? cellSize * dgFloat64 (0.5f) : dgFloat64 (0.0f);
+		const dgBigVector origin (minBox - dgBigVector (offset, offset, offset, dgFloat64 (0.0f)));
+		for (dgInt32 i = 0; i < faceCount; i ++) {
+			const dgBigVector centre ((m_points[faces[i].m_index[0]] + m_points[faces[i].m_index[1]] + m_points[faces[i].m_index[2]]).Scale3 (dgFloat64 (1.0f / 3.0f)));
+			const dgBigVector cell ((centre - origin).Scale3 (invCellSize));
+			const dgInt64 x = dgClamp (dgInt64 (cell.m_x), dgInt64 (0), dgInt64 (0xfffff));
+			const dgInt64 y = dgClamp (dgInt64 (cell.m_y), dgInt64 (0), dgInt64 (0xfffff));
+			const dgInt64 z = dgClamp (dgInt64 (cell.m_z), dgInt64 (0), dgInt64 (0xfffff));
+			regionKeys[i].m_key = (x << 40) + (y << 20) + z;
+			regionKeys[i].m_index = i;
+		}
+		dgSort (&regionKeys[0], faceCount, CompareSortKeys);
+		for (dgInt32 i = 0; i < faceCount; i ++) {
+			sortedFaces[i] = faces[regionKeys[i].m_index];
+		}
+		memcpy (faces, &sortedFaces[0], faceCount * sizeof (dgTriangle));
+
+		dgInt32 regionCount = 0;
+		for (dgInt32 i = 0; i < faceCount; ) {
+			dgInt32 j = i + 1;
+			for (; (j < faceCount) && (regionKeys[j].m_key == regionKeys[i].m_key); j ++);
+			regions[regionCount].m_start = i;
+			regions[regionCount].m_count = j - i;
+			regionCount ++;
+			i = j;
+		}
+
+		// vertices shared by two regions can not be removed
+		if (lockedVertex) {
+			memcpy (&regionLocked[0], lockedVertex, m_pointCount * sizeof (dgInt8));
+		} else {
+			memset (&regionLocked[0], 0, m_pointCount * sizeof (dgInt8));
+		}
+		memset (&vertexRegion[0], -1, m_pointCount * sizeof (dgInt32));
+		for (dgInt32 i = 0; i < regionCount; i ++) {
+			for (dgInt32 j = 0; j < regions[i].m_count; j ++) {
+				const dgTriangle& face = faces[regions[i].m_start + j];
+				for (dgInt32 k = 0; k < 3; k ++) {
+					const dgInt32 index = face.m_index[k];
+					if (vertexRegion[index] < 0) {
+						vertexRegion[index] = i;
+					} else if (vertexRegion[index] != i) {
+						regionLocked[index] = 1;
+					}
+				}
+			}
+		}
+
+		// the faces touching a locked vertex stay, the budget left is split between the other faces. 
+		// the first pass keeps the density of the target mesh, so the borders end at the same density
+		dgInt32 borderFaceCount = 0;
+		for (dgInt32 i = 0; i < regionCount; i ++) {
+			dgInt32 count = 0;
+			for (dgInt32 j = 0; j < regions[i].m_count; j ++) {
+				const dgTriangle& face = faces[regions[i].m_start + j];
+				count += (regionLocked[face.m_index[0]] | regionLocked[face.m_index[1]] | regionLocked[face.m_index[2]]) ? 1 : 0;
+			}
+			regions[i].m_target = count;
+			borderFaceCount += count;
+		}
+		const dgInt32 innerFaceCount = faceCount - borderFaceCount;
+		dgFloat64 ratio = dgFloat64 (maxFaceCount) / faceCount;
+		if ((pass > 0) || (regionCount == 1)) {
+			ratio = innerFaceCount ? dgFloat64 (maxFaceCount - borderFaceCount) / innerFaceCount : dgFloat64 (0.0f);
+		}
+		ratio = dgClamp (ratio, dgFloat64 (0.0f), dgFloat64 (1.0f));
+		for (dgInt32 i = 0; i < regionCount; i ++) {
+			const dgInt32 innerCount = regions[i].m_count - regions[i].m_target;
+			regions[i].m_target += dgInt32 (innerCount * ratio + dgFloat64 (0.5f));
+		}
+
+		descriptor.m_faces = faces;
+		descriptor.m_regions = &regions[0];
+		descriptor.m_lockedVertex = &regionLocked[0];
+		descriptor.m_regionCount = regionCount;
+		descriptor.m_index = 0;
+		if ((threadCount > 1) && (regionCount > 1)) {
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				threadPool->QueueJob (SimplifyRegionsKernel, &descriptor, NULL, "dgMeshEffectSimplifier::SimplifyFaces");
+			}
+			threadPool->SynchronizationBarrier();
+		} else {
+			SimplifyRegionsKernel (&descriptor, NULL, 0);
+		}
+
+		dgInt32 count = 0;
+		for (dgInt32 i = 0; i < regionCount; i ++) {
+			memmove (&faces[count], &faces[regions[i].m_start], regions[i].m_count * sizeof (dgTriangle));
+			count += regions[i].m_count;
+		}
+		const bool progress = count < faceCount;
+		faceCount = count;
+		m_faceCount = firstFace + faceCount;
+
+		if (reportProgressCallback) {
+			const dgFloat32 param = dgFloat32 (initialFaceCount - faceCount) / dgMax (initialFaceCount - maxFaceCount, 1);
+			if (!reportProgressCallback (dgMin (param, dgFloat32 (1.0f)), userData)) {
+				break;
+			}
+		}
+		if (!progress && (regionCount == 1)) {
+			break;
+		}
+	}
+
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		descriptor.m_allocators[i]->Free (descriptor.m_vertexMap[i]);
+		if (threadCount > 1) {
+			delete descriptor.m_allocators[i];
+		}
+	}
+}
+
+void dgMeshEffectSimplifier::Simplify (dgReportProgress reportProgressCallback, void* const userData)
+{
+	FlushBatch ();
+	if (m_needsWeld) {
+		WeldVertices ();
+	}
+	SimplifyFaces (0, m_maxFaceCount, NULL, reportProgressCallback, userData);
+	RemoveUnusedVertices (0, 0);
+}
+
+void dgMeshEffectSimplifier::BuildCollisionTree (dgCollisionBVH* const collision, dgInt32 optimize) const
+{
+	collision->BeginBuild();
+	for (dgInt32 i = 0; i < m_faceCount; i ++) {
+		dgFloat32 vertex[3][3];
+		const dgTriangle& face = m_faces[i];
+		for (dgInt32 j = 0; j < 3; j ++) {
+			const dgBigVector& p = m_points[face.m_index[j]];
+			vertex[j][0] = dgFloat32 (p.m_x);
+			vertex[j][1] = dgFloat32 (p.m_y);
+			vertex[j][2] = dgFloat32 (p.m_z);
+		}
+		collision->AddFace (3, &vertex[0][0], sizeof (vertex[0]), face.m_attribute);
+	}
+	collision->EndBuild(optimize);
+}
+
+dgMeshEffect* dgMeshEffectSimplifier::CreateMesh () const
+{
+	dgMeshEffect* const mesh = new (m_allocator) dgMeshEffect (m_allocator);
+	if (m_faceCount) {
+		dgStack<dgInt32> faceIndexCount (m_faceCount);
+		dgStack<dgInt32> faceMaterial (m_faceCount);
+		dgStack<dgInt32> indexList (m_faceCount * 3);
+		for (dgInt32 i = 0; i < m_faceCount; i ++) {
+			const dgTriangle& face = m_faces[i];
+			faceIndexCount[i] = 3;
+			faceMaterial[i] = face.m_attribute;
+			indexList[i * 3 + 0] = face.m_index[0];
+			indexList[i * 3 + 1] = face.m_index[1];
+			indexList[i * 3 + 2] = face.m_index[2];
+		}
+
+		dgMeshEffect::dgMeshVertexFormat format;
+		format.m_faceCount = m_faceCount;
+		format.m_faceIndexCount = &faceIndexCount[0];
+		format.m_faceMaterial = &faceMaterial[0];
+		format.m_vertex.m_data = &m_points[0].m_x;
+		format.m_vertex.m_indexList = &indexList[0];
+		format.m_vertex.m_strideInBytes = sizeof (dgBigVector);
+		mesh->BuildFromIndexList (&format);
+	}
+	return mesh;
+}
+
+dgMeshEffect* dgMeshEffect::CreateSimplification(dgInt32 maxVertexCount, dgReportProgress reportProgressCallback, void* const reportPrgressUserData, dgThreadHive* const threadPool) const
+{
+	if (GetVertexCount() <= maxVertexCount) {
+		return new (GetAllocator()) dgMeshEffect(*this); 
+	}
+
+	// a closed triangle mesh has two faces per vertex, minus four
+	dgMeshEffectSimplifier simplifier (GetAllocator(), maxVertexCount * 2 - 4, GetTotalFaceCount(), threadPool);
+	simplifier.AddMesh (this);
+	simplifier.Simplify (reportProgressCallback, reportPrgressUserData);
+	return simplifier.CreateMesh ();
 }
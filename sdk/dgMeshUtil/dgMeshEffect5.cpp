@@ -296,11 +296,29 @@ bool dgMeshEffect::PlaneClip(const dgMeshEffect& convexMesh, const dgEdge* const
 }
 
 
+class dgConvexMeshIntersectionDescriptor
+{
+	public:
+	const dgMeshEffect* m_mesh;
+	const dgMeshEffect* const* m_convexMeshArray;
+	dgMeshEffect** m_intersections;
+	dgMemoryAllocator* m_allocators[DG_MAX_THREADS_HIVE_COUNT];
+	dgInt32 m_count;
+	dgInt32 m_index;
+};
+
 dgMeshEffect* dgMeshEffect::ConvexMeshIntersection (const dgMeshEffect* const convexMeshSrc) const
 {
-	dgMeshEffect convexMesh (*convexMeshSrc);
+	return ConvexMeshIntersection (convexMeshSrc, GetAllocator());
+}
+
+dgMeshEffect* dgMeshEffect::ConvexMeshIntersection (const dgMeshEffect* const convexMeshSrc, dgMemoryAllocator* const allocator) const
+{
+	// the source meshes are only read, all the memory is taken from the allocator, 
+	// so different intersections can be calculated concurrently using different allocators
+	dgMeshEffect convexMesh (allocator, *convexMeshSrc);
 	convexMesh.ConvertToPolygons();
-	dgMeshEffect* const convexIntersection = new (GetAllocator()) dgMeshEffect (*this);
+	dgMeshEffect* const convexIntersection = new (allocator) dgMeshEffect (allocator, *this);
 
 	dgInt32 mark = convexMesh.IncLRU();
 	dgPolyhedra::Iterator iter (convexMesh);
@@ -328,6 +346,132 @@ dgMeshEffect* dgMeshEffect::ConvexMeshIntersection (const dgMeshEffect* const co
 	return convexIntersection;
 }
 
+void dgMeshEffect::ConvexMeshIntersectionKernel (void* const context, void* const unused, dgInt32 threadID)
+{
+	dgConvexMeshIntersectionDescriptor* const descriptor = (dgConvexMeshIntersectionDescriptor*) context;
+	dgMemoryAllocator* const allocator = descriptor->m_allocators[threadID];
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < descriptor->m_count; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+		descriptor->m_intersections[i] = descriptor->m_mesh->ConvexMeshIntersection (descriptor->m_convexMeshArray[i], allocator);
+	}
+}
+
+void dgMeshEffect::ConvexMeshIntersection (dgInt32 count, const dgMeshEffect* const* const convexMeshArray, dgMeshEffect** const intersections, dgThreadHive* const threadPool) const
+{
+	const dgInt32 threadCount = threadPool ? threadPool->GetThreadCount() : 1;
+	if ((threadCount <= 1) || (count <= 1)) {
+		for (dgInt32 i = 0; i < count; i ++) {
+			intersections[i] = ConvexMeshIntersection (convexMeshArray[i]);
+		}
+		return;
+	}
+
+	// the memory pools are not thread safe, each worker clips its pieces with its own allocator
+	dgConvexMeshIntersectionDescriptor descriptor;
+	descriptor.m_mesh = this;
+	descriptor.m_convexMeshArray = convexMeshArray;
+	descriptor.m_intersections = intersections;
+	descriptor.m_count = count;
+	descriptor.m_index = 0;
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		descriptor.m_allocators[i] = new dgMemoryAllocator();
+	}
+
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		threadPool->QueueJob (ConvexMeshIntersectionKernel, &descriptor, NULL, "dgMeshEffect::ConvexMeshIntersection");
+	}
+	threadPool->SynchronizationBarrier();
+
+	// move the pieces to the allocator of this mesh
+	dgMemoryAllocator* const allocator = GetAllocator();
+	for (dgInt32 i = 0; i < count; i ++) {
+		dgMeshEffect* const piece = intersections[i];
+		if (piece) {
+			intersections[i] = new (allocator) dgMeshEffect (allocator, *piece);
+			delete piece;
+		}
+	}
+
+	for (dgInt32 i = 0; i < threadCount; i ++) {
+		delete descriptor.m_allocators[i];
+	}
+}
+
+dgMeshEffectConvexIntersectionTask::dgMeshEffectConvexIntersectionTask (const dgMeshEffect* const mesh, dgInt32 count, const dgMeshEffect* const* const convexMeshArray)
+	:dgThread()
+	,m_resultAllocator(mesh->GetAllocator())
+	,m_allocator(new dgMemoryAllocator())
+	,m_mesh(NULL)
+	,m_convexMeshes(NULL)
+	,m_intersections(NULL)
+	,m_count(count)
+	,m_joined(false)
+{
+	m_mesh = new (m_allocator) dgMeshEffect (m_allocator, *mesh);
+	m_convexMeshes = (dgMeshEffect**) m_allocator->Malloc (dgInt32 (2 * count * sizeof (dgMeshEffect*)));
+	m_intersections = &m_convexMeshes[count];
+	for (dgInt32 i = 0; i < count; i ++) {
+		m_convexMeshes[i] = new (m_allocator) dgMeshEffect (m_allocator, *convexMeshArray[i]);
+		m_intersections[i] = NULL;
+	}
+
+	Init ("dgMeshEffectConvexIntersectionTask", 0);
+#ifdef DG_USE_THREAD_EMULATION
+	Execute (0);
+#endif
+}
+
+dgMeshEffectConvexIntersectionTask::~dgMeshEffectConvexIntersectionTask ()
+{
+	// pieces that were not collected are discarded, stop clipping as soon as possible
+	dgInterlockedExchange(&m_terminate, 1);
+	Wait ();
+	for (dgInt32 i = 0; i < m_count; i ++) {
+		delete m_convexMeshes[i];
+		if (m_intersections[i]) {
+			delete m_intersections[i];
+		}
+	}
+	m_allocator->Free (m_convexMeshes);
+	delete m_mesh;
+	delete m_allocator;
+}
+
+void dgMeshEffectConvexIntersectionTask::Execute (dgInt32 threadID)
+{
+	for (dgInt32 i = 0; (i < m_count) && !m_terminate; i ++) {
+		m_intersections[i] = m_mesh->ConvexMeshIntersection (m_convexMeshes[i], m_allocator);
+	}
+}
+
+bool dgMeshEffectConvexIntersectionTask::IsDone () const
+{
+	return !IsThreadActive();
+}
+
+void dgMeshEffectConvexIntersectionTask::Wait ()
+{
+	if (!m_joined) {
+		m_joined = true;
+#ifndef DG_USE_THREAD_EMULATION
+		Close ();
+#endif
+	}
+}
+
+void dgMeshEffectConvexIntersectionTask::GetIntersections (dgMeshEffect** const intersections)
+{
+	Wait ();
+	for (dgInt32 i = 0; i < m_count; i ++) {
+		dgMeshEffect* const piece = m_intersections[i];
+		intersections[i] = NULL;
+		if (piece) {
+			intersections[i] = new (m_resultAllocator) dgMeshEffect (m_resultAllocator, *piece);
+			delete piece;
+			m_intersections[i] = NULL;
+		}
+	}
+}
+
 
 void dgMeshEffect::ClipMesh (const dgMatrix& matrix, const dgMeshEffect* const clipMesh, dgMeshEffect** const back, dgMeshEffect** const front) const
 {
@@ -96,9 +96,24 @@ void SaveCollision (const NewtonCollision* const collisionPtr)
   Applications can use this function to ascertain that the memory use by the
   engine is balanced at all times.
 
-  See also: ::NewtonCreate
+  The value saturates at 2 GBytes, use NewtonGetMemoryUsed64 for the full value.
+
+  See also: ::NewtonCreate, ::NewtonGetMemoryUsed64
 */
 int NewtonGetMemoryUsed()
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	return int (dgMin (dgMemoryAllocator::GetGlobalMemoryUsed(), dgInt64 (0x7fffffff)));
+}
+
+/*!
+  Return the exact amount of memory (in Bytes) use by the engine at any given time, as a 64 bit value.
+
+  @return total memory use by the engine.
+
+  See also: ::NewtonGetMemoryUsed
+*/
+dLong NewtonGetMemoryUsed64()
 {
 	TRACE_FUNCTION(__FUNCTION__);
 	return dgMemoryAllocator::GetGlobalMemoryUsed();
@@ -565,6 +580,149 @@ int NewtonGetMultiThreadSolverOnSingleIsland(const NewtonWorld* const newtonWorl
 	return world->GetThreadOnSingleIsland();
 }
 
+/*!
+  Enable or disable speculative contacts for all bodies with continuous collision.
+
+  @param *newtonWorld is the pointer to the Newton world.
+  @param mode 0 uses time of impact sub steps, 1 uses speculative contacts.
+
+  When on, a body with continuous collision that is not touching but will hit another body 
+  during the step generates contacts at the time of impact with a negative penetration, and the 
+  solver resolves them in a single pass, instead of sub stepping the island to the time of impact.
+  This is much cheaper on islands with many fast bodies, at the cost of some accuracy since the 
+  contact points are the ones at the impact configuration.
+
+  See also: ::NewtonBodySetSpeculativeContactsMode, ::NewtonBodySetContinuousCollisionMode
+*/
+void NewtonSetSpeculativeContacts(const NewtonWorld* const newtonWorld, int mode)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	world->EnableSpeculativeContacts (mode);
+}
+
+int NewtonGetSpeculativeContacts(const NewtonWorld* const newtonWorld)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	return world->GetSpeculativeContacts();
+}
+
+/*!
+  Enable or disable skipping the broadphase update of sleeping bodies.
+
+  @param *newtonWorld is the pointer to the Newton world.
+  @param mode 0 every body searches the broadphase each step, 1 only awake bodies do.
+
+  With this option on, sleeping bodies do not search the broadphase for new pairs, pairs 
+  between an awake and a sleeping body are still found by the awake body. 
+  This saves most of the broadphase cost on scenes where the majority of the bodies are at rest.
+  Only the default broadphase uses this option.
+
+  See also: ::NewtonWorldSetIslandSleepState, ::NewtonSelectBroadphaseAlgorithm
+*/
+void NewtonSetSleepAwareBroadphase(const NewtonWorld* const newtonWorld, int mode)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	world->EnableSleepAwareBroadphase (mode);
+}
+
+int NewtonGetSleepAwareBroadphase(const NewtonWorld* const newtonWorld)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	return world->GetSleepAwareBroadphase();
+}
+
+/*!
+  Pre size the memory used for the temporary buffers of a simulation step.
+
+  @param *newtonWorld is the pointer to the Newton world.
+  @param sharedSizeInBytes size of the buffer used by the calling thread, solver rows and body forces.
+  @param perThreadSizeInBytes size of the buffer of each worker thread.
+
+  The step temporaries are taken linearly from these buffers and released all at once at the end 
+  of the step. When a step needs more memory, the extra is taken from the heap and the buffers grow 
+  to the high water mark on the next step, so this call is only needed to avoid the first few 
+  allocations. The buffers never shrink. This function must not be called during an update.
+
+  See also: ::NewtonGetFrameMemoryStatistics
+*/
+void NewtonReserveFrameMemory(const NewtonWorld* const newtonWorld, int sharedSizeInBytes, int perThreadSizeInBytes)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	world->GetFrameAllocator().Reserve (sharedSizeInBytes, perThreadSizeInBytes);
+}
+
+/*!
+  Get the usage of the step temporaries memory.
+
+  @param *newtonWorld is the pointer to the Newton world.
+  @param *capacity total bytes reserved by all the buffers, can be NULL.
+  @param *highWaterMark largest number of bytes used by a step since the statistics were cleared, can be NULL.
+  @param *allocatorCalls number of times the memory allocator was called since the statistics were cleared, can be NULL.
+
+  A scene that reached its steady state reports zero allocator calls.
+
+  See also: ::NewtonReserveFrameMemory, ::NewtonClearFrameMemoryStatistics
+*/
+void NewtonGetFrameMemoryStatistics(const NewtonWorld* const newtonWorld, dLong* const capacity, dLong* const highWaterMark, dLong* const allocatorCalls)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	const dgFrameAllocator& frameAllocator = world->GetFrameAllocator();
+	if (capacity) {
+		*capacity = frameAllocator.GetCapacity();
+	}
+	if (highWaterMark) {
+		*highWaterMark = frameAllocator.GetHighWaterMark();
+	}
+	if (allocatorCalls) {
+		*allocatorCalls = frameAllocator.GetAllocatorCalls();
+	}
+}
+
+void NewtonClearFrameMemoryStatistics(const NewtonWorld* const newtonWorld)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	world->GetFrameAllocator().ClearStatistics();
+}
+
+/*!
+  Get the memory used by one of the engine subsystems.
+
+  @param *newtonWorld is the pointer to the Newton world.
+  @param category subsystem to query, one of NEWTON_MEMORY_GENERAL, NEWTON_MEMORY_BROADPHASE, NEWTON_MEMORY_CONTACTS, 
+  NEWTON_MEMORY_COLLISION_SHAPES, NEWTON_MEMORY_MESHES, NEWTON_MEMORY_SOLVER or NEWTON_MEMORY_SKELETONS.
+  @param *memoryUsed bytes currently allocated by the subsystem, can be NULL.
+  @param *peakMemoryUsed largest number of bytes allocated by the subsystem during the last step, can be NULL.
+  @param *allocationsCount number of allocations made by the subsystem during the last step, can be NULL.
+
+  Only the memory allocated with the world allocator is reported, the peaks and allocation counts 
+  are reset at the beginning of each step.
+
+  See also: ::NewtonGetMemoryUsed
+*/
+void NewtonGetMemoryStatistics(const NewtonWorld* const newtonWorld, int category, dLong* const memoryUsed, dLong* const peakMemoryUsed, dLong* const allocationsCount)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	dgMemoryStatistics statistics;
+	world->dgWorld::GetAllocator()->GetMemoryStatistics (dgMemoryCategory (dgClamp (category, dgInt32 (m_memoryGeneral), dgInt32 (m_memoryCategoriesCount - 1))), statistics);
+	if (memoryUsed) {
+		*memoryUsed = statistics.m_memoryUsed;
+	}
+	if (peakMemoryUsed) {
+		*peakMemoryUsed = statistics.m_peakMemoryUsed;
+	}
+	if (allocationsCount) {
+		*allocationsCount = statistics.m_allocationsCount;
+	}
+}
+
 /*!
   Set the solver precision mode.
 
@@ -859,6 +1017,106 @@ void NewtonWorldForEachBodyInAABBDo(const NewtonWorld* const newtonWorld, const
 	world->GetBroadPhase()->ForEachBodyInAABB (q0, q1, (OnBodiesInAABB) callback, userData);
 }
 
+/*!
+  Iterate over every body in the island of a body.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *body the body that selects the island.
+  @param callback application defined callback, returning zero stops the iteration.
+  @param *userData pointer to the user defined user data value.
+
+  @return the number of bodies visited.
+
+  An island is the set of dynamic bodies connected to the body by joints or by active contacts.
+  Static bodies do not belong to any island, and calling this function with a static body does nothing.
+
+  See also: ::NewtonWorldSetIslandSleepState, ::NewtonWorldSetIslandFreezeState
+*/
+int NewtonWorldForEachBodyInIslandDo(const NewtonWorld* const newtonWorld, const NewtonBody* const body, NewtonBodyIterator callback, void* const userData)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	return world->ForEachBodyInIsland ((dgBody*)body, (OnBodiesInAABB) callback, userData);
+}
+
+/*!
+  Wake up or put to sleep every body in the island of a body.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *body the body that selects the island.
+  @param state 0 wakes up the island, 1 puts it to sleep.
+
+  @return the number of bodies changed.
+
+  See also: ::NewtonWorldForEachBodyInIslandDo, ::NewtonBodySetSleepState
+*/
+int NewtonWorldSetIslandSleepState(const NewtonWorld* const newtonWorld, const NewtonBody* const body, int state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	return world->SetIslandSleepState ((dgBody*)body, state ? true : false);
+}
+
+/*!
+  Freeze or unfreeze every body in the island of a body.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *body the body that selects the island.
+  @param state 0 unfreezes the island, 1 freezes it.
+
+  @return the number of bodies changed.
+
+  See also: ::NewtonWorldForEachBodyInIslandDo, ::NewtonBodySetFreezeState
+*/
+int NewtonWorldSetIslandFreezeState(const NewtonWorld* const newtonWorld, const NewtonBody* const body, int state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	return world->SetIslandFreezeState ((dgBody*)body, state ? true : false);
+}
+
+/*!
+  Wake up or put to sleep every dynamic body overlapping an AABB.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *p0 - pointer to an array of at least three floats with the minimum value of the AABB.
+  @param *p1 - pointer to an array of at least three floats with the maximum value of the AABB.
+  @param state 0 wakes up the bodies, 1 puts them to sleep.
+
+  @return the number of bodies changed.
+
+  See also: ::NewtonWorldForEachBodyInAABBDo, ::NewtonWorldSetIslandSleepState
+*/
+int NewtonWorldSetBodiesSleepStateInAABB(const NewtonWorld* const newtonWorld, const dFloat* const p0, const dFloat* const p1, int state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	dgVector q0 (dgMin (p0[0], p1[0]), dgMin (p0[1], p1[1]), dgMin (p0[2], p1[2]), dgFloat32 (0.0f));
+	dgVector q1 (dgMax (p0[0], p1[0]), dgMax (p0[1], p1[1]), dgMax (p0[2], p1[2]), dgFloat32 (0.0f));
+	return world->SetSleepStateInAABB (q0, q1, state ? true : false);
+}
+
+/*!
+  Freeze or unfreeze every dynamic body overlapping an AABB.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *p0 - pointer to an array of at least three floats with the minimum value of the AABB.
+  @param *p1 - pointer to an array of at least three floats with the maximum value of the AABB.
+  @param state 0 unfreezes the bodies, 1 freezes them.
+
+  @return the number of bodies changed.
+
+  See also: ::NewtonWorldForEachBodyInAABBDo, ::NewtonWorldSetIslandFreezeState
+*/
+int NewtonWorldSetBodiesFreezeStateInAABB(const NewtonWorld* const newtonWorld, const dFloat* const p0, const dFloat* const p1, int state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	dgVector q0 (dgMin (p0[0], p1[0]), dgMin (p0[1], p1[1]), dgMin (p0[2], p1[2]), dgFloat32 (0.0f));
+	dgVector q1 (dgMax (p0[0], p1[0]), dgMax (p0[1], p1[1]), dgMax (p0[2], p1[2]), dgFloat32 (0.0f));
+	return world->SetFreezeStateInAABB (q0, q1, state ? true : false);
+}
+
 
 /*!
   Return the current library version number.
@@ -1073,6 +1331,71 @@ int NewtonWorldGetConstraintCount(const NewtonWorld* const newtonWorld)
 	return world->GetConstraintsCount();
 }
 
+static void NewtonBodyStateArraysToEngine (const NewtonBodyStateArrays* const state, dgBodyStateArrays& engineState)
+{
+	engineState.m_matrix = state->m_matrix;
+	engineState.m_position = state->m_position;
+	engineState.m_rotation = state->m_rotation;
+	engineState.m_veloc = state->m_veloc;
+	engineState.m_omega = state->m_omega;
+	engineState.m_sleepState = state->m_sleepState;
+	engineState.m_matrixStrideInBytes = state->m_matrixStrideInBytes;
+	engineState.m_positionStrideInBytes = state->m_positionStrideInBytes;
+	engineState.m_rotationStrideInBytes = state->m_rotationStrideInBytes;
+	engineState.m_velocStrideInBytes = state->m_velocStrideInBytes;
+	engineState.m_omegaStrideInBytes = state->m_omegaStrideInBytes;
+	engineState.m_sleepStateStrideInBytes = state->m_sleepStateStrideInBytes;
+}
+
+/*!
+  Read the state of a set of bodies into application arrays in one call.
+
+  @param *newtonWorld pointer to the Newton world.
+  @param *bodies array of bodies to read, if NULL all bodies in the world are read in the order of ::NewtonWorldGetFirstBody, ::NewtonWorldGetNextBody.
+  @param count number of bodies in the array, ignored when bodies is NULL.
+  @param *state arrays to receive the matrix (16 floats), position (3 floats), rotation quaternion (4 floats), velocity (3 floats), 
+  omega (3 floats) and sleep state (one int) of each body, any array set to NULL is skipped.
+
+  @return the number of bodies read.
+
+  The arrays are filled by the worker threads, so this function should not be called while the world is being updated.
+
+  See also: ::NewtonWorldSetBodiesState, ::NewtonBodyGetMatrix
+*/
+int NewtonWorldGetBodiesState (const NewtonWorld* const newtonWorld, const NewtonBody* const* const bodies, int count, const NewtonBodyStateArrays* const state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	dgBodyStateArrays engineState;
+	NewtonBodyStateArraysToEngine (state, engineState);
+	return world->GetBodiesState ((dgBody**) bodies, count, engineState);
+}
+
+/*!
+  Set the state of a set of bodies from application arrays in one call.
+
+  @param *newtonWorld pointer to the Newton world.
+  @param *bodies array of bodies to write, if NULL all bodies in the world are written in the order of ::NewtonWorldGetFirstBody, ::NewtonWorldGetNextBody.
+  @param count number of bodies in the array, ignored when bodies is NULL.
+  @param *state arrays with the new state, any array set to NULL is skipped.
+
+  @return the number of bodies written.
+
+  When the matrix array is present the position and rotation arrays are ignored, otherwise the position and the rotation 
+  are applied separately. Setting the matrix, velocity or omega wakes the body the same as the single body functions, 
+  the sleep state is applied last.
+
+  See also: ::NewtonWorldGetBodiesState, ::NewtonBodySetMatrix
+*/
+int NewtonWorldSetBodiesState (const NewtonWorld* const newtonWorld, const NewtonBody* const* const bodies, int count, const NewtonBodyStateArrays* const state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	dgBodyStateArrays engineState;
+	NewtonBodyStateArraysToEngine (state, engineState);
+	return world->SetBodiesState ((dgBody**) bodies, count, engineState);
+}
+
 
 /*!
   Shoot ray from point p0 to p1 and trigger callback for each body on that line.
@@ -1365,6 +1688,31 @@ void NewtonMaterialSetSurfaceThickness(const NewtonWorld* const newtonWorld, int
 }
 
 
+/*!
+  Set the maximum number of contact points generated between two bodies whose physics
+  properties are defined by this material pair
+
+  @param *newtonWorld pointer to the Newton world.
+  @param  id0 - group id0
+  @param  id1 - group id1
+  @param maxContactCount maximum number of contacts, a value from 1 to 16; the default is 16
+
+  @return Nothing.
+
+  when the collision system generates more points than this value the contact manifold is reduced 
+  keeping the deepest point and the points that better cover the contact area.
+  
+  Lower values reduce the cost of the solver for large contact patches, but very low values can make stacking less stable.
+*/
+void NewtonMaterialSetMaxContactCount(const NewtonWorld* const newtonWorld, int id0, int id1, int maxContactCount)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	dgContactMaterial* const material = world->GetMaterial (dgUnsigned32 (id0), dgUnsigned32 (id1));
+	material->m_maxContactCount = dgClamp (maxContactCount, 1, DG_CONSTRAINT_MAX_ROWS / 3);
+}
+
+
 /*!
   Set the default coefficients of friction for the material interaction between two physics materials .
 
@@ -5681,6 +6029,30 @@ void NewtonBodySetContinuousCollisionMode(const NewtonBody* const bodyPtr, unsig
 	body->SetContinueCollisionMode (state ? true : false);
 }
 
+/*!
+  Use speculative contacts instead of time of impact sub steps for this body continuous collision.
+
+  @param *bodyPtr pointer to the body.
+  @param state 1 enables speculative contacts, 0 uses the world setting.
+
+  This option only has effect when continuous collision is enabled on the body.
+
+  See also: ::NewtonSetSpeculativeContacts, ::NewtonBodySetContinuousCollisionMode
+*/
+void NewtonBodySetSpeculativeContactsMode(const NewtonBody* const bodyPtr, unsigned state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgBody* const body = (dgBody *)bodyPtr;
+	body->SetSpeculativeContactsMode (state ? true : false);
+}
+
+int NewtonBodyGetSpeculativeContactsMode(const NewtonBody* const bodyPtr)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgBody* const body = (dgBody *)bodyPtr;
+	return body->GetSpeculativeContactsMode () ? 1 : 0;
+}
+
 int NewtonBodyGetSerializedID(const NewtonBody* const bodyPtr)
 {
 	TRACE_FUNCTION(__FUNCTION__);
@@ -7688,6 +8060,7 @@ Special effect mesh interface
 NewtonMesh* NewtonMeshCreate(const NewtonWorld* const newtonWorld)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 
 	Newton* const world = (Newton *) newtonWorld;
 	dgMeshEffect* const mesh = new (world->dgWorld::GetAllocator()) dgMeshEffect (world->dgWorld::GetAllocator());
@@ -7697,6 +8070,7 @@ NewtonMesh* NewtonMeshCreate(const NewtonWorld* const newtonWorld)
 NewtonMesh* NewtonMeshCreateFromMesh(const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const srcMesh = (dgMeshEffect*) mesh;
 
 	dgMeshEffect* const clone = new (srcMesh->GetAllocator()) dgMeshEffect (*srcMesh);
@@ -7706,6 +8080,7 @@ NewtonMesh* NewtonMeshCreateFromMesh(const NewtonMesh* const mesh)
 NewtonMesh* NewtonMeshCreateFromCollision(const NewtonCollision* const collision)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 
 	dgCollisionInstance* const shape = (dgCollisionInstance*) collision;
 	dgMeshEffect* const mesh = new (shape->GetAllocator()) dgMeshEffect (shape);
@@ -7715,6 +8090,7 @@ NewtonMesh* NewtonMeshCreateFromCollision(const NewtonCollision* const collision
 NewtonMesh* NewtonMeshCreateConvexHull (const NewtonWorld* const newtonWorld, int count, const dFloat* const vertexCloud, int strideInBytes, dFloat tolerance)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	Newton* const world = (Newton *) newtonWorld;
 	dgStack<dgBigVector> pool (count);
 
@@ -7725,34 +8101,64 @@ NewtonMesh* NewtonMeshCreateConvexHull (const NewtonWorld* const newtonWorld, in
 		pool[i].m_z = vertexCloud[i * stride + 2];
 		pool[i].m_w = dgFloat64 (0.0);
 	}
-	dgMeshEffect* const mesh = new (world->dgWorld::GetAllocator()) dgMeshEffect (world->dgWorld::GetAllocator(), &pool[0].m_x, count, sizeof (dgBigVector), tolerance);
+	dgScopeIdleThreadPool threadPool (world->GetThreadPool());
+	dgMeshEffect* const mesh = new (world->dgWorld::GetAllocator()) dgMeshEffect (world->dgWorld::GetAllocator(), &pool[0].m_x, count, sizeof (dgBigVector), tolerance, threadPool.GetPool());
 	return (NewtonMesh*) mesh;
 }
 
 NewtonMesh* NewtonMeshCreateTetrahedraIsoSurface(const NewtonMesh* const closeManifoldMesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) closeManifoldMesh;
 	return (NewtonMesh*)meshEffect->CreateTetrahedraIsoSurface();
 }
 
+// same as NewtonMeshCreateTetrahedraIsoSurface, but the grid points and the tetrahedra are 
+// classified, and the tetrahedra meshes are built, by the worker threads of the world.
+NewtonMesh* NewtonMeshParallelCreateTetrahedraIsoSurface(const NewtonWorld* const newtonWorld, const NewtonMesh* const closeManifoldMesh)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	dgScopeIdleThreadPool threadPool (world ? world->GetThreadPool() : NULL);
+	dgMeshEffect* const meshEffect = (dgMeshEffect*) closeManifoldMesh;
+	return (NewtonMesh*)meshEffect->CreateTetrahedraIsoSurface(threadPool.GetPool());
+}
+
 void NewtonCreateTetrahedraLinearBlendSkinWeightsChannel(const NewtonMesh* const tetrahedraMesh, NewtonMesh* const skinMesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*)skinMesh;
 	meshEffect->CreateTetrahedraLinearBlendSkinWeightsChannel((const dgMeshEffect*)tetrahedraMesh);
 }
 
+// same as NewtonCreateTetrahedraLinearBlendSkinWeightsChannel, but the weights of the skin 
+// vertices are calculated by the worker threads of the world.
+void NewtonParallelCreateTetrahedraLinearBlendSkinWeightsChannel(const NewtonWorld* const newtonWorld, const NewtonMesh* const tetrahedraMesh, NewtonMesh* const skinMesh)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	dgScopeIdleThreadPool threadPool (world ? world->GetThreadPool() : NULL);
+	dgMeshEffect* const meshEffect = (dgMeshEffect*)skinMesh;
+	meshEffect->CreateTetrahedraLinearBlendSkinWeightsChannel((const dgMeshEffect*)tetrahedraMesh, threadPool.GetPool());
+}
+
 NewtonMesh* NewtonMeshCreateVoronoiConvexDecomposition (const NewtonWorld* const newtonWorld, int pointCount, const dFloat* const vertexCloud, int strideInBytes, int materialID, const dFloat* const textureMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	Newton* const world = (Newton *) newtonWorld;
-	return (NewtonMesh*) dgMeshEffect::CreateVoronoiConvexDecomposition (world->dgWorld::GetAllocator(), pointCount, strideInBytes, vertexCloud, materialID, dgMatrix (textureMatrix));
+	dgScopeIdleThreadPool threadPool (world->GetThreadPool());
+	return (NewtonMesh*) dgMeshEffect::CreateVoronoiConvexDecomposition (world->dgWorld::GetAllocator(), pointCount, strideInBytes, vertexCloud, materialID, dgMatrix (textureMatrix), threadPool.GetPool());
 }
 
 NewtonMesh* NewtonMeshCreateFromSerialization (const NewtonWorld* const newtonWorld, NewtonDeserializeCallback deserializeFunction, void* const serializeHandle)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	Newton* const world = (Newton *) newtonWorld;
 	return (NewtonMesh*) dgMeshEffect::CreateFromSerialization (world->dgWorld::GetAllocator(), (dgDeserialize) deserializeFunction, serializeHandle);
 }
@@ -7782,6 +8188,7 @@ void NewtonMeshSaveOFF(const NewtonMesh* const mesh, const char* const filename)
 NewtonMesh* NewtonMeshLoadOFF(const NewtonWorld* const newtonWorld, const char* const filename)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	Newton* const world = (Newton *) newtonWorld;
 	dgMemoryAllocator* const allocator = world->dgWorld::GetAllocator();
 	dgMeshEffect* const mesh = new (allocator) dgMeshEffect (allocator);
@@ -7792,6 +8199,7 @@ NewtonMesh* NewtonMeshLoadOFF(const NewtonWorld* const newtonWorld, const char*
 NewtonMesh* NewtonMeshLoadTetrahedraMesh(const NewtonWorld* const newtonWorld, const char* const filename)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	Newton* const world = (Newton *)newtonWorld;
 	dgMemoryAllocator* const allocator = world->dgWorld::GetAllocator();
 	dgMeshEffect* const mesh = new (allocator) dgMeshEffect(allocator);
@@ -7802,6 +8210,7 @@ NewtonMesh* NewtonMeshLoadTetrahedraMesh(const NewtonWorld* const newtonWorld, c
 void NewtonMeshApplyTransform (const NewtonMesh* const mesh, const dFloat* const matrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 
 	meshEffect->ApplyTransform(dgMatrix (matrix));
@@ -7825,6 +8234,7 @@ void NewtonMeshCalculateOOBB(const NewtonMesh* const mesh, dFloat* const matrix,
 void NewtonMeshCalculateVertexNormals(const NewtonMesh* const mesh, dFloat angleInRadians)
 {
 	TRACE_FUNCTION(__FUNCTION__);	
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 	meshEffect->CalculateNormals (angleInRadians);
 }
@@ -7832,6 +8242,7 @@ void NewtonMeshCalculateVertexNormals(const NewtonMesh* const mesh, dFloat angle
 void NewtonMeshApplyAngleBasedMapping(const NewtonMesh* const mesh, int material, NewtonReportProgress reportPrograssCallback, void* const reportPrgressUserData, dFloat* const aligmentMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);	
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMatrix matrix(aligmentMatrix);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 	meshEffect->AngleBaseFlatteningMapping(material, (dgReportProgress) reportPrograssCallback, reportPrgressUserData);
@@ -7840,6 +8251,7 @@ void NewtonMeshApplyAngleBasedMapping(const NewtonMesh* const mesh, int material
 void NewtonMeshApplySphericalMapping(const NewtonMesh* const mesh, int material, const dFloat* const aligmentMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);	
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMatrix matrix(aligmentMatrix);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 	meshEffect->SphericalMapping (material, matrix);
@@ -7848,6 +8260,7 @@ void NewtonMeshApplySphericalMapping(const NewtonMesh* const mesh, int material,
 void NewtonMeshApplyBoxMapping(const NewtonMesh* const mesh, int front, int side, int top, const dFloat* const aligmentMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMatrix matrix(aligmentMatrix);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 	meshEffect->BoxMapping (front, side, top);
@@ -7856,6 +8269,7 @@ void NewtonMeshApplyBoxMapping(const NewtonMesh* const mesh, int front, int side
 void NewtonMeshApplyCylindricalMapping(const NewtonMesh* const mesh, int cylinderMaterial, int capMaterial, const dFloat* const aligmentMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);	
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMatrix matrix(aligmentMatrix);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 	meshEffect->CylindricalMapping (cylinderMaterial, capMaterial, matrix);
@@ -7864,12 +8278,14 @@ void NewtonMeshApplyCylindricalMapping(const NewtonMesh* const mesh, int cylinde
 void NewtonMeshTriangulate (const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	((dgMeshEffect*) mesh)->Triangulate ();
 }
 
 void NewtonMeshPolygonize (const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	((dgMeshEffect*) mesh)->ConvertToPolygons ();
 }
 
@@ -7884,6 +8300,7 @@ int NewtonMeshIsOpenMesh (const NewtonMesh* const mesh)
 void NewtonMeshFixTJoints (const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 
 	return ((dgMeshEffect*) mesh)->RepairTJoints();
 }
@@ -7902,20 +8319,95 @@ void NewtonMeshClip (const NewtonMesh* const mesh, const NewtonMesh* const clipp
 NewtonMesh* NewtonMeshSimplify (const NewtonMesh* const mesh, int maxVertexCount, NewtonReportProgress progressReportCallback, void* const reportPrgressUserData)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	return (NewtonMesh*) ((dgMeshEffect*) mesh)->CreateSimplification (maxVertexCount, (dgReportProgress) progressReportCallback, reportPrgressUserData);
 }
 
+// same as NewtonMeshSimplify, but the regions of the mesh are simplified by the worker threads 
+// of the world, the world must not be updating. the result does not depend on the number of threads.
+NewtonMesh* NewtonMeshParallelSimplify (const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh, int maxVertexCount, NewtonReportProgress progressReportCallback, void* const reportPrgressUserData)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	// the simplifier borrows the worker threads itself
+	dgThreadHive* const threadPool = world ? world->GetThreadPool() : NULL;
+	return (NewtonMesh*) ((dgMeshEffect*) mesh)->CreateSimplification (maxVertexCount, (dgReportProgress) progressReportCallback, reportPrgressUserData, threadPool);
+}
+
+// creates a simplifier that reduces the faces streamed into it to maxFaceCount faces, the faces are 
+// simplified in batches as they are added, at the ratio of maxFaceCount to expectedFaceCount. 
+NewtonMeshSimplifier* NewtonMeshCreateSimplifier (const NewtonWorld* const newtonWorld, int maxFaceCount, int expectedFaceCount)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	dgMemoryAllocator* const allocator = world->dgWorld::GetAllocator();
+	return (NewtonMeshSimplifier*) new (allocator) dgMeshEffectSimplifier (allocator, maxFaceCount, expectedFaceCount, world->GetThreadPool());
+}
+
+void NewtonMeshDestroySimplifier (const NewtonMeshSimplifier* const simplifier)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	delete (dgMeshEffectSimplifier*) simplifier;
+}
+
+void NewtonMeshSimplifierAddFace (const NewtonMeshSimplifier* const simplifier, int vertexCount, const dFloat* const vertexPtr, int strideInBytes, int faceAttribute)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	((dgMeshEffectSimplifier*) simplifier)->AddFace (vertexCount, vertexPtr, strideInBytes, faceAttribute);
+}
+
+// finishes the simplification and builds the tree collision with the simplified faces, 
+// there is no need to call NewtonTreeCollisionBeginBuild or NewtonTreeCollisionEndBuild.
+void NewtonMeshSimplifierBuildTreeCollision (const NewtonMeshSimplifier* const simplifier, const NewtonCollision* const treeCollision, int optimize)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	dgCollisionBVH* const collision = (dgCollisionBVH*) ((dgCollisionInstance*)treeCollision)->GetChildShape();
+	dgAssert (collision->IsType (dgCollision::dgCollisionBVH_RTTI));
+	dgMeshEffectSimplifier* const meshSimplifier = (dgMeshEffectSimplifier*) simplifier;
+	meshSimplifier->Simplify ();
+	meshSimplifier->BuildCollisionTree (collision, optimize);
+}
+
+// finishes the simplification and returns the simplified faces as a mesh.
+NewtonMesh* NewtonMeshSimplifierCreateMesh (const NewtonMeshSimplifier* const simplifier)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	dgMeshEffectSimplifier* const meshSimplifier = (dgMeshEffectSimplifier*) simplifier;
+	meshSimplifier->Simplify ();
+	return (NewtonMesh*) meshSimplifier->CreateMesh ();
+}
+
 NewtonMesh* NewtonMeshApproximateConvexDecomposition (const NewtonMesh* const mesh, dFloat maxConcavity, dFloat backFaceDistanceFactor, int maxCount, int maxVertexPerHull, NewtonReportProgress progressReportCallback, void* const reportProgressUserData)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	return (NewtonMesh*) ((dgMeshEffect*) mesh)->CreateConvexApproximation (maxConcavity, backFaceDistanceFactor, maxCount, maxVertexPerHull, (dgReportProgress) progressReportCallback, reportProgressUserData);
 }
 
+// same as NewtonMeshApproximateConvexDecomposition, but the candidate cluster merges are evaluated 
+// by the worker threads of the world, the world must not be updating when this function is called. 
+// the result does not depend on the number of threads.
+NewtonMesh* NewtonMeshParallelApproximateConvexDecomposition (const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh, dFloat maxConcavity, dFloat backFaceDistanceFactor, int maxCount, int maxVertexPerHull, NewtonReportProgress progressReportCallback, void* const reportProgressUserData)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	dgScopeIdleThreadPool threadPool (world ? world->GetThreadPool() : NULL);
+	return (NewtonMesh*) ((dgMeshEffect*) mesh)->CreateConvexApproximation (maxConcavity, backFaceDistanceFactor, maxCount, maxVertexPerHull, (dgReportProgress) progressReportCallback, reportProgressUserData, threadPool.GetPool());
+}
+
 
 
 NewtonMesh* NewtonMeshUnion (const NewtonMesh* const mesh, const NewtonMesh* const clipper, const dFloat* const clipperMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	return (NewtonMesh*) ((dgMeshEffect*) mesh)->Union (dgMatrix (clipperMatrix), (dgMeshEffect*)clipper);
 }
 
@@ -7923,21 +8415,115 @@ NewtonMesh* NewtonMeshUnion (const NewtonMesh* const mesh, const NewtonMesh* con
 NewtonMesh* NewtonMeshDifference (const NewtonMesh* const mesh, const NewtonMesh* const clipper, const dFloat* const clipperMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	return (NewtonMesh*) ((dgMeshEffect*) mesh)->Difference (dgMatrix (clipperMatrix), (dgMeshEffect*)clipper);
 }
 
 NewtonMesh* NewtonMeshIntersection (const NewtonMesh* const mesh, const NewtonMesh* const clipper, const dFloat* const clipperMatrix)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	return (NewtonMesh*) ((dgMeshEffect*) mesh)->Intersection (dgMatrix (clipperMatrix), (dgMeshEffect*)clipper);
 }
 
 NewtonMesh* NewtonMeshConvexMeshIntersection (const NewtonMesh* const mesh, const NewtonMesh* const convexMesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	return (NewtonMesh*) ((dgMeshEffect*) mesh)->ConvexMeshIntersection ((dgMeshEffect*)convexMesh);
 }
 
+// intersects the mesh with each convex mesh of the array using the worker threads of the world,
+// the world must not be updating, otherwise the intersections are calculated by the calling thread.
+void NewtonMeshConvexMeshIntersectionArray (const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh, int count, const NewtonMesh** const convexMeshArray, NewtonMesh** const intersections)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	dgScopeIdleThreadPool threadPool (world ? world->GetThreadPool() : NULL);
+	((dgMeshEffect*) mesh)->ConvexMeshIntersection (count, (const dgMeshEffect* const*) convexMeshArray, (dgMeshEffect**) intersections, threadPool.GetPool());
+}
+
+// starts calculating the intersections of the mesh with each convex mesh of the array in a 
+// background thread, the meshes are copied so the application can keep using or destroy them.
+NewtonMeshConvexIntersectionTask* NewtonMeshConvexMeshIntersectionBegin (const NewtonMesh* const mesh, int count, const NewtonMesh** const convexMeshArray)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	const dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
+	dgMeshEffectConvexIntersectionTask* const task = new (meshEffect->GetAllocator()) dgMeshEffectConvexIntersectionTask (meshEffect, count, (const dgMeshEffect* const*) convexMeshArray);
+	return (NewtonMeshConvexIntersectionTask*) task;
+}
+
+int NewtonMeshConvexMeshIntersectionIsDone (const NewtonMeshConvexIntersectionTask* const task)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	return ((dgMeshEffectConvexIntersectionTask*) task)->IsDone() ? 1 : 0;
+}
+
+// waits for the task to complete and destroys it, the intersections are returned in the array 
+// when it is not NULL, the entries of convex meshes that do not intersect the mesh are set to NULL.
+void NewtonMeshConvexMeshIntersectionEnd (NewtonMeshConvexIntersectionTask* const task, NewtonMesh** const intersections)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	dgMeshEffectConvexIntersectionTask* const meshTask = (dgMeshEffectConvexIntersectionTask*) task;
+	if (intersections) {
+		meshTask->GetIntersections ((dgMeshEffect**) intersections);
+	}
+	delete meshTask;
+}
+
+// calculates the voronoi cells of the point cloud and their adjacency, the pattern can later be 
+// applied to any number of meshes with NewtonMeshFracturePatternApply. 
+NewtonMeshFracturePattern* NewtonMeshCreateFracturePattern (const NewtonWorld* const newtonWorld, int pointCount, const dFloat* const vertexCloud, int strideInBytes, int materialID, const dFloat* const textureMatrix)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	dgMemoryAllocator* const allocator = world->dgWorld::GetAllocator();
+	dgScopeIdleThreadPool threadPool (world->GetThreadPool());
+	return (NewtonMeshFracturePattern*) new (allocator) dgMeshEffectFracturePattern (allocator, pointCount, strideInBytes, vertexCloud, materialID, dgMatrix (textureMatrix), threadPool.GetPool());
+}
+
+void NewtonMeshDestroyFracturePattern (const NewtonMeshFracturePattern* const pattern)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	delete (dgMeshEffectFracturePattern*) pattern;
+}
+
+int NewtonMeshFracturePatternGetCellCount (const NewtonMeshFracturePattern* const pattern)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	return ((dgMeshEffectFracturePattern*) pattern)->GetCellCount();
+}
+
+// copies up to maxCount neighbors of the cell and returns the number of neighbors of the cell. 
+int NewtonMeshFracturePatternGetCellNeighbors (const NewtonMeshFracturePattern* const pattern, int cell, int* const neighbors, int maxCount)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	const dgMeshEffectFracturePattern* const fracturePattern = (dgMeshEffectFracturePattern*) pattern;
+	const dgInt32 count = fracturePattern->GetNeighborCount (cell);
+	const dgInt32* const cellNeighbors = fracturePattern->GetNeighbors (cell);
+	for (dgInt32 i = 0; i < dgMin (count, maxCount); i ++) {
+		neighbors[i] = cellNeighbors[i];
+	}
+	return count;
+}
+
+// breaks the mesh with the pattern placed at matrix, pieces must hold one entry per cell and 
+// receives the part of the mesh inside each cell, or NULL for cells that miss the mesh. 
+// if the world is not updating, its worker threads clip the cells in parallel.
+void NewtonMeshFracturePatternApply (const NewtonWorld* const newtonWorld, const NewtonMeshFracturePattern* const pattern, const NewtonMesh* const mesh, const dFloat* const matrix, NewtonMesh** const pieces)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
+	Newton* const world = (Newton *) newtonWorld;
+	dgScopeIdleThreadPool threadPool (world ? world->GetThreadPool() : NULL);
+	((dgMeshEffectFracturePattern*) pattern)->Apply ((dgMeshEffect*) mesh, dgMatrix (matrix), (dgMeshEffect**) pieces, threadPool.GetPool());
+}
+
 void NewtonRemoveUnusedVertices(const NewtonMesh* const mesh, int* const vertexRemapTable)
 {
 	TRACE_FUNCTION(__FUNCTION__);
@@ -7948,6 +8534,7 @@ void NewtonRemoveUnusedVertices(const NewtonMesh* const mesh, int* const vertexR
 void NewtonMeshBeginBuild(const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 	meshEffect->BeginBuild();
 }
@@ -7955,6 +8542,7 @@ void NewtonMeshBeginBuild(const NewtonMesh* const mesh)
 void NewtonMeshBeginFace (const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*)mesh;
 	meshEffect->BeginBuildFace();
 }
@@ -7962,6 +8550,7 @@ void NewtonMeshBeginFace (const NewtonMesh* const mesh)
 void NewtonMeshEndFace(const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*)mesh;
 	meshEffect->EndBuildFace();
 }
@@ -7969,6 +8558,7 @@ void NewtonMeshEndFace(const NewtonMesh* const mesh)
 void NewtonMeshAddPoint(const NewtonMesh* const mesh, dFloat64 x, dFloat64 y, dFloat64 z)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*)mesh;
 	meshEffect->AddPoint (x, y, z);
 }
@@ -7983,6 +8573,7 @@ void NewtonMeshAddMaterial(const NewtonMesh* const mesh, int materialIndex)
 void NewtonMeshAddLayer(const NewtonMesh* const mesh, int layer)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*)mesh;
 	meshEffect->AddLayer(layer);
 }
@@ -8018,6 +8609,7 @@ void NewtonMeshAddUV1(const NewtonMesh* const mesh, dFloat u, dFloat v)
 void NewtonMeshEndBuild(const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*) mesh;
 
 	meshEffect->EndBuild(dgFloat64 (1.0e-8f));
@@ -8040,6 +8632,7 @@ void NewtonMeshBuildFromVertexListIndexList (const NewtonMesh* const mesh, const
 void NewtonMeshOptimizePoints(const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*)mesh;
 	meshEffect->OptimizePoints();
 }
@@ -8047,6 +8640,7 @@ void NewtonMeshOptimizePoints(const NewtonMesh* const mesh)
 void NewtonMeshOptimizeVertex(const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	dgMeshEffect* const meshEffect = (dgMeshEffect*)mesh;
 	meshEffect->OptimizeAttibutes();
 }
@@ -8054,6 +8648,7 @@ void NewtonMeshOptimizeVertex(const NewtonMesh* const mesh)
 void NewtonMeshOptimize(const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 	NewtonMeshOptimizePoints(mesh);
 	NewtonMeshOptimizeVertex(mesh);
 }
@@ -8261,6 +8856,7 @@ void NewtonMeshMaterialGetIndexStreamShort (const NewtonMesh* const mesh, void*
 NewtonMesh* NewtonMeshCreateFirstSingleSegment (const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 
 	dgMeshEffect* const effectMesh = (dgMeshEffect*)mesh;
 	dgPolyhedra segment(effectMesh->GetAllocator());
@@ -8277,6 +8873,7 @@ NewtonMesh* NewtonMeshCreateFirstSingleSegment (const NewtonMesh* const mesh)
 NewtonMesh* NewtonMeshCreateNextSingleSegment (const NewtonMesh* const mesh, const NewtonMesh* const segment)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 
 	dgMeshEffect* const effectMesh = (dgMeshEffect*)mesh;
 	dgPolyhedra nextSegment(effectMesh->GetAllocator());
@@ -8298,6 +8895,7 @@ NewtonMesh* NewtonMeshCreateNextSingleSegment (const NewtonMesh* const mesh, con
 NewtonMesh* NewtonMeshCreateFirstLayer (const NewtonMesh* const mesh)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 
 	dgMeshEffect* const effectMesh = (dgMeshEffect*)mesh;
 	return (NewtonMesh*) effectMesh->GetFirstLayer ();
@@ -8306,6 +8904,7 @@ NewtonMesh* NewtonMeshCreateFirstLayer (const NewtonMesh* const mesh)
 NewtonMesh* NewtonMeshCreateNextLayer (const NewtonMesh* const mesh, const NewtonMesh* const segment)
 {
 	TRACE_FUNCTION(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryMeshes);
 
 	dgMeshEffect* const effectMesh = (dgMeshEffect*)mesh;
 	return (NewtonMesh*) effectMesh->GetNextLayer ((dgMeshEffect*)segment);
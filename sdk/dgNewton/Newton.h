@@ -72,6 +72,15 @@ extern "C" {
 	
 	#define NEWTON_BROADPHASE_DEFAULT						0
 	#define NEWTON_BROADPHASE_PERSINTENT					1
+	#define NEWTON_BROADPHASE_SWEEP_AND_PRUNE				2
+
+	#define NEWTON_MEMORY_GENERAL							0
+	#define NEWTON_MEMORY_BROADPHASE						1
+	#define NEWTON_MEMORY_CONTACTS							2
+	#define NEWTON_MEMORY_COLLISION_SHAPES					3
+	#define NEWTON_MEMORY_MESHES							4
+	#define NEWTON_MEMORY_SOLVER							5
+	#define NEWTON_MEMORY_SKELETONS							6
 
 	#define NEWTON_DYNAMIC_BODY								0
 	#define NEWTON_KINEMATIC_BODY							1
@@ -105,6 +114,9 @@ extern "C" {
 	class NewtonInverseDynamics;
 	class NewtonDeformableMeshSegment;
 	class NewtonFracturedCompoundMeshPart;
+	class NewtonMeshConvexIntersectionTask;
+	class NewtonMeshFracturePattern;
+	class NewtonMeshSimplifier;
 #else
 	typedef struct NewtonMesh{} NewtonMesh;
 	typedef struct NewtonBody{} NewtonBody;
@@ -116,6 +128,9 @@ extern "C" {
 	typedef struct NewtonDeformableMeshSegment{} NewtonDeformableMeshSegment;
 	typedef struct NewtonInverseDynamicsEffector {} NewtonInverseDynamicsEffector;
 	typedef struct NewtonFracturedCompoundMeshPart{} NewtonFracturedCompoundMeshPart;
+	typedef struct NewtonMeshConvexIntersectionTask{} NewtonMeshConvexIntersectionTask;
+	typedef struct NewtonMeshFracturePattern{} NewtonMeshFracturePattern;
+	typedef struct NewtonMeshSimplifier{} NewtonMeshSimplifier;
 #endif
 
 	typedef struct NewtonCollisionMaterial
@@ -344,6 +359,23 @@ extern "C" {
 		NewtonMeshFloatData m_vertexColor;
 	} NewtonMeshVertexFormat;
 
+	// application arrays for bulk read and write of bodies state, NULL arrays are skipped
+	typedef struct NewtonBodyStateArrays
+	{
+		dFloat* m_matrix;
+		dFloat* m_position;
+		dFloat* m_rotation;
+		dFloat* m_veloc;
+		dFloat* m_omega;
+		int* m_sleepState;
+		int m_matrixStrideInBytes;
+		int m_positionStrideInBytes;
+		int m_rotationStrideInBytes;
+		int m_velocStrideInBytes;
+		int m_omegaStrideInBytes;
+		int m_sleepStateStrideInBytes;
+	} NewtonBodyStateArrays;
+
 	// Newton callback functions
 	typedef void* (*NewtonAllocMemory) (int sizeInBytes);
 	typedef void (*NewtonFreeMemory) (void* const ptr, int sizeInBytes);
@@ -438,6 +470,7 @@ extern "C" {
 	NEWTON_API int NewtonWorldFloatSize ();
 
 	NEWTON_API int NewtonGetMemoryUsed ();
+	NEWTON_API dLong NewtonGetMemoryUsed64 ();
 	NEWTON_API void NewtonSetMemorySystem (NewtonAllocMemory malloc, NewtonFreeMemory free);
 
 	NEWTON_API NewtonWorld* NewtonCreate ();
@@ -466,6 +499,15 @@ extern "C" {
 
 	NEWTON_API void NewtonSetMultiThreadSolverOnSingleIsland (const NewtonWorld* const newtonWorld, int mode);
 	NEWTON_API int NewtonGetMultiThreadSolverOnSingleIsland (const NewtonWorld* const newtonWorld);
+	NEWTON_API void NewtonSetSpeculativeContacts (const NewtonWorld* const newtonWorld, int mode);
+	NEWTON_API int NewtonGetSpeculativeContacts (const NewtonWorld* const newtonWorld);
+	NEWTON_API void NewtonSetSleepAwareBroadphase (const NewtonWorld* const newtonWorld, int mode);
+	NEWTON_API int NewtonGetSleepAwareBroadphase (const NewtonWorld* const newtonWorld);
+
+	NEWTON_API void NewtonReserveFrameMemory (const NewtonWorld* const newtonWorld, int sharedSizeInBytes, int perThreadSizeInBytes);
+	NEWTON_API void NewtonGetFrameMemoryStatistics (const NewtonWorld* const newtonWorld, dLong* const capacity, dLong* const highWaterMark, dLong* const allocatorCalls);
+	NEWTON_API void NewtonClearFrameMemoryStatistics (const NewtonWorld* const newtonWorld);
+	NEWTON_API void NewtonGetMemoryStatistics (const NewtonWorld* const newtonWorld, int category, dLong* const memoryUsed, dLong* const peakMemoryUsed, dLong* const allocationsCount);
 
 	NEWTON_API int NewtonGetBroadphaseAlgorithm (const NewtonWorld* const newtonWorld);
 	NEWTON_API void NewtonSelectBroadphaseAlgorithm (const NewtonWorld* const newtonWorld, int algorithmType);
@@ -510,6 +552,11 @@ extern "C" {
 //	NEWTON_API void NewtonWorldForEachBodyDo (const NewtonWorld* const newtonWorld, NewtonBodyIterator callback);
 	NEWTON_API void NewtonWorldForEachJointDo (const NewtonWorld* const newtonWorld, NewtonJointIterator callback, void* const userData);
 	NEWTON_API void NewtonWorldForEachBodyInAABBDo (const NewtonWorld* const newtonWorld, const dFloat* const p0, const dFloat* const p1, NewtonBodyIterator callback, void* const userData);
+	NEWTON_API int NewtonWorldForEachBodyInIslandDo (const NewtonWorld* const newtonWorld, const NewtonBody* const body, NewtonBodyIterator callback, void* const userData);
+	NEWTON_API int NewtonWorldSetIslandSleepState (const NewtonWorld* const newtonWorld, const NewtonBody* const body, int state);
+	NEWTON_API int NewtonWorldSetIslandFreezeState (const NewtonWorld* const newtonWorld, const NewtonBody* const body, int state);
+	NEWTON_API int NewtonWorldSetBodiesSleepStateInAABB (const NewtonWorld* const newtonWorld, const dFloat* const p0, const dFloat* const p1, int state);
+	NEWTON_API int NewtonWorldSetBodiesFreezeStateInAABB (const NewtonWorld* const newtonWorld, const dFloat* const p0, const dFloat* const p1, int state);
 
 	NEWTON_API void NewtonWorldSetUserData (const NewtonWorld* const newtonWorld, void* const userData);
 	NEWTON_API void* NewtonWorldGetUserData (const NewtonWorld* const newtonWorld);
@@ -538,6 +585,8 @@ extern "C" {
 	// world utility functions
 	NEWTON_API int NewtonWorldGetBodyCount(const NewtonWorld* const newtonWorld);
 	NEWTON_API int NewtonWorldGetConstraintCount(const NewtonWorld* const newtonWorld);
+	NEWTON_API int NewtonWorldGetBodiesState (const NewtonWorld* const newtonWorld, const NewtonBody* const* const bodies, int count, const NewtonBodyStateArrays* const state);
+	NEWTON_API int NewtonWorldSetBodiesState (const NewtonWorld* const newtonWorld, const NewtonBody* const* const bodies, int count, const NewtonBodyStateArrays* const state);
 
 	// **********************************************************************************************
 	//
@@ -559,6 +608,7 @@ extern "C" {
 	// material definitions that can not be overwritten in function callback
 	NEWTON_API void* NewtonMaterialGetUserData (const NewtonWorld* const newtonWorld, int id0, int id1);
 	NEWTON_API void NewtonMaterialSetSurfaceThickness (const NewtonWorld* const newtonWorld, int id0, int id1, dFloat thickness);
+	NEWTON_API void NewtonMaterialSetMaxContactCount (const NewtonWorld* const newtonWorld, int id0, int id1, int maxContactCount);
 
 //	deprecated, not longer continue collision is set on the material  	
 //	NEWTON_API void NewtonMaterialSetContinuousCollisionMode (const NewtonWorld* const newtonWorld, int id0, int id1, int state);
@@ -892,6 +942,7 @@ extern "C" {
 	
 	NEWTON_API void  NewtonBodySetMaterialGroupID (const NewtonBody* const body, int id);
 	NEWTON_API void  NewtonBodySetContinuousCollisionMode (const NewtonBody* const body, unsigned state);
+	NEWTON_API void  NewtonBodySetSpeculativeContactsMode (const NewtonBody* const body, unsigned state);
 	NEWTON_API void  NewtonBodySetJointRecursiveCollision (const NewtonBody* const body, unsigned state);
 	NEWTON_API void  NewtonBodySetOmega (const NewtonBody* const body, const dFloat* const omega);
 	NEWTON_API void  NewtonBodySetOmegaNoSleep (const NewtonBody* const body, const dFloat* const omega);
@@ -934,6 +985,7 @@ extern "C" {
 
 	NEWTON_API int NewtonBodyGetSerializedID(const NewtonBody* const body);
 	NEWTON_API int NewtonBodyGetContinuousCollisionMode (const NewtonBody* const body);
+	NEWTON_API int NewtonBodyGetSpeculativeContactsMode (const NewtonBody* const body);
 	NEWTON_API int NewtonBodyGetJointRecursiveCollision (const NewtonBody* const body);
 
 	NEWTON_API void NewtonBodyGetPosition(const NewtonBody* const body, dFloat* const pos);
@@ -1186,10 +1238,17 @@ extern "C" {
 	// Mesh joint functions
 	//
 	// **********************************************************************************************
+
+	// the mesh functions that take a world borrow its worker threads for the duration of the call. only one
+	// caller can borrow them at a time, and a world update waits until they are returned. when the world 
+	// is updating, the threads are borrowed by another caller, or the function is called from inside a job 
+	// of the same world (NewtonDispachThreadJob, or any world callback), the work runs on the calling thread.
+	// NewtonSetThreadsCount waits until the threads are returned, NewtonDispachThreadJob must not be used meanwhile.
 	NEWTON_API NewtonMesh* NewtonMeshCreate(const NewtonWorld* const newtonWorld);
 	NEWTON_API NewtonMesh* NewtonMeshCreateFromMesh(const NewtonMesh* const mesh);
 	NEWTON_API NewtonMesh* NewtonMeshCreateFromCollision(const NewtonCollision* const collision);
 	NEWTON_API NewtonMesh* NewtonMeshCreateTetrahedraIsoSurface(const NewtonMesh* const mesh);
+	NEWTON_API NewtonMesh* NewtonMeshParallelCreateTetrahedraIsoSurface(const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh);
 	NEWTON_API NewtonMesh* NewtonMeshCreateConvexHull (const NewtonWorld* const newtonWorld, int pointCount, const dFloat* const vertexCloud, int strideInBytes, dFloat tolerance);
 	NEWTON_API NewtonMesh* NewtonMeshCreateVoronoiConvexDecomposition (const NewtonWorld* const newtonWorld, int pointCount, const dFloat* const vertexCloud, int strideInBytes, int materialID, const dFloat* const textureMatrix);
 	NEWTON_API NewtonMesh* NewtonMeshCreateFromSerialization (const NewtonWorld* const newtonWorld, NewtonDeserializeCallback deserializeFunction, void* const serializeHandle);
@@ -1210,6 +1269,7 @@ extern "C" {
 	NEWTON_API void NewtonMeshApplyAngleBasedMapping(const NewtonMesh* const mesh, int material, NewtonReportProgress reportPrograssCallback, void* const reportPrgressUserData, dFloat* const aligmentMatrix);
 
 	NEWTON_API void NewtonCreateTetrahedraLinearBlendSkinWeightsChannel(const NewtonMesh* const tetrahedraMesh, NewtonMesh* const skinMesh);
+	NEWTON_API void NewtonParallelCreateTetrahedraLinearBlendSkinWeightsChannel(const NewtonWorld* const newtonWorld, const NewtonMesh* const tetrahedraMesh, NewtonMesh* const skinMesh);
 	
 	NEWTON_API void NewtonMeshOptimize (const NewtonMesh* const mesh);
 	NEWTON_API void NewtonMeshOptimizePoints (const NewtonMesh* const mesh);
@@ -1225,9 +1285,27 @@ extern "C" {
 	NEWTON_API void NewtonMeshClip (const NewtonMesh* const mesh, const NewtonMesh* const clipper, const dFloat* const clipperMatrix, NewtonMesh** const topMesh, NewtonMesh** const bottomMesh);
 
 	NEWTON_API NewtonMesh* NewtonMeshConvexMeshIntersection (const NewtonMesh* const mesh, const NewtonMesh* const convexMesh);
+	NEWTON_API void NewtonMeshConvexMeshIntersectionArray (const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh, int count, const NewtonMesh** const convexMeshArray, NewtonMesh** const intersections);
+	NEWTON_API NewtonMeshConvexIntersectionTask* NewtonMeshConvexMeshIntersectionBegin (const NewtonMesh* const mesh, int count, const NewtonMesh** const convexMeshArray);
+	NEWTON_API int NewtonMeshConvexMeshIntersectionIsDone (const NewtonMeshConvexIntersectionTask* const task);
+	NEWTON_API void NewtonMeshConvexMeshIntersectionEnd (NewtonMeshConvexIntersectionTask* const task, NewtonMesh** const intersections);
+
+	NEWTON_API NewtonMeshFracturePattern* NewtonMeshCreateFracturePattern (const NewtonWorld* const newtonWorld, int pointCount, const dFloat* const vertexCloud, int strideInBytes, int materialID, const dFloat* const textureMatrix);
+	NEWTON_API void NewtonMeshDestroyFracturePattern (const NewtonMeshFracturePattern* const pattern);
+	NEWTON_API int NewtonMeshFracturePatternGetCellCount (const NewtonMeshFracturePattern* const pattern);
+	NEWTON_API int NewtonMeshFracturePatternGetCellNeighbors (const NewtonMeshFracturePattern* const pattern, int cell, int* const neighbors, int maxCount);
+	NEWTON_API void NewtonMeshFracturePatternApply (const NewtonWorld* const newtonWorld, const NewtonMeshFracturePattern* const pattern, const NewtonMesh* const mesh, const dFloat* const matrix, NewtonMesh** const pieces);
 
 	NEWTON_API NewtonMesh* NewtonMeshSimplify (const NewtonMesh* const mesh, int maxVertexCount, NewtonReportProgress reportPrograssCallback, void* const reportPrgressUserData);
+	NEWTON_API NewtonMesh* NewtonMeshParallelSimplify (const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh, int maxVertexCount, NewtonReportProgress reportPrograssCallback, void* const reportPrgressUserData);
+
+	NEWTON_API NewtonMeshSimplifier* NewtonMeshCreateSimplifier (const NewtonWorld* const newtonWorld, int maxFaceCount, int expectedFaceCount);
+	NEWTON_API void NewtonMeshDestroySimplifier (const NewtonMeshSimplifier* const simplifier);
+	NEWTON_API void NewtonMeshSimplifierAddFace (const NewtonMeshSimplifier* const simplifier, int vertexCount, const dFloat* const vertexPtr, int strideInBytes, int faceAttribute);
+	NEWTON_API void NewtonMeshSimplifierBuildTreeCollision (const NewtonMeshSimplifier* const simplifier, const NewtonCollision* const treeCollision, int optimize);
+	NEWTON_API NewtonMesh* NewtonMeshSimplifierCreateMesh (const NewtonMeshSimplifier* const simplifier);
 	NEWTON_API NewtonMesh* NewtonMeshApproximateConvexDecomposition (const NewtonMesh* const mesh, dFloat maxConcavity, dFloat backFaceDistanceFactor, int maxCount, int maxVertexPerHull, NewtonReportProgress reportProgressCallback, void* const reportProgressUserData);
+	NEWTON_API NewtonMesh* NewtonMeshParallelApproximateConvexDecomposition (const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh, dFloat maxConcavity, dFloat backFaceDistanceFactor, int maxCount, int maxVertexPerHull, NewtonReportProgress reportProgressCallback, void* const reportProgressUserData);
 
 	NEWTON_API void NewtonRemoveUnusedVertices(const NewtonMesh* const mesh, int* const vertexRemapTable);
 
@@ -240,6 +240,12 @@ void dgBody::UpdateWorlCollisionMatrix() const
 }
 
 
+bool dgBody::UseSpeculativeContacts () const
+{
+	// speculative contacts replace the time of impact sub steps of continuous collision, 
+	// they can be selected per body or for the whole world.
+	return m_continueCollisionMode && (m_speculativeContacts || (m_world && m_world->GetSpeculativeContacts()));
+}
 
 void dgBody::UpdateCollisionMatrix (dgFloat32 timestep, dgInt32 threadIndex)
 {
@@ -118,6 +118,9 @@ class dgBody
 
 	bool GetContinueCollisionMode () const;
 	void SetContinueCollisionMode (bool mode);
+	bool GetSpeculativeContactsMode () const;
+	void SetSpeculativeContactsMode (bool mode);
+	bool UseSpeculativeContacts () const;
 	bool GetCollisionWithLinkedBodies () const;
 	void SetCollisionWithLinkedBodies (bool state);
 
@@ -256,6 +259,7 @@ class dgBody
 			dgUnsigned32 m_continueCollisionMode	: 1;
 			dgUnsigned32 m_collideWithLinkedBodies	: 1;
 			dgUnsigned32 m_transformIsDirty			: 1;
+			dgUnsigned32 m_speculativeContacts		: 1;
 		};
 	};
 
@@ -493,6 +497,16 @@ DG_INLINE bool dgBody::GetContinueCollisionMode () const
 	return m_continueCollisionMode;
 }
 
+DG_INLINE void dgBody::SetSpeculativeContactsMode (bool mode)
+{
+	m_speculativeContacts = dgUnsigned32 (mode);
+}
+
+DG_INLINE bool dgBody::GetSpeculativeContactsMode () const
+{
+	return m_speculativeContacts;
+}
+
 DG_INLINE void dgBody::SetCollisionWithLinkedBodies (bool state)
 {
 	m_collideWithLinkedBodies = dgUnsigned32 (state);
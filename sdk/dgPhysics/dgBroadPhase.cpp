@@ -40,6 +40,7 @@
 #define DG_CONTACT_ANGULAR_ERROR		(dgFloat32 (0.25f * dgDEG2RAD))
 #define DG_NARROW_PHASE_DIST			dgFloat32 (0.2f)
 #define DG_CONTACT_DELAY_FRAMES			4
+#define DG_CONTACT_BATCH_SIZE			8
 
 
 dgVector dgBroadPhase::m_velocTol(dgFloat32(1.0e-16f)); 
@@ -155,7 +156,6 @@ dgBroadPhase::dgBroadPhase(dgWorld* const world)
 	,m_pendingSoftBodyPairsCount(0)
 	,m_contacJointLock(0)
 	,m_criticalSectionLock(0)
-	,m_threadSync()
 {
 }
 
@@ -737,72 +737,176 @@ void dgBroadPhase::UpdateBody(dgBody* const body, dgInt32 threadIndex)
 }
 
 
-dgBroadPhaseNode* dgBroadPhase::BuildTopDown(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode)
+void dgBroadPhase::BeginTreeRebuild(dgFitnessList& fitness) const
 {
-	dgAssert(firstBox >= 0);
-	dgAssert(lastBox >= 0);
-
-	if (lastBox == firstBox) {
-		return leafArray[firstBox];
-	} else {
-		dgSpliteInfo info(&leafArray[firstBox], lastBox - firstBox + 1);
-
-		dgBroadPhaseTreeNode* const parent = (*nextNode)->GetInfo();
-		parent->m_parent = NULL;
-		*nextNode = (*nextNode)->GetNext();
+	DG_TRACKTIME(__FUNCTION__);
+	const dgInt32 nodesCount = fitness.GetCount();
+	fitness.m_rebuildLeafs.ResizeIfNecessary(nodesCount * 2 + 16);
+	fitness.m_rebuildNodes.ResizeIfNecessary(nodesCount + 16);
+	fitness.m_rebuildStack.ResizeIfNecessary(nodesCount * 2 + 16);
+
+	dgInt32 leafNodesCount = 0;
+	dgBroadPhaseNode** const leafArray = &fitness.m_rebuildLeafs[0];
+	for (dgFitnessList::dgListNode* nodePtr = fitness.GetFirst(); nodePtr; nodePtr = nodePtr->GetNext()) {
+		dgBroadPhaseNode* const node = nodePtr->GetInfo();
+		dgBroadPhaseNode* const leftNode = node->GetLeft();
+		dgBody* const leftBody = leftNode->GetBody();
+		if (leftBody) {
+			leftNode->SetAABB(leftBody->m_minAABB, leftBody->m_maxAABB);
+			leafArray[leafNodesCount] = leftNode;
+			leafNodesCount++;
+		} else if (leftNode->IsAggregate()) {
+			leafArray[leafNodesCount] = leftNode;
+			leafNodesCount++;
+		}
+		dgBroadPhaseNode* const rightNode = node->GetRight();
+		dgBody* const rightBody = rightNode->GetBody();
+		if (rightBody) {
+			rightNode->SetAABB(rightBody->m_minAABB, rightBody->m_maxAABB);
+			leafArray[leafNodesCount] = rightNode;
+			leafNodesCount++;
+		} else if (rightNode->IsAggregate()) {
+			leafArray[leafNodesCount] = rightNode;
+			leafNodesCount++;
+		}
+	}
+	dgAssert(leafNodesCount == (nodesCount + 1));
+	dgSortIndirect(leafArray, leafNodesCount, CompareNodes);
+
+	dgFitnessList::dgRebuildEntry& entry = fitness.m_rebuildStack[0];
+	entry.m_firstBox = 0;
+	entry.m_lastBox = leafNodesCount - 1;
+	entry.m_parent = -1;
+	entry.m_isLeft = 0;
+	entry.m_isBig = 1;
+
+	fitness.m_rebuildRoot = 0;
+	fitness.m_rebuildStackCount = 1;
+	fitness.m_rebuildNodesCount = 0;
+	fitness.m_rebuildLeafsCount = leafNodesCount;
+	fitness.m_rebuildVersion = fitness.m_version;
+}
 
-		parent->SetAABB(info.m_p0, info.m_p1);
+bool dgBroadPhase::BuildTopDown(dgFitnessList& fitness, dgInt32 boxBudget) const
+{
+	// non recursive version of the top down build, it stops after the budget of boxes is consumed
+	// and continues on the next call, the live tree is not touched until the build is completed.
+	DG_TRACKTIME(__FUNCTION__);
+	dgBroadPhaseNode** const leafArray = &fitness.m_rebuildLeafs[0];
+	dgFitnessList::dgRebuildNode* const nodeArray = &fitness.m_rebuildNodes[0];
+	dgFitnessList::dgRebuildEntry* const stack = &fitness.m_rebuildStack[0];
+
+	while (fitness.m_rebuildStackCount && (boxBudget > 0)) {
+		fitness.m_rebuildStackCount--;
+		const dgFitnessList::dgRebuildEntry entry(stack[fitness.m_rebuildStackCount]);
+		const dgInt32 firstBox = entry.m_firstBox;
+		const dgInt32 lastBox = entry.m_lastBox;
+		const dgInt32 count = lastBox - firstBox;
+		boxBudget -= count + 1;
+
+		dgInt32 index = -(firstBox + 1);
+		if (count) {
+			// the biggest boxes are split first, each one in its own branch.
+			dgInt32 midPoint = -1;
+			if (entry.m_isBig) {
+				const dgFloat32 scale = dgFloat32(1.0f / 64.0f);
+				dgFloat32 area0 = scale * leafArray[firstBox]->m_surfaceArea;
+				for (dgInt32 i = 1; i <= count; i++) {
+					dgFloat32 area1 = leafArray[firstBox + i]->m_surfaceArea;
+					if (area0 > area1) {
+						midPoint = i - 1;
+						break;
+					}
+				}
+			}
 
-		parent->m_left = BuildTopDown(leafArray, firstBox, firstBox + info.m_axis - 1, nextNode);
-		parent->m_left->m_parent = parent;
+			index = fitness.m_rebuildNodesCount;
+			fitness.m_rebuildNodesCount++;
+			dgAssert(fitness.m_rebuildNodesCount < fitness.m_rebuildNodes.GetElementsCapacity());
+			dgAssert((fitness.m_rebuildStackCount + 2) < fitness.m_rebuildStack.GetElementsCapacity());
+
+			dgFitnessList::dgRebuildEntry& left = stack[fitness.m_rebuildStackCount];
+			dgFitnessList::dgRebuildEntry& right = stack[fitness.m_rebuildStackCount + 1];
+			fitness.m_rebuildStackCount += 2;
+
+			left.m_parent = index;
+			left.m_isLeft = 1;
+			right.m_parent = index;
+			right.m_isLeft = 0;
+			if (midPoint == -1) {
+				dgSpliteInfo info(&leafArray[firstBox], count + 1);
+				left.m_firstBox = firstBox;
+				left.m_lastBox = firstBox + info.m_axis - 1;
+				left.m_isBig = 0;
+				right.m_firstBox = firstBox + info.m_axis;
+				right.m_lastBox = lastBox;
+				right.m_isBig = 0;
+			} else {
+				right.m_firstBox = firstBox;
+				right.m_lastBox = firstBox + midPoint;
+				right.m_isBig = 0;
+				left.m_firstBox = firstBox + midPoint + 1;
+				left.m_lastBox = lastBox;
+				left.m_isBig = 1;
+			}
+		}
 
-		parent->m_right = BuildTopDown(leafArray, firstBox + info.m_axis, lastBox, nextNode);
-		parent->m_right->m_parent = parent;
-		return parent;
+		if (entry.m_parent < 0) {
+			fitness.m_rebuildRoot = index;
+		} else if (entry.m_isLeft) {
+			nodeArray[entry.m_parent].m_left = index;
+		} else {
+			nodeArray[entry.m_parent].m_right = index;
+		}
 	}
+	return fitness.m_rebuildStackCount ? false : true;
 }
 
-
-dgBroadPhaseNode* dgBroadPhase::BuildTopDownBig(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode)
+dgBroadPhaseNode* dgBroadPhase::LinkRebuiltTree(dgFitnessList& fitness) const
 {
-	if (lastBox == firstBox) {
-		return BuildTopDown(leafArray, firstBox, lastBox, nextNode);
+	DG_TRACKTIME(__FUNCTION__);
+	dgAssert(fitness.m_rebuildNodesCount == fitness.GetCount());
+	fitness.m_rebuildTree.ResizeIfNecessary(fitness.GetCount() + 16);
+	dgBroadPhaseTreeNode** const treeArray = &fitness.m_rebuildTree[0];
+
+	dgInt32 count = 0;
+	for (dgFitnessList::dgListNode* nodePtr = fitness.GetFirst(); nodePtr; nodePtr = nodePtr->GetNext()) {
+		treeArray[count] = nodePtr->GetInfo();
+		count++;
 	}
 
-	dgInt32 midPoint = -1;
-	const dgFloat32 scale = dgFloat32 (1.0f / 64.0f);
-	const dgBroadPhaseNode* const node0 = leafArray[firstBox];
-	const dgInt32 count = lastBox - firstBox;
-	dgFloat32 area0 = scale * node0->m_surfaceArea;
-	for (dgInt32 i = 1; i <= count; i++) {
-		const dgBroadPhaseNode* const node1 = leafArray[firstBox + i];
-		dgFloat32 area1 = node1->m_surfaceArea;
-		if (area0 > area1) {
-			midPoint = i - 1;
-			break;
+	dgBroadPhaseNode** const leafArray = &fitness.m_rebuildLeafs[0];
+	for (dgInt32 i = 0; i < fitness.m_rebuildLeafsCount; i++) {
+		dgBroadPhaseNode* const leaf = leafArray[i];
+		dgBody* const body = leaf->GetBody();
+		if (body) {
+			leaf->SetAABB(body->m_minAABB, body->m_maxAABB);
 		}
 	}
 
-	if (midPoint == -1) {
-		return BuildTopDown(leafArray, firstBox, lastBox, nextNode);
-	} else {
-		dgBroadPhaseTreeNode* const parent = (*nextNode)->GetInfo();
-
-		parent->m_parent = NULL;
-		*nextNode = (*nextNode)->GetNext();
-
-		parent->m_right = BuildTopDown(leafArray, firstBox, firstBox + midPoint, nextNode);
-		parent->m_right->m_parent = parent;
-
-		parent->m_left = BuildTopDownBig(leafArray, firstBox + midPoint + 1, lastBox, nextNode);
-		parent->m_left->m_parent = parent;
-
-		dgVector minP (parent->m_left->m_minBox.GetMin(parent->m_right->m_minBox));
-		dgVector maxP (parent->m_left->m_maxBox.GetMax(parent->m_right->m_maxBox));
-		parent->SetAABB(minP, maxP);
-
-		return parent;
+	// children always have a higher index than their parent, so the boxes are calculated bottom up.
+	const dgFitnessList::dgRebuildNode* const nodeArray = &fitness.m_rebuildNodes[0];
+	for (dgInt32 i = count - 1; i >= 0; i--) {
+		dgBroadPhaseTreeNode* const node = treeArray[i];
+		const dgInt32 leftIndex = nodeArray[i].m_left;
+		const dgInt32 rightIndex = nodeArray[i].m_right;
+		node->m_left = (leftIndex >= 0) ? treeArray[leftIndex] : leafArray[-leftIndex - 1];
+		node->m_right = (rightIndex >= 0) ? treeArray[rightIndex] : leafArray[-rightIndex - 1];
+		node->m_left->m_parent = node;
+		node->m_right->m_parent = node;
+
+		dgVector minBox;
+		dgVector maxBox;
+		node->m_surfaceArea = CalculateSurfaceArea(node->m_left, node->m_right, minBox, maxBox);
+		node->m_minBox = minBox;
+		node->m_maxBox = maxBox;
 	}
+
+	dgAssert(fitness.m_rebuildRoot >= 0);
+	dgBroadPhaseNode* const root = treeArray[fitness.m_rebuildRoot];
+	root->m_parent = NULL;
+	fitness.m_rebuildLeafsCount = 0;
+	return root;
 }
 
 
@@ -820,7 +924,7 @@ dgInt32 dgBroadPhase::CompareNodes(const dgBroadPhaseNode* const nodeA, const dg
 }
 
 
-void dgBroadPhase::ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy, dgBroadPhaseNode** const root)
+void dgBroadPhase::ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy, dgBroadPhaseNode** const root, dgInt32 rebuildBudget)
 {
 	if (*root) {
 		DG_TRACKTIME(__FUNCTION__);
@@ -828,45 +932,29 @@ void dgBroadPhase::ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy,
 		(*root)->m_parent = NULL;
 		dgFloat64 entropy = CalculateEntropy(fitness, root);
 
-		if ((entropy > oldEntropy * dgFloat32(1.5f)) || (entropy < oldEntropy * dgFloat32(0.75f))) {
-			if (fitness.GetFirst()) {
-				m_world->m_solverJacobiansMemory.ResizeIfNecessary ((fitness.GetCount() * 2 + 16) * sizeof (dgBroadPhaseNode*));
-				dgBroadPhaseNode** const leafArray = (dgBroadPhaseNode**)&m_world->m_solverJacobiansMemory[0];
-
-				dgInt32 leafNodesCount = 0;
-				for (dgFitnessList::dgListNode* nodePtr = fitness.GetFirst(); nodePtr; nodePtr = nodePtr->GetNext()) {
-					dgBroadPhaseNode* const node = nodePtr->GetInfo();
-					dgBroadPhaseNode* const leftNode = node->GetLeft();
-					dgBody* const leftBody = leftNode->GetBody();
-					if (leftBody) {
-						node->SetAABB(leftBody->m_minAABB, leftBody->m_maxAABB);
-						leafArray[leafNodesCount] = leftNode;
-						leafNodesCount++;
-					} else if (leftNode->IsAggregate()) {
-						leafArray[leafNodesCount] = leftNode;
-						leafNodesCount++;
-					}
-					dgBroadPhaseNode* const rightNode = node->GetRight();
-					dgBody* const rightBody = rightNode->GetBody();
-					if (rightBody) {
-						rightNode->SetAABB(rightBody->m_minAABB, rightBody->m_maxAABB);
-						leafArray[leafNodesCount] = rightNode;
-						leafNodesCount++;
-					} else if (rightNode->IsAggregate()) {
-						leafArray[leafNodesCount] = rightNode;
-						leafNodesCount++;
-					}
-				}
+		if (fitness.IsRebuilding() && (fitness.m_rebuildVersion != fitness.m_version)) {
+			// nodes were added or removed since the snapshot was taken, start over
+			fitness.m_rebuildLeafsCount = 0;
+			fitness.m_rebuildStackCount = 0;
+		}
 
-				dgFitnessList::dgListNode* nodePtr = fitness.GetFirst();
+		if (!fitness.IsRebuilding() && ((entropy > oldEntropy * dgFloat32(1.5f)) || (entropy < oldEntropy * dgFloat32(0.75f)))) {
+			if (fitness.GetFirst()) {
+				BeginTreeRebuild(fitness);
+			} else {
+				oldEntropy = entropy;
+			}
+		}
 
-				dgSortIndirect(leafArray, leafNodesCount, CompareNodes);
-				*root = BuildTopDownBig(leafArray, 0, leafNodesCount - 1, &nodePtr);
-				dgAssert(!(*root)->m_parent);
-				//entropy = CalculateEntropy(fitness, root);
+		if (fitness.IsRebuilding()) {
+			// the rebuild runs on the calling thread, after the new contacts are attached.
+			// it does not overlap the contact generation, the budget is what bounds the cost per step
+			const dgInt32 boxBudget = dgMax(rebuildBudget, fitness.GetCount() >> 2);
+			if (BuildTopDown(fitness, boxBudget)) {
+				*root = LinkRebuiltTree(fitness);
 				entropy = fitness.TotalCost();
+				oldEntropy = entropy;
 			}
-			oldEntropy = entropy;
 		}
 		(*root)->m_parent = parent;
 	}
@@ -1054,9 +1142,14 @@ void dgBroadPhase::CalculatePairContacts (dgPair* const pair, dgInt32 threadID)
     dgContactPoint contacts[DG_MAX_CONTATCS];
 
 	pair->m_cacheIsValid = false;
+	pair->m_isSpeculative = false;
 	pair->m_contactBuffer = contacts;
 	m_world->CalculateContacts(pair, threadID, false, false);
 
+	if (!pair->m_contactCount && !pair->m_cacheIsValid) {
+		CalculateSpeculativeContacts(pair, threadID);
+	}
+
 	if (pair->m_contactCount) {
 //		if (pair->m_contact->m_body0->m_invMass.m_w != dgFloat32 (0.0f)) {
 //			pair->m_contact->m_body0->m_equilibrium = false;
@@ -1077,6 +1170,41 @@ void dgBroadPhase::CalculatePairContacts (dgPair* const pair, dgInt32 threadID)
 	}
 }
 
+void dgBroadPhase::CalculateSpeculativeContacts (dgPair* const pair, dgInt32 threadID) const
+{
+	dgContact* const contact = pair->m_contact;
+	if (!(contact->m_body0->UseSpeculativeContacts() || contact->m_body1->UseSpeculativeContacts())) {
+		return;
+	}
+
+	// the bodies are not touching, sweep them along the step and if they hit, keep the contacts 
+	// at the time of impact with a negative penetration equal to the gap that is still open, 
+	// the solver let the bodies close that gap in one step but not go past it.
+	const dgFloat32 timestep = pair->m_timestep;
+	m_world->CalculateContacts(pair, threadID, true, false);
+	const dgFloat32 timeOfImpact = pair->m_timestep;
+	pair->m_timestep = timestep;
+
+	// points that are separating are dropped, otherwise they would hold the bodies at a phantom gap
+	dgInt32 count = 0;
+	dgContactPoint* const contacts = pair->m_contactBuffer;
+	for (dgInt32 i = 0; i < pair->m_contactCount; i ++) {
+		const dgContactPoint& point = contacts[i];
+		const dgBody* const body0 = point.m_body0;
+		const dgBody* const body1 = point.m_body1;
+		const dgVector veloc0 (body0->m_veloc + body0->m_omega.CrossProduct3(point.m_point - body0->m_globalCentreOfMass));
+		const dgVector veloc1 (body1->m_veloc + body1->m_omega.CrossProduct3(point.m_point - body1->m_globalCentreOfMass));
+		const dgFloat32 closingSpeed = dgMax ((veloc1 - veloc0).DotProduct3(point.m_normal), dgFloat32 (0.0f));
+		if (closingSpeed > dgFloat32 (0.0f)) {
+			contacts[count] = point;
+			contacts[count].m_penetration = -closingSpeed * timeOfImpact;
+			count ++;
+		}
+	}
+	pair->m_contactCount = count;
+	pair->m_isSpeculative = count ? true : false;
+}
+
 void dgBroadPhase::AddPair (dgContact* const contact, dgFloat32 timestep, dgInt32 threadIndex)
 {
 	dgWorld* const world = (dgWorld*) m_world;
@@ -1208,6 +1336,7 @@ void dgBroadPhase::AddPair (dgBody* const body0, dgBody* const body1, const dgFl
 							m_pendingSoftBodyPairsCount++;
 						} else {
 							dgScopeSpinLock lock(&m_contacJointLock);
+							dgMemoryCategoryScope memoryScope (m_memoryContacts);
 							contact = new (m_world->m_allocator) dgContact(m_world, material);
 							contact->AppendToContactList();
 							dgAssert(contact);
@@ -1331,6 +1460,56 @@ void dgBroadPhase::SubmitPairs(dgBroadPhaseNode* const leafNode, dgBroadPhaseNod
 }
 
 
+// same as SubmitPairs but only pairs the leaf body with sleeping bodies, 
+// used by the sleep aware update to collect the pairs that the sleeping leafs no longer submit.
+void dgBroadPhase::SubmitSleepingPairs(dgBroadPhaseNode* const leafNode, dgBroadPhaseNode* const node, dgFloat32 timestep, dgInt32 threadID)
+{
+	dgBroadPhaseNode* pool[DG_BROADPHASE_MAX_STACK_DEPTH];
+	pool[0] = node;
+	dgInt32 stack = 1;
+
+	dgAssert (leafNode->IsLeafNode());
+	dgBody* const body0 = leafNode->GetBody();
+	dgAssert (!body0 || !body0->m_sleeping);
+	const dgVector boxP0 (body0 ? body0->m_minAABB : leafNode->m_minBox);
+	const dgVector boxP1 (body0 ? body0->m_maxAABB : leafNode->m_maxBox);
+
+	const bool test0 = body0 ? (body0->GetInvMass().m_w != dgFloat32(0.0f)) : true;
+	while (stack) {
+		stack--;
+		dgBroadPhaseNode* const rootNode = pool[stack];
+		if (dgOverlapTest(rootNode->m_minBox, rootNode->m_maxBox, boxP0, boxP1)) {
+			if (rootNode->IsLeafNode()) {
+				dgBody* const body1 = rootNode->GetBody();
+				if (body1 && body1->m_sleeping) {
+					if (body0) {
+						if (test0 || (body1->GetInvMass().m_w != dgFloat32(0.0f))) {
+							AddPair(body0, body1, timestep, threadID);
+						}
+					} else {
+						dgAssert (leafNode->IsAggregate());
+						dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*) leafNode;
+						aggregate->SummitPairs(body1, timestep, threadID);
+					}
+				}
+			} else {
+				dgBroadPhaseTreeNode* const tmpNode = (dgBroadPhaseTreeNode*) rootNode;
+				dgAssert (tmpNode->m_left);
+				dgAssert (tmpNode->m_right);
+
+				pool[stack] = tmpNode->m_left;
+				stack++;
+				dgAssert(stack < dgInt32(sizeof (pool) / sizeof (pool[0])));
+
+				pool[stack] = tmpNode->m_right;
+				stack++;
+				dgAssert(stack < dgInt32(sizeof (pool) / sizeof (pool[0])));
+			}
+		}
+	}
+}
+
+
 void dgBroadPhase::ImproveNodeFitness(dgBroadPhaseTreeNode* const node, dgBroadPhaseNode** const root)
 {
 	dgAssert(node->GetLeft());
@@ -1434,12 +1613,21 @@ void dgBroadPhase::KinematicBodyActivation (dgContact* const contatJoint) const
 
 void dgBroadPhase::CollidingPairsKernel(void* const context, void* const node, dgInt32 threadID)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryBroadPhase);
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
 	dgWorld* const world = descriptor->m_world;
 	dgBroadPhase* const broadPhase = world->GetBroadPhase();
 	broadPhase->FindCollidingPairs(descriptor, (dgList<dgBroadPhaseNode*>::dgListNode*) node, threadID);
 }
 
+void dgBroadPhase::PrepareCollidingPairsKernel(void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
+	dgWorld* const world = descriptor->m_world;
+	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	broadPhase->PrepareCollidingPairs();
+}
+
 void dgBroadPhase::AddNewContactsKernel(void* const context, void* const newContactNode, dgInt32 threadID)
 {
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
@@ -1448,6 +1636,39 @@ void dgBroadPhase::AddNewContactsKernel(void* const context, void* const newCont
 	broadPhase->AddNewContacts(descriptor, (dgContactsList::dgListNode*) newContactNode, threadID);
 }
 
+void dgBroadPhase::AddNewContactsTaskKernel(void* const context, void* const sliceIndex, dgInt32 threadID)
+{
+	// new contacts are added in front of the contact list by the colliding pairs tasks, 
+	// so the first node of each slice can only be found after those tasks are completed.
+	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
+	dgWorld* const world = descriptor->m_world;
+	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	dgContactsList* const contactList = world;
+	dgContactsList::dgListNode* node = descriptor->m_lastContactNode ? descriptor->m_lastContactNode->GetPrev() : contactList->GetLast();
+	const dgInt32 slice = dgInt32 (size_t (sliceIndex));
+	for (dgInt32 i = 0; i < slice; i++) {
+		node = node ? node->GetPrev() : NULL;
+	}
+	broadPhase->AddNewContacts(descriptor, node, threadID);
+}
+
+void dgBroadPhase::AttachNewContactsKernel(void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
+	dgWorld* const world = descriptor->m_world;
+	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	broadPhase->AttachNewContacts(descriptor->m_lastContactNode);
+	broadPhase->RemoveOldContacts();
+}
+
+void dgBroadPhase::UpdateFitnessKernel(void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
+	dgWorld* const world = descriptor->m_world;
+	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	broadPhase->UpdateFitness();
+}
+
 void dgBroadPhase::AddGeneratedBodiesContactsKernel (void* const context, void* const worldContext, dgInt32 threadID)
 {
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*) context;
@@ -1464,12 +1685,12 @@ void dgBroadPhase::UpdateSoftBodyContactKernel(void* const context, void* const
 	broadPhase->UpdateSoftBodyContacts(descriptor, descriptor->m_timestep, threadID);
 }
 
-void dgBroadPhase::UpdateRigidBodyContactKernel(void* const context, void* const node, dgInt32 threadID)
+void dgBroadPhase::UpdateRigidBodyContactKernel(void* const context, void* const worldContext, dgInt32 threadID)
 {
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
 	dgWorld* const world = descriptor->m_world;
 	dgBroadPhase* const broadPhase = world->GetBroadPhase();
-	broadPhase->UpdateRigidBodyContacts(descriptor, (dgContactsList::dgListNode*) node, descriptor->m_timestep, threadID);
+	broadPhase->UpdateRigidBodyContacts(descriptor, descriptor->m_timestep, threadID);
 }
 
 void dgBroadPhase::UpdateSoftBodyContacts(dgBroadphaseSyncDescriptor* const descriptor, dgFloat32 timeStep, dgInt32 threadID)
@@ -1491,85 +1712,99 @@ void dgBroadPhase::UpdateSoftBodyContacts(dgBroadphaseSyncDescriptor* const desc
 	}
 }
 
-void dgBroadPhase::UpdateRigidBodyContacts(dgBroadphaseSyncDescriptor* const descriptor, dgContactsList::dgListNode* const nodePtr, dgFloat32 timeStep, dgInt32 threadID)
+void dgBroadPhase::UpdateRigidBodyContacts(dgBroadphaseSyncDescriptor* const descriptor, dgFloat32 timeStep, dgInt32 threadID)
 {
 	DG_TRACKTIME(__FUNCTION__);
-	dgContactsList::dgListNode* node = nodePtr;
+	dgMemoryCategoryScope memoryScope (m_memoryContacts);
 	dgContactsList* const contactList = m_world;
 	const dgFloat32 timestep = descriptor->m_timestep;
-	const dgInt32 threadCount = descriptor->m_world->GetThreadCount();
 	const dgUnsigned32 lru = m_lru - DG_CONTACT_DELAY_FRAMES;
 	dgJointInfo* const constraintArray = (dgJointInfo*)&m_world->m_jointsMemory[0];
 
-	while (node) {
-		dgContact* const contact = node->GetInfo();
-
-		const dgBody* const body0 = contact->GetBody0();
-		const dgBody* const body1 = contact->GetBody1();
-		if (!(body0->m_equilibrium & body1->m_equilibrium)) {
-			if (ValidateContactCache(contact, timestep)) {
-				contact->m_broadphaseLru = m_lru;
-				contact->m_timeOfImpact = dgFloat32(1.0e10f);
-			} else {
-				contact->m_contactActive = 0;
-				contact->m_positAcc = dgVector::m_zero;
-				contact->m_rotationAcc = dgQuaternion();
-
-				dgFloat32 distance = contact->m_separationDistance;
-				if (distance >= DG_NARROW_PHASE_DIST) {
-					const dgVector veloc0 (body0->GetVelocity());
-					const dgVector veloc1 (body1->GetVelocity());
-					const dgVector omega0 (body0->GetOmega());
-					const dgVector omega1 (body1->GetOmega());
-					const dgCollisionInstance* const collision0 = body0->GetCollision();
-					const dgCollisionInstance* const collision1 = body1->GetCollision();
-					const dgFloat32 maxDiameter0 = dgFloat32 (3.5f) * collision0->GetBoxMaxRadius(); 
-					const dgFloat32 maxDiameter1 = dgFloat32 (3.5f) * collision1->GetBoxMaxRadius(); 
-
-					const dgVector velocLinear (veloc1 - veloc0);
-					const dgFloat32 velocAngular0 = dgSqrt((omega0.DotProduct4(omega0)).GetScalar()) * maxDiameter0;
-					const dgFloat32 velocAngular1 = dgSqrt((omega1.DotProduct4(omega1)).GetScalar()) * maxDiameter1;
-					const dgFloat32 speed = dgSqrt ((velocLinear.DotProduct4(velocLinear)).GetScalar()) + velocAngular1 + velocAngular0 + dgFloat32 (0.5f);
-					distance -= speed * timestep;
-					contact->m_separationDistance = distance;
-				}
-				if (distance < DG_NARROW_PHASE_DIST) {
-					AddPair(contact, timestep, threadID);
-					if (contact->m_maxDOF) {
-						contact->m_timeOfImpact = dgFloat32(1.0e10f);
-					}
+	// contacts are taken in small batches from a shared cursor, so a thread stuck on an expensive 
+	// pair does not hold back the contacts that would have been assigned to it.
+	for (dgContactsList::dgListNode* batch = GetNextContactsBatch(descriptor); batch; batch = GetNextContactsBatch(descriptor)) {
+		dgContactsList::dgListNode* node = batch;
+		for (dgInt32 n = 0; node && (n < DG_CONTACT_BATCH_SIZE); n ++) {
+			dgContact* const contact = node->GetInfo();
+
+			const dgBody* const body0 = contact->GetBody0();
+			const dgBody* const body1 = contact->GetBody1();
+			if (!(body0->m_equilibrium & body1->m_equilibrium)) {
+				if (ValidateContactCache(contact, timestep)) {
 					contact->m_broadphaseLru = m_lru;
+					contact->m_timeOfImpact = dgFloat32(1.0e10f);
 				} else {
-					dgAssert (contact->m_maxDOF == 0);
-					const dgBroadPhaseNode* const bodyNode0 = contact->GetBody0()->m_broadPhaseNode;
-					const dgBroadPhaseNode* const bodyNode1 = contact->GetBody1()->m_broadPhaseNode;
-					if (dgOverlapTest(bodyNode0->m_minBox, bodyNode0->m_maxBox, bodyNode1->m_minBox, bodyNode1->m_maxBox)) {
+					contact->m_contactActive = 0;
+					contact->m_positAcc = dgVector::m_zero;
+					contact->m_rotationAcc = dgQuaternion();
+
+					dgFloat32 distance = contact->m_separationDistance;
+					if (distance >= DG_NARROW_PHASE_DIST) {
+						const dgVector veloc0 (body0->GetVelocity());
+						const dgVector veloc1 (body1->GetVelocity());
+						const dgVector omega0 (body0->GetOmega());
+						const dgVector omega1 (body1->GetOmega());
+						const dgCollisionInstance* const collision0 = body0->GetCollision();
+						const dgCollisionInstance* const collision1 = body1->GetCollision();
+						const dgFloat32 maxDiameter0 = dgFloat32 (3.5f) * collision0->GetBoxMaxRadius(); 
+						const dgFloat32 maxDiameter1 = dgFloat32 (3.5f) * collision1->GetBoxMaxRadius(); 
+
+						const dgVector velocLinear (veloc1 - veloc0);
+						const dgFloat32 velocAngular0 = dgSqrt((omega0.DotProduct4(omega0)).GetScalar()) * maxDiameter0;
+						const dgFloat32 velocAngular1 = dgSqrt((omega1.DotProduct4(omega1)).GetScalar()) * maxDiameter1;
+						const dgFloat32 speed = dgSqrt ((velocLinear.DotProduct4(velocLinear)).GetScalar()) + velocAngular1 + velocAngular0 + dgFloat32 (0.5f);
+						distance -= speed * timestep;
+						contact->m_separationDistance = distance;
+					}
+					if (distance < DG_NARROW_PHASE_DIST) {
+						AddPair(contact, timestep, threadID);
+						if (contact->m_maxDOF) {
+							contact->m_timeOfImpact = dgFloat32(1.0e10f);
+						}
 						contact->m_broadphaseLru = m_lru;
 					} else {
-						if (contact->m_broadphaseLru < lru) {
-							dgInt32 index = dgAtomicExchangeAndAdd(&contactList->m_deadContactsCount, 1);
-							if (index < sizeof(contactList->m_deadContacts) / sizeof(contactList->m_deadContacts[0])) {
-								contactList->m_deadContacts[index] = node;
+						dgAssert (contact->m_maxDOF == 0);
+						const dgBroadPhaseNode* const bodyNode0 = contact->GetBody0()->m_broadPhaseNode;
+						const dgBroadPhaseNode* const bodyNode1 = contact->GetBody1()->m_broadPhaseNode;
+						if (dgOverlapTest(bodyNode0->m_minBox, bodyNode0->m_maxBox, bodyNode1->m_minBox, bodyNode1->m_maxBox)) {
+							contact->m_broadphaseLru = m_lru;
+						} else {
+							if (contact->m_broadphaseLru < lru) {
+								dgInt32 index = dgAtomicExchangeAndAdd(&contactList->m_deadContactsCount, 1);
+								if (index < sizeof(contactList->m_deadContacts) / sizeof(contactList->m_deadContacts[0])) {
+									contactList->m_deadContacts[index] = node;
+								}
 							}
 						}
 					}
 				}
+			} else {
+				contact->m_broadphaseLru = m_lru;
 			}
-		} else {
-			contact->m_broadphaseLru = m_lru;
-		}
 
-		if (contact->m_maxDOF) {
-			dgInt32 index = dgAtomicExchangeAndAdd (&contactList->m_activeContacts, 1);
-			constraintArray[index].m_joint = contact;
-		}
+			if (contact->m_maxDOF) {
+				dgInt32 index = dgAtomicExchangeAndAdd (&contactList->m_activeContacts, 1);
+				constraintArray[index].m_joint = contact;
+			}
 
-		for (dgInt32 i = 0; i < threadCount; i++) {
-			node = node ? node->GetNext() : NULL;
+			node = node->GetNext();
 		}
 	}
 }
 
+dgContactsList::dgListNode* dgBroadPhase::GetNextContactsBatch(dgBroadphaseSyncDescriptor* const descriptor) const
+{
+	dgScopeSpinLock lock(&descriptor->m_contactNodeLock);
+	dgContactsList::dgListNode* const batch = descriptor->m_contactNode;
+	dgContactsList::dgListNode* node = batch;
+	for (dgInt32 i = 0; node && (i < DG_CONTACT_BATCH_SIZE); i ++) {
+		node = node->GetNext();
+	}
+	descriptor->m_contactNode = node;
+	return batch;
+}
+
 void dgBroadPhase::AddNewContacts(dgBroadphaseSyncDescriptor* const descriptor, dgContactsList::dgListNode* const nodeConstactNode, dgInt32 threadID)
 {
 	const dgFloat32 timestep = descriptor->m_timestep;
@@ -1621,6 +1856,7 @@ void dgBroadPhase::RemoveOldContacts()
 void dgBroadPhase::UpdateContacts(dgFloat32 timestep)
 {
 	DG_TRACKTIME(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memoryBroadPhase);
     m_lru = m_lru + 1;
 	m_pendingSoftBodyPairsCount = 0;
 
@@ -1629,15 +1865,20 @@ void dgBroadPhase::UpdateContacts(dgFloat32 timestep)
 	const dgBodyMasterList* const masterList = m_world;
 	dgBroadphaseSyncDescriptor syncPoints(timestep, m_world);
 
-	dgBodyMasterList::dgListNode* node = masterList->GetLast();
-	for (dgInt32 i = 0; i < threadsCount; i++) {
-		m_world->QueueJob(ForceAndToqueKernel, &syncPoints, node, "dgBroadPhase::ForceAndToque");
-		node = node ? node->GetPrev() : NULL;
+	bool hasPreListeners = false;
+	for (dgWorld::dgListenerList::dgListNode* node1 = m_world->m_listeners.GetFirst(); node1; node1 = node1->GetNext()) {
+		hasPreListeners = hasPreListeners || (node1->GetInfo().m_onPreUpdate != NULL);
 	}
-	m_world->SynchronizationBarrier();
 
-	// update pre-listeners after the force and torque are applied
-	if (m_world->m_listeners.GetCount()) {
+	dgBodyMasterList::dgListNode* node = masterList->GetLast();
+	if (hasPreListeners) {
+		// the pre-listeners run on this thread after all the force and torque are applied
+		for (dgInt32 i = 0; i < threadsCount; i++) {
+			m_world->QueueJob(ForceAndToqueKernel, &syncPoints, node, "dgBroadPhase::ForceAndToque");
+			node = node ? node->GetPrev() : NULL;
+		}
+		m_world->SynchronizationBarrier();
+
 		for (dgWorld::dgListenerList::dgListNode* node1 = m_world->m_listeners.GetFirst(); node1; node1 = node1->GetNext()) {
 			dgWorld::dgListener& listener = node1->GetInfo();
 			if (listener.m_onPreUpdate) {
@@ -1659,20 +1900,20 @@ void dgBroadPhase::UpdateContacts(dgFloat32 timestep)
 	}
 	m_world->SynchronizationBarrier();
 
-	dgActiveContacts::dgListNode* contactListNode = contactList->GetFirst();
+	syncPoints.m_contactNode = contactList->GetFirst();
 	for (dgInt32 i = 0; i < threadsCount; i++) {
-		m_world->QueueJob(UpdateRigidBodyContactKernel, &syncPoints, contactListNode, "dgBroadPhase::UpdateRigidBodyContact");
-		contactListNode = contactListNode ? contactListNode->GetNext() : NULL;
+		m_world->QueueJob(UpdateRigidBodyContactKernel, &syncPoints, m_world, "dgBroadPhase::UpdateRigidBodyContact");
 	}
 	m_world->SynchronizationBarrier();
 
 	if (m_pendingSoftBodyPairsCount) {
 		for (dgInt32 i = 0; i < threadsCount; i++) {
-			m_world->QueueJob(UpdateSoftBodyContactKernel, &syncPoints, contactListNode, "dgBroadPhase::UpdateSoftBodyContact");
+			m_world->QueueJob(UpdateSoftBodyContactKernel, &syncPoints, m_world, "dgBroadPhase::UpdateSoftBodyContact");
 		}
 		m_world->SynchronizationBarrier();
 	}
 
+	PrepareCollidingPairs();
 	dgList<dgBroadPhaseNode*>::dgListNode* broadPhaseNode = m_updateList.GetFirst();
 	for (dgInt32 i = 0; i < threadsCount; i++) {
 		m_world->QueueJob(CollidingPairsKernel, &syncPoints, broadPhaseNode, "dgBroadPhase::CollidingPairs");
@@ -1714,12 +1955,78 @@ void dgBroadPhase::UpdateContacts(dgFloat32 timestep)
 	}
 	m_world->SynchronizationBarrier();
 
+	AttachNewContacts(lastNode);
+	RemoveOldContacts();
+	UpdateFitness();
+
 #else
-	m_threadSync.Reset(threadsCount);
+	// each phase is split in one task per thread. the aggregates entropy and the tree fitness allocate
+	// from the world allocator, which is not thread safe, so they wait until the contacts are attached.
+	syncPoints.m_lastContactNode = lastNode;
+	dgTaskGraph graph(m_world);
+
+	dgInt32 tasks[DG_MAX_THREADS_HIVE_COUNT];
+	dgInt32 forceAndTorque[DG_MAX_THREADS_HIVE_COUNT];
+	if (!hasPreListeners) {
+		// the force and torque and the sleeping state tasks walk the bodies with the same
+		// stride, so each slice only waits for the force and torque of its own bodies.
+		node = masterList->GetLast();
+		for (dgInt32 i = 0; i < threadsCount; i++) {
+			forceAndTorque[i] = graph.AddTask(ForceAndToqueKernel, &syncPoints, node, "dgBroadPhase::ForceAndToque");
+			node = node ? node->GetPrev() : NULL;
+		}
+	}
+
+	node = masterList->GetLast();
 	for (dgInt32 i = 0; i < threadsCount; i++) {
-		m_world->QueueJob(UpdateParallelKernel, &syncPoints, m_world, "dgBroadPhase::UpdateParallelKernel");
+		tasks[i] = graph.AddTask(SleepingStateKernel, &syncPoints, node, "dgBroadPhase::SleepingState");
+		if (!hasPreListeners) {
+			graph.AddDependency(tasks[i], forceAndTorque[i]);
+		}
+		node = node ? node->GetPrev() : NULL;
 	}
-	m_world->SynchronizationBarrier();
+	const dgInt32 sleepingState = graph.AddJoin(tasks, threadsCount, "dgBroadPhase::SleepingStateJoin");
+
+	syncPoints.m_contactNode = contactList->GetFirst();
+	for (dgInt32 i = 0; i < threadsCount; i++) {
+		tasks[i] = graph.AddTask(UpdateRigidBodyContactKernel, &syncPoints, m_world, "dgBroadPhase::UpdateRigidBodyContact");
+		graph.AddDependency(tasks[i], sleepingState);
+	}
+	const dgInt32 rigidBodyContacts = graph.AddJoin(tasks, threadsCount, "dgBroadPhase::UpdateRigidBodyContactJoin");
+
+	// the pairs structure only depends on the bodies aabb, so it is updated while the old contacts are calculated
+	const dgInt32 preparePairs = graph.AddTask(PrepareCollidingPairsKernel, &syncPoints, m_world, "dgBroadPhase::PrepareCollidingPairs");
+	graph.AddDependency(preparePairs, sleepingState);
+
+	dgList<dgBroadPhaseNode*>::dgListNode* broadPhaseNode = m_updateList.GetFirst();
+	for (dgInt32 i = 0; i < threadsCount; i++) {
+		tasks[i] = graph.AddTask(CollidingPairsKernel, &syncPoints, broadPhaseNode, "dgBroadPhase::CollidingPairs");
+		graph.AddDependency(tasks[i], rigidBodyContacts);
+		graph.AddDependency(tasks[i], preparePairs);
+		broadPhaseNode = broadPhaseNode ? broadPhaseNode->GetNext() : NULL;
+	}
+	const dgInt32 collidingPairs = graph.AddJoin(tasks, threadsCount, "dgBroadPhase::CollidingPairsJoin");
+
+	for (dgInt32 i = 0; i < threadsCount; i++) {
+		tasks[i] = graph.AddTask(AddNewContactsTaskKernel, &syncPoints, (void*) size_t(i), "dgBroadPhase::AddNewContacts");
+		graph.AddDependency(tasks[i], collidingPairs);
+	}
+	const dgInt32 newContacts = graph.AddJoin(tasks, threadsCount, "dgBroadPhase::AddNewContactsJoin");
+	const dgInt32 attachContacts = graph.AddTask(AttachNewContactsKernel, &syncPoints, m_world, "dgBroadPhase::AttachNewContacts");
+	graph.AddDependency(attachContacts, newContacts);
+
+	dgList<dgBroadPhaseAggregate*>::dgListNode* aggregateNode = m_aggregateList.GetFirst();
+	for (dgInt32 i = 0; i < threadsCount; i++) {
+		tasks[i] = graph.AddTask(UpdateAggregateEntropyKernel, &syncPoints, aggregateNode, "dgBroadPhase::UpdateAggregateEntropy");
+		graph.AddDependency(tasks[i], attachContacts);
+		aggregateNode = aggregateNode ? aggregateNode->GetNext() : NULL;
+	}
+	const dgInt32 aggregateEntropy = graph.AddJoin(tasks, threadsCount, "dgBroadPhase::UpdateAggregateEntropyJoin");
+	const dgInt32 fitness = graph.AddTask(UpdateFitnessKernel, &syncPoints, m_world, "dgBroadPhase::UpdateFitness");
+	graph.AddDependency(fitness, aggregateEntropy);
+
+	graph.Execute();
+	dgAssert(!m_pendingSoftBodyPairsCount);
 
 	//m_recursiveChunks = false;
 	if (m_generatedBodies.GetCount()) {
@@ -1738,67 +2045,4 @@ void dgBroadPhase::UpdateContacts(dgFloat32 timestep)
 		//m_generatedBodies.RemoveAll();
 	}
 #endif
-
-	AttachNewContacts(lastNode);
-	RemoveOldContacts();
-
-	UpdateFitness();
-}
-
-void dgBroadPhase::UpdateParallelKernel(void* const context, void* const node, dgInt32 threadID)
-{
-	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
-	dgWorld* const world = descriptor->m_world;
-	dgBroadPhase* const broadPhase = world->GetBroadPhase();
-	broadPhase->UpdateParallel(descriptor, threadID);
 }
-
-void dgBroadPhase::UpdateParallel(dgBroadphaseSyncDescriptor* const descriptor, dgInt32 threadID)
-{
-	// do the sleeping 
-	const dgBodyMasterList* const masterList = m_world;
-	dgBodyMasterList::dgListNode* node = masterList->GetLast();
-	for (dgInt32 i = 0; i < threadID; i++) {
-		node = node ? node->GetPrev() : NULL;
-	}
-	SleepingState(descriptor, node, threadID);
-	m_threadSync.Sync();
-
-	dgContactsList* const contactList = m_world;
-	dgContactsList::dgListNode* contactListNode = contactList->GetFirst();
-	for (dgInt32 i = 0; i < threadID; i++) {
-		contactListNode = contactListNode ? contactListNode->GetNext() : NULL;
-	}
-	UpdateRigidBodyContacts(descriptor, contactListNode, descriptor->m_timestep, threadID);
-	m_threadSync.Sync();
-
-	if (m_pendingSoftBodyPairsCount) {
-		dgAssert (0);
-//		for (dgInt32 i = 0; i < threadsCount; i++) {
-//			m_world->QueueJob(UpdateSoftBodyContactKernel, &syncPoints, contactListNode, "dgBroadPhase::UpdateSoftBodyContact");
-//		}
-//		m_world->SynchronizationBarrier();
-	}
-	
-	dgContactsList::dgListNode* const lastNode = contactList->GetFirst();
-	dgList<dgBroadPhaseNode*>::dgListNode* broadPhaseNode = m_updateList.GetFirst();
-	for (dgInt32 i = 0; i < threadID; i++) {
-		broadPhaseNode = broadPhaseNode ? broadPhaseNode->GetNext() : NULL;
-	}
-	FindCollidingPairs(descriptor, broadPhaseNode, threadID);
-	m_threadSync.Sync();
-
-	dgContactsList::dgListNode* newContact = lastNode ? lastNode->GetPrev() : contactList->GetLast();
-	for (dgInt32 i = 0; i < threadID; i++) {
-		newContact = newContact ? newContact->GetPrev() : NULL;
-	}
-	AddNewContacts(descriptor, newContact, threadID);
-	m_threadSync.Sync();
-
-	// this will move to an asynchronous thread 
-	dgList<dgBroadPhaseAggregate*>::dgListNode* aggregateNode = m_aggregateList.GetFirst();
-	for (dgInt32 i = 0; i < threadID; i++) {
-		aggregateNode = aggregateNode ? aggregateNode->GetNext() : NULL;
-	}
-	UpdateAggregateEntropy(descriptor, aggregateNode, threadID);
-}
\ No newline at end of file
@@ -37,6 +37,7 @@ class dgBroadPhaseAggregate;
 
 #define DG_CACHE_DIST_TOL				dgFloat32 (1.0e-3f)
 #define DG_BROADPHASE_MAX_STACK_DEPTH	256
+#define DG_BROADPHASE_REBUILD_BUDGET	(1024 * 4)
 
 class dgConvexCastReturnInfo
 {
@@ -378,27 +379,80 @@ class dgBroadPhase
 		dgBroadphaseSyncDescriptor(dgFloat32 timestep, dgWorld* const world)
 			:m_world(world)
 			,m_newBodiesNodes(NULL)
+			,m_lastContactNode(NULL)
+			,m_contactNode(NULL)
 			,m_timestep(timestep)
 			,m_pairsAtomicCounter(0)
+			,m_contactNodeLock(0)
 		{
 		}
 
 		dgWorld* m_world;
 		dgList<dgBody*>::dgListNode* m_newBodiesNodes;
+		dgContactsList::dgListNode* m_lastContactNode;
+		dgContactsList::dgListNode* m_contactNode;
 		dgFloat32 m_timestep;
 		dgInt32 m_pairsAtomicCounter;
+		dgInt32 m_contactNodeLock;
 	};
 	
 	class dgFitnessList: public dgList <dgBroadPhaseTreeNode*>
 	{
 		public:
+		// the tree is rebuilt over several steps from a snapshot of the leaves,
+		// internal nodes are referenced by index and leaves by -(index + 1)
+		class dgRebuildNode
+		{
+			public:
+			dgInt32 m_left;
+			dgInt32 m_right;
+		};
+
+		class dgRebuildEntry
+		{
+			public:
+			dgInt32 m_firstBox;
+			dgInt32 m_lastBox;
+			dgInt32 m_parent;
+			dgInt32 m_isLeft;
+			dgInt32 m_isBig;
+		};
+
 		dgFitnessList(dgMemoryAllocator* const allocator)
 			:dgList <dgBroadPhaseTreeNode*>(allocator)
+			,m_rebuildLeafs(allocator)
+			,m_rebuildNodes(allocator)
+			,m_rebuildStack(allocator)
+			,m_rebuildTree(allocator)
 			,m_index(0)
+			,m_version(0)
+			,m_rebuildVersion(0)
+			,m_rebuildRoot(0)
+			,m_rebuildLeafsCount(0)
+			,m_rebuildNodesCount(0)
+			,m_rebuildStackCount(0)
 			,m_prevCost(dgFloat32 (0.0f))
 		{
 		}
 
+		// add and remove tree nodes through these so a pending rebuild sees its snapshot is stale
+		dgListNode* AddNode(dgBroadPhaseTreeNode* const node)
+		{
+			m_version++;
+			return Append(node);
+		}
+
+		void RemoveNode(dgListNode* const node)
+		{
+			m_version++;
+			Remove(node);
+		}
+
+		bool IsRebuilding() const
+		{
+			return m_rebuildLeafsCount ? true : false;
+		}
+
 		dgFloat64 TotalCost() const
 		{
 			dgFloat64 cost = dgFloat32(0.0f);
@@ -409,7 +463,17 @@ class dgBroadPhase
 			return cost;
 		}
 
+		dgArray<dgBroadPhaseNode*> m_rebuildLeafs;
+		dgArray<dgRebuildNode> m_rebuildNodes;
+		dgArray<dgRebuildEntry> m_rebuildStack;
+		dgArray<dgBroadPhaseTreeNode*> m_rebuildTree;
 		dgInt32 m_index;
+		dgInt32 m_version;
+		dgInt32 m_rebuildVersion;
+		dgInt32 m_rebuildRoot;
+		dgInt32 m_rebuildLeafsCount;
+		dgInt32 m_rebuildNodesCount;
+		dgInt32 m_rebuildStackCount;
 		dgFloat64 m_prevCost;
 	};
 
@@ -430,6 +494,7 @@ class dgBroadPhase
 		dgInt32 m_contactCount : 16;
 		dgInt32 m_cacheIsValid : 1;
 		dgInt32 m_flipContacts : 1;
+		dgInt32 m_isSpeculative : 1;
 	};
 
 	dgBroadPhase(dgWorld* const world);
@@ -467,6 +532,7 @@ class dgBroadPhase
 	virtual dgInt32 Collide(dgCollisionInstance* const shape, const dgMatrix& matrix, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const = 0;
 	virtual dgInt32 ConvexCast (dgCollisionInstance* const shape, const dgMatrix& matrix, const dgVector& target, dgFloat32* const param, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const = 0;
 	virtual void FindCollidingPairs (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID) = 0;
+	virtual void PrepareCollidingPairs () {}
 
 	void RemoveOldContacts();
 	void AttachNewContacts(dgContactsList::dgListNode* const lastNode);
@@ -492,9 +558,10 @@ class dgBroadPhase
 	void RotateLeft(dgBroadPhaseTreeNode* const node, dgBroadPhaseNode** const root);
 	void RotateRight(dgBroadPhaseTreeNode* const node, dgBroadPhaseNode** const root);
 	void ImproveNodeFitness(dgBroadPhaseTreeNode* const node, dgBroadPhaseNode** const root);
-	void ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy, dgBroadPhaseNode** const root);
+	void ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy, dgBroadPhaseNode** const root, dgInt32 rebuildBudget = DG_BROADPHASE_REBUILD_BUDGET);
 
 	void CalculatePairContacts (dgPair* const pair, dgInt32 threadID);
+	void CalculateSpeculativeContacts (dgPair* const pair, dgInt32 threadID) const;
 	bool ValidateContactCache(dgContact* const contact, dgFloat32 timestep) const;
 	void AddPair (dgContact* const contact, dgFloat32 timestep, dgInt32 threadIndex);
 	void AddPair (dgBody* const body0, dgBody* const body1, dgFloat32 timestep, dgInt32 threadID);	
@@ -515,30 +582,34 @@ class dgBroadPhase
 	
 	void UpdateAggregateEntropy (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseAggregate*>::dgListNode* node, dgInt32 threadID);
 
-	dgBroadPhaseNode* BuildTopDown(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode);
-	dgBroadPhaseNode* BuildTopDownBig(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode);
+	void BeginTreeRebuild(dgFitnessList& fitness) const;
+	bool BuildTopDown(dgFitnessList& fitness, dgInt32 boxBudget) const;
+	dgBroadPhaseNode* LinkRebuiltTree(dgFitnessList& fitness) const;
 
 	void KinematicBodyActivation (dgContact* const contatJoint) const;
 	
 	void FindGeneratedBodiesCollidingPairs (dgBroadphaseSyncDescriptor* const descriptor, dgInt32 threadID);
 	void UpdateSoftBodyContacts(dgBroadphaseSyncDescriptor* const descriptor, dgFloat32 timeStep, dgInt32 threadID);
-	void UpdateRigidBodyContacts (dgBroadphaseSyncDescriptor* const descriptor, dgContactsList::dgListNode* const node, dgFloat32 timeStep, dgInt32 threadID);
+	void UpdateRigidBodyContacts (dgBroadphaseSyncDescriptor* const descriptor, dgFloat32 timeStep, dgInt32 threadID);
+	dgContactsList::dgListNode* GetNextContactsBatch (dgBroadphaseSyncDescriptor* const descriptor) const;
 	void SubmitPairs (dgBroadPhaseNode* const body, dgBroadPhaseNode* const node, dgFloat32 timestep, dgInt32 threaCount, dgInt32 threadID);
+	void SubmitSleepingPairs (dgBroadPhaseNode* const leafNode, dgBroadPhaseNode* const node, dgFloat32 timestep, dgInt32 threadID);
 	void AddNewContacts(dgBroadphaseSyncDescriptor* const descriptor, dgContactsList::dgListNode* const nodeConstactNode, dgInt32 threadID);
 		
 	static void SleepingStateKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void ForceAndToqueKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void CollidingPairsKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
+	static void PrepareCollidingPairsKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void AddNewContactsKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void UpdateAggregateEntropyKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void AddGeneratedBodiesContactsKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void UpdateRigidBodyContactKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void UpdateSoftBodyContactKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
+	static void AddNewContactsTaskKernel(void* const descriptor, void* const sliceIndex, dgInt32 threadID);
+	static void AttachNewContactsKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
+	static void UpdateFitnessKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static dgInt32 CompareNodes(const dgBroadPhaseNode* const nodeA, const dgBroadPhaseNode* const nodeB, void* const notUsed);
 
-	static void UpdateParallelKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
-	void UpdateParallel(dgBroadphaseSyncDescriptor* const descriptor, dgInt32 threadID);
-
 	class dgPendingCollisionSofBodies
 	{
 		public:
@@ -557,7 +628,6 @@ class dgBroadPhase
 	dgInt32 m_pendingSoftBodyPairsCount;
 	dgInt32 m_contacJointLock;
 	dgInt32 m_criticalSectionLock;
-	dThreadHiveSync m_threadSync;
 
 	static dgVector m_velocTol;
 	static dgVector m_linearContactError2;
@@ -60,7 +60,7 @@ void dgBroadPhaseDefault::UpdateFitness()
 void dgBroadPhaseDefault::InvalidateCache()
 {
 	ResetEntropy();
-	ImproveFitness(m_fitness, m_treeEntropy, &m_rootNode);
+	ImproveFitness(m_fitness, m_treeEntropy, &m_rootNode, 0x7fffffff);
 }
 
 void dgBroadPhaseDefault::ForEachBodyInAABB(const dgVector& minBox, const dgVector& maxBox, OnBodiesInAABB callback, void* const userData) const
@@ -148,7 +148,7 @@ void dgBroadPhaseDefault::AddNode(dgBroadPhaseNode* const newNode)
 		m_rootNode = newNode;
 	} else {
 		dgBroadPhaseTreeNode* const node = InsertNode(m_rootNode, newNode);
-		node->m_fitnessNode = m_fitness.Append(node);
+		node->m_fitnessNode = m_fitness.AddNode(node);
 		if (!node->m_parent) {
 			m_rootNode = node;
 		}
@@ -247,7 +247,7 @@ void dgBroadPhaseDefault::RemoveNode(dgBroadPhaseNode* const node)
 					body->GetBroadPhaseAggregate()->m_fitnessList.Remove(parent->m_fitnessNode);
 					body->SetBroadPhaseAggregate(NULL);
 				} else {
-					m_fitness.Remove(parent->m_fitnessNode);
+					m_fitness.RemoveNode(parent->m_fitnessNode);
 				}
 			}
 			delete parent;
@@ -344,6 +344,7 @@ void dgBroadPhaseDefault::FindCollidingPairs(dgBroadphaseSyncDescriptor* const d
 
 	dgList<dgBroadPhaseNode*>::dgListNode* node = nodePtr;
 	const dgInt32 threadCount = descriptor->m_world->GetThreadCount();
+	const bool sleepAware = descriptor->m_world->GetSleepAwareBroadphase() ? true : false;
 	while (node) {
 		dgBroadPhaseNode* const broadPhaseNode = node->GetInfo();
 		dgAssert(broadPhaseNode->IsLeafNode());
@@ -353,12 +354,28 @@ void dgBroadPhaseDefault::FindCollidingPairs(dgBroadphaseSyncDescriptor* const d
 			((dgBroadPhaseAggregate*)broadPhaseNode)->SubmitSeltPairs(timestep, threadID);
 		}
 
-		for (dgBroadPhaseNode* ptr = broadPhaseNode; ptr->m_parent; ptr = ptr->m_parent) {
-			dgBroadPhaseTreeNode* const parent = (dgBroadPhaseTreeNode*)ptr->m_parent;
-			dgAssert(!parent->IsLeafNode());
-			dgBroadPhaseNode* const sibling = parent->m_right;
-			if (sibling != ptr) {
-				SubmitPairs(broadPhaseNode, sibling, timestep, 0, threadID);
+		dgBody* const body = broadPhaseNode->GetBody();
+		if (!sleepAware) {
+			for (dgBroadPhaseNode* ptr = broadPhaseNode; ptr->m_parent; ptr = ptr->m_parent) {
+				dgBroadPhaseTreeNode* const parent = (dgBroadPhaseTreeNode*)ptr->m_parent;
+				dgAssert(!parent->IsLeafNode());
+				dgBroadPhaseNode* const sibling = parent->m_right;
+				if (sibling != ptr) {
+					SubmitPairs(broadPhaseNode, sibling, timestep, 0, threadID);
+				}
+			}
+		} else if (!body || !body->GetSleepState()) {
+			// sleeping leafs do not search the tree, so awake leafs also search 
+			// their left siblings for sleeping bodies, this way each pair is still found once.
+			for (dgBroadPhaseNode* ptr = broadPhaseNode; ptr->m_parent; ptr = ptr->m_parent) {
+				dgBroadPhaseTreeNode* const parent = (dgBroadPhaseTreeNode*)ptr->m_parent;
+				dgAssert(!parent->IsLeafNode());
+				dgBroadPhaseNode* const sibling = parent->m_right;
+				if (sibling != ptr) {
+					SubmitPairs(broadPhaseNode, sibling, timestep, 0, threadID);
+				} else {
+					SubmitSleepingPairs(broadPhaseNode, parent->m_left, timestep, threadID);
+				}
 			}
 		}
 
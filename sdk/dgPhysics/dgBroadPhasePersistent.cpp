@@ -99,7 +99,7 @@ void dgBroadPhasePersistent::Add(dgBody* const body)
 		m_staticNeedsUpdate = true;
 		if (root->m_right) {
 			dgBroadPhaseTreeNode* const node = InsertNode(root->m_right, new (m_world->GetAllocator()) dgBroadPhaseBodyNode(body));
-			node->m_fitnessNode = m_staticFitness.Append(node);
+			node->m_fitnessNode = m_staticFitness.AddNode(node);
 		} else {
 			root->m_right = new (m_world->GetAllocator()) dgBroadPhaseBodyNode(body);
 			root->m_right->m_parent = root;
@@ -108,7 +108,7 @@ void dgBroadPhasePersistent::Add(dgBody* const body)
 		dgBroadPhaseBodyNode* const newNode = new (m_world->GetAllocator()) dgBroadPhaseBodyNode(body);
 		if (root->m_left) {
 			dgBroadPhaseTreeNode* const node = InsertNode(root->m_left, newNode);
-			node->m_fitnessNode = m_dynamicsFitness.Append(node);
+			node->m_fitnessNode = m_dynamicsFitness.AddNode(node);
 		} else {
 			root->m_left = newNode;
 			root->m_left->m_parent = root;
@@ -132,7 +132,7 @@ void dgBroadPhasePersistent::LinkAggregate(dgBroadPhaseAggregate* const aggregat
 	aggregate->m_broadPhase = this;
 	if (root->m_left) {
 		dgBroadPhaseTreeNode* const node = InsertNode(root->m_left, aggregate);
-		node->m_fitnessNode = m_dynamicsFitness.Append(node);
+		node->m_fitnessNode = m_dynamicsFitness.AddNode(node);
 	} else {
 		root->m_left = aggregate;
 		root->m_left->m_parent = m_rootNode;
@@ -197,7 +197,7 @@ void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 					body->GetBroadPhaseAggregate()->m_fitnessList.Remove(parent->m_fitnessNode);
 					body->SetBroadPhaseAggregate(NULL);
 				} else {
-					m_dynamicsFitness.Remove(parent->m_fitnessNode);
+					m_dynamicsFitness.RemoveNode(parent->m_fitnessNode);
 				}
 			}
 
@@ -218,7 +218,7 @@ void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 					parent->m_right = NULL;
 					parent->m_parent = NULL;
 				}
-				m_staticFitness.Remove(parent->m_fitnessNode);
+				m_staticFitness.RemoveNode(parent->m_fitnessNode);
 				delete parent;
 			} else {
 				dgAssert (grandParent->m_left == parent);
@@ -233,7 +233,7 @@ void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 					parent->m_right = NULL;
 					parent->m_parent = NULL;
 				}
-				m_dynamicsFitness.Remove(parent->m_fitnessNode);
+				m_dynamicsFitness.RemoveNode(parent->m_fitnessNode);
 				delete parent;
 			}
 		} else {
@@ -270,16 +270,16 @@ void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 			if (body) {
 				if (body->GetInvMass().m_w == dgFloat32(0.0f)) {
 					m_staticNeedsUpdate = true;
-					m_staticFitness.Remove(parent->m_fitnessNode);
+					m_staticFitness.RemoveNode(parent->m_fitnessNode);
 				} else if (body->GetBroadPhaseAggregate()) {
 					body->GetBroadPhaseAggregate()->m_fitnessList.Remove(parent->m_fitnessNode);
 					body->SetBroadPhaseAggregate(NULL);
 				} else {
-					m_dynamicsFitness.Remove(parent->m_fitnessNode);
+					m_dynamicsFitness.RemoveNode(parent->m_fitnessNode);
 				}
 			} else {
 				dgAssert (node->IsAggregate());
-				m_dynamicsFitness.Remove(parent->m_fitnessNode);
+				m_dynamicsFitness.RemoveNode(parent->m_fitnessNode);
 			}
 
 			delete parent;
@@ -349,15 +349,15 @@ void dgBroadPhasePersistent::InvalidateCache()
 	m_staticNeedsUpdate = false;
 	dgAssert (m_rootNode->IsPersistentRoot());
 	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
-	ImproveFitness(m_staticFitness, m_staticEntropy, &root->m_right);
-	ImproveFitness(m_dynamicsFitness, m_dynamicsEntropy, &root->m_left);
+	ImproveFitness(m_staticFitness, m_staticEntropy, &root->m_right, 0x7fffffff);
+	ImproveFitness(m_dynamicsFitness, m_dynamicsEntropy, &root->m_left, 0x7fffffff);
 	root->SetBox ();
 }
 
 void dgBroadPhasePersistent::UpdateFitness()
 {
 	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
-	if (m_staticNeedsUpdate) {
+	if (m_staticNeedsUpdate || m_staticFitness.IsRebuilding()) {
 		m_staticNeedsUpdate = false;
 		ImproveFitness(m_staticFitness, m_staticEntropy, &root->m_right);
 	}
@@ -0,0 +1,259 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgPhysicsStdafx.h"
+#include "dgBody.h"
+#include "dgWorld.h"
+#include "dgBroadPhaseAggregate.h"
+#include "dgBroadPhaseSweepAndPrune.h"
+
+
+dgBroadPhaseSweepAndPrune::dgBroadPhaseSweepAndPrune(dgWorld* const world)
+	:dgBroadPhaseDefault(world)
+	,m_entries(world->GetAllocator())
+	,m_regionEntries(world->GetAllocator())
+	,m_regionStart(world->GetAllocator())
+	,m_regionCount(world->GetAllocator())
+	,m_originX(dgFloat32(0.0f))
+	,m_originZ(dgFloat32(0.0f))
+	,m_invRegionSizeX(dgFloat32(0.0f))
+	,m_invRegionSizeZ(dgFloat32(0.0f))
+	,m_entriesCount(0)
+	,m_regionsX(1)
+	,m_regionsZ(1)
+	,m_regions(1)
+	,m_regionIndex(0)
+	,m_entriesDirty(true)
+{
+}
+
+dgBroadPhaseSweepAndPrune::~dgBroadPhaseSweepAndPrune()
+{
+}
+
+dgInt32 dgBroadPhaseSweepAndPrune::GetType() const
+{
+	return dgWorld::m_sweepAndPruneBroadphase;
+}
+
+void dgBroadPhaseSweepAndPrune::Add(dgBody* const body)
+{
+	m_entriesDirty = true;
+	dgBroadPhaseDefault::Add(body);
+}
+
+void dgBroadPhaseSweepAndPrune::Remove(dgBody* const body)
+{
+	m_entriesDirty = true;
+	dgBroadPhaseDefault::Remove(body);
+}
+
+void dgBroadPhaseSweepAndPrune::DestroyAggregate(dgBroadPhaseAggregate* const aggregate)
+{
+	m_entriesDirty = true;
+	dgBroadPhaseDefault::DestroyAggregate(aggregate);
+}
+
+void dgBroadPhaseSweepAndPrune::LinkAggregate(dgBroadPhaseAggregate* const aggregate)
+{
+	m_entriesDirty = true;
+	dgBroadPhaseDefault::LinkAggregate(aggregate);
+}
+
+void dgBroadPhaseSweepAndPrune::UnlinkAggregate(dgBroadPhaseAggregate* const aggregate)
+{
+	m_entriesDirty = true;
+	dgBroadPhaseDefault::UnlinkAggregate(aggregate);
+}
+
+dgInt32 dgBroadPhaseSweepAndPrune::CompareEntries(const dgSweepEntry* const entryA, const dgSweepEntry* const entryB, void* const context)
+{
+	if (entryA->m_minX < entryB->m_minX) {
+		return -1;
+	}
+	if (entryA->m_minX > entryB->m_minX) {
+		return 1;
+	}
+	return 0;
+}
+
+void dgBroadPhaseSweepAndPrune::CalculateRegions(const dgVector& size)
+{
+	// aim for a fixed number of boxes per region, and split the regions 
+	// between the x and z axis so that the cells are close to square.
+	const dgInt32 maxRegions = DG_SWEEP_AND_PRUNE_MAX_REGIONS_SIDE * DG_SWEEP_AND_PRUNE_MAX_REGIONS_SIDE;
+	const dgInt32 regions = dgClamp (m_entriesCount / DG_SWEEP_AND_PRUNE_BOXES_PER_REGION, 1, maxRegions);
+	const dgFloat32 regionsX = dgSqrt (dgFloat32 (regions) * size.m_x / size.m_z);
+	m_regionsX = dgClamp (dgInt32 (regionsX + dgFloat32 (0.5f)), 1, DG_SWEEP_AND_PRUNE_MAX_REGIONS_SIDE);
+	m_regionsZ = dgClamp (regions / m_regionsX, 1, DG_SWEEP_AND_PRUNE_MAX_REGIONS_SIDE);
+	m_regions = m_regionsX * m_regionsZ;
+
+	m_invRegionSizeX = dgFloat32 (m_regionsX) / size.m_x;
+	m_invRegionSizeZ = dgFloat32 (m_regionsZ) / size.m_z;
+
+	m_regionStart.ResizeIfNecessary (m_regions + 1);
+	m_regionCount.ResizeIfNecessary (m_regions + 1);
+}
+
+void dgBroadPhaseSweepAndPrune::PrepareCollidingPairs()
+{
+	DG_TRACKTIME(__FUNCTION__);
+	const bool entriesDirty = m_entriesDirty;
+	if (m_entriesDirty) {
+		m_entriesDirty = false;
+		m_entriesCount = 0;
+		for (dgList<dgBroadPhaseNode*>::dgListNode* node = m_updateList.GetFirst(); node; node = node->GetNext()) {
+			m_entries[m_entriesCount].m_node = node->GetInfo();
+			m_entriesCount++;
+		}
+	}
+
+	dgSweepEntry* const entries = &m_entries[0];
+	dgVector minP (dgFloat32 ( 1.0e15f));
+	dgVector maxP (dgFloat32 (-1.0e15f));
+	for (dgInt32 i = 0; i < m_entriesCount; i++) {
+		const dgBroadPhaseNode* const node = entries[i].m_node;
+		entries[i].m_minX = node->m_minBox.m_x;
+		entries[i].m_maxX = node->m_maxBox.m_x;
+		minP = minP.GetMin(node->m_minBox);
+		maxP = maxP.GetMax(node->m_maxBox);
+	}
+
+	if (entriesDirty) {
+		dgSort(entries, m_entriesCount, CompareEntries);
+	} else {
+		// boxes move very little from one step to the next, so the array is almost sorted 
+		// and the insertion sort is close to linear time
+		for (dgInt32 i = 1; i < m_entriesCount; i++) {
+			const dgSweepEntry tmp(entries[i]);
+			dgInt32 j = i - 1;
+			for (; (j >= 0) && (CompareEntries(&entries[j], &tmp, NULL) > 0); j--) {
+				entries[j + 1] = entries[j];
+			}
+			entries[j + 1] = tmp;
+		}
+	}
+
+	const dgVector size ((maxP - minP).GetMax(dgVector (dgFloat32 (1.0e-3f))));
+	CalculateRegions (size);
+	m_originX = minP.m_x;
+	m_originZ = minP.m_z;
+
+	// a box is added to all the regions it overlaps, entries are added in sorted order 
+	// so each region is also sorted along the x axis.
+	dgInt32* const regionCount = &m_regionCount[0];
+	dgInt32* const regionStart = &m_regionStart[0];
+	memset (regionCount, 0, m_regions * sizeof (dgInt32));
+	for (dgInt32 i = 0; i < m_entriesCount; i++) {
+		const dgBroadPhaseNode* const node = entries[i].m_node;
+		const dgInt32 x0 = GetRegionX(node->m_minBox.m_x);
+		const dgInt32 x1 = GetRegionX(node->m_maxBox.m_x);
+		const dgInt32 z0 = GetRegionZ(node->m_minBox.m_z);
+		const dgInt32 z1 = GetRegionZ(node->m_maxBox.m_z);
+		for (dgInt32 z = z0; z <= z1; z++) {
+			for (dgInt32 x = x0; x <= x1; x++) {
+				regionCount[z * m_regionsX + x]++;
+			}
+		}
+	}
+
+	dgInt32 start = 0;
+	for (dgInt32 i = 0; i < m_regions; i++) {
+		regionStart[i] = start;
+		start += regionCount[i];
+		regionCount[i] = regionStart[i];
+	}
+	regionStart[m_regions] = start;
+
+	m_regionEntries.ResizeIfNecessary(start + 1);
+	dgInt32* const regionEntries = &m_regionEntries[0];
+	for (dgInt32 i = 0; i < m_entriesCount; i++) {
+		const dgBroadPhaseNode* const node = entries[i].m_node;
+		const dgInt32 x0 = GetRegionX(node->m_minBox.m_x);
+		const dgInt32 x1 = GetRegionX(node->m_maxBox.m_x);
+		const dgInt32 z0 = GetRegionZ(node->m_minBox.m_z);
+		const dgInt32 z1 = GetRegionZ(node->m_maxBox.m_z);
+		for (dgInt32 z = z0; z <= z1; z++) {
+			for (dgInt32 x = x0; x <= x1; x++) {
+				const dgInt32 region = z * m_regionsX + x;
+				regionEntries[regionCount[region]] = i;
+				regionCount[region]++;
+			}
+		}
+	}
+
+	m_regionIndex = 0;
+}
+
+void dgBroadPhaseSweepAndPrune::SweepRegion(dgInt32 region, dgFloat32 timestep, dgInt32 threadID)
+{
+	const dgSweepEntry* const entries = &m_entries[0];
+	const dgInt32* const regionEntries = &m_regionEntries[m_regionStart[region]];
+	const dgInt32 count = m_regionStart[region + 1] - m_regionStart[region];
+	const bool sleepAware = m_world->GetSleepAwareBroadphase() ? true : false;
+
+	for (dgInt32 i = 0; i < count; i++) {
+		const dgSweepEntry& entry0 = entries[regionEntries[i]];
+		dgBroadPhaseNode* const node0 = entry0.m_node;
+		const dgBody* const body0 = node0->GetBody();
+		const bool sleeping0 = sleepAware && body0 && body0->GetSleepState();
+		for (dgInt32 j = i + 1; (j < count) && (entries[regionEntries[j]].m_minX <= entry0.m_maxX); j++) {
+			dgBroadPhaseNode* const node1 = entries[regionEntries[j]].m_node;
+			if (sleeping0) {
+				// same as the default broadphase, two sleeping bodies are not paired
+				const dgBody* const body1 = node1->GetBody();
+				if (body1 && body1->GetSleepState()) {
+					continue;
+				}
+			}
+			if (dgOverlapTest(node0->m_minBox, node0->m_maxBox, node1->m_minBox, node1->m_maxBox)) {
+				// a pair can be in more than one region, only the region that contains 
+				// the lower corner of the boxes intersection reports it.
+				const dgVector p (node0->m_minBox.GetMax(node1->m_minBox));
+				if ((GetRegionZ(p.m_z) * m_regionsX + GetRegionX(p.m_x)) == region) {
+					SubmitPairs(node0, node1, timestep, 0, threadID);
+				}
+			}
+		}
+	}
+}
+
+void dgBroadPhaseSweepAndPrune::FindCollidingPairs(dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const nodePtr, dgInt32 threadID)
+{
+	DG_TRACKTIME(__FUNCTION__);
+	const dgFloat32 timestep = descriptor->m_timestep;
+
+	dgList<dgBroadPhaseNode*>::dgListNode* node = nodePtr;
+	const dgInt32 threadCount = descriptor->m_world->GetThreadCount();
+	while (node) {
+		dgBroadPhaseNode* const broadPhaseNode = node->GetInfo();
+		if (broadPhaseNode->IsAggregate()) {
+			((dgBroadPhaseAggregate*)broadPhaseNode)->SubmitSeltPairs(timestep, threadID);
+		}
+		for (dgInt32 i = 0; i < threadCount; i++) {
+			node = node ? node->GetNext() : NULL;
+		}
+	}
+
+	for (dgInt32 region = dgAtomicExchangeAndAdd(&m_regionIndex, 1); region < m_regions; region = dgAtomicExchangeAndAdd(&m_regionIndex, 1)) {
+		SweepRegion(region, timestep, threadID);
+	}
+}
@@ -0,0 +1,96 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __AFX_BROADPHASE_SWEEP_AND_PRUNE_H_
+#define __AFX_BROADPHASE_SWEEP_AND_PRUNE_H_
+
+#include "dgPhysicsStdafx.h"
+#include "dgBroadPhaseDefault.h"
+
+#define DG_SWEEP_AND_PRUNE_BOXES_PER_REGION	64
+#define DG_SWEEP_AND_PRUNE_MAX_REGIONS_SIDE		32
+
+// multi box pruning broad phase, the scene is divided in a grid of regions and the colliding pairs 
+// of each region are found by sweeping the boxes sorted along the x axis. 
+// the aabb tree of the default broad phase is still maintained and it is used for the scene queries.
+// the grid only splits x and z, the y axis is the up axis and game scenes spread over the ground plane,
+// pairs that are separated in y are still rejected by the full box test of the sweep.
+// the sort along x is a plain insertion sort, from one step to the next the entries are almost sorted
+// so it is close to a linear pass, and there is not enough work in it for a vector sort to pay off.
+class dgBroadPhaseSweepAndPrune: public dgBroadPhaseDefault
+{
+	public:
+	DG_CLASS_ALLOCATOR(allocator);
+
+	dgBroadPhaseSweepAndPrune(dgWorld* const world);
+	virtual ~dgBroadPhaseSweepAndPrune();
+
+	protected:
+	class dgSweepEntry
+	{
+		public:
+		dgBroadPhaseNode* m_node;
+		dgFloat32 m_minX;
+		dgFloat32 m_maxX;
+	};
+
+	virtual dgInt32 GetType() const;
+	virtual void Add(dgBody* const body);
+	virtual void Remove(dgBody* const body);
+	virtual void DestroyAggregate(dgBroadPhaseAggregate* const aggregate);
+	virtual void LinkAggregate (dgBroadPhaseAggregate* const aggregate); 
+	virtual void UnlinkAggregate (dgBroadPhaseAggregate* const aggregate); 
+	virtual void PrepareCollidingPairs ();
+	virtual void FindCollidingPairs (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID);
+
+	DG_INLINE dgInt32 GetRegionX (dgFloat32 x) const;
+	DG_INLINE dgInt32 GetRegionZ (dgFloat32 z) const;
+	void CalculateRegions (const dgVector& size);
+	void SweepRegion (dgInt32 region, dgFloat32 timestep, dgInt32 threadID);
+	static dgInt32 CompareEntries (const dgSweepEntry* const entryA, const dgSweepEntry* const entryB, void* const context);
+
+	dgArray<dgSweepEntry> m_entries;
+	dgArray<dgInt32> m_regionEntries;
+	dgArray<dgInt32> m_regionStart;
+	dgArray<dgInt32> m_regionCount;
+	dgFloat32 m_originX;
+	dgFloat32 m_originZ;
+	dgFloat32 m_invRegionSizeX;
+	dgFloat32 m_invRegionSizeZ;
+	dgInt32 m_entriesCount;
+	dgInt32 m_regionsX;
+	dgInt32 m_regionsZ;
+	dgInt32 m_regions;
+	dgInt32 m_regionIndex;
+	bool m_entriesDirty;
+};
+
+DG_INLINE dgInt32 dgBroadPhaseSweepAndPrune::GetRegionX (dgFloat32 x) const
+{
+	return dgClamp (dgInt32 ((x - m_originX) * m_invRegionSizeX), 0, m_regionsX - 1);
+}
+
+DG_INLINE dgInt32 dgBroadPhaseSweepAndPrune::GetRegionZ (dgFloat32 z) const
+{
+	return dgClamp (dgInt32 ((z - m_originZ) * m_invRegionSizeZ), 0, m_regionsZ - 1);
+}
+
+#endif
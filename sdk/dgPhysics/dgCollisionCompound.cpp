@@ -34,6 +34,7 @@
 //////////////////////////////////////////////////////////////////////
 
 #define DG_MAX_MIN_VOLUME				dgFloat32 (1.0e-3f)
+#define DG_COMPOUND_REBUILD_EDIT_FRACTION	4
 
 
 dgVector dgCollisionCompound::m_padding (dgFloat32 (1.0e-3f)); 
@@ -164,6 +165,9 @@ dgCollisionCompound::dgNodeBase::dgNodeBase ()
 	,m_parent(NULL)
 	,m_shape(NULL)
 	,m_myNode(NULL)
+	,m_shapeInertiaValid(0)
+	,m_flatNode(-1)
+	,m_flatSlot(-1)
 {
 }
 
@@ -179,6 +183,9 @@ dgCollisionCompound::dgNodeBase::dgNodeBase (const dgNodeBase& copyFrom)
 	,m_parent(NULL)
 	,m_shape(copyFrom.m_shape)
 	,m_myNode(NULL)
+	,m_shapeInertiaValid(0)
+	,m_flatNode(-1)
+	,m_flatSlot(-1)
 {
 	dgAssert (!copyFrom.m_shape);
 }
@@ -191,6 +198,9 @@ dgCollisionCompound::dgNodeBase::dgNodeBase (dgCollisionInstance* const instance
 	,m_parent(NULL)
 	,m_shape(new (instance->GetAllocator()) dgCollisionInstance (*instance))
 	,m_myNode(NULL)
+	,m_shapeInertiaValid(0)
+	,m_flatNode(-1)
+	,m_flatSlot(-1)
 {	
 	CalculateAABB();
 }
@@ -203,6 +213,9 @@ dgCollisionCompound::dgNodeBase::dgNodeBase (dgNodeBase* const left, dgNodeBase*
 	,m_parent(NULL)
 	,m_shape(NULL)
 	,m_myNode(NULL)
+	,m_shapeInertiaValid(0)
+	,m_flatNode(-1)
+	,m_flatSlot(-1)
 {
 	m_left->m_parent = this;
 	m_right->m_parent = this;
@@ -241,10 +254,25 @@ void dgCollisionCompound::dgNodeBase::CalculateAABB()
 {
 	dgVector p0;
 	dgVector p1;
-	m_shape->CalcAABB(m_shape->GetLocalMatrix (), p0, p1);
+	m_shapeMatrix = m_shape->GetLocalMatrix ();
+	m_shapeAlignMatrix = m_shape->GetAlignMatrix ();
+	m_shapeScale = m_shape->GetScale ();
+	m_shapeInertiaValid = 0;
+	m_shape->CalcAABB(m_shapeMatrix, p0, p1);
 	SetBox (p0, p1);
 }
 
+bool dgCollisionCompound::dgNodeBase::ShapeChanged() const
+{
+	const dgMatrix& matrix = m_shape->GetLocalMatrix ();
+	const dgMatrix& alignMatrix = m_shape->GetAlignMatrix ();
+	dgVector test (m_shapeScale == m_shape->GetScale ());
+	for (dgInt32 i = 0; i < 4; i ++) {
+		test = test & (m_shapeMatrix[i] == matrix[i]) & (m_shapeAlignMatrix[i] == alignMatrix[i]);
+	}
+	return test.GetSignMask() != 0x0f;
+}
+
 bool dgCollisionCompound::dgNodeBase::BoxTest (const dgOOBBTestData& data) const
 {
 	dgFloat32 separatingDistance = data.UpdateSeparatingDistance (data.m_aabbP0, data.m_aabbP1, m_p0, m_p1);
@@ -460,6 +488,66 @@ class dgCollisionCompound::dgSpliteInfo
 
 
 
+void dgCollisionCompound::dgFlatNode::SetEmpty ()
+{
+	for (dgInt32 i = 0; i < 4; i ++) {
+		SetEmptySlot (i);
+	}
+	m_p0 = dgVector::m_zero;
+	m_p1 = dgVector::m_zero;
+	m_area = dgFloat32 (0.0f);
+	m_parent = -1;
+	m_parentSlot = -1;
+}
+
+void dgCollisionCompound::dgFlatNode::SetEmptySlot (dgInt32 slot)
+{
+	// the box of an empty slot is so far away that it never overlaps anything
+	m_leaf[slot] = NULL;
+	m_child[slot] = -1;
+	SetSlotBox (slot, dgVector (dgFloat32 (1.0e15f)), dgVector (dgFloat32 (1.0e15f)));
+}
+
+void dgCollisionCompound::dgFlatNode::SetSlotBox (dgInt32 slot, const dgVector& p0, const dgVector& p1)
+{
+	m_minX[slot] = p0.m_x;
+	m_minY[slot] = p0.m_y;
+	m_minZ[slot] = p0.m_z;
+	m_maxX[slot] = p1.m_x;
+	m_maxY[slot] = p1.m_y;
+	m_maxZ[slot] = p1.m_z;
+}
+
+bool dgCollisionCompound::dgFlatNode::SlotBoxEqual (dgInt32 slot, const dgVector& p0, const dgVector& p1) const
+{
+	return (m_minX[slot] == p0.m_x) && (m_minY[slot] == p0.m_y) && (m_minZ[slot] == p0.m_z) && 
+		   (m_maxX[slot] == p1.m_x) && (m_maxY[slot] == p1.m_y) && (m_maxZ[slot] == p1.m_z);
+}
+
+void dgCollisionCompound::dgFlatNode::CalculateBox ()
+{
+	dgInt32 count = 0;
+	dgVector p0 (dgFloat32 (1.0e15f));
+	dgVector p1 (-dgFloat32 (1.0e15f));
+	for (dgInt32 i = 0; i < 4; i ++) {
+		if (!IsEmptySlot (i)) {
+			p0 = p0.GetMin (dgVector (m_minX[i], m_minY[i], m_minZ[i], dgFloat32 (0.0f)));
+			p1 = p1.GetMax (dgVector (m_maxX[i], m_maxY[i], m_maxZ[i], dgFloat32 (0.0f)));
+			count ++;
+		}
+	}
+	if (count) {
+		m_p0 = p0;
+		m_p1 = p1;
+	} else {
+		m_p0 = dgVector::m_zero;
+		m_p1 = dgVector::m_zero;
+	}
+	dgVector size (dgVector::m_half * (m_p1 - m_p0));
+	m_area = size.DotProduct4(size.ShiftTripleRight()).GetScalar();
+}
+
+
 dgCollisionCompound::dgCollisionCompound(dgWorld* const world)
 	:dgCollision (world->GetAllocator(), 0, m_compoundCollision) 
 	,m_boxMinRadius (dgFloat32 (0.0f))
@@ -469,6 +557,9 @@ dgCollisionCompound::dgCollisionCompound(dgWorld* const world)
 	,m_root(NULL)
 	,m_myInstance(NULL)
 	,m_array (world->GetAllocator())
+	,m_flatTree (world->GetAllocator())
+	,m_flatNodeCount(0)
+	,m_editCount(0)
 	,m_idIndex(0)
 	,m_criticalSectionLock(0)
 {
@@ -484,6 +575,9 @@ dgCollisionCompound::dgCollisionCompound (const dgCollisionCompound& source, con
 	,m_root(NULL)
 	,m_myInstance(myInstance)
 	,m_array (source.GetAllocator())
+	,m_flatTree (source.GetAllocator())
+	,m_flatNodeCount(0)
+	,m_editCount(0)
 	,m_idIndex(source.m_idIndex)
 	,m_criticalSectionLock(0)
 {
@@ -554,6 +648,7 @@ dgCollisionCompound::dgCollisionCompound (const dgCollisionCompound& source, con
 			}
 		}
 	}
+	BuildFlatTree ();
 }
 
 dgCollisionCompound::dgCollisionCompound (dgWorld* const world, dgDeserialize deserialization, void* const userData, const dgCollisionInstance* const myInstance, dgInt32 revisionNumber)
@@ -565,6 +660,9 @@ dgCollisionCompound::dgCollisionCompound (dgWorld* const world, dgDeserialize de
 	,m_root(NULL)
 	,m_myInstance(myInstance)
 	,m_array (world->GetAllocator())
+	,m_flatTree (world->GetAllocator())
+	,m_flatNodeCount(0)
+	,m_editCount(0)
 	,m_idIndex(0)
 	,m_criticalSectionLock(0)
 {
@@ -849,9 +947,15 @@ void dgCollisionCompound::MassProperties ()
 	dgVector inertiaIJ (dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
 	dgTreeArray::Iterator iter (m_array);
 	for (iter.Begin(); iter; iter ++) {
-		dgCollisionInstance* const collision = iter.GetNode()->GetInfo()->GetShape();
-		dgMatrix shapeInertia (collision->CalculateInertia());
-		dgFloat32 shapeVolume = collision->GetVolume();
+		dgNodeBase* const node = iter.GetNode()->GetInfo();
+		if (!node->m_shapeInertiaValid) {
+			dgCollisionInstance* const collision = node->GetShape();
+			node->m_shapeInertia = collision->CalculateInertia();
+			node->m_shapeVolume = collision->GetVolume();
+			node->m_shapeInertiaValid = 1;
+		}
+		const dgMatrix& shapeInertia = node->m_shapeInertia;
+		dgFloat32 shapeVolume = node->m_shapeVolume;
 
 		volume += shapeVolume;
 		origin += shapeInertia.m_posit.Scale3(shapeVolume);
@@ -998,61 +1102,24 @@ void dgCollisionCompound::EndAddRemove (bool flushCache)
 		//dgThreadHiveScopeLock lock (world, &m_criticalSectionLock);
 		dgScopeSpinLock lock(&m_criticalSectionLock);
 
+		// the trees are only optimized after the number of edits is a fraction of the shapes, 
+		// otherwise the boxes of the shapes that moved are refitted in place
+		const bool optimize = (m_treeEntropy == dgFloat64 (0.0f)) || ((m_editCount * DG_COMPOUND_REBUILD_EDIT_FRACTION) >= m_array.GetCount());
+
 		dgTreeArray::Iterator iter (m_array);
 		for (iter.Begin(); iter; iter ++) {
 			dgNodeBase* const node = iter.GetNode()->GetInfo();
-			node->CalculateAABB();
+			if (optimize) {
+				node->CalculateAABB();
+			} else if (node->ShapeChanged()) {
+				node->CalculateAABB();
+				RefitLeaf (node);
+				m_editCount ++;
+			}
 		}
 
-		dgList<dgNodeBase*> list (GetAllocator());
-		dgList<dgNodeBase*> stack (GetAllocator());
-		stack.Append(m_root);
-		while (stack.GetCount()) {
-			dgList<dgNodeBase*>::dgListNode* const stackNode = stack.GetLast();
-			dgNodeBase* const node = stackNode->GetInfo();
-			stack.Remove(stackNode);
-
-			//if (node->m_type == m_node) {
-			//	list.Append(node);
-			//}
-
-			if (node->m_type == m_node) {
-				list.Append(node);
-				stack.Append(node->m_right);
-				stack.Append(node->m_left);
-			} 
-		}
-
-		if (list.GetCount()) {
-			dgFloat64 cost = CalculateEntropy (list);
-			if ((cost > m_treeEntropy * dgFloat32 (2.0f)) || (cost < m_treeEntropy * dgFloat32 (0.5f))) {
-				dgInt32 count = list.GetCount() * 2 + 12;
-				dgInt32 leafNodesCount = 0;
-				dgStack<dgNodeBase*> leafArray(count);
-				for (dgList<dgNodeBase*>::dgListNode* listNode = list.GetFirst(); listNode; listNode = listNode->GetNext()) {
-					dgNodeBase* const node = listNode->GetInfo();
-					if (node->m_left->m_type == m_leaf) {
-						leafArray[leafNodesCount] = node->m_left;
-						leafNodesCount ++;
-					}
-					if (node->m_right->m_type == m_leaf) {
-						leafArray[leafNodesCount] = node->m_right;
-						leafNodesCount ++;
-					}
-				}
-
-				dgList<dgNodeBase*>::dgListNode* nodePtr = list.GetFirst();
-				
-				dgSortIndirect (&leafArray[0], leafNodesCount, CompareNodes); 
-				
-				m_root = BuildTopDownBig (&leafArray[0], 0, leafNodesCount - 1, &nodePtr);
-				m_treeEntropy = CalculateEntropy (list);
-			}
-			while (m_root->m_parent) {
-				m_root = m_root->m_parent;
-			}
-		} else {
-			m_treeEntropy = dgFloat32 (2.0f);
+		if (optimize) {
+			OptimizeTree ();
 		}
 
 		m_boxMinRadius = dgMin(m_root->m_size.m_x, m_root->m_size.m_y, m_root->m_size.m_z);
@@ -1068,6 +1135,63 @@ void dgCollisionCompound::EndAddRemove (bool flushCache)
 	}
 }
 
+void dgCollisionCompound::OptimizeTree ()
+{
+	dgList<dgNodeBase*> list (GetAllocator());
+	dgList<dgNodeBase*> stack (GetAllocator());
+	stack.Append(m_root);
+	while (stack.GetCount()) {
+		dgList<dgNodeBase*>::dgListNode* const stackNode = stack.GetLast();
+		dgNodeBase* const node = stackNode->GetInfo();
+		stack.Remove(stackNode);
+
+		//if (node->m_type == m_node) {
+		//	list.Append(node);
+		//}
+
+		if (node->m_type == m_node) {
+			list.Append(node);
+			stack.Append(node->m_right);
+			stack.Append(node->m_left);
+		} 
+	}
+
+	if (list.GetCount()) {
+		dgFloat64 cost = CalculateEntropy (list);
+		if ((cost > m_treeEntropy * dgFloat32 (2.0f)) || (cost < m_treeEntropy * dgFloat32 (0.5f))) {
+			dgInt32 count = list.GetCount() * 2 + 12;
+			dgInt32 leafNodesCount = 0;
+			dgStack<dgNodeBase*> leafArray(count);
+			for (dgList<dgNodeBase*>::dgListNode* listNode = list.GetFirst(); listNode; listNode = listNode->GetNext()) {
+				dgNodeBase* const node = listNode->GetInfo();
+				if (node->m_left->m_type == m_leaf) {
+					leafArray[leafNodesCount] = node->m_left;
+					leafNodesCount ++;
+				}
+				if (node->m_right->m_type == m_leaf) {
+					leafArray[leafNodesCount] = node->m_right;
+					leafNodesCount ++;
+				}
+			}
+
+			dgList<dgNodeBase*>::dgListNode* nodePtr = list.GetFirst();
+			
+			dgSortIndirect (&leafArray[0], leafNodesCount, CompareNodes); 
+			
+			m_root = BuildTopDownBig (&leafArray[0], 0, leafNodesCount - 1, &nodePtr);
+			m_treeEntropy = CalculateEntropy (list);
+		}
+		while (m_root->m_parent) {
+			m_root = m_root->m_parent;
+		}
+	} else {
+		m_treeEntropy = dgFloat32 (2.0f);
+	}
+
+	BuildFlatTree ();
+	m_editCount = 0;
+}
+
 dgTree<dgCollisionCompound::dgNodeBase*, dgInt32>::dgTreeNode* dgCollisionCompound::AddCollision (dgCollisionInstance* const shape)
 {
 	dgNodeBase* const newNode = new (m_allocator) dgNodeBase (shape);
@@ -1128,6 +1252,8 @@ dgTree<dgCollisionCompound::dgNodeBase*, dgInt32>::dgTreeNode* dgCollisionCompou
 		}
 	}
 
+	AddFlatLeaf (newNode);
+	m_editCount ++;
 	return newNode->m_myNode;
 }
 
@@ -1159,29 +1285,21 @@ void dgCollisionCompound::SetCollisionMatrix (dgTreeArray::dgTreeNode* const nod
 		instance->SetLocalMatrix(localMatrix);
 		instance->SetScale(scale);
 
-		dgVector p0;
-		dgVector p1;
-		instance->CalcAABB(instance->GetLocalMatrix (), p0, p1);
-		
 		//dgThreadHiveScopeLock lock (world, &m_criticalSectionLock);
 		dgScopeSpinLock lock(&m_criticalSectionLock);
 
-		baseNode->SetBox (p0, p1);
-		for (dgNodeBase* parent = baseNode->m_parent; parent; parent = parent->m_parent) {
-			dgVector minBox;
-			dgVector maxBox;
-			CalculateSurfaceArea (parent->m_left, parent->m_right, minBox, maxBox);
-			if (dgBoxInclusionTest (minBox, maxBox, parent->m_p0, parent->m_p1)) {
-				break;
-			}
-			parent->SetBox (minBox, maxBox);
-		}
+		baseNode->CalculateAABB ();
+		RefitLeaf (baseNode);
+		m_editCount ++;
 	}
 }
 
 
 void dgCollisionCompound::RemoveCollision (dgNodeBase* const treeNode)
 {
+	RemoveFlatLeaf (treeNode);
+	m_editCount ++;
+
 	if (!treeNode->m_parent) {
 		delete (m_root);
 		m_root = NULL;
@@ -1222,6 +1340,257 @@ void dgCollisionCompound::RemoveCollision (dgNodeBase* const treeNode)
 			root->m_right->m_parent = root;
 		}
 		delete (treeNode->m_parent);
+		RefitNode (root);
+	}
+}
+
+void dgCollisionCompound::RefitNode (dgNodeBase* const node)
+{
+	for (dgNodeBase* parent = node; parent; parent = parent->m_parent) {
+		dgVector minBox;
+		dgVector maxBox;
+		CalculateSurfaceArea (parent->m_left, parent->m_right, minBox, maxBox);
+		if ((((minBox == parent->m_p0) & (maxBox == parent->m_p1)).GetSignMask() & 0x07) == 0x07) {
+			break;
+		}
+		parent->SetBox (minBox, maxBox);
+	}
+}
+
+void dgCollisionCompound::RefitLeaf (dgNodeBase* const leaf)
+{
+	RefitNode (leaf->m_parent);
+	if (leaf->m_flatNode >= 0) {
+		m_flatTree[leaf->m_flatNode].SetSlotBox (leaf->m_flatSlot, leaf->m_p0, leaf->m_p1);
+		RefitFlatNode (leaf->m_flatNode);
+	}
+}
+
+void dgCollisionCompound::RefitFlatNode (dgInt32 index)
+{
+	while (index >= 0) {
+		dgFlatNode& node = m_flatTree[index];
+		node.CalculateBox ();
+		if (node.m_parent >= 0) {
+			dgFlatNode& parent = m_flatTree[node.m_parent];
+			if (parent.SlotBoxEqual (node.m_parentSlot, node.m_p0, node.m_p1)) {
+				break;
+			}
+			parent.SetSlotBox (node.m_parentSlot, node.m_p0, node.m_p1);
+		}
+		index = node.m_parent;
+	}
+}
+
+dgInt32 dgCollisionCompound::AddFlatNode (dgInt32 parent, dgInt32 slot)
+{
+	dgInt32 index = m_flatNodeCount;
+	m_flatNodeCount ++;
+	dgFlatNode& node = m_flatTree[index];
+	node.SetEmpty ();
+	node.m_parent = parent;
+	node.m_parentSlot = slot;
+	if (parent >= 0) {
+		dgFlatNode& parentNode = m_flatTree[parent];
+		parentNode.m_leaf[slot] = NULL;
+		parentNode.m_child[slot] = index;
+	}
+	return index;
+}
+
+void dgCollisionCompound::RemoveFlatNode (dgInt32 index)
+{
+	// the last node of the array is moved to the free location
+	m_flatNodeCount --;
+	if (index != m_flatNodeCount) {
+		dgFlatNode& node = m_flatTree[index];
+		node = m_flatTree[m_flatNodeCount];
+		m_flatTree[node.m_parent].m_child[node.m_parentSlot] = index;
+		for (dgInt32 i = 0; i < 4; i ++) {
+			if (node.m_leaf[i]) {
+				node.m_leaf[i]->m_flatNode = index;
+			} else if (node.m_child[i] >= 0) {
+				m_flatTree[node.m_child[i]].m_parent = index;
+			}
+		}
+	}
+}
+
+void dgCollisionCompound::SetFlatLeaf (dgInt32 index, dgInt32 slot, dgNodeBase* const leaf)
+{
+	dgFlatNode& node = m_flatTree[index];
+	node.m_leaf[slot] = leaf;
+	node.m_child[slot] = -1;
+	node.SetSlotBox (slot, leaf->m_p0, leaf->m_p1);
+	leaf->m_flatNode = index;
+	leaf->m_flatSlot = slot;
+}
+
+void dgCollisionCompound::BuildFlatTree ()
+{
+	m_flatNodeCount = 0;
+	if (m_root) {
+		dgNodeBase* pool[DG_COMPOUND_STACK_DEPTH];
+		dgInt32 parents[DG_COMPOUND_STACK_DEPTH];
+		dgInt32 slots[DG_COMPOUND_STACK_DEPTH];
+		pool[0] = m_root;
+		parents[0] = -1;
+		slots[0] = -1;
+		dgInt32 stack = 1;
+		while (stack) {
+			stack --;
+			const dgInt32 index = AddFlatNode (parents[stack], slots[stack]);
+
+			// open the largest node of the sub tree until there are four children, the children keep the tree order
+			dgInt32 count = 1;
+			dgNodeBase* children[4];
+			children[0] = pool[stack];
+			while (count < 4) {
+				dgInt32 open = -1;
+				dgFloat32 area = dgFloat32 (-1.0f);
+				for (dgInt32 i = 0; i < count; i ++) {
+					if ((children[i]->m_type == m_node) && (children[i]->m_area > area)) {
+						open = i;
+						area = children[i]->m_area;
+					}
+				}
+				if (open == -1) {
+					break;
+				}
+				dgNodeBase* const node = children[open];
+				for (dgInt32 i = count; i > (open + 1); i --) {
+					children[i] = children[i - 1];
+				}
+				children[open] = node->m_left;
+				children[open + 1] = node->m_right;
+				count ++;
+			}
+
+			for (dgInt32 i = 0; i < count; i ++) {
+				if (children[i]->m_type == m_leaf) {
+					SetFlatLeaf (index, i, children[i]);
+				} else {
+					pool[stack] = children[i];
+					parents[stack] = index;
+					slots[stack] = i;
+					stack ++;
+					dgAssert (stack < DG_COMPOUND_STACK_DEPTH);
+				}
+			}
+		}
+
+		// children are always after their parent in the array
+		for (dgInt32 i = m_flatNodeCount - 1; i >= 0; i --) {
+			dgFlatNode& node = m_flatTree[i];
+			node.CalculateBox ();
+			if (node.m_parent >= 0) {
+				m_flatTree[node.m_parent].SetSlotBox (node.m_parentSlot, node.m_p0, node.m_p1);
+			}
+		}
+	}
+}
+
+void dgCollisionCompound::AddFlatLeaf (dgNodeBase* const leaf)
+{
+	if (!m_flatNodeCount) {
+		const dgInt32 index = AddFlatNode (-1, -1);
+		SetFlatLeaf (index, 0, leaf);
+		RefitFlatNode (index);
+		return;
+	}
+
+	dgInt32 index = 0;
+	for (dgInt32 depth = 0; ; depth ++) {
+		const dgFlatNode& node = m_flatTree[index];
+
+		// take the first empty slot, or the child that grows the least
+		dgInt32 slot = -1;
+		dgFloat32 minCost = dgFloat32 (1.0e20f);
+		for (dgInt32 i = 0; i < 4; i ++) {
+			if (node.IsEmptySlot (i)) {
+				SetFlatLeaf (index, i, leaf);
+				RefitFlatNode (index);
+				return;
+			}
+			dgVector p0 (node.m_minX[i], node.m_minY[i], node.m_minZ[i], dgFloat32 (0.0f));
+			dgVector p1 (node.m_maxX[i], node.m_maxY[i], node.m_maxZ[i], dgFloat32 (0.0f));
+			dgVector size0 (dgVector::m_half * (p1 - p0));
+			dgVector size1 (dgVector::m_half * (p1.GetMax (leaf->m_p1) - p0.GetMin (leaf->m_p0)));
+			dgFloat32 cost = size1.DotProduct4(size1.ShiftTripleRight()).GetScalar() - size0.DotProduct4(size0.ShiftTripleRight()).GetScalar();
+			if (cost < minCost) {
+				slot = i;
+				minCost = cost;
+			}
+		}
+		dgAssert (slot >= 0);
+
+		if (node.m_child[slot] >= 0) {
+			index = node.m_child[slot];
+		} else if (depth >= DG_COMPOUND_FLAT_TREE_MAX_DEPTH) {
+			// the tree is too deep for the contact stacks, make it again from the binary tree
+			// and let the next update optimized both trees
+			m_editCount = m_array.GetCount();
+			BuildFlatTree ();
+			return;
+		} else {
+			dgNodeBase* const sibling = node.m_leaf[slot];
+			const dgInt32 child = AddFlatNode (index, slot);
+			SetFlatLeaf (child, 0, sibling);
+			SetFlatLeaf (child, 1, leaf);
+			RefitFlatNode (child);
+			return;
+		}
+	}
+}
+
+void dgCollisionCompound::RemoveFlatLeaf (dgNodeBase* const leaf)
+{
+	dgInt32 index = leaf->m_flatNode;
+	if (index >= 0) {
+		m_flatTree[index].SetEmptySlot (leaf->m_flatSlot);
+		leaf->m_flatNode = -1;
+		leaf->m_flatSlot = -1;
+		while (1) {
+			const dgFlatNode& node = m_flatTree[index];
+			dgInt32 count = 0;
+			dgInt32 lastSlot = -1;
+			for (dgInt32 i = 0; i < 4; i ++) {
+				if (!node.IsEmptySlot (i)) {
+					lastSlot = i;
+					count ++;
+				}
+			}
+
+			if (node.m_parent < 0) {
+				if (count) {
+					RefitFlatNode (index);
+				} else {
+					m_flatNodeCount = 0;
+				}
+				break;
+			}
+
+			if ((count > 1) || (count && (node.m_child[lastSlot] >= 0))) {
+				RefitFlatNode (index);
+				break;
+			}
+
+			// an empty node is removed, and a node with only one leaf is replaced by the leaf
+			dgInt32 parent = node.m_parent;
+			const dgInt32 parentSlot = node.m_parentSlot;
+			dgNodeBase* const lastLeaf = count ? node.m_leaf[lastSlot] : NULL;
+			m_flatTree[parent].SetEmptySlot (parentSlot);
+			if (parent == (m_flatNodeCount - 1)) {
+				parent = index;
+			}
+			RemoveFlatNode (index);
+			if (lastLeaf) {
+				SetFlatLeaf (parent, parentSlot, lastLeaf);
+				RefitFlatNode (parent);
+				break;
+			}
+			index = parent;
+		}
 	}
 }
 
@@ -1543,8 +1912,7 @@ dgInt32 dgCollisionCompound::CalculateContacts (dgBroadPhase::dgPair* const pair
 			} else if (body1->m_collision->IsType (dgCollision::dgCollisionBVH_RTTI)) {
 				contactCount = CalculateContactsToCollisionTreeContinue (pair, proxy);
 			} else if (body1->m_collision->IsType (dgCollision::dgCollisionHeightField_RTTI)) {
-				dgAssert (0);
-//				contactCount = CalculateContactsToHeightField (pair, proxy);
+				contactCount = CalculateContactsToHeightFieldContinue (pair, proxy);
 			} else {
 				dgAssert (0);
 				dgAssert (body1->m_collision->IsType (dgCollision::dgCollisionUserMesh_RTTI));
@@ -1759,7 +2127,7 @@ dgInt32 dgCollisionCompound::ClosestDistanceToCompound (dgCollisionParamProxy& p
 dgInt32 dgCollisionCompound::CalculateContactsToCompound (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const
 {
 	dgContactPoint* const contacts = proxy.m_contacts;
-	const dgNodeBase* stackPool[4 * DG_COMPOUND_STACK_DEPTH][2];
+	dgInt32 stackPool[4 * DG_COMPOUND_STACK_DEPTH][2];
 
 	dgInt32 contactCount = 0;
 	dgContact* const contactJoint = pair->m_contact;
@@ -1780,9 +2148,12 @@ dgInt32 dgCollisionCompound::CalculateContactsToCompound (dgBroadPhase::dgPair*
 	const dgMatrix& otherMatrix = otherCompoundInstance->GetGlobalMatrix();
 	dgOOBBTestData data (otherMatrix * myMatrix.Inverse());
 
-	dgInt32 stack = 1;
-	stackPool[0][0] = m_root;
-	stackPool[0][1] = otherCompound->m_root;
+	// nodes of the flat trees are pushed by index, and leafs by the negative index of their slot 
+	const dgFlatNode* const myTree = m_flatNodeCount ? &m_flatTree[0] : NULL;
+	const dgFlatNode* const otherTree = otherCompound->m_flatNodeCount ? &otherCompound->m_flatTree[0] : NULL;
+	dgInt32 stack = (myTree && otherTree) ? 1 : 0;
+	stackPool[0][0] = 0;
+	stackPool[0][1] = 0;
 	const dgContactMaterial* const material = contactJoint->GetMaterial();
 
 	dgAssert ((contacts != NULL) ^ proxy.m_intersectionTestOnly);
@@ -1791,14 +2162,13 @@ dgInt32 dgCollisionCompound::CalculateContactsToCompound (dgBroadPhase::dgPair*
 	dgFloat32 closestDist = dgFloat32 (1.0e10f);
 	while (stack) {
 		stack --;
-		const dgNodeBase* const me = stackPool[stack][0];
-		const dgNodeBase* const other = stackPool[stack][1];
-
-		dgAssert (me && other);
-
-		if (me->BoxTest (data, other)) {
+		const dgInt32 myEntry = stackPool[stack][0];
+		const dgInt32 otherEntry = stackPool[stack][1];
+		const dgNodeBase* const me = (myEntry < 0) ? myTree[(-myEntry - 1) >> 2].m_leaf[(-myEntry - 1) & 3] : NULL;
+		const dgNodeBase* const other = (otherEntry < 0) ? otherTree[(-otherEntry - 1) >> 2].m_leaf[(-otherEntry - 1) & 3] : NULL;
 
-			if ((me->m_type == m_leaf) && (other->m_type == m_leaf)) {
+		if (me && other) {
+			if (me->BoxTest (data, other)) {
 				bool processContacts = true;
 				if (material->m_compoundAABBOverlap) {
 					processContacts = material->m_compoundAABBOverlap (*contactJoint, timestep, myBody, me->m_myNode, otherBody, other->m_myNode, proxy.m_threadIndex);
@@ -1831,7 +2201,7 @@ dgInt32 dgCollisionCompound::CalculateContactsToCompound (dgBroadPhase::dgPair*
 							}
 							contactCount += count;
 							if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 							}
 						} else if (count == -1) {
 							contactCount = -1;
@@ -1844,57 +2214,36 @@ dgInt32 dgCollisionCompound::CalculateContactsToCompound (dgBroadPhase::dgPair*
 						proxy.m_instance1 = NULL; 
 					}
 				}
-
-			} else if (me->m_type == m_leaf) {
-				dgAssert (other->m_type == m_node);
-
-				stackPool[stack][0] = me;
-				stackPool[stack][1] = other->m_left;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
-				stackPool[stack][0] = me;
-				stackPool[stack][1] = other->m_right;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
-
-			} else if (other->m_type == m_leaf) {
-				dgAssert (me->m_type == m_node);
-
-				stackPool[stack][0] = me->m_left;
-				stackPool[stack][1] = other;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
-				stackPool[stack][0] = me->m_right;
-				stackPool[stack][1] = other;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-			} else {
-				dgAssert (me->m_type == m_node);
-				dgAssert (other->m_type == m_node);
-
-				stackPool[stack][0] = me->m_left;
-				stackPool[stack][1] = other->m_left;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
-				stackPool[stack][0] = me->m_left;
-				stackPool[stack][1] = other->m_right;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
-				stackPool[stack][0] = me->m_right;
-				stackPool[stack][1] = other->m_left;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
-				stackPool[stack][0] = me->m_right;
-				stackPool[stack][1] = other->m_right;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
+			}
+		} else if (!me && (other || (myTree[myEntry].m_area > otherTree[otherEntry].m_area))) {
+			// open my node, the box of the other node is moved to my space
+			const dgFlatNode& node = myTree[myEntry];
+			const dgVector& p0 = other ? other->m_p0 : otherTree[otherEntry].m_p0;
+			const dgVector& p1 = other ? other->m_p1 : otherTree[otherEntry].m_p1;
+			dgVector origin (data.m_matrix.TransformVector(dgVector::m_half * (p1 + p0)));
+			dgVector size (data.m_absMatrix.RotateVector(dgVector::m_half * (p1 - p0)) + m_padding);
+			const dgInt32 mask = node.BoxTest (origin - size, origin + size);
+			for (dgInt32 i = 0; i < 4; i ++) {
+				if (mask & (1 << i)) {
+					stackPool[stack][0] = (node.m_child[i] >= 0) ? node.m_child[i] : -(myEntry * 4 + i) - 1;
+					stackPool[stack][1] = otherEntry;
+					stack++;
+					dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (stackPool[0])));
+				}
+			}
+		} else {
+			// open the other node, its children boxes are moved to my space
+			const dgFlatNode& node = otherTree[otherEntry];
+			const dgVector& p0 = me ? me->m_p0 : myTree[myEntry].m_p0;
+			const dgVector& p1 = me ? me->m_p1 : myTree[myEntry].m_p1;
+			const dgInt32 mask = node.BoxTest (data, p0, p1);
+			for (dgInt32 i = 0; i < 4; i ++) {
+				if (mask & (1 << i)) {
+					stackPool[stack][0] = myEntry;
+					stackPool[stack][1] = (node.m_child[i] >= 0) ? node.m_child[i] : -(otherEntry * 4 + i) - 1;
+					stack++;
+					dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (stackPool[0])));
+				}
 			}
 		}
 	}
@@ -1986,7 +2335,7 @@ dgInt32 dgCollisionCompound::CalculateContactsToHeightField (dgBroadPhase::dgPai
 							contactCount += count;
 
 							if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 							}
 						} else if (count == -1) {
 							contactCount = -1;
@@ -2088,7 +2437,7 @@ dgInt32 dgCollisionCompound::CalculateContactsUserDefinedCollision (dgBroadPhase
 							contactCount += count;
 
 							if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 							}
 						} else if (count == -1) {
 							contactCount = -1;
@@ -2119,7 +2468,7 @@ dgInt32 dgCollisionCompound::CalculateContactsUserDefinedCollision (dgBroadPhase
 dgInt32 dgCollisionCompound::CalculateContactsToSingle (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const
 {
 	dgContactPoint* const contacts = proxy.m_contacts;
-	const dgNodeBase* stackPool[DG_COMPOUND_STACK_DEPTH];
+	dgInt32 stackPool[DG_COMPOUND_STACK_DEPTH];
 
 	dgContact* const contactJoint = pair->m_contact;
 
@@ -2146,8 +2495,10 @@ dgInt32 dgCollisionCompound::CalculateContactsToSingle (dgBroadPhase::dgPair* co
 	otherInstance->CalcObb (origin, size);
 	dgOOBBTestData data (matrix, origin, size);
 
-	dgInt32 stack = 1;
-	stackPool[0] = m_root;
+	// nodes of the flat tree are pushed by index, and leafs by the negative index of their slot 
+	const dgFlatNode* const flatTree = m_flatNodeCount ? &m_flatTree[0] : NULL;
+	dgInt32 stack = m_flatNodeCount ? 1 : 0;
+	stackPool[0] = 0;
 	const dgContactMaterial* const material = contactJoint->GetMaterial();
 
 	dgAssert ((contacts != NULL) ^ proxy.m_intersectionTestOnly);
@@ -2156,11 +2507,21 @@ dgInt32 dgCollisionCompound::CalculateContactsToSingle (dgBroadPhase::dgPair* co
 	dgFloat32 closestDist = dgFloat32 (1.0e10f);
 	while (stack) {
 		stack --;
-		const dgNodeBase* const me = stackPool[stack];
-		dgAssert (me);
-
-		if (me->BoxTest (data)) {
-			if (me->m_type == m_leaf) {
+		const dgInt32 entry = stackPool[stack];
+		if (entry >= 0) {
+			const dgFlatNode& node = flatTree[entry];
+			const dgInt32 mask = node.BoxTest (data);
+			for (dgInt32 i = 0; i < 4; i ++) {
+				if (mask & (1 << i)) {
+					stackPool[stack] = (node.m_child[i] >= 0) ? node.m_child[i] : -(entry * 4 + i) - 1;
+					stack++;
+					dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (stackPool[0])));
+				}
+			}
+		} else {
+			const dgNodeBase* const me = flatTree[(-entry - 1) >> 2].m_leaf[(-entry - 1) & 3];
+			dgAssert (me && (me->m_type == m_leaf));
+			if (me->BoxTest (data)) {
 				dgCollisionInstance* const subShape = me->GetShape();
 				if (subShape->GetCollisionMode()) {
 					bool processContacts = true;
@@ -2184,7 +2545,7 @@ dgInt32 dgCollisionCompound::CalculateContactsToSingle (dgBroadPhase::dgPair* co
 							}
 							contactCount += count;
 							if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 							}
 						} else if (count == -1) {
 							contactCount = -1;
@@ -2194,16 +2555,6 @@ dgInt32 dgCollisionCompound::CalculateContactsToSingle (dgBroadPhase::dgPair* co
 						proxy.m_instance0 = NULL;
 					}
 				}
-
-			} else {
-				dgAssert (me->m_type == m_node);
-				stackPool[stack] = me->m_left;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
-
-				stackPool[stack] = me->m_right;
-				stack++;
-				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
 			}
 		}
 	}
@@ -2305,7 +2656,7 @@ dgInt32 dgCollisionCompound::CalculateContactsToCollisionTree (dgBroadPhase::dgP
 							}
 							contactCount += count;
 							if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+								contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 							}
 						} else if (count == -1) {
 							contactCount = -1;
@@ -2554,7 +2905,7 @@ dgInt32 dgCollisionCompound::CalculateContactsToSingleContinue(dgBroadPhase::dgP
 								contactCount += count;
 
 								if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-									contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+									contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 								}
 
 								if (maxParam == dgFloat32 (0.0f)) {
@@ -2707,7 +3058,7 @@ dgInt32 dgCollisionCompound::CalculateContactsToCompoundContinue(dgBroadPhase::d
 								contactCount += count;
 
 								if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-									contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+									contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 								}
 
 								if (maxParam == dgFloat32 (0.0f)) {
@@ -2815,9 +3166,9 @@ dgInt32 dgCollisionCompound::CalculateContactsToCollisionTreeContinue (dgBroadPh
 	const dgMatrix& otherMatrix = treeCollisionInstance->GetGlobalMatrix();
 	dgOOBBTestData data (otherMatrix * myMatrix.Inverse());
 
-	dgVector relVeloc (myMatrix.UnrotateVector (treeBody->GetVelocity() - myBody->GetVelocity()));
-	dgFastRayTest myCompoundRay (dgVector (dgFloat32 (0.0f)), relVeloc);
-	dgFastRayTest otherTreedRay (dgVector (dgFloat32 (0.0f)), data.m_matrix.UnrotateVector(relVeloc));
+	dgVector relStep (myMatrix.UnrotateVector (treeBody->GetVelocity() - myBody->GetVelocity()).Scale4 (proxy.m_timestep));
+	dgFastRayTest myCompoundRay (dgVector (dgFloat32 (0.0f)), relStep);
+	dgFastRayTest otherTreedRay (dgVector (dgFloat32 (0.0f)), data.m_matrix.UnrotateVector(relStep));
 
 	dgInt32 stack = 1;
 	stackPool[0].m_myNode = m_root;
@@ -2918,7 +3269,7 @@ dgInt32 dgCollisionCompound::CalculateContactsToCollisionTreeContinue (dgBroadPh
 								contactCount += count;
 
 								if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-									contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance());
+									contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
 								}
 
 								if (maxParam == dgFloat32 (0.0f)) {
@@ -3066,3 +3417,159 @@ dgInt32 dgCollisionCompound::CalculateContactsToCollisionTreeContinue (dgBroadPh
 	proxy.m_contacts = contacts;	
 	return contactCount;
 }
+
+dgInt32 dgCollisionCompound::CalculateContactsToHeightFieldContinue (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const
+{
+	if (proxy.m_timestep < dgFloat32 (1.0e-4f)) {
+		return 0;
+	}
+
+	dgContactPoint* const contacts = proxy.m_contacts;
+
+	const dgNodeBase* stackPool[DG_COMPOUND_STACK_DEPTH];
+
+	dgInt32 contactCount = 0;
+	dgContact* const contactJoint = pair->m_contact;
+	dgBody* const myBody = contactJoint->GetBody0();
+	dgBody* const terrainBody = contactJoint->GetBody1();
+
+	dgCollisionInstance* const compoundInstance = myBody->m_collision;
+	dgCollisionInstance* const terrainInstance = terrainBody->m_collision;
+
+	dgAssert (compoundInstance->GetChildShape() == this);
+	dgAssert (terrainInstance->IsType (dgCollision::dgCollisionHeightField_RTTI));
+	dgCollisionHeightField* const terrainCollision = (dgCollisionHeightField*)terrainInstance->GetChildShape();
+
+	proxy.m_body0 = myBody;
+	proxy.m_body1 = terrainBody;
+	proxy.m_instance1 = terrainInstance;
+
+	const dgMatrix& myMatrix = compoundInstance->GetGlobalMatrix();
+	dgOOBBTestData data (terrainInstance->GetGlobalMatrix() * myMatrix.Inverse());
+
+	// the rays are the relative displacement over the step, so that the ray parameter is the fraction of the step
+	dgVector relStep (myMatrix.UnrotateVector (terrainBody->GetVelocity() - myBody->GetVelocity()).Scale4 (proxy.m_timestep));
+	dgVector terrainStep (data.m_matrix.UnrotateVector(relStep));
+	dgFastRayTest myCompoundRay (dgVector (dgFloat32 (0.0f)), relStep);
+	dgFastRayTest otherTerrainRay (dgVector (dgFloat32 (0.0f)), terrainStep);
+
+	// displacement of the compound in the terrain space, used to get the elevation bounds of the swept node
+	dgVector sweep0 ((dgVector (dgFloat32 (0.0f)) - terrainStep).GetMin(dgVector (dgFloat32 (0.0f))) & dgVector::m_triplexMask);
+	dgVector sweep1 ((dgVector (dgFloat32 (0.0f)) - terrainStep).GetMax(dgVector (dgFloat32 (0.0f))) & dgVector::m_triplexMask);
+
+	dgInt32 stack = 1;
+	stackPool[0] = m_root;
+
+	dgNodeBase nodeProxi;
+	nodeProxi.m_left = NULL;
+	nodeProxi.m_right = NULL;
+	const dgContactMaterial* const material = contactJoint->GetMaterial();
+
+	dgVector n (dgFloat32 (0.0f), dgFloat32 (1.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
+	dgVector p (dgFloat32 (0.0f));
+	dgVector q (dgFloat32 (0.0f));
+
+	dgFloat32 maxParam = proxy.m_timestep;
+	dgFloat32 invMaxParam = dgFloat32 (1.0f) / maxParam; 
+	dgFloat32 upperBound = dgFloat32 (1.0f);
+
+	dgFloat32 timestep = pair->m_timestep;
+	dgFloat32 closestDist = dgFloat32 (1.0e10f);
+	while (stack) {
+		stack --;
+		const dgNodeBase* const me = stackPool[stack];
+
+		dgVector origin (data.m_matrix.UntransformVector(me->m_origin));
+		dgVector size (data.m_absMatrix.UnrotateVector(me->m_size));
+		dgVector p0 (origin - size + sweep0);
+		dgVector p1 (origin + size + sweep1);
+		terrainCollision->GetLocalAABB (p0, p1, nodeProxi.m_p0, nodeProxi.m_p1);
+		nodeProxi.m_size = dgVector::m_half * (nodeProxi.m_p1 - nodeProxi.m_p0);
+		nodeProxi.m_origin = dgVector::m_half * (nodeProxi.m_p1 + nodeProxi.m_p0);
+
+		dgFloat32 dist = me->RayBoxDistance (data, myCompoundRay, otherTerrainRay, &nodeProxi);
+		if (dist <= upperBound) {
+			if (me->m_type == m_leaf) {
+				dgCollisionInstance* const subShape = me->GetShape();
+				if (subShape->GetCollisionMode()) {
+					bool processContacts = true;
+					if (material->m_compoundAABBOverlap) {
+						processContacts = material->m_compoundAABBOverlap (*contactJoint, timestep, myBody, me->m_myNode, terrainBody, NULL, proxy.m_threadIndex);
+					}
+					if (processContacts) {
+						dgCollisionInstance childInstance (*subShape, subShape->GetChildShape());
+						childInstance.m_globalMatrix = childInstance.GetLocalMatrix() * myMatrix;
+						proxy.m_instance0 = &childInstance; 
+
+						proxy.m_maxContacts = DG_MAX_CONTATCS - contactCount;
+						proxy.m_contacts = contacts ? &contacts[contactCount] : contacts;
+
+						dgInt32 count = m_world->CalculateConvexToNonConvexContacts (proxy);
+						closestDist = dgMin(closestDist, contactJoint->m_closestDistance);
+
+						dgFloat32 param = proxy.m_timestep;
+						dgAssert (param >= dgFloat32 (0.0f));
+						if (param < maxParam) {
+							n = proxy.m_normal;
+							p = proxy.m_closestPointBody0;
+							q = proxy.m_closestPointBody1;
+
+							upperBound = param * invMaxParam;
+							if (proxy.m_intersectionTestOnly) {
+								maxParam = param;
+								if (count == -1) {
+									contactCount = -1;
+									break;
+								}
+							} else {
+								// a child hit earlier than the contacts collected so far, those are discarded 
+								if (contactCount && ((param - maxParam) * invMaxParam) < dgFloat32(-1.0e-3f)) {
+									for (dgInt32 i = 0; i < count; i ++) {
+										contacts[i] = contacts[contactCount + i];
+									}
+									contactCount = 0;
+								}
+								maxParam = param;
+
+								for (dgInt32 i = 0; i < count; i ++) {
+									dgAssert (contacts[contactCount + i].m_collision0 == &childInstance);
+									contacts[contactCount + i].m_collision0 = subShape;
+								}
+								contactCount += count;
+
+								if (contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
+									contactCount = m_world->ReduceContacts (contactCount, contacts, DG_CONSTRAINT_MAX_ROWS / 3);
+								}
+
+								if (maxParam == dgFloat32 (0.0f)) {
+									break;
+								}
+							}
+						}
+						childInstance.m_material.m_userData = NULL;
+						proxy.m_instance0 = NULL;
+					}
+				}
+
+			} else {
+				dgAssert (me->m_type == m_node);
+				stackPool[stack] = me->m_left;
+				stack++;
+				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
+
+				stackPool[stack] = me->m_right;
+				stack++;
+				dgAssert (stack < dgInt32 (sizeof (stackPool) / sizeof (dgNodeBase*)));
+			}
+		}
+	}
+
+	proxy.m_normal = n;
+	proxy.m_closestPointBody0 = p;
+	proxy.m_closestPointBody1 = q;
+	proxy.m_timestep = maxParam;
+
+	contactJoint->m_closestDistance = closestDist;
+	proxy.m_contacts = contacts;	
+	return contactCount;
+}
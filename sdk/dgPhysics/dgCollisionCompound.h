@@ -31,6 +31,7 @@ class dgCollisionInstance;
 
 
 #define DG_COMPOUND_STACK_DEPTH	256
+#define DG_COMPOUND_FLAT_TREE_MAX_DEPTH	48
 
 class dgCollisionCompound: public dgCollision
 {
@@ -91,6 +92,7 @@ class dgCollisionCompound: public dgCollision
 		~dgNodeBase();
 
 		void CalculateAABB();
+		bool ShapeChanged() const;
 		void SetBox (const dgVector& p0, const dgVector& p1);
 		bool BoxTest (const dgOOBBTestData& data) const;
 		bool BoxTest (const dgOOBBTestData& data, const dgNodeBase* const otherNode) const;
@@ -119,6 +121,53 @@ class dgCollisionCompound: public dgCollision
 		dgNodeBase* m_parent;
 		dgCollisionInstance* m_shape;
 		dgTreeArray::dgTreeNode* m_myNode; 
+
+		// state of the shape when the leaf box was calculated, and its inertia and volume
+		dgMatrix m_shapeMatrix;
+		dgMatrix m_shapeAlignMatrix;
+		dgMatrix m_shapeInertia;
+		dgVector m_shapeScale;
+		dgFloat32 m_shapeVolume;
+		dgInt32 m_shapeInertiaValid;
+		dgInt32 m_flatNode;
+		dgInt32 m_flatSlot;
+	} DG_GCC_VECTOR_ALIGMENT;
+
+	// four wide node of the tree used for calculating contacts, the boxes of the children 
+	// are stored by axis so that they can be tested against a box all at once.
+	// a child is a leaf, another node of the array, or an empty slot.
+	DG_MSC_VECTOR_ALIGMENT
+	class dgFlatNode
+	{
+		public:
+		void SetEmpty ();
+		void SetEmptySlot (dgInt32 slot);
+		void SetSlotBox (dgInt32 slot, const dgVector& p0, const dgVector& p1);
+		bool SlotBoxEqual (dgInt32 slot, const dgVector& p0, const dgVector& p1) const;
+		void CalculateBox ();
+
+		DG_INLINE bool IsEmptySlot (dgInt32 slot) const
+		{
+			return !m_leaf[slot] && (m_child[slot] < 0);
+		}
+
+		DG_INLINE dgInt32 BoxTest (const dgVector& p0, const dgVector& p1) const;
+		DG_INLINE dgInt32 BoxTest (const dgOOBBTestData& data) const;
+		DG_INLINE dgInt32 BoxTest (const dgOOBBTestData& data, const dgVector& p0, const dgVector& p1) const;
+
+		dgVector m_minX;
+		dgVector m_minY;
+		dgVector m_minZ;
+		dgVector m_maxX;
+		dgVector m_maxY;
+		dgVector m_maxZ;
+		dgVector m_p0;
+		dgVector m_p1;
+		dgFloat32 m_area;
+		dgNodeBase* m_leaf[4];
+		dgInt32 m_child[4];
+		dgInt32 m_parent;
+		dgInt32 m_parentSlot;
 	} DG_GCC_VECTOR_ALIGMENT;
 
 	protected:
@@ -192,6 +241,7 @@ class dgCollisionCompound: public dgCollision
 	dgInt32 CalculateContactsToCollisionTree (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculateContactsToCollisionTreeContinue (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculateContactsToHeightField (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const;
+	dgInt32 CalculateContactsToHeightFieldContinue (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculateContactsUserDefinedCollision (dgBroadPhase::dgPair* const pair, dgCollisionParamProxy& proxy) const;
 	dgInt32 ClosestDistance (dgCollisionParamProxy& proxy) const;
 	dgInt32 ClosestDistanceToConvex (dgCollisionParamProxy& proxy) const;
@@ -209,6 +259,17 @@ class dgCollisionCompound: public dgCollision
 	void ImproveNodeFitness (dgNodeBase* const node) const;
 	dgFloat32 CalculateSurfaceArea (dgNodeBase* const node0, dgNodeBase* const node1, dgVector& minBox, dgVector& maxBox) const;
 
+	void OptimizeTree ();
+	void RefitNode (dgNodeBase* const node);
+	void RefitLeaf (dgNodeBase* const leaf);
+	void BuildFlatTree ();
+	dgInt32 AddFlatNode (dgInt32 parent, dgInt32 slot);
+	void RemoveFlatNode (dgInt32 node);
+	void SetFlatLeaf (dgInt32 node, dgInt32 slot, dgNodeBase* const leaf);
+	void AddFlatLeaf (dgNodeBase* const leaf);
+	void RemoveFlatLeaf (dgNodeBase* const leaf);
+	void RefitFlatNode (dgInt32 node);
+
 	dgInt32 CalculatePlaneIntersection (const dgVector& normal, const dgVector& point, dgVector* const contactsOut) const;
 
 	void PushNode (const dgMatrix& matrix, dgUpHeap<dgHeapNodePair, dgFloat32>& heap, dgNodeBase* const myNode, dgNodeBase* const otehrNode) const;
@@ -223,6 +284,9 @@ class dgCollisionCompound: public dgCollision
 	dgNodeBase* m_root;
 	const dgCollisionInstance* m_myInstance;
 	dgTreeArray m_array;
+	dgArray<dgFlatNode> m_flatTree;
+	dgInt32 m_flatNodeCount;
+	dgInt32 m_editCount;
 	dgInt32 m_idIndex;
 	dgInt32 m_criticalSectionLock;
 
@@ -244,6 +308,71 @@ DG_INLINE dgFloat32 dgCollisionCompound::dgOOBBTestData::UpdateSeparatingDistanc
 	return dist.GetScalar();
 }
 
+// same test as dgOverlapTest done on the four children at once, returns a bit for each overlapping child
+DG_INLINE dgInt32 dgCollisionCompound::dgFlatNode::BoxTest (const dgVector& p0, const dgVector& p1) const
+{
+	dgVector testX ((dgVector (p0.m_x) - m_maxX) * (dgVector (p1.m_x) - m_minX));
+	dgVector testY ((dgVector (p0.m_y) - m_maxY) * (dgVector (p1.m_y) - m_minY));
+	dgVector testZ ((dgVector (p0.m_z) - m_maxZ) * (dgVector (p1.m_z) - m_minZ));
+	return (testX & testY & testZ).GetSignMask();
+}
+
+// test the children boxes against the box of a convex shape, and then in the space of the shape against its obb
+DG_INLINE dgInt32 dgCollisionCompound::dgFlatNode::BoxTest (const dgOOBBTestData& data) const
+{
+	dgInt32 mask = BoxTest (data.m_aabbP0, data.m_aabbP1);
+	if (mask) {
+		const dgMatrix& matrix = data.m_matrix;
+		const dgMatrix& absMatrix = data.m_absMatrix;
+		dgVector originX (dgVector::m_half * (m_maxX + m_minX) - dgVector (matrix.m_posit.m_x));
+		dgVector originY (dgVector::m_half * (m_maxY + m_minY) - dgVector (matrix.m_posit.m_y));
+		dgVector originZ (dgVector::m_half * (m_maxZ + m_minZ) - dgVector (matrix.m_posit.m_z));
+		dgVector sizeX (dgVector::m_half * (m_maxX - m_minX) + m_padding);
+		dgVector sizeY (dgVector::m_half * (m_maxY - m_minY) + m_padding);
+		dgVector sizeZ (dgVector::m_half * (m_maxZ - m_minZ) + m_padding);
+
+		dgVector test (dgVector::m_negOne);
+		for (dgInt32 i = 0; i < 3; i ++) {
+			const dgVector& axis = matrix[i];
+			const dgVector& absAxis = absMatrix[i];
+			dgVector origin (originX * dgVector (axis.m_x) + originY * dgVector (axis.m_y) + originZ * dgVector (axis.m_z));
+			dgVector size (sizeX * dgVector (absAxis.m_x) + sizeY * dgVector (absAxis.m_y) + sizeZ * dgVector (absAxis.m_z));
+			test = test & ((origin - size - dgVector (data.m_localP1[i])) * (origin + size - dgVector (data.m_localP0[i])));
+		}
+		mask &= test.GetSignMask();
+	}
+	return mask;
+}
+
+// move the children boxes to the space of the other compound and test them against a box in that space
+DG_INLINE dgInt32 dgCollisionCompound::dgFlatNode::BoxTest (const dgOOBBTestData& data, const dgVector& p0, const dgVector& p1) const
+{
+	const dgMatrix& matrix = data.m_matrix;
+	const dgMatrix& absMatrix = data.m_absMatrix;
+	dgVector originX (dgVector::m_half * (m_maxX + m_minX));
+	dgVector originY (dgVector::m_half * (m_maxY + m_minY));
+	dgVector originZ (dgVector::m_half * (m_maxZ + m_minZ));
+	dgVector sizeX (dgVector::m_half * (m_maxX - m_minX) + m_padding);
+	dgVector sizeY (dgVector::m_half * (m_maxY - m_minY) + m_padding);
+	dgVector sizeZ (dgVector::m_half * (m_maxZ - m_minZ) + m_padding);
+
+	dgVector test (dgVector::m_negOne);
+	for (dgInt32 i = 0; i < 3; i ++) {
+		dgVector origin (originX * dgVector (matrix[0][i]) + originY * dgVector (matrix[1][i]) + originZ * dgVector (matrix[2][i]) + dgVector (matrix[3][i]));
+		dgVector size (sizeX * dgVector (absMatrix[0][i]) + sizeY * dgVector (absMatrix[1][i]) + sizeZ * dgVector (absMatrix[2][i]));
+		test = test & ((origin - size - dgVector (p1[i])) * (origin + size - dgVector (p0[i])));
+	}
+
+	// a rotation can move the far away box of an empty slot into the test box
+	dgInt32 mask = test.GetSignMask();
+	for (dgInt32 i = 0; i < 4; i ++) {
+		if (IsEmptySlot (i)) {
+			mask &= ~(1 << i);
+		}
+	}
+	return mask;
+}
+
 
 #endif 
 
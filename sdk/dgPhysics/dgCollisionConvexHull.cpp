@@ -59,7 +59,7 @@ dgCollisionConvexHull::dgCollisionConvexHull(dgMemoryAllocator* const allocator,
 	m_rtti |= dgCollisionConvexHull_RTTI;
 }
 
-dgCollisionConvexHull::dgCollisionConvexHull(dgMemoryAllocator* const allocator, dgUnsigned32 signature, dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray)
+dgCollisionConvexHull::dgCollisionConvexHull(dgMemoryAllocator* const allocator, dgUnsigned32 signature, dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray, dgThreadHive* const threadPool)
 	:dgCollisionConvex(allocator, signature, m_convexHullCollision)
 	,m_faceCount (0)
 	,m_supportTreeCount (0)
@@ -73,7 +73,7 @@ dgCollisionConvexHull::dgCollisionConvexHull(dgMemoryAllocator* const allocator,
 	m_simplex = NULL;
 	m_rtti |= dgCollisionConvexHull_RTTI;
 
-	BuildHull (count, strideInBytes, tolerance, vertexArray);
+	BuildHull (count, strideInBytes, tolerance, vertexArray, threadPool);
 }
 
 dgCollisionConvexHull::dgCollisionConvexHull(dgWorld* const world, dgDeserialize deserialization, void* const userData, dgInt32 revisionNumber)
@@ -140,9 +140,9 @@ dgCollisionConvexHull::~dgCollisionConvexHull()
 	}
 }
 
-void dgCollisionConvexHull::BuildHull (dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray)
+void dgCollisionConvexHull::BuildHull (dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray, dgThreadHive* const threadPool)
 {
-	Create (count, strideInBytes, vertexArray, tolerance);
+	Create (count, strideInBytes, vertexArray, tolerance, threadPool);
 }
 
 dgInt32 dgCollisionConvexHull::GetFaceIndices (dgInt32 index, dgInt32* const indices) const
@@ -330,7 +330,7 @@ bool dgCollisionConvexHull::CheckConvex (dgPolyhedra& polyhedra1, const dgBigVec
 
 
 
-bool dgCollisionConvexHull::Create (dgInt32 count, dgInt32 strideInBytes, const dgFloat32* const vertexArray, dgFloat32 tolerance)
+bool dgCollisionConvexHull::Create (dgInt32 count, dgInt32 strideInBytes, const dgFloat32* const vertexArray, dgFloat32 tolerance, dgThreadHive* const threadPool)
 {
 	dgInt32 stride = strideInBytes / sizeof (dgFloat32);
 	dgStack<dgFloat64> buffer(3 * 2 * count);
@@ -340,7 +340,7 @@ bool dgCollisionConvexHull::Create (dgInt32 count, dgInt32 strideInBytes, const
 		buffer[i * 3 + 2] = vertexArray[i * stride + 2];
 	}
 
-	dgConvexHull3d* convexHull =  new (GetAllocator()) dgConvexHull3d (GetAllocator(), &buffer[0], 3 * sizeof (dgFloat64), count, tolerance);
+	dgConvexHull3d* convexHull =  new (GetAllocator()) dgConvexHull3d (GetAllocator(), &buffer[0], 3 * sizeof (dgFloat64), count, tolerance, 0x7fffffff, threadPool);
 	if (!convexHull->GetCount()) {
 		// this is a degenerated hull hull to add some thickness and for a thick plane
 		delete convexHull;
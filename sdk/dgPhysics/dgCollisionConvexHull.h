@@ -31,7 +31,7 @@ class dgCollisionConvexHull: public dgCollisionConvex
 	class dgConvexBox;
 
 	dgCollisionConvexHull(dgMemoryAllocator* const allocator, dgUnsigned32 signature);
-	dgCollisionConvexHull(dgMemoryAllocator* const allocator, dgUnsigned32 signature, dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray);
+	dgCollisionConvexHull(dgMemoryAllocator* const allocator, dgUnsigned32 signature, dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray, dgThreadHive* const threadPool = NULL);
 	dgCollisionConvexHull(dgWorld* const world, dgDeserialize deserialization, void* const userData, dgInt32 revisionNumber);
 	virtual ~dgCollisionConvexHull();
 
@@ -40,8 +40,8 @@ class dgCollisionConvexHull: public dgCollisionConvex
 	static dgInt32 CalculateSignature (dgInt32 vertexCount, const dgFloat32* const vertexArray, dgInt32 strideInBytes);
 
 	protected:
-	void BuildHull (dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray);
-	bool Create (dgInt32 count, dgInt32 strideInBytes, const dgFloat32* const vertexArray, dgFloat32 tolerance);
+	void BuildHull (dgInt32 count, dgInt32 strideInBytes, dgFloat32 tolerance, const dgFloat32* const vertexArray, dgThreadHive* const threadPool);
+	bool Create (dgInt32 count, dgInt32 strideInBytes, const dgFloat32* const vertexArray, dgFloat32 tolerance, dgThreadHive* const threadPool);
 
 	bool RemoveCoplanarEdge (dgPolyhedra& convex, const dgBigVector* const hullVertexArray) const;	
 	dgBigVector FaceNormal (const dgEdge *face, const dgBigVector* const pool) const;
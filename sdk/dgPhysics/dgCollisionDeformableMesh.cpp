@@ -38,7 +38,9 @@ dgVector dgCollisionDeformableMesh::m_smallestLenght2	(DG_SMALLEST_SPRING_LENGTH
 dgCollisionDeformableMesh::dgCollisionDeformableMesh(dgWorld* const world, dgCollisionID collisionID)
 	:dgCollisionLumpedMassParticles(world, collisionID)
 	,m_linkList(world->GetAllocator())
+	,m_linkColorStart(world->GetAllocator())
 	,m_linksCount(0)
+	,m_linkColorsCount(0)
 {
 	m_rtti |= dgCollisionDeformableMesh_RTTI;
 }
@@ -46,7 +48,9 @@ dgCollisionDeformableMesh::dgCollisionDeformableMesh(dgWorld* const world, dgCol
 dgCollisionDeformableMesh::dgCollisionDeformableMesh(const dgCollisionDeformableMesh& source)
 	:dgCollisionLumpedMassParticles(source)
 	,m_linkList(source.m_linkList, source.m_linksCount)
+	,m_linkColorStart(source.m_linkColorStart, source.m_linkColorsCount + 1)
 	,m_linksCount(source.m_linksCount)
+	,m_linkColorsCount(source.m_linkColorsCount)
 {
 	m_rtti = source.m_rtti;
 }
@@ -54,7 +58,9 @@ dgCollisionDeformableMesh::dgCollisionDeformableMesh(const dgCollisionDeformable
 dgCollisionDeformableMesh::dgCollisionDeformableMesh(dgWorld* const world, dgDeserialize deserialization, void* const userData, dgInt32 revisionNumber)
 	:dgCollisionLumpedMassParticles(world, deserialization, userData, revisionNumber)
 	,m_linkList(world->GetAllocator())
+	,m_linkColorStart(world->GetAllocator())
 	,m_linksCount(0)
+	,m_linkColorsCount(0)
 {
 	dgAssert(0);
 }
@@ -66,6 +72,58 @@ dgCollisionDeformableMesh::~dgCollisionDeformableMesh(void)
 void dgCollisionDeformableMesh::FinalizeBuild()
 {
 	dgCollisionLumpedMassParticles::FinalizeBuild();
+	ColorLinks();
+}
+
+void dgCollisionDeformableMesh::ColorLinks()
+{
+	// greedy coloring, each link get the lowest color not used yet by any of its two particles
+	dgStack<dgUnsigned64> particleColors(m_particlesCount);
+	dgStack<dgInt32> linkColors(m_linksCount);
+	dgInt32 colorCount[DG_DEFORMABLE_MAX_LINK_COLORS + 1];
+
+	memset (&particleColors[0], 0, m_particlesCount * sizeof (dgUnsigned64));
+	memset (colorCount, 0, sizeof (colorCount));
+	for (dgInt32 i = 0; i < m_linksCount; i++) {
+		const dgInt32 j0 = m_linkList[i].m_m0;
+		const dgInt32 j1 = m_linkList[i].m_m1;
+		const dgUnsigned64 usedColors = particleColors[j0] | particleColors[j1];
+		dgInt32 color = 0;
+		for (; (color < DG_DEFORMABLE_MAX_LINK_COLORS) && (usedColors & (dgUnsigned64(1) << color)); color++);
+		if (color < DG_DEFORMABLE_MAX_LINK_COLORS) {
+			particleColors[j0] |= dgUnsigned64(1) << color;
+			particleColors[j1] |= dgUnsigned64(1) << color;
+		}
+		linkColors[i] = color;
+		colorCount[color] ++;
+	}
+
+	// the greedy colors are always consecutive
+	m_linkColorsCount = 0;
+	for (; (m_linkColorsCount < DG_DEFORMABLE_MAX_LINK_COLORS) && colorCount[m_linkColorsCount]; m_linkColorsCount++);
+
+	dgInt32 colorStart[DG_DEFORMABLE_MAX_LINK_COLORS + 1];
+	dgInt32 acc = 0;
+	for (dgInt32 i = 0; i <= DG_DEFORMABLE_MAX_LINK_COLORS; i++) {
+		colorStart[i] = acc;
+		acc += colorCount[i];
+	}
+
+	m_linkColorStart.Resize(m_linkColorsCount + 1);
+	for (dgInt32 i = 0; i < m_linkColorsCount; i++) {
+		m_linkColorStart[i] = colorStart[i];
+	}
+	m_linkColorStart[m_linkColorsCount] = colorStart[DG_DEFORMABLE_MAX_LINK_COLORS];
+
+	dgStack<dgSpringDamperLink> links(m_linksCount);
+	for (dgInt32 i = 0; i < m_linksCount; i++) {
+		links[i] = m_linkList[i];
+	}
+	for (dgInt32 i = 0; i < m_linksCount; i++) {
+		const dgInt32 color = linkColors[i];
+		m_linkList[colorStart[color]] = links[i];
+		colorStart[color] ++;
+	}
 }
 
 void dgCollisionDeformableMesh::Serialize(dgSerialize callback, void* const userData) const
@@ -95,7 +153,7 @@ void dgCollisionDeformableMesh::DisableInactiveLinks ()
 */
 }
 
-const dgInt16* dgCollisionDeformableMesh::GetLinks() const
+const dgInt32* dgCollisionDeformableMesh::GetLinks() const
 {
 	return &m_linkList[0].m_m0;
 }
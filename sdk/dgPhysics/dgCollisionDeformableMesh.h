@@ -26,6 +26,8 @@
 #include "dgCollision.h"
 #include "dgCollisionLumpedMassParticles.h"
 
+#define DG_DEFORMABLE_MAX_LINK_COLORS	64
+
 
 class dgCollisionDeformableMesh: public dgCollisionLumpedMassParticles
 {
@@ -36,7 +38,7 @@ class dgCollisionDeformableMesh: public dgCollisionLumpedMassParticles
 	virtual ~dgCollisionDeformableMesh(void);
 
 	dgInt32 GetLinksCount() const;
-	const dgInt16* GetLinks() const;
+	const dgInt32* GetLinks() const;
 	
 	virtual void ConstraintParticle(dgInt32 particleIndex, const dgVector& posit, const dgBody* const body);
 
@@ -49,8 +51,8 @@ class dgCollisionDeformableMesh: public dgCollisionLumpedMassParticles
 		dgFloat32 m_spring;
 		dgFloat32 m_damper;
 		dgFloat32 m_restlength;
-		dgInt16 m_m0;
-		dgInt16 m_m1;
+		dgInt32 m_m0;
+		dgInt32 m_m1;
 	};
 
 
@@ -60,9 +62,15 @@ class dgCollisionDeformableMesh: public dgCollisionLumpedMassParticles
 	virtual void Serialize(dgSerialize callback, void* const userData) const;
 	virtual void IntegrateForces(dgFloat32 timestep);
 	virtual void DebugCollision (const dgMatrix& matrix, dgCollision::OnDebugCollisionMeshCallback callback, void* const userData) const;
+
+	void ColorLinks();
 	
+	// links are sorted by color, links of the same color do not share particles. 
+	// links past the last color could not be colored and must be processed serially
 	dgArray<dgSpringDamperLink> m_linkList;
+	dgArray<dgInt32> m_linkColorStart;
 	dgInt32 m_linksCount;
+	dgInt32 m_linkColorsCount;
 
 	static dgVector m_smallestLenght2;
 };
@@ -262,7 +262,7 @@ dgFloat32 kVolumetricStiffness = dgFloat32(20000000.0f);
 	dgVector epsilon (dgFloat32 (1.0e-14f));
 
 	dtRK4 = dtRK4 & dgVector::m_triplexMask;
-	HandleCollision (timestep, normalDir, normalAccel, frictionCoeffecient);
+	HandleCollision (timestep, normalDir, normalAccel, frictionCoeffecient, 0, m_particlesCount);
 	for (dgInt32 k = 0; k < iter; k ++) {
 
 		for (dgInt32 i = 0; i < m_particlesCount; i++) {
@@ -282,7 +282,7 @@ dgVector dgCollisionLumpedMassParticles::CalculateContactNormalAndPenetration(co
 	return contactNormal;
 }
 
-void dgCollisionLumpedMassParticles::HandleCollision(dgFloat32 timestep, dgVector* const normalDir, dgVector* const normalAccel, dgFloat32* const frictionCoefficient)
+void dgCollisionLumpedMassParticles::HandleCollision(dgFloat32 timestep, dgVector* const normalDir, dgVector* const normalAccel, dgFloat32* const frictionCoefficient, dgInt32 firstParticle, dgInt32 lastParticle)
 {
 	const dgMatrix& matrix = m_body->GetCollision()->GetGlobalMatrix();
 	dgVector origin(matrix.m_posit);
@@ -298,11 +298,7 @@ coeficientOfPenetration *= 1.0f;
 	const dgVector* const posit = &m_posit[0];
 	const dgVector* const extAccel = &m_externalAccel[0];
 
-static int xxx;
-xxx ++;
-//dgTrace (("%d %f %f\n", xxx, externAccel[0].m_y, veloc[0].m_y));
-
-	for (dgInt32 i = 0; i < m_particlesCount; i++) {
+	for (dgInt32 i = firstParticle; i < lastParticle; i++) {
 		dgVector normal(dgVector::m_zero);
 		dgVector accel1(dgVector::m_zero);
 		dgVector tangent0(dgVector::m_zero);
@@ -27,6 +27,9 @@
 #include "dgCollision.h"
 #include "dgCollisionConvex.h"
 
+// particles systems this size or bigger are integrated using all threads of the world thread pool
+#define DG_LUMPED_MASS_PARALLEL_PARTICLES_COUNT		1024
+
 
 class dgCollisionLumpedMassParticles: public dgCollisionConvex
 {
@@ -60,7 +63,7 @@ class dgCollisionLumpedMassParticles: public dgCollisionConvex
 
 	//dgFloat32 CalculaleContactPenetration(const dgVector& point, const dgVector& normal) const;
 	dgVector CalculateContactNormalAndPenetration(const dgVector& worldPosition) const;
-	virtual void HandleCollision (dgFloat32 timestep, dgVector* const normalDir, dgVector* const normalAccel, dgFloat32* const frictionCoefficient);
+	virtual void HandleCollision (dgFloat32 timestep, dgVector* const normalDir, dgVector* const normalAccel, dgFloat32* const frictionCoefficient, dgInt32 firstParticle, dgInt32 lastParticle);
 
 	virtual dgInt32 GetMemoryBufferSizeInBytes() const = 0;
 
@@ -27,9 +27,24 @@
 #include "dgDynamicBody.h"
 #include "dgCollisionMassSpringDamperSystem.h"
 
+#define DG_MASS_SPRING_RK_STEPS		4
+
+class dgCollisionMassSpringDamperSystem::dgIntegrateDescriptor
+{
+	public:
+	dgVector m_unitAccel;
+	dThreadHiveSync m_sync;
+	dgFloat32 m_timestep;
+	dgInt32 m_threadCount;
+	dgCollisionMassSpringDamperSystem* m_me;
+};
 
 dgCollisionMassSpringDamperSystem::dgCollisionMassSpringDamperSystem (dgWorld* const world, dgInt32 shapeID, dgInt32 pointCount, const dgFloat32* const points, dgInt32 strideInBytes, const dgFloat32* const pointsMasses, dgInt32 linksCount, const dgInt32* const links, const dgFloat32* const linksSpring, const dgFloat32* const LinksDamper)
 	:dgCollisionDeformableMesh(world, m_deformableSolidMesh)
+	,m_normalDir(world->GetAllocator())
+	,m_normalAccel(world->GetAllocator())
+	,m_diagonal(world->GetAllocator())
+	,m_frictionCoefficient(world->GetAllocator())
 {
 	m_rtti |= dgCollisionMassSpringDamperSystem_RTTI;
 
@@ -56,8 +71,8 @@ dgCollisionMassSpringDamperSystem::dgCollisionMassSpringDamperSystem (dgWorld* c
 		dgAssert(v1 >= 0);
 		dgAssert(v0 < pointCount);
 		dgAssert(v1 < pointCount);
-		m_linkList[i].m_m0 = dgInt16(dgMin(v0, v1));
-		m_linkList[i].m_m1 = dgInt16(dgMax(v0, v1));
+		m_linkList[i].m_m0 = dgMin(v0, v1);
+		m_linkList[i].m_m1 = dgMax(v0, v1);
 		m_linkList[i].m_spring = linksSpring[i];
 		m_linkList[i].m_damper = LinksDamper[i];
 
@@ -68,19 +83,39 @@ dgCollisionMassSpringDamperSystem::dgCollisionMassSpringDamperSystem (dgWorld* c
 		dgAssert(m_linkList[i].m_restlength > dgFloat32(1.0e-2f));
 	}
 
+	m_normalDir.Resize(m_particlesCount);
+	m_normalAccel.Resize(m_particlesCount);
+	m_diagonal.Resize(m_particlesCount);
+	m_frictionCoefficient.Resize(m_particlesCount);
 	FinalizeBuild();
 }
 
 
 dgCollisionMassSpringDamperSystem::dgCollisionMassSpringDamperSystem(const dgCollisionMassSpringDamperSystem& source)
 	:dgCollisionDeformableMesh(source)
+	,m_normalDir(source.GetAllocator())
+	,m_normalAccel(source.GetAllocator())
+	,m_diagonal(source.GetAllocator())
+	,m_frictionCoefficient(source.GetAllocator())
 {
 	m_rtti |= source.m_rtti;
+	m_normalDir.Resize(m_particlesCount);
+	m_normalAccel.Resize(m_particlesCount);
+	m_diagonal.Resize(m_particlesCount);
+	m_frictionCoefficient.Resize(m_particlesCount);
 }
 
 dgCollisionMassSpringDamperSystem::dgCollisionMassSpringDamperSystem(dgWorld* const world, dgDeserialize deserialization, void* const userData, dgInt32 revisionNumber)
 	:dgCollisionDeformableMesh(world, deserialization, userData, revisionNumber)
+	,m_normalDir(world->GetAllocator())
+	,m_normalAccel(world->GetAllocator())
+	,m_diagonal(world->GetAllocator())
+	,m_frictionCoefficient(world->GetAllocator())
 {
+	m_normalDir.Resize(m_particlesCount);
+	m_normalAccel.Resize(m_particlesCount);
+	m_diagonal.Resize(m_particlesCount);
+	m_frictionCoefficient.Resize(m_particlesCount);
 }
 
 dgCollisionMassSpringDamperSystem::~dgCollisionMassSpringDamperSystem(void)
@@ -149,7 +184,7 @@ void dgCollisionMassSpringDamperSystem::CalculateAcceleration(dgFloat32 timestep
 	dgVector epsilon(dgFloat32(1.0e-14f));
 
 	dtRK4 = dtRK4 & dgVector::m_triplexMask;
-	HandleCollision(timestep, normalDir, normalAccel, frictionCoeffecient);
+	HandleCollision(timestep, normalDir, normalAccel, frictionCoeffecient, 0, m_particlesCount);
 	for (dgInt32 k = 0; k < iter; k++) {
 
 		for (dgInt32 i = 0; i < m_particlesCount; i++) {
@@ -230,50 +265,12 @@ void dgCollisionMassSpringDamperSystem::CalculateAcceleration(dgFloat32 timestep
 {
 	// Ks is in [sec^-2] a spring constant unit acceleration, not a spring force acceleration. 
 	// Kc is in [sec^-1] a damper constant unit velocity, not a damper force acceleration. 
-
-	dgInt32 iter = 4;
-	dgVector* const accel = &m_accel[0];
-	dgVector* const veloc = &m_veloc[0];
-	dgVector* const posit = &m_posit[0];
-	dgVector* const extAccel = &m_externalAccel[0];
-	const dgSpringDamperLink* const links = &m_linkList[0];
-/*
-	
-	dgVector* const dx = dgAlloca(dgVector, m_linksCount);
-	dgVector* const dv = dgAlloca(dgVector, m_linksCount);
-	dgVector* const dpdv = dgAlloca(dgVector, m_linksCount);
-
-	dgVector* const normalDir = dgAlloca(dgVector, m_particlesCount);
-	dgVector* const normalAccel = dgAlloca(dgVector, m_particlesCount);
-	dgFloat32* const spring_A01 = dgAlloca(dgFloat32, m_linksCount);
-	dgFloat32* const spring_B01 = dgAlloca(dgFloat32, m_linksCount);
-	dgFloat32* const frictionCoeffecient = dgAlloca(dgFloat32, m_particlesCount);
-*/
-	//	dgFloat32* const damper_A01 = dgAlloca(dgFloat32, m_linksCount);
-	//	dgFloat32* const damper_B01 = dgAlloca(dgFloat32, m_linksCount);
-	//	dgFloat32* const damper_C01 = dgAlloca(dgFloat32, m_linksCount);
-	//	dgVector* const collisionDir1 = dgAlloca(dgVector, m_particlesCount);
-	//	dgVector* const collisionDir2 = dgAlloca(dgVector, m_particlesCount);
-	//	dgVector* const tmp1 = dgAlloca(dgVector, m_particlesCount);
-	//	dgVector* const tmp2 = dgAlloca(dgVector, m_particlesCount);
-	//	dgVector* const diag = dgAlloca(dgVector, m_particlesCount);
-	//	dgVector* const offDiag = dgAlloca(dgVector, m_particlesCount);
-	//dgVector deltaOmega(m_body->m_invWorldInertiaMatrix.RotateVector(m_body->m_externalTorque.Scale4(timestep)));
-
 	dgWorld* const world = m_body->GetWorld();
-	world->m_solverJacobiansMemory.ResizeIfNecessary(GetMemoryBufferSizeInBytes() + 1024);
-
-	dgVector* const normalAccel = (dgVector*)&world->m_solverJacobiansMemory[0];
-	dgVector* const normalDir = &normalAccel[m_particlesCount];
-	dgVector* const diagonal = &normalDir[m_particlesCount];
-	dgFloat32* const frictionCoeffecient = (dgFloat32*)&diagonal[m_particlesCount];
-
-	dgVector unitAccel(m_body->m_externalForce * dgVector(m_body->m_invMass.m_w));
 
-	// here I need to add all other external acceleration like wind and pressure, friction and collision.
-	for (dgInt32 i = 0; i < m_particlesCount; i++) {
-		extAccel[i] = unitAccel;
-	}
+	dgIntegrateDescriptor descriptor;
+	descriptor.m_unitAccel = m_body->m_externalForce * dgVector(m_body->m_invMass.m_w);
+	descriptor.m_timestep = timestep;
+	descriptor.m_me = this;
 
 	dgAssert(m_body->IsRTTIType(dgBody::m_dynamicBodyRTTI));
 	m_body->m_alpha = dgVector::m_zero;
@@ -281,88 +278,119 @@ void dgCollisionMassSpringDamperSystem::CalculateAcceleration(dgFloat32 timestep
 	m_body->m_externalForce = dgVector::m_zero;
 	m_body->m_externalTorque = dgVector::m_zero;
 
-	//dgFloat32 ks_dt = -timestep * kSpring;
-	//dgFloat32 kd_dt0 = -timestep * kDamper;
-	//dgFloat32 kd_dt1 = -timestep * kDamper * dgFloat32(2.0f);
+	// big meshes are integrated by all threads, the world only does that from outside of the thread pool
+	const dgInt32 threadCount = world->GetThreadCount();
+	if ((threadCount > 1) && (m_particlesCount >= DG_LUMPED_MASS_PARALLEL_PARTICLES_COUNT)) {
+		descriptor.m_threadCount = threadCount;
+		descriptor.m_sync.Reset(threadCount);
+		for (dgInt32 i = 0; i < threadCount; i++) {
+			world->QueueJob(CalculateAccelerationKernel, &descriptor, NULL, "dgCollisionMassSpringDamperSystem::CalculateAcceleration");
+		}
+		world->SynchronizationBarrier();
+	} else {
+		descriptor.m_threadCount = 1;
+		descriptor.m_sync.Reset(1);
+		CalculateAcceleration(&descriptor, 0);
+	}
+}
 
-	//dgFloat32 dtRK4__ = timestep / iter;
-	dgVector dtRK4 (timestep / iter);
-	dgVector epsilon(dgFloat32(1.0e-14f));
+void dgCollisionMassSpringDamperSystem::CalculateAccelerationKernel(void* const context, void* const, dgInt32 threadID)
+{
+	dgIntegrateDescriptor* const descriptor = (dgIntegrateDescriptor*)context;
+	descriptor->m_me->CalculateAcceleration(descriptor, threadID);
+}
 
-//	dtRK4 = dtRK4 & dgVector::m_triplexMask;
-	HandleCollision(timestep, normalDir, normalAccel, frictionCoeffecient);
-	for (dgInt32 k = 0; k < iter; k++) {
-		for (dgInt32 i = 0; i < m_particlesCount; i++) {
-			accel[i] = dgVector::m_zero; 
-			diagonal[i] = dgVector::m_zero; 
-		}
-/*
-		for (dgInt32 i = 0; i < m_linksCount; i++) {
-			const dgInt32 j0 = links[i].m_m0;
-			const dgInt32 j1 = links[i].m_m1;
+void dgCollisionMassSpringDamperSystem::CalculateLinksAcceleration(dgInt32 firstLink, dgInt32 lastLink, dgFloat32 timestep)
+{
+	dgVector* const accel = &m_accel[0];
+	dgVector* const diagonal = &m_diagonal[0];
+	const dgVector* const veloc = &m_veloc[0];
+	const dgVector* const posit = &m_posit[0];
+	const dgSpringDamperLink* const links = &m_linkList[0];
 
-			const dgVector p0p1(posit[j0] - posit[j1]);
-			const dgVector v0v1(veloc[j0] - veloc[j1]);
-			const dgVector dpdv(p0p1.CompProduct4(v0v1));
+	for (dgInt32 i = firstLink; i < lastLink; i++) {
+		const dgInt32 j0 = links[i].m_m0;
+		const dgInt32 j1 = links[i].m_m1;
+		const dgVector p0p1(posit[j0] - posit[j1]);
+		const dgVector v0v1(veloc[j0] - veloc[j1]);
+		const dgVector dvdp(v0v1 * p0p1);
 
-			const dgVector mag2(p0p1.DotProduct4(p0p1));
-			const dgVector mask(mag2 > m_smallestLenght2);
+		const dgVector p0p1Mag2(p0p1.DotProduct4(p0p1));
+		const dgVector p0p1Mask(p0p1Mag2 > m_smallestLenght2);
+		const dgVector p0p1Lenght2((p0p1Mag2 & p0p1Mask) | m_smallestLenght2.AndNot(p0p1Mask));
 
-			const dgVector lenght2((mag2 & mask) | mag2.AndNot(mask));
-			const dgFloat32 length = (lenght2.Sqrt()).GetScalar();
-			const dgFloat32 invDen = dgFloat32(1.0f) / length;
-			const dgFloat32 lenghtRatio = restLenght[i] * invDen;
-			const dgFloat32 compression = dgFloat32(1.0f) - lenghtRatio;
-			const dgVector fs(p0p1.Scale4(kSpring * compression));
-			const dgVector fd(p0p1.Scale4(kDamper * invDen * invDen * (v0v1.DotProduct4(p0p1)).GetScalar()));
-			const dgVector dfsdx(v0v1.Scale4 (ks_dt * compression) + (p0p1.CompProduct4(dpdv).Scale4 (ks_dt * lenghtRatio * invDen * invDen)));
-			dgAssert(fs.m_w == dgFloat32(0.0f));
-			dgAssert(fs.m_w == dgFloat32(0.0f));
-			dgAssert(p0p1.m_w == dgFloat32(0.0f));
-			dgAssert(dfsdx.m_w == dgFloat32(0.0f));
+		const dgFloat32 p0p1Length = p0p1Lenght2.Sqrt().GetScalar();
+		const dgFloat32 p0p1InvMag = dgFloat32 (1.0f) / p0p1Length;
 
-			const dgVector nextAccel(fs + fd - dfsdx);
-			accel[j0] -= nextAccel;
-			accel[j1] += nextAccel;
-		}
-*/
+		const dgFloat32 k01 = -links[i].m_spring * (p0p1Length - links[i].m_restlength) * p0p1InvMag;
+		const dgFloat32 d01 = -links[i].m_damper * dvdp.GetScalar() * p0p1InvMag * p0p1InvMag;
+		const dgFloat32 h01dt = - timestep * links[i].m_spring * links[i].m_restlength * p0p1InvMag * p0p1InvMag * p0p1InvMag;
 
-		for (dgInt32 i = 0; i < m_linksCount; i++) {
-			const dgInt32 j0 = links[i].m_m0;
-			const dgInt32 j1 = links[i].m_m1;
-			const dgVector p0p1(posit[j0] - posit[j1]);
-			const dgVector v0v1(veloc[j0] - veloc[j1]);
-			const dgVector dvdp(v0v1 * p0p1);
+		const dgVector diag ((p0p1 * p0p1).Scale4(h01dt * timestep));
+
+		const dgFloat32 dtdfp0dx0 = h01dt * v0v1.DotProduct4(p0p1).GetScalar();
+		const dgVector netForce (p0p1.Scale4(k01 + d01 + dtdfp0dx0));
 
-			const dgVector p0p1Mag2(p0p1.DotProduct4(p0p1));
-			const dgVector p0p1Mask(p0p1Mag2 > m_smallestLenght2);
-			const dgVector p0p1Lenght2((p0p1Mag2 & p0p1Mask) | m_smallestLenght2.AndNot(p0p1Mask));
+		diagonal[j0] -= diag;
+		diagonal[j1] -= diag;
+		accel[j0] += netForce;
+		accel[j1] -= netForce;
+	}
+}
 
-			const dgFloat32 p0p1Length = p0p1Lenght2.Sqrt().GetScalar();
-			const dgFloat32 p0p1InvMag = dgFloat32 (1.0f) / p0p1Length;
+void dgCollisionMassSpringDamperSystem::CalculateAcceleration(dgIntegrateDescriptor* const descriptor, dgInt32 threadID)
+{
+	DG_TRACKTIME(__FUNCTION__);
+	dgVector* const accel = &m_accel[0];
+	dgVector* const veloc = &m_veloc[0];
+	dgVector* const posit = &m_posit[0];
+	dgVector* const extAccel = &m_externalAccel[0];
+	dgVector* const diagonal = &m_diagonal[0];
+	const dgVector* const normalDir = &m_normalDir[0];
+	const dgVector* const normalAccel = &m_normalAccel[0];
+	const dgFloat32* const frictionCoeffecient = &m_frictionCoefficient[0];
 
-			const dgFloat32 k01 = -links[i].m_spring * (p0p1Length - links[i].m_restlength) * p0p1InvMag;
-			const dgFloat32 d01 = -links[i].m_damper * dvdp.GetScalar() * p0p1InvMag * p0p1InvMag;
-			const dgFloat32 h01dt = - dtRK4.GetScalar() * links[i].m_spring * links[i].m_restlength * p0p1InvMag * p0p1InvMag * p0p1InvMag;
+	// each thread owns a fix range of particles, and a range of the links of each color
+	const dgInt32 threadCount = descriptor->m_threadCount;
+	const dgInt32 firstParticle = m_particlesCount * threadID / threadCount;
+	const dgInt32 lastParticle = m_particlesCount * (threadID + 1) / threadCount;
 
-			const dgVector diag ((p0p1 * p0p1).Scale4(h01dt * dtRK4.GetScalar()));
+	// here I need to add all other external acceleration like wind and pressure, friction and collision.
+	const dgVector unitAccel(descriptor->m_unitAccel);
+	for (dgInt32 i = firstParticle; i < lastParticle; i++) {
+		extAccel[i] = unitAccel;
+	}
 
-			const dgFloat32 dtdfp0dx0 = h01dt * v0v1.DotProduct4(p0p1).GetScalar();
-			const dgVector netForce (p0p1.Scale4(k01 + d01 + dtdfp0dx0));
-			
+	const dgFloat32 timestep = descriptor->m_timestep;
+	const dgVector dtRK4 (timestep / DG_MASS_SPRING_RK_STEPS);
+	const dgVector epsilon(dgFloat32(1.0e-14f));
 
-			diagonal[j0] -= diag;
-			diagonal[j1] -= diag;
-			accel[j0] += netForce;
-			accel[j1] -= netForce;
+	HandleCollision(timestep, &m_normalDir[0], &m_normalAccel[0], &m_frictionCoefficient[0], firstParticle, lastParticle);
+	for (dgInt32 k = 0; k < DG_MASS_SPRING_RK_STEPS; k++) {
+		for (dgInt32 i = firstParticle; i < lastParticle; i++) {
+			accel[i] = dgVector::m_zero; 
+			diagonal[i] = dgVector::m_zero; 
+		}
+		descriptor->m_sync.Sync();
+
+		for (dgInt32 i = 0; i < m_linkColorsCount; i++) {
+			const dgInt32 colorStart = m_linkColorStart[i];
+			const dgInt32 colorCount = m_linkColorStart[i + 1] - colorStart;
+			const dgInt32 firstLink = colorStart + colorCount * threadID / threadCount;
+			const dgInt32 lastLink = colorStart + colorCount * (threadID + 1) / threadCount;
+			CalculateLinksAcceleration(firstLink, lastLink, dtRK4.GetScalar());
+			descriptor->m_sync.Sync();
 		}
 
+		const dgInt32 uncoloredLinks = m_linkColorStart[m_linkColorsCount];
+		if (uncoloredLinks < m_linksCount) {
+			if (!threadID) {
+				CalculateLinksAcceleration(uncoloredLinks, m_linksCount, dtRK4.GetScalar());
+			}
+			descriptor->m_sync.Sync();
+		}
 
-		for (dgInt32 i = 0; i < m_particlesCount; i++) {
-			//dgVector dirAccel1 (collisionDir1[i].CompProduct4(accel[i].DotProduct4(collisionDir1[i])));
-			//dgVector dirAccel2 (collisionDir2[i].CompProduct4(accel[i].DotProduct4(collisionDir2[i])));
-			//tmp0[i] = accel[i] + collidingAccel[i] - dirAccel0 - dirAccel1 - dirAccel2;
-
+		for (dgInt32 i = firstParticle; i < lastParticle; i++) {
 			dgVector netAccel (accel[i] + extAccel[i]);
 			dgVector tangentDir(veloc[i] - normalDir[i] * (normalDir[i].DotProduct4(veloc[i])));
 			dgVector mag(tangentDir.DotProduct4(tangentDir) + epsilon);
@@ -370,13 +398,12 @@ void dgCollisionMassSpringDamperSystem::CalculateAcceleration(dgFloat32 timestep
 			dgFloat32 tangentFrictionAccel = dgAbs(netAccel.DotProduct4(normalDir[i]).GetScalar());
 			dgVector friction(tangentDir.Scale4(frictionCoeffecient[i] * tangentFrictionAccel / dgSqrt(mag.GetScalar())));
 
-			//dgVector particleAccel (accel[i] + normalAccel[i] - normalDirAccel);
 			dgVector normalDirAccel(normalDir[i] * (netAccel.DotProduct4(normalDir[i])));
-			//accel[i] = accel[i] + normalAccel[i] - normalDirAccel - friction;
 			netAccel = netAccel + normalAccel[i] - normalDirAccel - friction;
 			veloc[i] += netAccel * dtRK4;
 			posit[i] += veloc[i] * dtRK4;
 		}
+		descriptor->m_sync.Sync();
 	}
 }
 
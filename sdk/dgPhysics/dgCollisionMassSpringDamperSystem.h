@@ -40,6 +40,19 @@ class dgCollisionMassSpringDamperSystem: public dgCollisionDeformableMesh
 	virtual void CalculateAcceleration(dgFloat32 timestep);
 
 	dgInt32 GetMemoryBufferSizeInBytes() const;
+
+	private:
+	class dgIntegrateDescriptor;
+
+	void CalculateLinksAcceleration(dgInt32 firstLink, dgInt32 lastLink, dgFloat32 timestep);
+	void CalculateAcceleration(dgIntegrateDescriptor* const descriptor, dgInt32 threadID);
+	static void CalculateAccelerationKernel(void* const context, void* const, dgInt32 threadID);
+
+	// per particle scratch buffers, private to each mesh so that meshes can be integrated concurrently
+	dgArray<dgVector> m_normalDir;
+	dgArray<dgVector> m_normalAccel;
+	dgArray<dgVector> m_diagonal;
+	dgArray<dgFloat32> m_frictionCoefficient;
 };
 
 
@@ -62,6 +62,7 @@ dgContactMaterial::dgContactMaterial()
 	m_normal_Force.m_force = dgFloat32 (0.0f);
 	m_normal_Force.m_impact = dgFloat32 (0.0f);
 	m_skinThickness = dgFloat32 (0.0f);
+	m_maxContactCount = DG_CONSTRAINT_MAX_ROWS / 3;
 	m_flags = m_collisionEnable | m_friction0Enable | m_friction1Enable;
 }
 
@@ -201,7 +202,13 @@ void dgContact::JacobianContactDerivative (dgContraintDescritor& params, const d
 	dgFloat32 penetrationStiffness = MAX_PENETRATION_STIFFNESS * contact.m_softness;
 	dgFloat32 penetrationVeloc = penetration * penetrationStiffness;
 	dgAssert (dgAbs (penetrationVeloc - MAX_PENETRATION_STIFFNESS * contact.m_softness * penetration) < dgFloat32 (1.0e-6f));
-	if (relVelocErr > REST_RELATIVE_VELOCITY) {
+	if (contact.m_flags & dgContactMaterial::m_speculativeContact) {
+		// speculative contact, the penetration is the negative of the gap the bodies can still close 
+		// this step, the row only removes the part of the closing velocity that will go past the surface 
+		restitution = dgFloat32 (0.0f);
+		penetration = dgFloat32 (0.0f);
+		penetrationVeloc = contact.m_penetration * params.m_invTimestep;
+	} else if (relVelocErr > REST_RELATIVE_VELOCITY) {
 		relVelocErr *= (restitution + dgFloat32 (1.0f));
 	}
 
@@ -121,6 +121,7 @@ class dgContactMaterial: public dgContactPoint
 		m_override0Friction = 1<<5,
 		m_override1Friction = 1<<6,
 		m_overrideNormalAccel = 1<<7,
+		m_speculativeContact = 1<<8,
 	};
 
 	DG_MSC_VECTOR_ALIGMENT 
@@ -162,6 +163,7 @@ class dgContactMaterial: public dgContactPoint
 	dgFloat32 m_dynamicFriction0;
 	dgFloat32 m_dynamicFriction1;
 	dgFloat32 m_skinThickness;
+	dgInt32 m_maxContactCount;
 	dgInt32 m_flags;
 
 	private:
@@ -127,6 +127,7 @@ class dgCollisionContactCloud: public dgCollisionConvex
 
 dgCollisionInstance* dgWorld::CreateNull ()
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollision::dgCollisionNull_RTTI;
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
 	if (!node) {
@@ -138,6 +139,7 @@ dgCollisionInstance* dgWorld::CreateNull ()
 
 dgCollisionInstance* dgWorld::CreateSphere(dgFloat32 radii, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollisionSphere::CalculateSignature (radii);
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
 	if (!node) {
@@ -150,6 +152,7 @@ dgCollisionInstance* dgWorld::CreateSphere(dgFloat32 radii, dgInt32 shapeID, con
 
 dgCollisionInstance* dgWorld::CreateBox(dgFloat32 dx, dgFloat32 dy, dgFloat32 dz, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollisionBox::CalculateSignature(dx, dy, dz);
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
 	if (!node) {
@@ -162,6 +165,7 @@ dgCollisionInstance* dgWorld::CreateBox(dgFloat32 dx, dgFloat32 dy, dgFloat32 dz
 
 dgCollisionInstance* dgWorld::CreateCapsule (dgFloat32 radio0, dgFloat32 radio1, dgFloat32 height, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollisionCapsule::CalculateSignature(dgAbs (radio0), dgAbs (radio1), dgAbs (height) * dgFloat32 (0.5f));
 
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
@@ -175,6 +179,7 @@ dgCollisionInstance* dgWorld::CreateCapsule (dgFloat32 radio0, dgFloat32 radio1,
 
 dgCollisionInstance* dgWorld::CreateCylinder (dgFloat32 radio0, dgFloat32 radio1, dgFloat32 height, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollisionCylinder::CalculateSignature(dgAbs (radio0), dgAbs (radio1), dgAbs (height) * dgFloat32 (0.5f));
 
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
@@ -188,6 +193,7 @@ dgCollisionInstance* dgWorld::CreateCylinder (dgFloat32 radio0, dgFloat32 radio1
 
 dgCollisionInstance* dgWorld::CreateChamferCylinder (dgFloat32 radius, dgFloat32 height, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollisionChamferCylinder::CalculateSignature(dgAbs (radius), dgAbs (height) * dgFloat32 (0.5f));
 
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
@@ -200,6 +206,7 @@ dgCollisionInstance* dgWorld::CreateChamferCylinder (dgFloat32 radius, dgFloat32
 
 dgCollisionInstance* dgWorld::CreateCone (dgFloat32 radius, dgFloat32 height, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollisionCone::CalculateSignature (dgAbs (radius), dgAbs (height) * dgFloat32 (0.5f));
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
 	if (!node) {
@@ -212,13 +219,15 @@ dgCollisionInstance* dgWorld::CreateCone (dgFloat32 radius, dgFloat32 height, dg
 
 dgCollisionInstance* dgWorld::CreateConvexHull (dgInt32 count, const dgFloat32* const vertexArray, dgInt32 strideInBytes, dgFloat32 tolerance, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgUnsigned32 crc = dgCollisionConvexHull::CalculateSignature (count, vertexArray, strideInBytes);
 
 	dgBodyCollisionList::dgTreeNode* node = dgBodyCollisionList::Find (crc);
 
 	if (!node) {
 		// shape not found create a new one and add to the cache
-		dgCollisionConvexHull* const collision = new (m_allocator) dgCollisionConvexHull (m_allocator, crc, count, strideInBytes, tolerance, vertexArray);
+		dgScopeIdleThreadPool threadPool (GetThreadPool());
+		dgCollisionConvexHull* const collision = new (m_allocator) dgCollisionConvexHull (m_allocator, crc, count, strideInBytes, tolerance, vertexArray, threadPool.GetPool());
 		if (collision->GetConvexVertexCount()) {
 			node = dgBodyCollisionList::Insert (collision, crc);
 		} else {
@@ -237,6 +246,7 @@ dgCollisionInstance* dgWorld::CreateConvexHull (dgInt32 count, const dgFloat32*
 
 dgCollisionInstance* dgWorld::CreateCompound ()
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	// compound collision are not cached
 	dgCollisionCompound* const collision = new  (m_allocator) dgCollisionCompound (this);
 	dgCollisionInstance* const instance = CreateInstance (collision, 0, dgGetIdentityMatrix()); 
@@ -247,6 +257,7 @@ dgCollisionInstance* dgWorld::CreateCompound ()
 
 dgCollisionInstance* dgWorld::CreateScene ()
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgCollisionScene* const collision = new (m_allocator) dgCollisionScene(this);
 	dgCollisionInstance* const instance = CreateInstance (collision, 0, dgGetIdentityMatrix()); 
 	collision->SetParent(instance);
@@ -259,6 +270,7 @@ dgCollisionInstance* dgWorld::CreateFracturedCompound (dgMeshEffect* const solid
 													  dgCollisionCompoundFractured::OnEmitNewCompundFractureCallBack emitFracturedCompound,
 													  dgCollisionCompoundFractured::OnReconstructFractureMainMeshCallBack reconstructMainMesh)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgCollisionCompoundFractured* const collision = new (m_allocator) dgCollisionCompoundFractured (this, solidMesh, fracturePhysicsMaterialID, pointcloudCount, vertexCloud, strideInBytes, materialID, textureMatrix, emitFracfuredChunk, emitFracturedCompound, reconstructMainMesh);
 	dgCollisionInstance* const instance = CreateInstance (collision, shapeID, dgGetIdentityMatrix()); 
 	collision->SetParent(instance);
@@ -269,6 +281,7 @@ dgCollisionInstance* dgWorld::CreateFracturedCompound (dgMeshEffect* const solid
 
 dgCollisionInstance* dgWorld::CreateMassSpringDamperSystem (dgInt32 shapeID, dgInt32 pointCount, const dgFloat32* const points, dgInt32 strideInBytes, const dgFloat32* const pointsMass, dgInt32 linksCount, const dgInt32* const links, const dgFloat32* const linksSpring, const dgFloat32* const LinksDamper)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgCollision* const collision = new (m_allocator)dgCollisionMassSpringDamperSystem(this, shapeID, pointCount, points, strideInBytes, pointsMass, linksCount, links, linksSpring, LinksDamper);
 	dgCollisionInstance* const instance = CreateInstance(collision, shapeID, dgGetIdentityMatrix());
 	collision->Release();
@@ -277,6 +290,7 @@ dgCollisionInstance* dgWorld::CreateMassSpringDamperSystem (dgInt32 shapeID, dgI
 
 dgCollisionInstance* dgWorld::CreateDeformableSolid (dgMeshEffect* const mesh, dgInt32 shapeID)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgAssert (m_allocator == mesh->GetAllocator());
 	dgCollision* const collision = new (m_allocator) dgCollisionDeformableSolidMesh (this, mesh);
 	dgCollisionInstance* const instance = CreateInstance (collision, shapeID, dgGetIdentityMatrix()); 
@@ -286,6 +300,7 @@ dgCollisionInstance* dgWorld::CreateDeformableSolid (dgMeshEffect* const mesh, d
 
 dgCollisionInstance* dgWorld::CreateBVH ()	
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	// collision tree are not cached
 	dgCollision* const collision = new  (m_allocator) dgCollisionBVH (this);
 	dgCollisionInstance* const instance = CreateInstance (collision, 0, dgGetIdentityMatrix()); 
@@ -295,6 +310,7 @@ dgCollisionInstance* dgWorld::CreateBVH ()
 
 dgCollisionInstance* dgWorld::CreateStaticUserMesh (const dgVector& boxP0, const dgVector& boxP1, const dgUserMeshCreation& data)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgCollision* const collision = new (m_allocator) dgCollisionUserMesh(this, boxP0, boxP1, data);
 	dgCollisionInstance* const instance = CreateInstance (collision, 0, dgGetIdentityMatrix()); 
 	collision->Release();
@@ -307,6 +323,7 @@ dgCollisionInstance* dgWorld::CreateHeightField(
 	const void* const elevationMap, const dgInt8* const atributeMap, 
 	dgFloat32 verticalScale, dgFloat32 horizontalScale_x, dgFloat32 horizontalScale_z)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgCollision* const collision = new  (m_allocator) dgCollisionHeightField (this, width, height, contructionMode, elevationMap, 
 																			  elevationDataType	? dgCollisionHeightField::m_unsigned16Bit : dgCollisionHeightField::m_float32Bit,	
 																			  verticalScale, atributeMap, horizontalScale_x, horizontalScale_z);
@@ -317,6 +334,7 @@ dgCollisionInstance* dgWorld::CreateHeightField(
 
 dgCollisionInstance* dgWorld::CreateInstance (const dgCollision* const child, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgAssert (dgAbs (offsetMatrix[0].DotProduct3(offsetMatrix[0]) - dgFloat32 (1.0f)) < dgFloat32 (1.0e-5f));
 	dgAssert (dgAbs (offsetMatrix[1].DotProduct3(offsetMatrix[1]) - dgFloat32 (1.0f)) < dgFloat32 (1.0e-5f));
 	dgAssert (dgAbs (offsetMatrix[2].DotProduct3(offsetMatrix[2]) - dgFloat32 (1.0f)) < dgFloat32 (1.0e-5f));
@@ -338,6 +356,7 @@ void dgWorld::SerializeCollision(dgCollisionInstance* const shape, dgSerialize s
 
 dgCollisionInstance* dgWorld::CreateCollisionFromSerialization (dgDeserialize deserialization, void* const userData)
 {
+	dgMemoryCategoryScope memoryScope (m_memoryCollisionShapes);
 	dgInt32 revision = dgDeserializeMarker (deserialization, userData);
 	dgCollisionInstance* const instance = new  (m_allocator) dgCollisionInstance (this, deserialization, userData, revision);
 	return instance;
@@ -548,99 +567,137 @@ dgInt32 dgWorld::ClosestCompoundPoint (dgCollisionParamProxy& proxy) const
 // dynamics collision system
 //
 // **********************************************************************************
-static inline dgInt32 CompareContact (const dgContactPoint* const contactA, const dgContactPoint* const contactB, void* dommy)
+// copy the points of the manifold to a structure of arrays, four points per entry. 
+// the unused lanes of the last entry are filled with a far away point.
+static inline dgInt32 dgGetContactPointsSoa (dgInt32 count, const dgContactPoint* const contact, dgVector* const px, dgVector* const py, dgVector* const pz)
 {
-	if (contactA->m_point[0] < contactB->m_point[0]) {
-		return -1;
-	} else if (contactA->m_point[0] > contactB->m_point[0]) {
-		return 1;
-	} else {
-		return 0;
+	const dgInt32 batches = (count + 3) >> 2;
+	for (dgInt32 i = 0; i < batches; i ++) {
+		dgVector points[4];
+		for (dgInt32 j = 0; j < 4; j ++) {
+			const dgInt32 index = i * 4 + j;
+			points[j] = (index < count) ? contact[index].m_point : dgVector (dgFloat32 (1.0e10f));
+		}
+		dgVector unused;
+		dgVector::Transpose4x4 (px[i], py[i], pz[i], unused, points[0], points[1], points[2], points[3]);
 	}
+	return batches;
 }
 
-
-dgInt32 dgWorld::ReduceContacts (dgInt32 count, dgContactPoint* const contact,  dgInt32 maxCount, dgFloat32 tol, dgInt32 arrayIsSorted) const
+// reduce the manifold to maxCount points. the deepest point is selected first, then the point 
+// farthest from all the points already selected is added until the manifold is full, this keeps 
+// the extreme points of the contact patch, which are the ones that give support for stacking.
+dgInt32 dgWorld::ReduceContacts (dgInt32 count, dgContactPoint* const contact, dgInt32 maxCount) const
 {
-//	if ((count > maxCount) && (maxCount > 1)) {
 	if (count > maxCount) {
+		dgAssert (maxCount > 0);
+		dgAssert (count <= DG_MAX_CONTATCS);
+		dgVector px[DG_MAX_CONTATCS / 4];
+		dgVector py[DG_MAX_CONTATCS / 4];
+		dgVector pz[DG_MAX_CONTATCS / 4];
+		dgVector minDist2[DG_MAX_CONTATCS / 4];
 		dgUnsigned8 mask[DG_MAX_CONTATCS];
 
-		if (!arrayIsSorted) {
-			dgSort (contact, count, CompareContact, NULL);
+		const dgInt32 batches = dgGetContactPointsSoa (count, contact, px, py, pz);
+		for (dgInt32 i = 0; i < batches; i ++) {
+			minDist2[i] = dgVector (dgFloat32 (1.0e20f));
+		}
+		// the padding lanes are never selected
+		for (dgInt32 i = count; i < batches * 4; i ++) {
+			minDist2[i >> 2][i & 3] = dgFloat32 (-1.0f);
 		}
 
-		dgInt32 index = 0;
-		dgFloat32 window = tol;
-		dgFloat32 window2 = window * window;
-		dgInt32 countOver = count - maxCount;
+		dgInt32 selected = 0;
+		for (dgInt32 i = 1; i < count; i ++) {
+			if (contact[i].m_penetration > contact[selected].m_penetration) {
+				selected = i;
+			}
+		}
 
-		dgAssert (countOver >= 0);
 		memset (mask, 0, size_t (count));
-		do {
-			for (dgInt32 i = 0; (i < count) && countOver; i ++) {
-				if (!mask[i]) {
-					dgFloat32 val = contact[i].m_point[index] + window;
-					for (dgInt32 j = i + 1; (j < count) && countOver && (contact[j].m_point[index] < val) ; j ++) {
-						if (!mask[j]) {
-							dgVector dp (contact[j].m_point - contact[i].m_point);
-							dgFloat32 dist2 = dp.DotProduct3(dp);
-							if (dist2 < window2) {
-								mask[j] = 1;
-								countOver --;
-							}
-						}
-					}
-				}
+		for (dgInt32 k = 0; k < maxCount; k ++) {
+			mask[selected] = 1;
+			minDist2[selected >> 2][selected & 3] = dgFloat32 (-1.0f);
+			if (k == (maxCount - 1)) {
+				break;
+			}
+
+			const dgVector x (contact[selected].m_point.m_x);
+			const dgVector y (contact[selected].m_point.m_y);
+			const dgVector z (contact[selected].m_point.m_z);
+			dgVector maxDist2 (dgFloat32 (-1.0f));
+			for (dgInt32 i = 0; i < batches; i ++) {
+				const dgVector dx (px[i] - x);
+				const dgVector dy (py[i] - y);
+				const dgVector dz (pz[i] - z);
+				minDist2[i] = minDist2[i].GetMin(dx * dx + dy * dy + dz * dz);
+				maxDist2 = maxDist2.GetMax(minDist2[i]);
 			}
-			window *= dgFloat32(2.0f);
-			window2 = window * window;
 
-		} while (countOver);
+			const dgVector farthestDist2 (maxDist2.GetMax());
+			for (dgInt32 i = 0; i < batches; i ++) {
+				const dgInt32 signMask = (minDist2[i] == farthestDist2).GetSignMask();
+				if (signMask) {
+					selected = i * 4 + ((signMask & 1) ? 0 : (signMask & 2) ? 1 : (signMask & 4) ? 2 : 3);
+					break;
+				}
+			}
+			dgAssert (!mask[selected]);
+		}
 
 		dgInt32 j = 0;
 		for (dgInt32 i = 0; i < count; i ++) {
-			if (!mask[i]) {
+			if (mask[i]) {
 				contact[j] = contact[i];
 				j ++;
 			}
 		}
 		dgAssert (j == maxCount);
+		count = maxCount;
 	}
 
-	return maxCount;
+	return count;
 }
 
 
 dgInt32 dgWorld::PruneContacts (dgInt32 count, dgContactPoint* const contactPointArray, dgFloat32 distTolerenace, dgInt32 maxCount) const
 {
 	if (count > 1) {
+		dgAssert (count <= DG_MAX_CONTATCS);
+		dgVector px[DG_MAX_CONTATCS / 4];
+		dgVector py[DG_MAX_CONTATCS / 4];
+		dgVector pz[DG_MAX_CONTATCS / 4];
 		dgUnsigned8 mask[DG_MAX_CONTATCS];
 
-		dgInt32 index = 0;
 		dgInt32 packContacts = 0;
+		const dgVector window2 (distTolerenace * distTolerenace);
+		const dgInt32 batches = dgGetContactPointsSoa (count, contactPointArray, px, py, pz);
 
-		dgFloat32 window = distTolerenace;
-		dgFloat32 window2 = window * window;
-
+		// points closer than the tolerance are merged into the deepest one, distances to the 
+		// point are tested four points at the time
 		memset (mask, 0, size_t (count));
-		dgSort (contactPointArray, count, CompareContact, NULL);
-
 		for (dgInt32 i = 0; i < count; i ++) {
 			if (!mask[i]) {
-				dgFloat32 val = contactPointArray[i].m_point[index] + window;
-				for (dgInt32 j = i + 1; (j < count) && (contactPointArray[j].m_point[index] < val) ; j ++) {
-					if (!mask[j]) {
-						dgVector dp (contactPointArray[j].m_point - contactPointArray[i].m_point);
-						dgFloat32 dist2 = dp.DotProduct3(dp);
-						if (dist2 < window2) {
-							if (contactPointArray[i].m_penetration < contactPointArray[j].m_penetration ) {
-								contactPointArray[i].m_point = contactPointArray[j].m_point;
-								contactPointArray[i].m_normal = contactPointArray[j].m_normal;
-								contactPointArray[i].m_penetration =contactPointArray[j].m_penetration;
+				const dgVector x (px[i >> 2][i & 3]);
+				const dgVector y (py[i >> 2][i & 3]);
+				const dgVector z (pz[i >> 2][i & 3]);
+				for (dgInt32 j = i >> 2; j < batches; j ++) {
+					const dgVector dx (px[j] - x);
+					const dgVector dy (py[j] - y);
+					const dgVector dz (pz[j] - z);
+					const dgInt32 closeMask = ((dx * dx + dy * dy + dz * dz) < window2).GetSignMask();
+					if (closeMask) {
+						for (dgInt32 k = 0; k < 4; k ++) {
+							const dgInt32 index = j * 4 + k;
+							if ((closeMask & (1 << k)) && (index > i) && !mask[index]) {
+								if (contactPointArray[i].m_penetration < contactPointArray[index].m_penetration) {
+									contactPointArray[i].m_point = contactPointArray[index].m_point;
+									contactPointArray[i].m_normal = contactPointArray[index].m_normal;
+									contactPointArray[i].m_penetration = contactPointArray[index].m_penetration;
+								}
+								mask[index] = 1;
+								packContacts = 1;
 							}
-							mask[j] = 1;
-							packContacts = 1;
 						}
 					}
 				}
@@ -659,7 +716,7 @@ dgInt32 dgWorld::PruneContacts (dgInt32 count, dgContactPoint* const contactPoin
 		}
 
 		if (count > maxCount) {
-			count = ReduceContacts (count, contactPointArray, maxCount, window * dgFloat32 (2.0f), 1);
+			count = ReduceContacts (count, contactPointArray, maxCount);
 		}
 	}
 	return count;
@@ -888,6 +945,9 @@ void dgWorld::PopulateContacts (dgBroadPhase::dgPair* const pair, dgInt32 thread
 		//contactMaterial.m_override1Accel = false;
 		//contactMaterial.m_overrideNormalAccel = false;
 		contactMaterial->m_flags = dgContactMaterial::m_collisionEnable | (material->m_flags & (dgContactMaterial::m_friction0Enable | dgContactMaterial::m_friction1Enable));
+		if (pair->m_isSpeculative) {
+			contactMaterial->m_flags |= dgContactMaterial::m_speculativeContact;
+		}
 		contactMaterial->m_userData = material->m_userData;
 
 		if (staticMotion) {
@@ -1019,7 +1079,7 @@ void dgWorld::CompoundContacts (dgBroadPhase::dgPair* const pair, dgCollisionPar
 	compound->CalculateContacts (pair, proxy);
 	if (pair->m_contactCount) {
 		// prune close contacts
-		pair->m_contactCount = PruneContacts (pair->m_contactCount, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance());
+		pair->m_contactCount = PruneContacts (pair->m_contactCount, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance(), proxy.m_contactJoint->GetMaterial()->m_maxContactCount);
 	}
 
 //	if (pair->m_contactCount > 8) {
@@ -1047,7 +1107,7 @@ void dgWorld::SceneChildContacts (dgBroadPhase::dgPair* const pair, dgCollisionP
 
 	proxy.m_contacts = savedBuffer;
 	if (pair->m_contactCount > (DG_MAX_CONTATCS - 2 * (DG_CONSTRAINT_MAX_ROWS / 3))) {
-		pair->m_contactCount = dgInt16 (ReduceContacts (pair->m_contactCount, proxy.m_contacts, DG_CONSTRAINT_MAX_ROWS / 3, proxy.m_contactJoint->GetPruningTolerance()));
+		pair->m_contactCount = dgInt16 (ReduceContacts (pair->m_contactCount, proxy.m_contacts, DG_CONSTRAINT_MAX_ROWS / 3));
 	}
 }
 
@@ -1074,7 +1134,7 @@ void dgWorld::SceneContacts (dgBroadPhase::dgPair* const pair, dgCollisionParamP
 		scene->CollidePair (pair, proxy);
 		if (pair->m_contactCount > 0) {
 			// prune close contacts
-			pair->m_contactCount = dgInt16 (PruneContacts (pair->m_contactCount, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance()));
+			pair->m_contactCount = dgInt16 (PruneContacts (pair->m_contactCount, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance(), proxy.m_contactJoint->GetMaterial()->m_maxContactCount));
 		}
 	} else if (otherInstance->IsType (dgCollision::dgCollisionCompound_RTTI) & ~otherInstance->IsType (dgCollision::dgCollisionScene_RTTI)) {
 		proxy.m_body0 = otherBody;
@@ -1086,7 +1146,7 @@ void dgWorld::SceneContacts (dgBroadPhase::dgPair* const pair, dgCollisionParamP
 		scene->CollideCompoundPair (pair, proxy);
 		if (pair->m_contactCount > 0) {
 			// prune close contacts
-			pair->m_contactCount = dgInt16 (PruneContacts (pair->m_contactCount, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance()));
+			pair->m_contactCount = dgInt16 (PruneContacts (pair->m_contactCount, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance(), proxy.m_contactJoint->GetMaterial()->m_maxContactCount));
 		}
 	} else {
 		dgAssert (0);
@@ -1331,7 +1391,7 @@ dgInt32 dgWorld::Collide (
 
 	count = pair.m_contactCount;
 	if (count > maxContacts) {
-		count = ReduceContacts (count, contacts, maxContacts, contactJoint.GetPruningTolerance());
+		count = ReduceContacts (count, contacts, maxContacts);
 		count = dgMin (count, maxContacts);
 	}
 
@@ -1631,7 +1691,7 @@ dgInt32 dgWorld::CalculateConvexToNonConvexContacts(dgCollisionParamProxy& proxy
 
 			if (count > 0) {
 				proxy.m_contactJoint->m_contactActive = 1;
-				count = PruneContacts(count, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance());
+				count = PruneContacts(count, proxy.m_contacts, proxy.m_contactJoint->GetPruningTolerance(), proxy.m_contactJoint->GetMaterial()->m_maxContactCount);
 			}
 		}
 
@@ -1721,7 +1781,14 @@ dgInt32 dgWorld::CalculatePolySoupToHullContactsDescrete (dgCollisionParamProxy&
 	dgInt32* const indexArray = (dgInt32*)data.m_faceVertexIndex;
 	data.SortFaceArray();
 
-	for (dgInt32 i = data.m_faceCount - 1; (i >= 0) && (count < 32); i --) {
+	// the culled faces are too big for the stack, use the per thread arrays
+	dgAssert (proxy.m_threadIndex < DG_MAX_THREADS_HIVE_COUNT);
+	dgInt32* const faceArray = (dgInt32*)&m_culledFacesMemory[proxy.m_threadIndex][0];
+	dgVector* const facePlanes = (dgVector*)&m_culledFacePlanesMemory[proxy.m_threadIndex][0];
+	const dgInt32 faceCount = CullPolySoupFaces (proxy, polygon, polySoupInstance, polySoupScaledMatrix, faceArray, facePlanes, closestDist);
+
+	for (dgInt32 k = faceCount - 1; (k >= 0) && (count < 32); k --) {
+		const dgInt32 i = faceArray[k];
 		dgInt32 address = data.m_faceIndexStart[i];
 		const dgInt32* const localIndexArray = &indexArray[address];
 		polygon.m_vertexIndex = localIndexArray;
@@ -1730,7 +1797,7 @@ dgInt32 dgWorld::CalculatePolySoupToHullContactsDescrete (dgCollisionParamProxy&
 		polygon.m_faceId = data.GetFaceId (localIndexArray, polygon.m_count);
 		polygon.m_faceClipSize = data.GetFaceSize (localIndexArray, polygon.m_count);
 		polygon.m_faceNormalIndex = data.GetNormalIndex (localIndexArray, polygon.m_count);
-		polygon.m_normal = polygon.CalculateGlobalNormal (polySoupInstance, dgVector (&vertex[polygon.m_faceNormalIndex * stride]));
+		polygon.m_normal = facePlanes[k] & dgVector::m_triplexMask;
 		dgAssert (polygon.m_normal.m_w == dgFloat32 (0.0f));
 		for (dgInt32 j = 0; j < polygon.m_count; j++) {
 			polygon.m_localPoly[j] = polySoupScaledMatrix.TransformVector(dgVector(&vertex[localIndexArray[j] * stride]));
@@ -1746,7 +1813,7 @@ dgInt32 dgWorld::CalculatePolySoupToHullContactsDescrete (dgCollisionParamProxy&
 			countleft -= count1;
 			dgAssert (countleft >= 0); 
 			if (count >= maxReduceLimit) {
-				count = ReduceContacts (count, contactOut, maxReduceLimit >> 1, dgFloat32 (1.0e-2f));
+				count = ReduceContacts (count, contactOut, maxReduceLimit >> 1);
 				countleft = maxContacts - count;
 				dgAssert (countleft >= 0); 
 				proxy.m_maxContacts = countleft;
@@ -1810,6 +1877,84 @@ dgInt32 dgWorld::CalculatePolySoupToHullContactsDescrete (dgCollisionParamProxy&
 	return count;
 }
 
+// test the box enclosing the hull against the planes of four faces at the time, faces with the 
+// hull all in front or all behind can not generate contacts and are removed from the list.
+// the surviving faces are returned in the same order with their global planes.
+dgInt32 dgWorld::CullPolySoupFaces (const dgCollisionParamProxy& proxy, const dgCollisionConvexPolygon& polygon, const dgCollisionInstance* const polySoupInstance, const dgMatrix& polySoupScaledMatrix, dgInt32* const faceArray, dgVector* const facePlanes, dgFloat32& closestDist) const
+{
+	const dgCollisionInstance* const hull = proxy.m_instance0;
+	const dgPolygonMeshDesc& data = *proxy.m_polyMeshData;
+
+	const dgInt32 stride = polygon.m_stride;
+	const dgFloat32* const vertex = polygon.m_vertex;
+	const dgInt32* const indexArray = (dgInt32*)data.m_faceVertexIndex;
+
+	dgVector boxSize;
+	dgVector boxOrigin;
+	hull->CalcObb(boxOrigin, boxSize);
+	const dgMatrix& hullMatrix = hull->m_globalMatrix;
+	const dgVector origin (hullMatrix.TransformVector(boxOrigin & dgVector::m_triplexMask));
+	const dgVector axis0 (hullMatrix.m_front.Scale4(boxSize.m_x));
+	const dgVector axis1 (hullMatrix.m_up.Scale4(boxSize.m_y));
+	const dgVector axis2 (hullMatrix.m_right.Scale4(boxSize.m_z));
+
+	const dgVector originX (origin.m_x);
+	const dgVector originY (origin.m_y);
+	const dgVector originZ (origin.m_z);
+	const dgVector axis0X (axis0.m_x);
+	const dgVector axis0Y (axis0.m_y);
+	const dgVector axis0Z (axis0.m_z);
+	const dgVector axis1X (axis1.m_x);
+	const dgVector axis1Y (axis1.m_y);
+	const dgVector axis1Z (axis1.m_z);
+	const dgVector axis2X (axis2.m_x);
+	const dgVector axis2Y (axis2.m_y);
+	const dgVector axis2Z (axis2.m_z);
+	const dgVector skinThickness (proxy.m_skinThickness + dgFloat32 (1.0e-5f));
+
+	dgInt32 count = 0;
+	const dgInt32 faceCount = data.m_faceCount;
+	for (dgInt32 i = 0; i < faceCount; i += 4) {
+		dgVector planes[4];
+		for (dgInt32 j = 0; j < 4; j ++) {
+			const dgInt32 face = dgMin (i + j, faceCount - 1);
+			const dgInt32* const localIndexArray = &indexArray[data.m_faceIndexStart[face]];
+			const dgInt32 normalIndex = data.GetNormalIndex (localIndexArray, data.m_faceIndexCount[face]);
+			const dgVector normal (polygon.CalculateGlobalNormal (polySoupInstance, dgVector (&vertex[normalIndex * stride]) & dgVector::m_triplexMask));
+			const dgVector point (polySoupScaledMatrix.TransformVector(dgVector(&vertex[localIndexArray[0] * stride]) & dgVector::m_triplexMask));
+			planes[j] = normal;
+			planes[j].m_w = -normal.DotProduct3(point);
+		}
+
+		dgVector normalX;
+		dgVector normalY;
+		dgVector normalZ;
+		dgVector planeDist;
+		dgVector::Transpose4x4 (normalX, normalY, normalZ, planeDist, planes[0], planes[1], planes[2], planes[3]);
+
+		const dgVector centerDist (normalX * originX + normalY * originY + normalZ * originZ + planeDist);
+		const dgVector radius ((normalX * axis0X + normalY * axis0Y + normalZ * axis0Z).Abs() + 
+							   (normalX * axis1X + normalY * axis1Y + normalZ * axis1Z).Abs() + 
+							   (normalX * axis2X + normalY * axis2Y + normalZ * axis2Z).Abs());
+
+		const dgInt32 frontMask = (skinThickness < (centerDist - radius)).GetSignMask();
+		const dgInt32 backMask = (dgVector::m_zero >= (centerDist + radius)).GetSignMask();
+
+		const dgInt32 batchCount = dgMin (4, faceCount - i);
+		for (dgInt32 j = 0; j < batchCount; j ++) {
+			if (backMask & (1 << j)) {
+				// the hull is all behind the face, the polygon test reports these as touching
+				closestDist = dgFloat32 (0.0f);
+			} else if (!(frontMask & (1 << j))) {
+				faceArray[count] = i + j;
+				facePlanes[count] = planes[j];
+				count ++;
+			}
+		}
+	}
+	return count;
+}
+
 dgInt32 dgWorld::CalculateConvexToNonConvexContactsContinue(dgCollisionParamProxy& proxy) const
 {
 	dgAssert(proxy.m_instance1->IsType(dgCollision::dgCollisionMesh_RTTI));
@@ -1900,7 +2045,7 @@ dgInt32 dgWorld::CalculateConvexToNonConvexContactsContinue(dgCollisionParamProx
 			countleft -= count1;
 			dgAssert(countleft >= 0);
 			if (count >= maxReduceLimit) {
-				count = ReduceContacts(count, contactOut, maxReduceLimit >> 1, dgFloat32(1.0e-2f));
+				count = ReduceContacts(count, contactOut, maxReduceLimit >> 1);
 				countleft = maxContacts - count;
 				dgAssert(countleft >= 0);
 			}
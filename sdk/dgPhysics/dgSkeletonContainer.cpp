@@ -35,6 +35,21 @@ class dgSkeletonContainer::dgNodePair
 	dgInt32 m_m1;
 };
 
+class dgSkeletonContainer::dgBodyRowPair
+{
+	public:
+	dgInt32 m_body;
+	dgInt32 m_row;
+	dgInt32 m_side;
+};
+
+class dgSkeletonContainer::dgSparseRowInfo
+{
+	public:
+	dgInt32 m_normalIndex;
+	dgInt32 m_isTreeRow;
+};
+
 DG_MSC_VECTOR_ALIGMENT
 class dgSkeletonContainer::dgForcePair
 {
@@ -383,8 +398,9 @@ dgSkeletonContainer::dgSkeletonContainer(dgWorld* const world, dgDynamicBody* co
 	,m_rightHandSide(NULL)
 	,m_leftHandSide(NULL)
 	,m_matrixRowsIndex(NULL)
+	,m_rowInfo(NULL)
 	,m_loopingJoints(world->GetAllocator())
-	,m_auxiliaryMemoryBuffer(world->GetAllocator())
+	,m_sparseSolver(world->GetAllocator())
 	,m_id(m_uniqueID)
 	,m_lru(0)
 	,m_nodeCount(1)
@@ -393,6 +409,9 @@ dgSkeletonContainer::dgSkeletonContainer(dgWorld* const world, dgDynamicBody* co
 	,m_rowCount(0)
 	,m_loopRowCount(0)
 	,m_auxiliaryRowCount(0)
+	,m_freeRowCount(0)
+	,m_boundedRowCount(0)
+	,m_useSparseSolver(false)
 {
 	if (rootBody->GetInvMass().m_w != dgFloat32 (0.0f)) {
 		rootBody->SetSkeleton(this);
@@ -680,10 +699,46 @@ DG_INLINE void dgSkeletonContainer::CalculateLoopMassMatrixCoefficients(dgFloat3
 }
 
 
-void dgSkeletonContainer::InitLoopMassMatrix(const dgJointInfo* const jointInfoArray)
+DG_INLINE void dgSkeletonContainer::CalculateSchurComplement(dgInt32 primaryCount, dgInt32 auxiliaryCount, dgFloat32* const diagDamp)
+{
+	dgInt16* const indexList = dgAlloca(dgInt16, primaryCount);
+	for (dgInt32 i = 0; i < auxiliaryCount; i++) {
+		const dgFloat32* const matrixRow10 = &m_massMatrix10[i * primaryCount];
+		const dgFloat32* const deltaForcePtr = &m_deltaForce[i * primaryCount];
+		dgFloat32* const matrixRow11 = &m_massMatrix11[i * auxiliaryCount];
+
+		dgInt32 indexCount = 0;
+		for (dgInt32 k = 0; k < primaryCount; k++) {
+			indexList[indexCount] = dgInt16(k);
+			indexCount += (matrixRow10[k] != dgFloat32(0.0f)) ? 1 : 0;
+		}
+
+		dgFloat32 diagonal = matrixRow11[i];
+		for (dgInt32 k = 0; k < indexCount; k++) {
+			dgInt32 index = indexList[k];
+			diagonal += matrixRow10[index] * deltaForcePtr[index];
+		}
+		matrixRow11[i] = dgMax(diagonal, diagDamp[i]);
+
+		for (dgInt32 j = i + 1; j < auxiliaryCount; j++) {
+			dgFloat32 offDiagonal = matrixRow11[j];
+			const dgFloat32* const row10 = &m_deltaForce[j * primaryCount];
+			for (dgInt32 k = 0; k < indexCount; k++) {
+				dgInt32 index = indexList[k];
+				offDiagonal += matrixRow10[index] * row10[index];
+			}
+			matrixRow11[j] = offDiagonal;
+			m_massMatrix11[j * auxiliaryCount + i] = offDiagonal;
+		}
+	}
+
+	dgCholeskyApplyRegularizer(auxiliaryCount, m_massMatrix11, diagDamp);
+}
+
+
+void dgSkeletonContainer::InitLoopMassMatrix(const dgJointInfo* const jointInfoArray, dgInt8* const memoryBuffer)
 {
 	const dgInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
-	dgInt8* const memoryBuffer = CalculateBufferSizeInBytes(jointInfoArray);
 
 	m_matrixRowsIndex = (dgInt32*)memoryBuffer;
 	m_pairs = (dgNodePair*)&m_matrixRowsIndex[m_rowCount];
@@ -793,40 +848,219 @@ void dgSkeletonContainer::InitLoopMassMatrix(const dgJointInfo* const jointInfoA
 		}
 	}
 
-	dgInt16* const indexList = dgAlloca(dgInt16, primaryCount);
-	for (dgInt32 i = 0; i < m_auxiliaryRowCount; i++) {
-		const dgFloat32* const matrixRow10 = &m_massMatrix10[i * primaryCount];
-		const dgFloat32* const deltaForcePtr = &m_deltaForce[i * primaryCount];
-		dgFloat32* const matrixRow11 = &m_massMatrix11[i * m_auxiliaryRowCount];
+	CalculateSchurComplement(primaryCount, m_auxiliaryRowCount, diagDamp);
+}
 
-		dgInt32 indexCount = 0;
-		for (dgInt32 k = 0; k < primaryCount; k++) {
-			indexList[indexCount] = dgInt16(k);
-			indexCount += (matrixRow10[k] != dgFloat32(0.0f)) ? 1 : 0;
+
+dgInt32 dgSkeletonContainer::CompareBodyRowPairs(const dgBodyRowPair* const pairA, const dgBodyRowPair* const pairB, void* const context)
+{
+	if (pairA->m_body < pairB->m_body) {
+		return -1;
+	} else if (pairA->m_body > pairB->m_body) {
+		return 1;
+	} else if (pairA->m_row < pairB->m_row) {
+		return -1;
+	} else if (pairA->m_row > pairB->m_row) {
+		return 1;
+	}
+	return 0;
+}
+
+dgInt32 dgSkeletonContainer::CalculateSparseBufferSizeInBytes(const dgJointInfo* const jointInfoArray)
+{
+	dgInt32 freeLoopRowCount = 0;
+	for (dgInt32 j = 0; j < m_loopCount; j++) {
+		const dgConstraint* const joint = m_loopingJoints[j];
+		const dgJointInfo* const jointInfo = &jointInfoArray[joint->m_index];
+		const dgInt32 first = jointInfo->m_pairStart;
+		for (dgInt32 i = 0; i < jointInfo->m_pairCount; i++) {
+			const dgRightHandSide* const rhs = &m_rightHandSide[first + i];
+			if ((rhs->m_lowerBoundFrictionCoefficent <= dgFloat32(-DG_LCP_MAX_VALUE)) && (rhs->m_upperBoundFrictionCoefficent >= dgFloat32(DG_LCP_MAX_VALUE))) {
+				freeLoopRowCount++;
+			}
 		}
+	}
 
-		dgFloat32 diagonal = matrixRow11[i];
-		for (dgInt32 k = 0; k < indexCount; k++) {
-			dgInt32 index = indexList[k];
-			diagonal += matrixRow10[index] * deltaForcePtr[index];
+	const dgInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
+	const dgInt32 freeCount = primaryCount + freeLoopRowCount;
+	const dgInt32 boundedCount = m_rowCount - freeCount;
+	m_freeRowCount = dgInt16(freeCount);
+	m_boundedRowCount = dgInt16(boundedCount);
+
+	dgInt32 size = sizeof(dgInt32) * m_rowCount;
+	size += sizeof(dgNodePair) * m_rowCount;
+	size += sizeof(dgSparseRowInfo) * m_rowCount;
+	size += sizeof(dgBodyRowPair) * m_rowCount * 2;
+	size += sizeof(dgFloat32) * boundedCount * boundedCount;
+	size += sizeof(dgFloat32) * boundedCount * freeCount * 2;
+	return (size + 1024) & -0x10;
+}
+
+bool dgSkeletonContainer::InitSparseMassMatrix(const dgJointInfo* const jointInfoArray, dgInt8* const memoryBuffer)
+{
+	// the unbounded rows, tree primary rows and bilateral loop rows, are placed first and form a sparse matrix
+	// that is factorized with a fill reducing ordering. the bounded rows are coupled to them by a dense
+	// Schur complement that is solved with the LCP solver, same as the auxiliary rows in the dense path.
+	const dgInt32 freeCount = m_freeRowCount;
+	const dgInt32 boundedCount = m_boundedRowCount;
+
+	m_matrixRowsIndex = (dgInt32*)memoryBuffer;
+	m_pairs = (dgNodePair*)&m_matrixRowsIndex[m_rowCount];
+	m_rowInfo = (dgSparseRowInfo*)&m_pairs[m_rowCount];
+	dgBodyRowPair* const bodyRowPairs = (dgBodyRowPair*)&m_rowInfo[m_rowCount];
+	m_massMatrix11 = (dgFloat32*)&bodyRowPairs[m_rowCount * 2];
+	m_massMatrix10 = &m_massMatrix11[boundedCount * boundedCount];
+	m_deltaForce = &m_massMatrix10[boundedCount * freeCount];
+
+	dgInt32 freeIndex = 0;
+	dgInt32 boundedIndex = freeCount;
+	for (dgInt32 i = 0; i < m_nodeCount - 1; i++) {
+		const dgNode* const node = m_nodesOrder[i];
+		const dgJointInfo* const jointInfo = &jointInfoArray[node->m_joint->m_index];
+		const dgInt32 first = jointInfo->m_pairStart;
+		const dgInt32 primaryDof = node->m_dof;
+		for (dgInt32 j = 0; j < jointInfo->m_pairCount; j++) {
+			dgInt32 row;
+			if (j < primaryDof) {
+				row = freeIndex;
+				freeIndex++;
+			} else {
+				row = boundedIndex;
+				boundedIndex++;
+			}
+			m_pairs[row].m_m0 = jointInfo->m_m0;
+			m_pairs[row].m_m1 = jointInfo->m_m1;
+			m_matrixRowsIndex[row] = first + node->m_sourceJacobianIndex[j];
+			m_rowInfo[row].m_normalIndex = -1;
+			m_rowInfo[row].m_isTreeRow = 1;
 		}
-		matrixRow11[i] = dgMax(diagonal, diagDamp[i]);
+	}
 
-		for (dgInt32 j = i + 1; j < m_auxiliaryRowCount; j++) {
-			dgFloat32 offDiagonal = matrixRow11[j];
-			const dgFloat32* const row10 = &m_deltaForce[j * primaryCount];
-			for (dgInt32 k = 0; k < indexCount; k++) {
-				dgInt32 index = indexList[k];
-				offDiagonal += matrixRow10[index] * row10[index];
+	const dgInt32 loopCount = m_loopCount + m_selfContactCount;
+	for (dgInt32 j = 0; j < loopCount; j++) {
+		const dgConstraint* const joint = m_loopingJoints[j];
+		const dgJointInfo* const jointInfo = &jointInfoArray[joint->m_index];
+		const dgInt32 first = jointInfo->m_pairStart;
+		for (dgInt32 i = 0; i < jointInfo->m_pairCount; i++) {
+			const dgRightHandSide* const rhs = &m_rightHandSide[first + i];
+			dgInt32 row;
+			dgInt32 normalIndex = -1;
+			if (j >= m_loopCount) {
+				row = boundedIndex;
+				boundedIndex++;
+				normalIndex = (rhs->m_normalForceIndex >= 0) ? first + rhs->m_normalForceIndex : -1;
+			} else if ((rhs->m_lowerBoundFrictionCoefficent <= dgFloat32(-DG_LCP_MAX_VALUE)) && (rhs->m_upperBoundFrictionCoefficent >= dgFloat32(DG_LCP_MAX_VALUE))) {
+				row = freeIndex;
+				freeIndex++;
+			} else {
+				row = boundedIndex;
+				boundedIndex++;
 			}
-			matrixRow11[j] = offDiagonal;
-			m_massMatrix11[j * m_auxiliaryRowCount + i] = offDiagonal;
+			m_pairs[row].m_m0 = jointInfo->m_m0;
+			m_pairs[row].m_m1 = jointInfo->m_m1;
+			m_matrixRowsIndex[row] = first + i;
+			m_rowInfo[row].m_normalIndex = normalIndex;
+			m_rowInfo[row].m_isTreeRow = 0;
 		}
 	}
+	dgAssert(freeIndex == freeCount);
+	dgAssert(boundedIndex == m_rowCount);
 
-	dgCholeskyApplyRegularizer(m_auxiliaryRowCount, m_massMatrix11, diagDamp);
-}
+	// group the rows by the bodies they act on, only bodies with mass contribute to the matrix
+	dgInt32 pairCount = 0;
+	for (dgInt32 i = 0; i < m_rowCount; i++) {
+		const dgLeftHandSide* const row = &m_leftHandSide[m_matrixRowsIndex[i]];
+		const dgJacobian& JMinvM0 = row->m_JMinv.m_jacobianM0;
+		const dgJacobian& JMinvM1 = row->m_JMinv.m_jacobianM1;
+		dgVector mag0(JMinvM0.m_linear * JMinvM0.m_linear + JMinvM0.m_angular * JMinvM0.m_angular);
+		dgVector mag1(JMinvM1.m_linear * JMinvM1.m_linear + JMinvM1.m_angular * JMinvM1.m_angular);
+		if (mag0.AddHorizontal().GetScalar() > dgFloat32(0.0f)) {
+			bodyRowPairs[pairCount].m_body = m_pairs[i].m_m0;
+			bodyRowPairs[pairCount].m_row = i;
+			bodyRowPairs[pairCount].m_side = 0;
+			pairCount++;
+		}
+		if (mag1.AddHorizontal().GetScalar() > dgFloat32(0.0f)) {
+			bodyRowPairs[pairCount].m_body = m_pairs[i].m_m1;
+			bodyRowPairs[pairCount].m_row = i;
+			bodyRowPairs[pairCount].m_side = 1;
+			pairCount++;
+		}
+	}
+	dgSort(bodyRowPairs, pairCount, CompareBodyRowPairs);
+
+	memset(m_massMatrix10, 0, boundedCount * freeCount * sizeof(dgFloat32));
+	memset(m_massMatrix11, 0, boundedCount * boundedCount * sizeof(dgFloat32));
+
+	m_sparseSolver.BeginMatrix(freeCount);
+	for (dgInt32 i = 0; i < pairCount; ) {
+		dgInt32 end = i + 1;
+		for (; (end < pairCount) && (bodyRowPairs[end].m_body == bodyRowPairs[i].m_body); end++);
+
+		for (dgInt32 j = i; j < end; j++) {
+			const dgInt32 row_j = bodyRowPairs[j].m_row;
+			const dgLeftHandSide* const lhs_j = &m_leftHandSide[m_matrixRowsIndex[row_j]];
+			const dgJacobian& JMinv = bodyRowPairs[j].m_side ? lhs_j->m_JMinv.m_jacobianM1 : lhs_j->m_JMinv.m_jacobianM0;
+			for (dgInt32 k = j; k < end; k++) {
+				// pairs are sorted by row, so row_k is never smaller than row_j
+				const dgInt32 row_k = bodyRowPairs[k].m_row;
+				const dgLeftHandSide* const lhs_k = &m_leftHandSide[m_matrixRowsIndex[row_k]];
+				const dgJacobian& Jt = bodyRowPairs[k].m_side ? lhs_k->m_Jt.m_jacobianM1 : lhs_k->m_Jt.m_jacobianM0;
+				dgVector acc(JMinv.m_linear * Jt.m_linear + JMinv.m_angular * Jt.m_angular);
+				const dgFloat32 value = acc.AddHorizontal().GetScalar();
+				if (row_k < freeCount) {
+					m_sparseSolver.AddEntry(row_k, row_j, value);
+				} else if (row_j < freeCount) {
+					m_massMatrix10[(row_k - freeCount) * freeCount + row_j] += value;
+				} else {
+					const dgInt32 index_j = row_j - freeCount;
+					const dgInt32 index_k = row_k - freeCount;
+					m_massMatrix11[index_j * boundedCount + index_k] += value;
+					if (index_j != index_k) {
+						m_massMatrix11[index_k * boundedCount + index_j] += value;
+					}
+				}
+			}
+		}
+		i = end;
+	}
+
+	// tree primary rows use the same regularizer as the tree factorization, all other rows are doubled.
+	for (dgInt32 i = 0; i < freeCount; i++) {
+		const dgRightHandSide* const rhs = &m_rightHandSide[m_matrixRowsIndex[i]];
+		const dgFloat32 diagDamp = m_rowInfo[i].m_isTreeRow ? rhs->m_diagDamp : rhs->m_diagDamp * dgFloat32(2.0f);
+		m_sparseSolver.AddEntry(i, i, diagDamp);
+	}
+	m_sparseSolver.EndMatrix();
+
+	dgFloat32* const regularizer = dgAlloca(dgFloat32, freeCount);
+	for (dgInt32 i = 0; i < freeCount; i++) {
+		regularizer[i] = m_sparseSolver.GetDiagonal(i) * (DG_PSD_DAMP_TOL * dgFloat32(4.0f));
+	}
+	if (!m_sparseSolver.FactorizeWithRegularizer(regularizer)) {
+		return false;
+	}
 
+	if (boundedCount) {
+		dgFloat32* const diagDamp = dgAlloca(dgFloat32, boundedCount);
+		for (dgInt32 i = 0; i < boundedCount; i++) {
+			const dgRightHandSide* const rhs = &m_rightHandSide[m_matrixRowsIndex[freeCount + i]];
+			dgFloat32* const matrixRow11 = &m_massMatrix11[i * boundedCount];
+			matrixRow11[i] += rhs->m_diagDamp * dgFloat32(2.0f);
+			diagDamp[i] = matrixRow11[i] * (DG_PSD_DAMP_TOL * dgFloat32(4.0f));
+
+			const dgFloat32* const matrixRow10 = &m_massMatrix10[i * freeCount];
+			dgFloat32* const deltaForce = &m_deltaForce[i * freeCount];
+			memcpy(deltaForce, matrixRow10, freeCount * sizeof(dgFloat32));
+			m_sparseSolver.Solve(deltaForce);
+			for (dgInt32 j = 0; j < freeCount; j++) {
+				deltaForce[j] = -deltaForce[j];
+			}
+		}
+		CalculateSchurComplement(freeCount, boundedCount, diagDamp);
+	}
+	return true;
+}
 
 bool dgSkeletonContainer::SanityCheck(const dgForcePair* const force, const dgForcePair* const accel) const
 {
@@ -968,6 +1202,24 @@ DG_INLINE void dgSkeletonContainer::CalculateJointAccel(dgJointInfo* const joint
 }
 
 
+DG_INLINE void dgSkeletonContainer::ApplyRowForces(dgJacobian* const internalForces, const dgFloat32* const force) const
+{
+	for (dgInt32 i = 0; i < m_rowCount; i++) {
+		dgInt32 index = m_matrixRowsIndex[i];
+		dgRightHandSide* const rhs = &m_rightHandSide[index];
+		const dgLeftHandSide* const row = &m_leftHandSide[index];
+		const dgInt32 m0 = m_pairs[i].m_m0;
+		const dgInt32 m1 = m_pairs[i].m_m1;
+
+		rhs->m_force += force[i];
+		dgVector jointForce(force[i]);
+		internalForces[m0].m_linear += row->m_Jt.m_jacobianM0.m_linear * jointForce;
+		internalForces[m0].m_angular += row->m_Jt.m_jacobianM0.m_angular * jointForce;
+		internalForces[m1].m_linear += row->m_Jt.m_jacobianM1.m_linear * jointForce;
+		internalForces[m1].m_angular += row->m_Jt.m_jacobianM1.m_angular * jointForce;
+	}
+}
+
 void dgSkeletonContainer::SolveAuxiliary(const dgJointInfo* const jointInfoArray, dgJacobian* const internalForces, const dgForcePair* const accel, dgForcePair* const force) const
 {
 	dgFloat32* const f = dgAlloca(dgFloat32, m_rowCount);
@@ -1100,24 +1352,78 @@ void dgSkeletonContainer::SolveAuxiliary(const dgJointInfo* const jointInfoArray
 		}
 	}
 
+	ApplyRowForces(internalForces, f);
+}
+
+
+void dgSkeletonContainer::SolveSparse(dgJacobian* const internalForces) const
+{
+	const dgInt32 freeCount = m_freeRowCount;
+	const dgInt32 boundedCount = m_boundedRowCount;
+	dgFloat32* const f = dgAlloca(dgFloat32, m_rowCount);
+	dgFloat32* const u = dgAlloca(dgFloat32, boundedCount + 1);
+	dgFloat32* const b = dgAlloca(dgFloat32, boundedCount + 1);
+	dgFloat32* const low = dgAlloca(dgFloat32, boundedCount + 1);
+	dgFloat32* const high = dgAlloca(dgFloat32, boundedCount + 1);
+
 	for (dgInt32 i = 0; i < m_rowCount; i++) {
-		dgInt32 index = m_matrixRowsIndex[i];
-		dgRightHandSide* const rhs = &m_rightHandSide[index];
+		const dgInt32 index = m_matrixRowsIndex[i];
+		const dgRightHandSide* const rhs = &m_rightHandSide[index];
 		const dgLeftHandSide* const row = &m_leftHandSide[index];
-		const dgInt32 m0 = m_pairs[i].m_m0;
-		const dgInt32 m1 = m_pairs[i].m_m1;
+		const dgJacobian& y0 = internalForces[m_pairs[i].m_m0];
+		const dgJacobian& y1 = internalForces[m_pairs[i].m_m1];
+
+		dgVector acc(row->m_JMinv.m_jacobianM0.m_linear * y0.m_linear + row->m_JMinv.m_jacobianM0.m_angular * y0.m_angular +
+					 row->m_JMinv.m_jacobianM1.m_linear * y1.m_linear + row->m_JMinv.m_jacobianM1.m_angular * y1.m_angular);
+		dgFloat32 r = rhs->m_coordenateAccel - acc.AddHorizontal().GetScalar();
+		if (m_rowInfo[i].m_isTreeRow) {
+			r -= rhs->m_force * rhs->m_diagDamp;
+		}
 
-		rhs->m_force += f[i];
-		dgVector jointForce(f[i]);
-		internalForces[m0].m_linear += row->m_Jt.m_jacobianM0.m_linear * jointForce;
-		internalForces[m0].m_angular += row->m_Jt.m_jacobianM0.m_angular * jointForce;
-		internalForces[m1].m_linear += row->m_Jt.m_jacobianM1.m_linear * jointForce;
-		internalForces[m1].m_angular += row->m_Jt.m_jacobianM1.m_angular * jointForce;
+		if (i < freeCount) {
+			f[i] = r;
+		} else {
+			const dgInt32 k = i - freeCount;
+			const dgInt32 normalIndex = m_rowInfo[i].m_normalIndex;
+			const dgFloat32 normalForce = (normalIndex >= 0) ? m_rightHandSide[normalIndex].m_force : dgFloat32(1.0f);
+			f[i] = dgFloat32(0.0f);
+			b[k] = r;
+			low[k] = dgClamp(normalForce * rhs->m_lowerBoundFrictionCoefficent - rhs->m_force, -DG_MAX_BOUND, dgFloat32(0.0f));
+			high[k] = dgClamp(normalForce * rhs->m_upperBoundFrictionCoefficent - rhs->m_force, dgFloat32(0.0f), DG_MAX_BOUND);
+		}
+	}
+
+	m_sparseSolver.Solve(f);
+
+	if (boundedCount) {
+		dgFloat32* const massMatrix11 = dgAlloca(dgFloat32, boundedCount * boundedCount);
+		memcpy(massMatrix11, m_massMatrix11, sizeof(dgFloat32) * boundedCount * boundedCount);
+		for (dgInt32 i = 0; i < boundedCount; i++) {
+			const dgFloat32* const matrixRow10 = &m_massMatrix10[i * freeCount];
+			dgFloat32 r = dgFloat32(0.0f);
+			for (dgInt32 j = 0; j < freeCount; j++) {
+				r += matrixRow10[j] * f[j];
+			}
+			b[i] -= r;
+		}
+
+		dgSolveDantzigLCP(boundedCount, massMatrix11, u, b, low, high);
+
+		for (dgInt32 i = 0; i < boundedCount; i++) {
+			const dgFloat32 s = u[i];
+			f[freeCount + i] = s;
+			const dgFloat32* const deltaForce = &m_deltaForce[i * freeCount];
+			for (dgInt32 j = 0; j < freeCount; j++) {
+				f[j] += deltaForce[j] * s;
+			}
+		}
 	}
+
+	ApplyRowForces(internalForces, f);
 }
 
 
-dgInt8* dgSkeletonContainer::CalculateBufferSizeInBytes (const dgJointInfo* const jointInfoArray)
+dgInt32 dgSkeletonContainer::CalculateBufferSizeInBytes (const dgJointInfo* const jointInfoArray) const
 {
 	dgInt32 rowCount = 0;
 	dgInt32 auxiliaryRowCount = 0;
@@ -1146,13 +1452,11 @@ dgInt8* dgSkeletonContainer::CalculateBufferSizeInBytes (const dgJointInfo* cons
 //	size += sizeof (dgFloat32) * auxiliaryRowCount * auxiliaryRowCount;		// matrixLowerTraingular [auxiliaryRowCount * auxiliaryRowCount]
 	size += sizeof (dgFloat32) * auxiliaryRowCount * (rowCount - auxiliaryRowCount);
 	size += sizeof (dgFloat32) * auxiliaryRowCount * (rowCount - auxiliaryRowCount);
-	size = (size + 1024) & -0x10;
-	m_auxiliaryMemoryBuffer.ResizeIfNecessary((size + 1024) & -0x10);
-	return &m_auxiliaryMemoryBuffer[0];
+	return (size + 1024) & -0x10;
 }
 
 
-void dgSkeletonContainer::InitMassMatrix(const dgJointInfo* const jointInfoArray, const dgLeftHandSide* const leftHandSide, dgRightHandSide* const rightHandSide)
+void dgSkeletonContainer::InitMassMatrix(const dgJointInfo* const jointInfoArray, const dgLeftHandSide* const leftHandSide, dgRightHandSide* const rightHandSide, dgInt32 threadID)
 {
 	dgInt32 rowCount = 0;
 	dgInt32 auxiliaryCount = 0;
@@ -1184,13 +1488,32 @@ void dgSkeletonContainer::InitMassMatrix(const dgJointInfo* const jointInfoArray
 	m_rowCount += m_loopRowCount;
 	m_auxiliaryRowCount += m_loopRowCount;
 
+	m_useSparseSolver = m_loopCount && (m_auxiliaryRowCount >= DG_SKELETON_SPARSE_AUXILIARY_ROWS);
 	if (m_auxiliaryRowCount) {
-		InitLoopMassMatrix(jointInfoArray);
+		dgInt32 size = CalculateBufferSizeInBytes(jointInfoArray);
+		if (m_useSparseSolver) {
+			// a matrix that can not be regularized falls back to the dense path in the same buffer
+			size = dgMax (size, CalculateSparseBufferSizeInBytes(jointInfoArray));
+		}
+		dgInt8* const memoryBuffer = (dgInt8*)m_world->GetFrameAllocator().Alloc(size, threadID);
+		dgAssert (memoryBuffer);
+
+		if (m_useSparseSolver) {
+			m_useSparseSolver = InitSparseMassMatrix(jointInfoArray, memoryBuffer);
+		}
+		if (!m_useSparseSolver) {
+			InitLoopMassMatrix(jointInfoArray, memoryBuffer);
+		}
 	}
 }
 
 void dgSkeletonContainer::CalculateJointForce(dgJointInfo* const jointInfoArray, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces)
 {
+	if (m_useSparseSolver) {
+		SolveSparse(internalForces);
+		return;
+	}
+
 	dgForcePair* const force = dgAlloca(dgForcePair, m_nodeCount);
 	dgForcePair* const accel = dgAlloca(dgForcePair, m_nodeCount);
 
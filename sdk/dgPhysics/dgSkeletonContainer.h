@@ -24,6 +24,9 @@
 
 #define DG_SKELETON_BASE_UNIQUE_ID	10
 
+// skeletons with this many auxiliary rows and closed loops are solved with a sparse factorization
+#define DG_SKELETON_SPARSE_AUXILIARY_ROWS	48
+
 #include "dgConstraint.h"
 #include "dgContact.h"
 #include "dgBilateralConstraint.h"
@@ -37,6 +40,8 @@ class dgSkeletonContainer
 	class dgNodePair;
 	class dgForcePair;
 	class dgMatriData;
+	class dgBodyRowPair;
+	class dgSparseRowInfo;
 	class dgBodyJointMatrixDataPair;
 
 	DG_CLASS_ALLOCATOR(allocator)
@@ -69,15 +74,21 @@ class dgSkeletonContainer
 	DG_INLINE void CalculateJointAccel (dgJointInfo* const jointInfoArray, const dgJacobian* const internalForces, dgForcePair* const accel) const;
 
 	DG_INLINE void CalculateLoopMassMatrixCoefficients(dgFloat32* const diagDamp);
+	DG_INLINE void CalculateSchurComplement(dgInt32 primaryCount, dgInt32 auxiliaryCount, dgFloat32* const diagDamp);
+	DG_INLINE void ApplyRowForces(dgJacobian* const internalForces, const dgFloat32* const force) const;
+	static dgInt32 CompareBodyRowPairs(const dgBodyRowPair* const pairA, const dgBodyRowPair* const pairB, void* const context);
 	static void ResetUniqueId(dgInt32 id);
 
 	dgNode* FindNode(dgDynamicBody* const node) const;
 	void SortGraph(dgNode* const root, dgInt32& index);
 		
-	void InitLoopMassMatrix (const dgJointInfo* const jointInfoArray);
-	dgInt8* CalculateBufferSizeInBytes (const dgJointInfo* const jointInfoArray);
-	void InitMassMatrix (const dgJointInfo* const jointInfoArray, const dgLeftHandSide* const matrixRow, dgRightHandSide* const rightHandSide);
+	void InitLoopMassMatrix (const dgJointInfo* const jointInfoArray, dgInt8* const memoryBuffer);
+	bool InitSparseMassMatrix (const dgJointInfo* const jointInfoArray, dgInt8* const memoryBuffer);
+	dgInt32 CalculateBufferSizeInBytes (const dgJointInfo* const jointInfoArray) const;
+	dgInt32 CalculateSparseBufferSizeInBytes (const dgJointInfo* const jointInfoArray);
+	void InitMassMatrix (const dgJointInfo* const jointInfoArray, const dgLeftHandSide* const matrixRow, dgRightHandSide* const rightHandSide, dgInt32 threadID);
 	void SolveAuxiliary (const dgJointInfo* const jointInfoArray, dgJacobian* const internalForces, const dgForcePair* const accel, dgForcePair* const force) const;
+	void SolveSparse (dgJacobian* const internalForces) const;
 	void CalculateJointForce (dgJointInfo* const jointInfoArray, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces);
 
 	dgWorld* m_world;
@@ -90,8 +101,9 @@ class dgSkeletonContainer
 	dgRightHandSide* m_rightHandSide;
 	const dgLeftHandSide* m_leftHandSide;
 	dgInt32* m_matrixRowsIndex;
+	dgSparseRowInfo* m_rowInfo;
 	dgArray<dgConstraint*> m_loopingJoints;
-	dgArray<dgInt8> m_auxiliaryMemoryBuffer;
+	dgSparseLDLt m_sparseSolver;
 	dgInt32 m_id;
 	dgInt32 m_lru;
 	dgInt16 m_nodeCount;
@@ -100,6 +112,9 @@ class dgSkeletonContainer
 	dgInt16 m_rowCount;
 	dgInt16 m_loopRowCount;
 	dgInt16 m_auxiliaryRowCount;
+	dgInt16 m_freeRowCount;
+	dgInt16 m_boundedRowCount;
+	bool m_useSparseSolver;
 	static dgInt32 m_uniqueID;
 	static dgInt32 m_lruMarker;
 
@@ -28,6 +28,7 @@
 #include "dgKinematicBody.h"
 #include "dgCollisionNull.h"
 #include "dgCollisionCone.h"
+#include "dgCollisionMesh.h"
 #include "dgCollisionScene.h"
 #include "dgCollisionSphere.h"
 #include "dgInverseDynamics.h"
@@ -38,6 +39,7 @@
 #include "dgWorldDynamicUpdate.h"
 #include "dgCollisionConvexHull.h"
 #include "dgBroadPhasePersistent.h"
+#include "dgBroadPhaseSweepAndPrune.h"
 #include "dgCollisionChamferCylinder.h"
 
 #include "dgUserConstraint.h"
@@ -213,9 +215,8 @@ dgWorld::dgWorld(dgMemoryAllocator* const allocator)
 	,m_bodiesMemory (allocator, 64)
 	,m_jointsMemory (allocator, 64)
 	,m_solverJacobiansMemory (allocator, 64)
-	,m_solverRightHandSideMemory (allocator, 64)
-	,m_solverForceAccumulatorMemory (allocator, 64)
 	,m_clusterMemory (allocator, 64)
+	,m_frameAllocator (allocator)
 	,m_concurrentUpdate(false)
 {
 	dgMutexThread* const myThread = this;
@@ -226,8 +227,14 @@ dgWorld::dgWorld(dgMemoryAllocator* const allocator)
 	m_jointsMemory.Resize(1024 * 32);
 	m_clusterMemory.Resize(1024 * 32);
 	m_solverJacobiansMemory.Resize(1024 * 64);
-	m_solverRightHandSideMemory.Resize(1024 * 64);
-	m_solverForceAccumulatorMemory.Resize(1024 * 32);
+	m_frameAllocator.Reserve(1024 * 128, 0);
+
+	for (dgInt32 i = 0; i < DG_MAX_THREADS_HIVE_COUNT; i ++) {
+		m_culledFacesMemory[i].SetAllocator(allocator);
+		m_culledFacePlanesMemory[i].SetAllocator(allocator);
+		m_culledFacesMemory[i].Resize(DG_MAX_COLLIDING_FACES);
+		m_culledFacePlanesMemory[i].Resize(DG_MAX_COLLIDING_FACES);
+	}
 
 	m_savetimestep = dgFloat32 (0.0f);
 	m_allocator = allocator;
@@ -249,6 +256,8 @@ dgWorld::dgWorld(dgMemoryAllocator* const allocator)
 	m_clusterLRU = 0;
 
 	m_useParallelSolver = 0;
+	m_useSpeculativeContacts = 0;
+	m_useSleepAwareBroadphase = 0;
 
 	m_solverMode = DG_DEFAULT_SOLVER_ITERATION_COUNT;
 	m_dynamicsLru = 0;
@@ -366,7 +375,10 @@ void dgWorld::DestroyAllBodies()
 
 void dgWorld::SetThreadsCount (dgInt32 count)
 {
+	// wait until no tool is using the worker threads
+	dgThreadHive::Acquire();
 	dgThreadHive::SetThreadsCount(count);
+	dgThreadHive::Release();
 }
 
 dgUnsigned32 dgWorld::GetPerformanceCount ()
@@ -409,6 +421,26 @@ dgInt32 dgWorld::GetThreadOnSingleIsland() const
 	return m_useParallelSolver ? 1 : 0;
 }
 
+void dgWorld::EnableSpeculativeContacts(dgInt32 mode)
+{
+	m_useSpeculativeContacts = mode ? 1 : 0;
+}
+
+dgInt32 dgWorld::GetSpeculativeContacts() const
+{
+	return m_useSpeculativeContacts ? 1 : 0;
+}
+
+void dgWorld::EnableSleepAwareBroadphase(dgInt32 mode)
+{
+	m_useSleepAwareBroadphase = mode ? 1 : 0;
+}
+
+dgInt32 dgWorld::GetSleepAwareBroadphase() const
+{
+	return m_useSleepAwareBroadphase ? 1 : 0;
+}
+
 
 void dgWorld::SetFrictionThreshold (dgFloat32 acceleration)
 {
@@ -857,6 +889,91 @@ bool dgWorld::AreBodyConnectedByJoints (dgBody* const originSrc, dgBody* const t
 	return false;
 }
 
+dgInt32 dgWorld::ForEachBodyInIsland (dgBody* const body, OnBodiesInAABB callback, void* const userData)
+{
+	if ((body == m_sentinelBody) || (body->GetInvMass().m_w == dgFloat32 (0.0f))) {
+		return 0;
+	}
+
+	dgStack<dgBody*> queue (GetBodiesCount() + 1);
+
+	m_genericLRUMark ++;
+	body->m_genericLRUMark = m_genericLRUMark;
+
+	dgInt32 end = 1;
+	queue[0] = body;
+	for (dgInt32 start = 0; start < end; start ++) {
+		dgBody* const body0 = queue[start];
+		if (!callback (body0, userData)) {
+			return start + 1;
+		}
+
+		for (dgBodyMasterListRow::dgListNode* jointNode = body0->m_masterNode->GetInfo().GetFirst(); jointNode; jointNode = jointNode->GetNext()) {
+			dgBodyMasterListCell& cell = jointNode->GetInfo();
+			dgBody* const body1 = cell.m_bodyNode;
+			if (body1->m_genericLRUMark != m_genericLRUMark) {
+				if ((body1->GetInvMass().m_w != dgFloat32 (0.0f)) && cell.m_joint->IsActive()) {
+					dgAssert (body1 != m_sentinelBody);
+					dgAssert (end < GetBodiesCount() + 1);
+					body1->m_genericLRUMark = m_genericLRUMark;
+					queue[end] = body1;
+					end ++;
+				}
+			}
+		}
+	}
+	return end;
+}
+
+dgInt32 dgApi dgWorld::SetBodySleepStateCallback (dgBody* body, void* const userData)
+{
+	dgBodyStateChange* const change = (dgBodyStateChange*)userData;
+	if (body->GetInvMass().m_w != dgFloat32 (0.0f)) {
+		body->SetSleepState (change->m_state);
+		change->m_count ++;
+	}
+	return 1;
+}
+
+dgInt32 dgApi dgWorld::SetBodyFreezeStateCallback (dgBody* body, void* const userData)
+{
+	// the flag is set directly, dgBody::SetFreeze would propagate the state past the selected bodies 
+	dgBodyStateChange* const change = (dgBodyStateChange*)userData;
+	if (body->GetInvMass().m_w != dgFloat32 (0.0f)) {
+		body->m_freeze = change->m_state;
+		change->m_count ++;
+	}
+	return 1;
+}
+
+dgInt32 dgWorld::SetIslandSleepState (dgBody* const body, bool state)
+{
+	dgBodyStateChange change (state);
+	ForEachBodyInIsland (body, SetBodySleepStateCallback, &change);
+	return change.m_count;
+}
+
+dgInt32 dgWorld::SetIslandFreezeState (dgBody* const body, bool state)
+{
+	dgBodyStateChange change (state);
+	ForEachBodyInIsland (body, SetBodyFreezeStateCallback, &change);
+	return change.m_count;
+}
+
+dgInt32 dgWorld::SetSleepStateInAABB (const dgVector& minBox, const dgVector& maxBox, bool state)
+{
+	dgBodyStateChange change (state);
+	m_broadPhase->ForEachBodyInAABB (minBox, maxBox, SetBodySleepStateCallback, &change);
+	return change.m_count;
+}
+
+dgInt32 dgWorld::SetFreezeStateInAABB (const dgVector& minBox, const dgVector& maxBox, bool state)
+{
+	dgBodyStateChange change (state);
+	m_broadPhase->ForEachBodyInAABB (minBox, maxBox, SetBodyFreezeStateCallback, &change);
+	return change.m_count;
+}
+
 void dgWorld::FlushCache()
 {
 	// delete all contacts
@@ -887,10 +1004,15 @@ void dgWorld::StepDynamics (dgFloat32 timestep)
 	m_inUpdate ++;
 
 	DG_TRACKTIME(__FUNCTION__);
+	// memory peaks and allocation counts are reported per step
+	m_allocator->ResetMemoryPeaks();
 	UpdateSkeletons();
 	UpdateBroadphase(timestep);
 	UpdateDynamics (timestep);
 
+	// all step temporaries are dead past this point
+	m_frameAllocator.Reset();
+
 	if (m_listeners.GetCount()) {
 		for (dgListenerList::dgListNode* node = m_listeners.GetFirst(); node; node = node->GetNext()) {
 			dgListener& listener = node->GetInfo();
@@ -949,6 +1071,167 @@ void dgWorld::UpdateTransforms(void* const context, void* const nodePtr, dgInt32
 	world->UpdateTransforms(node, threadID);
 }
 
+dgInt32 dgWorld::GetBodiesState (dgBody** const bodies, dgInt32 count, const dgBodyStateArrays& state)
+{
+	return BodiesState (bodies, count, state, false);
+}
+
+dgInt32 dgWorld::SetBodiesState (dgBody** const bodies, dgInt32 count, const dgBodyStateArrays& state)
+{
+	return BodiesState (bodies, count, state, true);
+}
+
+dgInt32 dgWorld::BodiesState (dgBody** const bodies, dgInt32 count, const dgBodyStateArrays& state, bool write)
+{
+	DG_TRACKTIME(__FUNCTION__);
+	const dgBodyMasterList& masterList = *this;
+	dgAssert (masterList.GetFirst()->GetInfo().GetBody() == GetSentinelBody());
+
+	dgBodyStateDescriptor descriptor;
+	descriptor.m_bodies = bodies;
+	descriptor.m_state = &state;
+	descriptor.m_firstNode = masterList.GetFirst()->GetNext();
+	descriptor.m_count = bodies ? count : GetBodiesCount();
+	descriptor.m_index = 0;
+	descriptor.m_threadCount = 1;
+	descriptor.m_write = write;
+
+	const dgInt32 threadsCount = GetThreadCount();
+	if ((threadsCount > 1) && (descriptor.m_count >= DG_BODY_STATE_PARALLEL_COUNT)) {
+		descriptor.m_threadCount = threadsCount;
+		for (dgInt32 i = 0; i < threadsCount; i ++) {
+			QueueJob (BodiesStateKernel, &descriptor, this, "dgWorld::BodiesState");
+		}
+		SynchronizationBarrier();
+	} else {
+		BodiesStateKernel (&descriptor, this, 0);
+	}
+	return descriptor.m_count;
+}
+
+void dgWorld::BodiesStateKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	DG_TRACKTIME(__FUNCTION__);
+	dgBodyStateDescriptor* const descriptor = (dgBodyStateDescriptor*) context;
+	const dgBodyStateArrays& state = *descriptor->m_state;
+	const bool write = descriptor->m_write;
+
+	if (descriptor->m_bodies) {
+		dgBody** const bodies = descriptor->m_bodies;
+		const dgInt32 count = descriptor->m_count;
+		for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1); i < count; i = dgAtomicExchangeAndAdd(&descriptor->m_index, 1)) {
+			if (write) {
+				SetBodyState (bodies[i], i, state);
+			} else {
+				GetBodyState (bodies[i], i, state);
+			}
+		}
+	} else {
+		// each thread takes every n body in the list, the same as the transform update
+		const dgInt32 threadsCount = descriptor->m_threadCount;
+		dgBodyMasterList::dgListNode* node = descriptor->m_firstNode;
+		for (dgInt32 i = 0; node && (i < threadID); i ++) {
+			node = node->GetNext();
+		}
+		for (dgInt32 index = threadID; node; index += threadsCount) {
+			dgBody* const body = node->GetInfo().GetBody();
+			if (write) {
+				SetBodyState (body, index, state);
+			} else {
+				GetBodyState (body, index, state);
+			}
+			for (dgInt32 i = 0; node && (i < threadsCount); i++) {
+				node = node->GetNext();
+			}
+		}
+	}
+}
+
+void dgWorld::GetBodyState (const dgBody* const body, dgInt32 index, const dgBodyStateArrays& state)
+{
+	if (state.m_matrix) {
+		dgFloat32* const matrix = (dgFloat32*) (((dgInt8*)state.m_matrix) + index * state.m_matrixStrideInBytes);
+		memcpy (matrix, &body->GetMatrix()[0][0], sizeof (dgMatrix));
+	}
+
+	if (state.m_position) {
+		dgFloat32* const position = (dgFloat32*) (((dgInt8*)state.m_position) + index * state.m_positionStrideInBytes);
+		const dgVector& posit = body->GetPosition();
+		position[0] = posit.m_x;
+		position[1] = posit.m_y;
+		position[2] = posit.m_z;
+	}
+
+	if (state.m_rotation) {
+		dgFloat32* const rotation = (dgFloat32*) (((dgInt8*)state.m_rotation) + index * state.m_rotationStrideInBytes);
+		const dgQuaternion& rot = body->GetRotation();
+		rotation[0] = rot.m_q0;
+		rotation[1] = rot.m_q1;
+		rotation[2] = rot.m_q2;
+		rotation[3] = rot.m_q3;
+	}
+
+	if (state.m_veloc) {
+		dgFloat32* const veloc = (dgFloat32*) (((dgInt8*)state.m_veloc) + index * state.m_velocStrideInBytes);
+		const dgVector& vector = body->GetVelocity();
+		veloc[0] = vector.m_x;
+		veloc[1] = vector.m_y;
+		veloc[2] = vector.m_z;
+	}
+
+	if (state.m_omega) {
+		dgFloat32* const omega = (dgFloat32*) (((dgInt8*)state.m_omega) + index * state.m_omegaStrideInBytes);
+		const dgVector& vector = body->GetOmega();
+		omega[0] = vector.m_x;
+		omega[1] = vector.m_y;
+		omega[2] = vector.m_z;
+	}
+
+	if (state.m_sleepState) {
+		dgInt32* const sleepState = (dgInt32*) (((dgInt8*)state.m_sleepState) + index * state.m_sleepStateStrideInBytes);
+		*sleepState = body->GetSleepState() ? 1 : 0;
+	}
+}
+
+void dgWorld::SetBodyState (dgBody* const body, dgInt32 index, const dgBodyStateArrays& state)
+{
+	if (state.m_matrix) {
+		const dgFloat32* const matrixPtr = (dgFloat32*) (((dgInt8*)state.m_matrix) + index * state.m_matrixStrideInBytes);
+		dgMatrix matrix (matrixPtr);
+		matrix.m_front.m_w = dgFloat32 (0.0f);
+		matrix.m_up.m_w = dgFloat32 (0.0f);
+		matrix.m_right.m_w = dgFloat32 (0.0f);
+		matrix.m_posit.m_w = dgFloat32 (1.0f);
+		body->SetMatrixResetSleep (matrix);
+	} else if (state.m_position || state.m_rotation) {
+		dgMatrix matrix (body->GetMatrix());
+		if (state.m_rotation) {
+			const dgFloat32* const rotation = (dgFloat32*) (((dgInt8*)state.m_rotation) + index * state.m_rotationStrideInBytes);
+			matrix = dgMatrix (dgQuaternion (rotation[0], rotation[1], rotation[2], rotation[3]), matrix.m_posit);
+		}
+		if (state.m_position) {
+			const dgFloat32* const position = (dgFloat32*) (((dgInt8*)state.m_position) + index * state.m_positionStrideInBytes);
+			matrix.m_posit = dgVector (position[0], position[1], position[2], dgFloat32 (1.0f));
+		}
+		body->SetMatrixResetSleep (matrix);
+	}
+
+	if (state.m_veloc) {
+		const dgFloat32* const veloc = (dgFloat32*) (((dgInt8*)state.m_veloc) + index * state.m_velocStrideInBytes);
+		body->SetVelocity (dgVector (veloc[0], veloc[1], veloc[2], dgFloat32 (0.0f)));
+	}
+
+	if (state.m_omega) {
+		const dgFloat32* const omega = (dgFloat32*) (((dgInt8*)state.m_omega) + index * state.m_omegaStrideInBytes);
+		body->SetOmega (dgVector (omega[0], omega[1], omega[2], dgFloat32 (0.0f)));
+	}
+
+	if (state.m_sleepState) {
+		const dgInt32* const sleepState = (dgInt32*) (((dgInt8*)state.m_sleepState) + index * state.m_sleepStateStrideInBytes);
+		body->SetSleepState (*sleepState ? true : false);
+	}
+}
+
 void dgWorld::RunStep ()
 {
 	static int zzzz;
@@ -962,6 +1245,9 @@ void dgWorld::RunStep ()
 
 
 	DG_TRACKTIME(__FUNCTION__);
+	// the update owns the worker threads until it is completed, a tool that borrowed them is waited for
+	dgThreadHive::Acquire();
+
 	dgUnsigned64 timeAcc = dgGetTimeInMicrosenconds();
 	dgFloat32 step = m_savetimestep / m_numberOfSubsteps;
 	for (dgUnsigned32 i = 0; i < m_numberOfSubsteps; i ++) {
@@ -991,6 +1277,7 @@ void dgWorld::RunStep ()
 
 	m_lastExecutionTime = (dgGetTimeInMicrosenconds() - timeAcc) * dgFloat32 (1.0e-6f);
 
+	dgThreadHive::Release();
 	if (!m_concurrentUpdate) {
 		m_mutex.Release();
 	}
@@ -1055,6 +1342,10 @@ void dgWorld::SetBroadPhaseType(dgInt32 type)
 				newBroadPhase = new (m_allocator) dgBroadPhasePersistent(this);
 				break;
 
+			case m_sweepAndPruneBroadphase:
+				newBroadPhase = new (m_allocator) dgBroadPhaseSweepAndPrune(this);
+				break;
+
 			case m_defaultBroadphase:
 			default:
 				newBroadPhase = new (m_allocator) dgBroadPhaseDefault(this);
@@ -1077,6 +1368,10 @@ void dgWorld::ResetBroadPhase()
 			newBroadPhase = new (m_allocator) dgBroadPhasePersistent(this);
 			break;
 
+		case m_sweepAndPruneBroadphase:
+			newBroadPhase = new (m_allocator) dgBroadPhaseSweepAndPrune(this);
+			break;
+
 		case m_defaultBroadphase:
 		default:
 			newBroadPhase = new (m_allocator) dgBroadPhaseDefault(this);
@@ -1244,6 +1539,7 @@ dgInt32 dgWorld::CompareJointByInvMass(const dgBilateralConstraint* const jointA
 void dgWorld::UpdateSkeletons()
 {
 	DG_TRACKTIME(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memorySkeletons);
 	dgSkeletonList& skelManager = *this;
 	if (skelManager.m_skelListIsDirty) {
 		skelManager.m_skelListIsDirty = false;
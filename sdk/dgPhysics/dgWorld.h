@@ -38,6 +38,7 @@
 
 #define DG_SLEEP_ENTRIES					8
 #define DG_MAX_DESTROYED_BODIES_BY_FORCE	8
+#define DG_BODY_STATE_PARALLEL_COUNT		256
 
 class dgBody;
 class dgDynamicBody;
@@ -54,6 +55,7 @@ class dgSkeletonContainer;
 class dgUpVectorConstraint;
 class dgUniversalConstraint;
 class dgCorkscrewConstraint;
+class dgCollisionConvexPolygon;
 class dgCollisionDeformableMesh;
 
 
@@ -152,6 +154,41 @@ class dgDeadBodies: public dgTree<dgBody*, void* >
 	dgInt32 m_lock;
 };
 
+// application owned arrays for reading or writing the state of many bodies in one call.
+// arrays set to NULL are skipped, all strides are in bytes.
+class dgBodyStateArrays
+{
+	public:
+	dgBodyStateArrays()
+		:m_matrix(NULL)
+		,m_position(NULL)
+		,m_rotation(NULL)
+		,m_veloc(NULL)
+		,m_omega(NULL)
+		,m_sleepState(NULL)
+		,m_matrixStrideInBytes(0)
+		,m_positionStrideInBytes(0)
+		,m_rotationStrideInBytes(0)
+		,m_velocStrideInBytes(0)
+		,m_omegaStrideInBytes(0)
+		,m_sleepStateStrideInBytes(0)
+	{
+	}
+
+	dgFloat32* m_matrix;
+	dgFloat32* m_position;
+	dgFloat32* m_rotation;
+	dgFloat32* m_veloc;
+	dgFloat32* m_omega;
+	dgInt32* m_sleepState;
+	dgInt32 m_matrixStrideInBytes;
+	dgInt32 m_positionStrideInBytes;
+	dgInt32 m_rotationStrideInBytes;
+	dgInt32 m_velocStrideInBytes;
+	dgInt32 m_omegaStrideInBytes;
+	dgInt32 m_sleepStateStrideInBytes;
+};
+
 typedef void (*dgPostUpdateCallback) (const dgWorld* const world, dgFloat32 timestep);
 
 DG_MSC_VECTOR_ALIGMENT
@@ -187,6 +224,7 @@ class dgWorld
 	{
 		m_defaultBroadphase,
 		m_persistentBroadphase,
+		m_sweepAndPruneBroadphase,
 	};
 
 	class dgListener
@@ -249,6 +287,12 @@ class dgWorld
 	void EnableThreadOnSingleIsland(dgInt32 mode);
 	dgInt32 GetThreadOnSingleIsland() const;
 
+	void EnableSpeculativeContacts(dgInt32 mode);
+	dgInt32 GetSpeculativeContacts() const;
+
+	void EnableSleepAwareBroadphase(dgInt32 mode);
+	dgInt32 GetSleepAwareBroadphase() const;
+
 	void FlushCache();
 
 	virtual dgUnsigned64 GetTimeInMicrosenconds() const;
@@ -394,16 +438,34 @@ class dgWorld
 	dgContactMaterial* GetNextMaterial (dgContactMaterial* material) const;
 
 	void SetThreadsCount (dgInt32 count);
+
+	// the worker threads can be borrowed by the tools with a dgScopeIdleThreadPool, the update owns 
+	// them for the whole step, so the tools only get them while the world is not being updated
+	dgThreadHive* GetThreadPool();
 	
 	//Parallel Job dispatcher for user related stuff
 	void ExecuteUserJob (dgWorkerThreadTaskCallback userJobKernel, void* const userJobKernelContext);
 
+	// read or write the state of a set of bodies on the worker threads, 
+	// when bodies is NULL the call applies to all bodies in the world in list order.
+	dgInt32 GetBodiesState (dgBody** const bodies, dgInt32 count, const dgBodyStateArrays& state);
+	dgInt32 SetBodiesState (dgBody** const bodies, dgInt32 count, const dgBodyStateArrays& state);
+
+	// an island is the set of dynamic bodies connected to a body by joints or by active contacts, 
+	// static bodies are not part of any island and stop the propagation.
+	dgInt32 ForEachBodyInIsland (dgBody* const body, OnBodiesInAABB callback, void* const userData);
+	dgInt32 SetIslandSleepState (dgBody* const body, bool state);
+	dgInt32 SetIslandFreezeState (dgBody* const body, bool state);
+	dgInt32 SetSleepStateInAABB (const dgVector& minBox, const dgVector& maxBox, bool state);
+	dgInt32 SetFreezeStateInAABB (const dgVector& minBox, const dgVector& maxBox, bool state);
+
 	void BodyEnableSimulation (dgBody* const body);
 	void BodyDisableSimulation (dgBody* const body);
 	bool GetBodyEnableDisableSimulationState (dgBody* const body) const;
 
 	dgDynamicBody* GetSentinelBody() const;
 	dgMemoryAllocator* GetAllocator() const;
+	dgFrameAllocator& GetFrameAllocator();
 
 	dgInt32 GetBroadPhaseType() const;
 	void SetBroadPhaseType (dgInt32 type);
@@ -425,12 +487,25 @@ class dgWorld
 		dgFloat32 m_dist;
 	};
 
+	class dgBodyStateDescriptor
+	{
+		public:
+		dgBody** m_bodies;
+		const dgBodyStateArrays* m_state;
+		dgBodyMasterList::dgListNode* m_firstNode;
+		dgInt32 m_count;
+		dgInt32 m_index;
+		dgInt32 m_threadCount;
+		bool m_write;
+	};
+
 	void RunStep ();
 	void CalculateContacts (dgBroadPhase::dgPair* const pair, dgInt32 threadIndex, bool ccdMode, bool intersectionTestOnly);
 	dgInt32 PruneContacts (dgInt32 count, dgContactPoint* const contact, dgFloat32 distTolerenace, dgInt32 maxCount = (DG_CONSTRAINT_MAX_ROWS / 3)) const;
-	dgInt32 ReduceContacts (dgInt32 count, dgContactPoint* const contact, dgInt32 maxCount, dgFloat32 tol, dgInt32 arrayIsSorted = 0) const;
+	dgInt32 ReduceContacts (dgInt32 count, dgContactPoint* const contact, dgInt32 maxCount) const;
 	dgInt32 CalculateConvexPolygonToHullContactsDescrete (dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculatePolySoupToHullContactsDescrete (dgCollisionParamProxy& proxy) const;
+	dgInt32 CullPolySoupFaces (const dgCollisionParamProxy& proxy, const dgCollisionConvexPolygon& polygon, const dgCollisionInstance* const polySoupInstance, const dgMatrix& polySoupScaledMatrix, dgInt32* const faceArray, dgVector* const facePlanes, dgFloat32& closestDist) const;
 	dgInt32 CalculateConvexToNonConvexContactsContinue (dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculateUserContacts (dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculateConvexToNonConvexContacts (dgCollisionParamProxy& proxy) const;
@@ -467,6 +542,24 @@ class dgWorld
 
 	static dgUnsigned32 dgApi GetPerformanceCount ();
 	static void UpdateTransforms(void* const context, void* const node, dgInt32 threadID);
+	static void BodiesStateKernel (void* const context, void* const worldContext, dgInt32 threadID);
+	static void GetBodyState (const dgBody* const body, dgInt32 index, const dgBodyStateArrays& state);
+	static void SetBodyState (dgBody* const body, dgInt32 index, const dgBodyStateArrays& state);
+	dgInt32 BodiesState (dgBody** const bodies, dgInt32 count, const dgBodyStateArrays& state, bool write);
+	class dgBodyStateChange
+	{
+		public:
+		dgBodyStateChange (bool state)
+			:m_count(0)
+			,m_state(state)
+		{
+		}
+		dgInt32 m_count;
+		bool m_state;
+	};
+
+	static dgInt32 dgApi SetBodySleepStateCallback (dgBody* body, void* const userData);
+	static dgInt32 dgApi SetBodyFreezeStateCallback (dgBody* body, void* const userData);
 	static dgInt32 SortFaces (const dgAdressDistPair* const A, const dgAdressDistPair* const B, void* const context);
 	static dgInt32 CompareJointByInvMass (const dgBilateralConstraint* const jointA, const dgBilateralConstraint* const jointB, void* notUsed);
 
@@ -478,6 +571,8 @@ class dgWorld
 	dgUnsigned32 m_defualtBodyGroupID;
 	dgUnsigned32 m_bodiesUniqueID;
 	dgUnsigned32 m_useParallelSolver;
+	dgUnsigned32 m_useSpeculativeContacts;
+	dgUnsigned32 m_useSleepAwareBroadphase;
 	dgUnsigned32 m_genericLRUMark;
 	dgInt32 m_delayDelateLock;
 	dgInt32 m_clusterLRU;
@@ -513,9 +608,10 @@ class dgWorld
 	dgArray<dgUnsigned8> m_bodiesMemory; 
 	dgArray<dgUnsigned8> m_jointsMemory; 
 	dgArray<dgUnsigned8> m_solverJacobiansMemory;  
-	dgArray<dgUnsigned8> m_solverRightHandSideMemory;
-	dgArray<dgUnsigned8> m_solverForceAccumulatorMemory;
 	dgArray<dgUnsigned8> m_clusterMemory;
+	dgArray<dgInt32> m_culledFacesMemory[DG_MAX_THREADS_HIVE_COUNT];
+	dgArray<dgVector> m_culledFacePlanesMemory[DG_MAX_THREADS_HIVE_COUNT];
+	dgFrameAllocator m_frameAllocator;
 	
 	bool m_concurrentUpdate;
 	
@@ -566,6 +662,16 @@ inline dgMemoryAllocator* dgWorld::GetAllocator() const
 	return m_allocator;
 }
 
+inline dgFrameAllocator& dgWorld::GetFrameAllocator()
+{
+	return m_frameAllocator;
+}
+
+inline dgThreadHive* dgWorld::GetThreadPool()
+{
+	return (dgWorldThreadPool*) this;
+}
+
 inline dgBroadPhase* dgWorld::GetBroadPhase() const
 {
 	return m_broadPhase;
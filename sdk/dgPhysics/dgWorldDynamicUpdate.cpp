@@ -40,6 +40,13 @@
 dgVector dgWorldDynamicUpdate::m_velocTol (dgFloat32 (1.0e-8f));
 
 
+class dgSkeletonSolverEntry
+{
+	public:
+	dgSkeletonContainer* m_skeleton;
+	const dgBodyCluster* m_cluster;
+};
+
 class dgWorldDynamicUpdateSyncDescriptor
 {
 	public:
@@ -53,20 +60,20 @@ class dgWorldDynamicUpdateSyncDescriptor
 	
 	dgInt32 m_clusterCount;
 	dgInt32 m_firstCluster;
+	dgInt32 m_updateTransforms;
+
+	dgSkeletonSolverEntry* m_skeletons;
+	dgInt32 m_skeletonCount;
+	dgInt32 m_skeletonIndex;
 };
 
 
 void dgJacobianMemory::Init(dgWorld* const world, dgInt32 rowsCount, dgInt32 bodyCount)
 {
-	world->m_solverJacobiansMemory.ResizeIfNecessary((rowsCount + 1) * sizeof(dgLeftHandSide));
-	m_leftHandSizeBuffer = (dgLeftHandSide*)&world->m_solverJacobiansMemory[0];
-
-	world->m_solverRightHandSideMemory.ResizeIfNecessary((rowsCount + 1) * sizeof(dgRightHandSide));
-	m_righHandSizeBuffer = (dgRightHandSide*)&world->m_solverRightHandSideMemory[0];
-
-	world->m_solverForceAccumulatorMemory.ResizeIfNecessary((bodyCount + 8) * sizeof(dgJacobian));
-	m_internalForcesBuffer = (dgJacobian*)&world->m_solverForceAccumulatorMemory[0];
-	dgAssert(bodyCount <= (((world->m_solverForceAccumulatorMemory.GetBytesCapacity() - 16) / dgInt32(sizeof(dgJacobian))) & (-8)));
+	dgFrameAllocator& frameAllocator = world->m_frameAllocator;
+	m_leftHandSizeBuffer = (dgLeftHandSide*)frameAllocator.Alloc((rowsCount + 1) * sizeof(dgLeftHandSide));
+	m_righHandSizeBuffer = (dgRightHandSide*)frameAllocator.Alloc((rowsCount + 1) * sizeof(dgRightHandSide));
+	m_internalForcesBuffer = (dgJacobian*)frameAllocator.Alloc((bodyCount + 8) * sizeof(dgJacobian));
 
 	dgAssert((dgUnsigned64(m_leftHandSizeBuffer) & 0x01f) == 0);
 	dgAssert((dgUnsigned64(m_internalForcesBuffer) & 0x01f) == 0);
@@ -83,6 +90,7 @@ dgWorldDynamicUpdate::dgWorldDynamicUpdate(dgMemoryAllocator* const allocator)
 	,m_markLru(0)
 	,m_softBodyCriticalSectionLock(0)
 	,m_clusterMemory(NULL)
+	,m_clusterSort()
 	,m_parallelSolver(allocator)
 {
 	m_parallelSolver.m_world = (dgWorld*) this;
@@ -91,6 +99,7 @@ dgWorldDynamicUpdate::dgWorldDynamicUpdate(dgMemoryAllocator* const allocator)
 void dgWorldDynamicUpdate::UpdateDynamics(dgFloat32 timestep)
 {
 	DG_TRACKTIME(__FUNCTION__);
+	dgMemoryCategoryScope memoryScope (m_memorySolver);
 
 	m_bodies = 0;
 	m_joints = 0;
@@ -144,33 +153,115 @@ void dgWorldDynamicUpdate::UpdateDynamics(dgFloat32 timestep)
 	}
 
 	if (index < m_clusters) {
+		// with a single sub step and no post listeners the body matrices are final once the cluster 
+		// is solved, so the transform callbacks of a cluster run while the other clusters are solved.
+		bool hasPostListeners = false;
+		for (dgWorld::dgListenerList::dgListNode* node = world->m_listeners.GetFirst(); node; node = node->GetNext()) {
+			hasPostListeners = hasPostListeners || (node->GetInfo().m_onPostUpdate != NULL);
+		}
+
 		descriptor.m_atomicCounter = 0;
 		descriptor.m_firstCluster = index;
 		descriptor.m_clusterCount = m_clusters - index;
+		descriptor.m_updateTransforms = ((world->m_numberOfSubsteps == 1) && !hasPostListeners) ? 1 : 0;
+
+		const dgSkeletonList& skeletonList = *world;
+		if ((threadCount > 1) && skeletonList.GetCount()) {
+			// the skeletons of a cluster are factorized by the thread that solves it, so a pile of ragdolls 
+			// in one cluster runs on one thread. instead the jacobians are built first, then each skeleton
+			// is factorized by its own job, largest first, and then the clusters are solved.
+			descriptor.m_skeletons = (dgSkeletonSolverEntry*) world->m_frameAllocator.Alloc (skeletonList.GetCount() * sizeof (dgSkeletonSolverEntry));
+			for (dgInt32 i = 0; i < threadCount; i ++) {
+				world->QueueJob (BuildClusterJacobiansKernel, &descriptor, world, "dgWorldDynamicUpdate::BuildClusterJacobians");
+			}
+			world->SynchronizationBarrier();
+
+			if (descriptor.m_skeletonCount) {
+				dgSort (descriptor.m_skeletons, descriptor.m_skeletonCount, CompareSkeletonEntries);
+				for (dgInt32 i = 0; i < threadCount; i ++) {
+					world->QueueJob (InitSkeletonsMassMatrixKernel, &descriptor, world, "dgWorldDynamicUpdate::InitSkeletonsMassMatrix");
+				}
+				world->SynchronizationBarrier();
+			}
+			descriptor.m_atomicCounter = 0;
+		}
+
 		for (dgInt32 i = 0; i < threadCount; i ++) {
 			world->QueueJob (CalculateClusterReactionForcesKernel, &descriptor, world, "dgWorldDynamicUpdate::CalculateClusterReactionForces");
 		}
 		world->SynchronizationBarrier();
 	}
 
-	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
-	for (dgInt32 i = 0; i < softBodiesCount; i++) {
-		dgBodyCluster* const cluster = &m_clusterMemory[i];
-//		IntegrateExternalForce(cluster, timestep, 0);
-		dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
-		dgAssert (cluster->m_bodyCount == 2);
-		dgDynamicBody* const body = (dgDynamicBody*)bodyArray[1].m_body;
-		dgAssert (body->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI));
-		body->IntegrateOpenLoopExternalForce(timestep);
-		IntegrateVelocity(cluster, DG_SOLVER_MAX_ERROR, timestep, 0);
+	if (softBodiesCount) {
+		// small soft bodies are integrated concurrently, one per thread 
+		descriptor.m_atomicCounter = 0;
+		descriptor.m_firstCluster = 0;
+		descriptor.m_clusterCount = softBodiesCount;
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			world->QueueJob (IntegrateSoftBodiesKernel, &descriptor, world, "dgWorldDynamicUpdate::IntegrateSoftBodies");
+		}
+		world->SynchronizationBarrier();
+
+		// large soft bodies are integrated one at a time using all threads
+		for (dgInt32 i = 0; i < softBodiesCount; i++) {
+			dgBodyCluster* const cluster = &m_clusterMemory[i];
+			if (IsLargeSoftBody(cluster)) {
+				IntegrateSoftBody(cluster, timestep, 0);
+			}
+		}
 	}
 
 	m_clusterMemory = NULL;
 }
 
+bool dgWorldDynamicUpdate::IsLargeSoftBody(const dgBodyCluster* const cluster) const
+{
+	dgWorld* const world = (dgWorld*) this;
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
+	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+	dgAssert (cluster->m_bodyCount == 2);
+	const dgBody* const body = bodyArray[1].m_body;
+	dgAssert (body->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI));
+	const dgCollisionLumpedMassParticles* const lumpedMassShape = (dgCollisionLumpedMassParticles*)body->m_collision->GetChildShape();
+	return (world->GetThreadCount() > 1) && (lumpedMassShape->GetCount() >= DG_LUMPED_MASS_PARALLEL_PARTICLES_COUNT);
+}
+
+void dgWorldDynamicUpdate::IntegrateSoftBody(const dgBodyCluster* const cluster, dgFloat32 timestep, dgInt32 threadID) const
+{
+	dgWorld* const world = (dgWorld*) this;
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
+	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+	dgAssert (cluster->m_bodyCount == 2);
+	dgDynamicBody* const body = (dgDynamicBody*)bodyArray[1].m_body;
+	dgAssert (body->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI));
+	body->IntegrateOpenLoopExternalForce(timestep);
+	IntegrateVelocity(cluster, DG_SOLVER_MAX_ERROR, timestep, threadID);
+}
+
+void dgWorldDynamicUpdate::IntegrateSoftBodiesKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgWorldDynamicUpdateSyncDescriptor* const descriptor = (dgWorldDynamicUpdateSyncDescriptor*) context;
+
+	dgFloat32 timestep = descriptor->m_timestep;
+	dgWorld* const world = (dgWorld*) worldContext;
+	dgInt32 count = descriptor->m_clusterCount;
+	dgBodyCluster* const clusters = &((dgBodyCluster*)&world->m_clusterMemory[0])[descriptor->m_firstCluster];
+
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1); i < count; i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1)) {
+		dgBodyCluster* const cluster = &clusters[i]; 
+		if (!world->IsLargeSoftBody(cluster)) {
+			world->IntegrateSoftBody(cluster, timestep, threadID);
+		}
+	}
+}
+
 void dgWorldDynamicUpdate::SortClustersByCount ()
 {
-	dgSort(m_clusterMemory, m_clusters, CompareClusters);
+	// the upper half of the cluster memory is used as the merge buffer
+	dgWorld* const world = (dgWorld*) this;
+	world->m_clusterMemory.ResizeIfNecessary (2 * m_clusters * sizeof (dgBodyCluster));
+	m_clusterMemory = (dgBodyCluster*) &world->m_clusterMemory[0];
+	m_clusterSort.Sort (world, m_clusterMemory, &m_clusterMemory[m_clusters], m_clusters, CompareClusters);
 }
 
 DG_INLINE dgBody* dgWorldDynamicUpdate::Find(dgBody* const body) const
@@ -531,7 +622,9 @@ void dgWorldDynamicUpdate::SpanningTree (dgDynamicBody* const body, dgDynamicBod
 			dgAssert (constraintArray[i].m_pairCount < 64);
 			rowsCount += constraintArray[i].m_pairCount;
 			if (joint->GetId() == dgConstraint::m_contactConstraint) {
-				if (body0->m_continueCollisionMode | body1->m_continueCollisionMode) {
+				// pairs using speculative contacts are resolved in the regular solver pass
+				const bool speculative = body0->UseSpeculativeContacts() || body1->UseSpeculativeContacts();
+				if ((body0->m_continueCollisionMode | body1->m_continueCollisionMode) && !speculative) {
 					dgInt32 ccdJoint = false;
 					const dgVector& veloc0 = body0->m_veloc;
 					const dgVector& veloc1 = body1->m_veloc;
@@ -755,7 +848,91 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForcesKernel (void* const con
 
 	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1); i < count; i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1)) {
 		dgBodyCluster* const cluster = &clusters[i]; 
-		world->ResolveClusterForces (cluster, threadID, timestep);
+		if (descriptor->m_skeletons) {
+			world->ResolveClusterForces (cluster, cluster->m_activeJointCount, true, threadID, timestep);
+		} else {
+			const dgInt32 activeJoint = world->BuildClusterJacobians (cluster, threadID, timestep);
+			world->ResolveClusterForces (cluster, activeJoint, false, threadID, timestep);
+		}
+		if (descriptor->m_updateTransforms) {
+			world->UpdateClusterTransforms (cluster, threadID);
+		}
+	}
+}
+
+void dgWorldDynamicUpdate::BuildClusterJacobiansKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgWorldDynamicUpdateSyncDescriptor* const descriptor = (dgWorldDynamicUpdateSyncDescriptor*) context;
+
+	dgFloat32 timestep = descriptor->m_timestep;
+	dgWorld* const world = (dgWorld*) worldContext;
+	dgInt32 count = descriptor->m_clusterCount;
+	dgBodyCluster* const clusters = &((dgBodyCluster*)&world->m_clusterMemory[0])[descriptor->m_firstCluster];
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
+
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1); i < count; i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1)) {
+		dgBodyCluster* const cluster = &clusters[i]; 
+		cluster->m_activeJointCount = world->BuildClusterJacobians (cluster, threadID, timestep);
+		if (!cluster->m_isContinueCollision && (cluster->m_activeJointCount >= 1)) {
+			// continuous collision clusters factorize their skeletons on each sub step, so they are not collected
+			const dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+			const dgInt32 lru = dgAtomicExchangeAndAdd(&dgSkeletonContainer::m_lruMarker, 1);
+			for (dgInt32 j = 1; j < cluster->m_bodyCount; j++) {
+				dgSkeletonContainer* const container = bodyArray[j].m_body->GetSkeleton();
+				if (container && (container->m_lru != lru)) {
+					container->m_lru = lru;
+					const dgInt32 index = dgAtomicExchangeAndAdd(&descriptor->m_skeletonCount, 1);
+					descriptor->m_skeletons[index].m_skeleton = container;
+					descriptor->m_skeletons[index].m_cluster = cluster;
+				}
+			}
+		}
+	}
+}
+
+void dgWorldDynamicUpdate::InitSkeletonsMassMatrixKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgWorldDynamicUpdateSyncDescriptor* const descriptor = (dgWorldDynamicUpdateSyncDescriptor*) context;
+	dgWorld* const world = (dgWorld*) worldContext;
+	dgJointInfo* const constraintArrayPtr = (dgJointInfo*)&world->m_jointsMemory[0];
+	const dgInt32 count = descriptor->m_skeletonCount;
+	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_skeletonIndex, 1); i < count; i = dgAtomicExchangeAndAdd(&descriptor->m_skeletonIndex, 1)) {
+		const dgSkeletonSolverEntry& entry = descriptor->m_skeletons[i];
+		const dgBodyCluster* const cluster = entry.m_cluster;
+		const dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+		const dgLeftHandSide* const leftHandSide = &world->m_solverMemory.m_leftHandSizeBuffer[cluster->m_rowsStart];
+		dgRightHandSide* const rightHandSide = &world->m_solverMemory.m_righHandSizeBuffer[cluster->m_rowsStart];
+		entry.m_skeleton->InitMassMatrix(constraintArray, leftHandSide, rightHandSide, threadID);
+	}
+}
+
+dgInt32 dgWorldDynamicUpdate::CompareSkeletonEntries (const dgSkeletonSolverEntry* const entryA, const dgSkeletonSolverEntry* const entryB, void* notUsed)
+{
+	// sort from high to low node count
+	const dgInt32 countA = entryA->m_skeleton->m_nodeCount;
+	const dgInt32 countB = entryB->m_skeleton->m_nodeCount;
+	if (countA > countB) {
+		return -1;
+	}
+	if (countA < countB) {
+		return 1;
+	}
+	return 0;
+}
+
+void dgWorldDynamicUpdate::UpdateClusterTransforms (const dgBodyCluster* const cluster, dgInt32 threadID) const
+{
+	// a body with mass is in only one cluster, the final transforms pass skips the bodies updated here
+	dgWorld* const world = (dgWorld*) this;
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
+	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+	for (dgInt32 i = 1; i < cluster->m_bodyCount; i++) {
+		dgBody* const body = bodyArray[i].m_body;
+		dgAssert (body->m_invMass.m_w > dgFloat32 (0.0f));
+		if (body->m_transformIsDirty && body->m_matrixUpdate) {
+			body->m_matrixUpdate (*body, body->m_matrix, threadID);
+		}
+		body->m_transformIsDirty = false;
 	}
 }
 
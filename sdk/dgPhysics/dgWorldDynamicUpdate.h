@@ -56,6 +56,7 @@
 class dgBody;
 class dgDynamicBody;
 class dgWorldDynamicUpdateSyncDescriptor;
+class dgSkeletonSolverEntry;
 
 
 class dgClusterCallbackStruct
@@ -84,6 +85,7 @@ class dgBodyCluster
 	dgInt32 m_rowsStart;
 	dgInt32 m_rowsCount;
 	dgInt32 m_clusterLRU;
+	dgInt32 m_activeJointCount;
 	dgInt16 m_isContinueCollision;
 	dgInt16 m_hasSoftBodies;
 };
@@ -221,14 +223,20 @@ class dgWorldDynamicUpdate
 	static dgInt32 CompareBodyInfos(const dgBodyInfo* const infoA, const dgBodyInfo* const infoB, void* notUsed);
 	static dgInt32 CompareJointInfos(const dgJointInfo* const infoA, const dgJointInfo* const infoB, void* notUsed);
 	static dgInt32 CompareClusters(const dgBodyCluster* const clusterA, const dgBodyCluster* const clusterB, void* notUsed);
+	static dgInt32 CompareSkeletonEntries(const dgSkeletonSolverEntry* const entryA, const dgSkeletonSolverEntry* const entryB, void* notUsed);
 	static void CalculateClusterReactionForcesKernel (void* const context, void* const worldContext, dgInt32 threadID);
+	static void IntegrateSoftBodiesKernel (void* const context, void* const worldContext, dgInt32 threadID);
+	static void BuildClusterJacobiansKernel (void* const context, void* const worldContext, dgInt32 threadID);
+	static void InitSkeletonsMassMatrixKernel (void* const context, void* const worldContext, dgInt32 threadID);
 
 	
 	void BuildJacobianMatrix (dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
-	void ResolveClusterForces (dgBodyCluster* const cluste, dgInt32 threadID, dgFloat32 timestep) const;
+	dgInt32 BuildClusterJacobians (dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
+	void ResolveClusterForces (dgBodyCluster* const cluster, dgInt32 activeJoint, bool skeletonsFactorized, dgInt32 threadID, dgFloat32 timestep) const;
+	void UpdateClusterTransforms (const dgBodyCluster* const cluster, dgInt32 threadID) const;
 	void IntegrateReactionsForces(const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
 	void BuildJacobianMatrix (const dgBodyInfo* const bodyInfo, dgJointInfo* const jointInfo, dgJacobian* const internalForces, dgLeftHandSide* const matrixRow, dgRightHandSide* const rightHandSide, dgFloat32 forceImpulseScale) const;
-	void CalculateClusterReactionForces(const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
+	void CalculateClusterReactionForces(const dgBodyCluster* const cluster, bool skeletonsFactorized, dgInt32 threadID, dgFloat32 timestep) const;
 	void CalculateReactionForcesParallel(const dgBodyCluster* const clusters, dgInt32 clustersCount, dgFloat32 timestep);
 		
 	dgFloat32 CalculateJointForce(const dgJointInfo* const jointInfo, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces, const dgLeftHandSide* const matrixRow, dgRightHandSide* const rightHandSide) const;
@@ -236,6 +244,8 @@ class dgWorldDynamicUpdate
 	dgJacobian IntegrateForceAndToque(dgDynamicBody* const body, const dgVector& force, const dgVector& torque, const dgVector& timestep) const ;
 
 	void SortClustersByCount ();
+	bool IsLargeSoftBody(const dgBodyCluster* const cluster) const;
+	void IntegrateSoftBody(const dgBodyCluster* const cluster, dgFloat32 timestep, dgInt32 threadID) const;
 	void IntegrateExternalForce(const dgBodyCluster* const cluster, dgFloat32 timestep, dgInt32 threadID) const;
 	void IntegrateVelocity (const dgBodyCluster* const cluster, dgFloat32 accelTolerance, dgFloat32 timestep, dgInt32 threadID) const;
 	void CalculateClusterContacts (dgBodyCluster* const cluster, dgFloat32 timestep, dgInt32 currLru, dgInt32 threadID) const;
@@ -247,6 +257,7 @@ class dgWorldDynamicUpdate
 	dgJacobianMemory m_solverMemory;
 	dgInt32 m_softBodyCriticalSectionLock;
 	dgBodyCluster* m_clusterMemory;
+	dgParallelSort<dgBodyCluster> m_clusterSort;
 	
 	dgParallelBodySolver m_parallelSolver;
 	static dgVector m_velocTol;
@@ -168,6 +168,11 @@ void dgParallelBodySolver::CalculateJointForces(const dgBodyCluster& cluster, dg
 	m_bodyProxyArray = dgAlloca(dgBodyProxy, cluster.m_bodyCount);
 	m_bodyJacobiansPairs = dgAlloca (dgBodyJacobianPair, cluster.m_jointCount * 2);
 
+	// sort buffers come from the step frame memory, like the solver jacobian arrays
+	dgFrameAllocator& frameAllocator = m_world->m_frameAllocator;
+	m_bodyJacobiansPairsBuffer = (dgBodyJacobianPair*)frameAllocator.Alloc(cluster.m_jointCount * 2 * sizeof (dgBodyJacobianPair));
+	m_jointArrayBuffer = (dgJointInfo*)frameAllocator.Alloc(cluster.m_jointCount * sizeof (dgJointInfo));
+
 	InitWeights();
 #if 1
 	m_firstPassCoef = dgFloat32(0.0f);
@@ -299,6 +304,25 @@ dgInt32 dgParallelBodySolver::CompareBodyJointsPairs(const dgBodyJacobianPair* c
 	return 0;
 }
 
+dgInt32 dgParallelBodySolver::GetBodyJointsPairRadixKey(const dgBodyJacobianPair* const pair, void* const notUsed)
+{
+	return pair->m_bodyIndex;
+}
+
+dgInt32 dgParallelBodySolver::GetJointRadixKey(const dgJointInfo* const info, void* const notUsed)
+{
+	// same order as CompareJointInfos, resting joints first, then by decreasing row count
+	dgAssert(info->m_pairCount < 256);
+	const dgInt32 resting = (info->m_joint->m_body0->m_resting & info->m_joint->m_body1->m_resting) ? 0 : 1;
+	return (resting << 8) + (255 - info->m_pairCount);
+}
+
+dgInt32 dgParallelBodySolver::GetBodyIndexRadixPasses() const
+{
+	const dgInt32 bodyCount = m_cluster->m_bodyCount;
+	return (bodyCount <= (1 << 8)) ? 1 : ((bodyCount <= (1 << 16)) ? 2 : 3);
+}
+
 DG_INLINE void dgParallelBodySolver::SortWorkGroup(dgInt32 base) const
 {
 	dgJointInfo* const jointArray = m_jointArray;
@@ -324,7 +348,7 @@ void dgParallelBodySolver::InitJacobianMatrix()
 	dgBodyJacobianPair* const bodyJacobiansPairs = m_bodyJacobiansPairs;
 
 	const dgInt32 entryCount = m_cluster->m_jointCount * 2;
-	dgSort(bodyJacobiansPairs, entryCount, CompareBodyJointsPairs);
+	m_bodyJacobiansPairsSort.RadixSort(m_world, bodyJacobiansPairs, m_bodyJacobiansPairsBuffer, entryCount, GetBodyIndexRadixPasses(), GetBodyJointsPairRadixKey);
 	for (dgInt32 i = entryCount - 1; i >= 0; i --) {
 		dgInt32 index = bodyJacobiansPairs[i].m_bodyIndex;
 		bodyProxyArray[index].m_jointStart = i;
@@ -340,7 +364,7 @@ void dgParallelBodySolver::InitJacobianMatrix()
 	internalForces[0].m_angular = dgVector::m_zero;
 
 	dgJointInfo* const jointArray = m_jointArray;
-	dgSort(jointArray, m_cluster->m_jointCount, CompareJointInfos);
+	m_jointSort.RadixSort(m_world, jointArray, m_jointArrayBuffer, m_cluster->m_jointCount, 2, GetJointRadixKey);
 
 	const dgInt32 jointCount = m_jointCount * DG_WORK_GROUP_SIZE;
 	for (dgInt32 i = m_cluster->m_jointCount; i < jointCount; i++) {
@@ -1174,11 +1198,11 @@ void dgParallelBodySolver::ParallelSolver(dgInt32 threadID)
 	
 	InitJacobianMatrix(threadID);
 	m_threadSync.Sync();
+	m_bodyJacobiansPairsSort.RadixSort(m_threadSync, threadID, m_threadCounts, m_bodyJacobiansPairs, m_bodyJacobiansPairsBuffer, m_cluster->m_jointCount * 2, GetBodyIndexRadixPasses(), GetBodyJointsPairRadixKey);
 	if (!threadID) {
 		dgBodyProxy* const bodyProxyArray = m_bodyProxyArray;
 		dgBodyJacobianPair* const bodyJacobiansPairs = m_bodyJacobiansPairs;
 		const dgInt32 entryCount = m_cluster->m_jointCount * 2;
-		dgSort(bodyJacobiansPairs, entryCount, CompareBodyJointsPairs);
 		for (dgInt32 i = entryCount - 1; i >= 0; i--) {
 			dgInt32 index = bodyJacobiansPairs[i].m_bodyIndex;
 			bodyProxyArray[index].m_jointStart = i;
@@ -1188,13 +1212,13 @@ void dgParallelBodySolver::ParallelSolver(dgInt32 threadID)
 
 	InitInternalForces(threadID);
 	m_threadSync.Sync();
+	m_jointSort.RadixSort(m_threadSync, threadID, m_threadCounts, m_jointArray, m_jointArrayBuffer, m_cluster->m_jointCount, 2, GetJointRadixKey);
 	if (!threadID) {
 		dgJacobian* const internalForces = &m_world->m_solverMemory.m_internalForcesBuffer[0];
 		internalForces[0].m_linear = dgVector::m_zero;
 		internalForces[0].m_angular = dgVector::m_zero;
 
 		dgJointInfo* const jointArray = m_jointArray;
-		dgSort(jointArray, m_cluster->m_jointCount, CompareJointInfos);
 
 		const dgInt32 jointCount = m_jointCount * DG_WORK_GROUP_SIZE;
 		for (dgInt32 i = m_cluster->m_jointCount; i < jointCount; i++) {
@@ -263,6 +263,9 @@ class dgParallelBodySolver
 
 	static dgInt32 CompareJointInfos(const dgJointInfo* const infoA, const dgJointInfo* const infoB, void* notUsed);
 	static dgInt32 CompareBodyJointsPairs(const dgBodyJacobianPair* const pairA, const dgBodyJacobianPair* const pairB, void* notUsed);
+	static dgInt32 GetJointRadixKey(const dgJointInfo* const info, void* const notUsed);
+	static dgInt32 GetBodyJointsPairRadixKey(const dgBodyJacobianPair* const pair, void* const notUsed);
+	dgInt32 GetBodyIndexRadixPasses() const;
 
 	DG_INLINE void SortWorkGroup (dgInt32 base) const; 
 	DG_INLINE void TransposeRow (dgSolverSoaElement* const row, const dgJointInfo* const jointInfoArray, dgInt32 index);
@@ -279,6 +282,8 @@ class dgParallelBodySolver
 	dgJointInfo* m_jointArray;
 	dgBodyProxy* m_bodyProxyArray;
 	dgBodyJacobianPair* m_bodyJacobiansPairs;
+	dgBodyJacobianPair* m_bodyJacobiansPairsBuffer;
+	dgJointInfo* m_jointArrayBuffer;
 	dgFloat32 m_timestep;
 	dgFloat32 m_invTimestep;
 	dgFloat32 m_invStepRK;
@@ -299,6 +304,8 @@ class dgParallelBodySolver
 
 	private:
 	dgArray<dgSolverSoaElement> m_massMatrix;
+	dgParallelSort<dgJointInfo> m_jointSort;
+	dgParallelSort<dgBodyJacobianPair> m_bodyJacobiansPairsSort;
 	friend class dgWorldDynamicUpdate;
 };
 
@@ -308,6 +315,9 @@ DG_INLINE dgParallelBodySolver::dgParallelBodySolver(dgMemoryAllocator* const al
 	,m_bodyArray(NULL)
 	,m_jointArray(NULL)
 	,m_bodyProxyArray(NULL)
+	,m_bodyJacobiansPairs(NULL)
+	,m_bodyJacobiansPairsBuffer(NULL)
+	,m_jointArrayBuffer(NULL)
 	,m_timestep(dgFloat32(0.0f))
 	,m_invTimestep(dgFloat32(0.0f))
 	,m_invStepRK(dgFloat32(0.0f))
@@ -323,6 +333,8 @@ DG_INLINE dgParallelBodySolver::dgParallelBodySolver(dgMemoryAllocator* const al
 	,m_soaRowStart(NULL)
 	,m_bodyRowStart(NULL)
 	,m_massMatrix(allocator)
+	,m_jointSort()
+	,m_bodyJacobiansPairsSort()
 {
 }
 
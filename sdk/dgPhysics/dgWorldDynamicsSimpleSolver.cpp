@@ -33,21 +33,27 @@
 //#define DG_TEST_GYRO
 #define DG_USE_SKEL
 
-void dgWorldDynamicUpdate::ResolveClusterForces(dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const
+dgInt32 dgWorldDynamicUpdate::BuildClusterJacobians(dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const
 {
 	dgInt32 activeJoint = cluster->m_jointCount;
 	if (activeJoint > 0) {
 		activeJoint = SortClusters(cluster, timestep, threadID);
 	}
+	if (!cluster->m_isContinueCollision && (activeJoint >= 1)) {
+		BuildJacobianMatrix(cluster, threadID, timestep);
+	}
+	return activeJoint;
+}
 
+void dgWorldDynamicUpdate::ResolveClusterForces(dgBodyCluster* const cluster, dgInt32 activeJoint, bool skeletonsFactorized, dgInt32 threadID, dgFloat32 timestep) const
+{
 	dgWorld* const world = (dgWorld*) this;
 	dgJointInfo* const constraintArrayPtr = (dgJointInfo*)&world->m_jointsMemory[0];
 	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
 
 	if (!cluster->m_isContinueCollision) {
 		if (activeJoint >= 1) {
-			BuildJacobianMatrix(cluster, threadID, timestep);
-			CalculateClusterReactionForces(cluster, threadID, timestep);
+			CalculateClusterReactionForces(cluster, skeletonsFactorized, threadID, timestep);
 		} else if (cluster->m_jointCount == 0) {
 			IntegrateExternalForce(cluster, timestep, threadID);
 		} else {
@@ -328,6 +334,7 @@ void dgWorldDynamicUpdate::CalculateClusterContacts(dgBodyCluster* const cluster
 					contact->m_broadphaseLru = currLru;
 					pair.m_contact = contact;
 					pair.m_cacheIsValid = false;
+					pair.m_isSpeculative = false;
 					pair.m_timestep = timestep;
 					pair.m_contactBuffer = contactArray;
 					world->CalculateContacts (&pair, threadID, false, false);
@@ -378,7 +385,7 @@ void dgWorldDynamicUpdate::IntegrateReactionsForces(const dgBodyCluster* const c
 	if (cluster->m_jointCount == 0) {
 		IntegrateExternalForce(cluster, timestep, threadID);
 	} else {
-		CalculateClusterReactionForces(cluster, threadID, timestep);
+		CalculateClusterReactionForces(cluster, false, threadID, timestep);
 	}
 }
 
@@ -667,7 +674,7 @@ dgJacobian dgWorldDynamicUpdate::IntegrateForceAndToque(dgDynamicBody* const bod
 	return velocStep;
 }
 
-void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const
+void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* const cluster, bool skeletonsFactorized, dgInt32 threadID, dgFloat32 timestep) const
 {
 	dgWorld* const world = (dgWorld*) this;
 	const dgInt32 bodyCount = cluster->m_bodyCount;
@@ -707,7 +714,9 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* c
 		if (container && (container->m_lru != lru)) {
 			container->m_lru = lru;
 			skeletonArray[skeletonCount] = container;
-			container->InitMassMatrix(constraintArray, leftHandSide, rightHandSide);
+			if (!skeletonsFactorized) {
+				container->InitMassMatrix(constraintArray, leftHandSide, rightHandSide, threadID);
+			}
 			skeletonCount++;
 			dgAssert(skeletonCount < dgInt32(sizeof(skeletonArray) / sizeof(skeletonArray[0])));
 		}